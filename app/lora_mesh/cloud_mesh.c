@@ -72,6 +72,7 @@ static struct {
  * Private Function Prototypes
  */
 static bool getQueuedRequest(void);
+static bool checkPayload(const cloud_payload_st *ps_req);
 static void cbRequestSent(void);
 static bool updateChild(uint32_t u32_child_id, const mesh_comms_payload_st *ps_payload);
 
@@ -512,6 +513,13 @@ static bool getQueuedRequest(void)
             //LOGD("re-queued report %u-%u", ps_req->s_hdr.u2_method, ps_req->s_hdr.u3_endpoint);
         }
     }
+    else if (false == checkPayload(ps_req))
+    {
+        // a payload the server would reject anyway: don't spend the uplink on it
+        LOGW("discard malformed request %u (%u bytes, ep=%u)", ps_req->s_hdr.u16_msg_id, ps_req->u16_len, ps_req->s_hdr.u3_endpoint);
+        (void)xQueueReceive(s_cloud_request.queue_send, &ps_req, 10);
+        memset(ps_req, 0, sizeof(cloud_payload_st));
+    }
     else
     {
         // got complete request
@@ -522,6 +530,33 @@ static bool getQueuedRequest(void)
     return false;
 }
 
+// decode an assembled child payload the way the server would, before forwarding it
+static bool checkPayload(const cloud_payload_st *ps_req)
+{
+    ep_payload_kind_et e_kind;
+
+    switch (ps_req->s_hdr.u3_endpoint)
+    {
+    case MESH_COMMS_ENDPOINT_MONITOR:
+        e_kind = EP_PAYLOAD_MONITOR;
+        break;
+    case MESH_COMMS_ENDPOINT_STATUS:
+        e_kind = (MESH_COMMS_REQUEST_PUT == ps_req->s_hdr.u2_method) ? EP_PAYLOAD_STATUS : EP_PAYLOAD_STATUS_GET;
+        break;
+    case MESH_COMMS_ENDPOINT_EVENT:
+        e_kind = EP_PAYLOAD_EVENT;
+        break;
+    case MESH_COMMS_ENDPOINT_UPDATE:
+        e_kind = EP_PAYLOAD_UPDATE_GET;
+        break;
+    default:
+        // cloudMeshCycle() has no path for it either
+        return false;
+    }
+
+    return edgePayloadCheck(e_kind, ps_req->au8_buf, ps_req->u16_len);
+}
+
 static void cbRequestSent(void)
 {
     cloud_payload_st *ps_req = NULL;
@@ -1,9 +1,531 @@
 
 #include "global_defs.h"
+#include <time.h>
+#include <atomic>
+#include <esp_system.h>
+#include <freertos/semphr.h>
+#include <freertos/queue.h>
+#if CONFIG_SPIRAM
+#include <esp_heap_caps.h>
+#endif
+#include "general_info.h"
+#include "enmtr_manager.h"
+#include "monitor_agg/monitor_agg.h"
+#include "energy/energy.h"
+#include "pq_event/pq_event.h"
+#include "data_log/data_log.h"
+#include "mon_codec/mon_codec.h"
+#include "journal/journal.h"
+#include "log_compact/log_compact.h"
 #include "data_logging.h"
 namespace data::logging
 {
 
+/*
+ * Local Constants
+ */
+#define K_EVENT_BUF_LEN     (128)   // serialized event payload, K_PAYLOAD_MAX_EVENTS_COUNT events
+#define K_EVENT_QUEUE_LEN   (4)     // event payloads waiting for cloud::event
+#define K_MONITOR_BUF_LEN   (K_MON_CODEC_MAX_LEN)   // serialized monitor payload, K_PAYLOAD_MAX_MON_PHASE_COUNT full phases
+#define K_DAY_MIN           (1440)  // report intervals divide the day, so their windows meet midnight
+
+typedef struct
+{
+    uint16_t    ui16_len;
+    uint8_t     aui8_buf[K_EVENT_BUF_LEN];
+} event_msg_st;
+
+typedef enum
+{
+    CH_VRMS,
+    CH_IRMS,
+    CH_WATT,
+    CH_VA,
+    CH_VAR,
+    CH_PF,
+    CH_LINE_FREQ,
+    NUM_CH
+} channel_et;
+
+// decoded measurement of each channel, channel A (line side) of every phase
+static const ENMTR_CLASS::meas_et AE_CHANNEL_MEAS[NUM_CH] =
+{
+    ENMTR_CLASS::MEAS_VRMS_A,
+    ENMTR_CLASS::MEAS_IRMS_A,
+    ENMTR_CLASS::MEAS_WATT_A,
+    ENMTR_CLASS::MEAS_VA_A,
+    ENMTR_CLASS::MEAS_VAR_A,
+    ENMTR_CLASS::MEAS_PF_A,
+    ENMTR_CLASS::MEAS_LINE_FREQ,
+};
+
+static const uint8_t     AUI8_TIER_SEGMENTS[K_COMPACT_TIERS] = K_COMPACT_TIER_SEGMENTS;
+static const char      *APC_TIER_DIR[K_COMPACT_TIERS]       = K_COMPACT_TIER_DIRS;
+
+#define CHANNEL_DESC(ch)    ENMTR_CLASS::AS_MEAS_DESC[AE_CHANNEL_MEAS[ch]]
+
+static const mon_agg_channel_st AS_CHANNELS[NUM_CH] =
+{
+    { EP_MON_ID_GDL_VAVE,       EP_MON_ID_GDL_VMIN,     EP_MON_ID_GDL_VMAX,     CHANNEL_DESC(CH_VRMS).si32_div,         CHANNEL_DESC(CH_VRMS).b_signed      },
+    { EP_MON_ID_GDL_IAVE,       EP_MON_ID_GDL_IMIN,     EP_MON_ID_GDL_IMAX,     CHANNEL_DESC(CH_IRMS).si32_div,         CHANNEL_DESC(CH_IRMS).b_signed      },
+    { EP_MON_ID_GDL_WATTAVE,    EP_MON_ID_GDL_WATTMIN,  EP_MON_ID_GDL_WATTMAX,  CHANNEL_DESC(CH_WATT).si32_div,         CHANNEL_DESC(CH_WATT).b_signed      },
+    { EP_MON_ID_GDL_VAAVE,      EP_MON_ID_GDL_VAMIN,    EP_MON_ID_GDL_VAMAX,    CHANNEL_DESC(CH_VA).si32_div,           CHANNEL_DESC(CH_VA).b_signed        },
+    { EP_MON_ID_GDL_VARAVE,     EP_MON_ID_GDL_VARMIN,   EP_MON_ID_GDL_VARMAX,   CHANNEL_DESC(CH_VAR).si32_div,          CHANNEL_DESC(CH_VAR).b_signed       },
+    { EP_MON_ID_GDL_PF,         K_MON_AGG_NO_ID,        K_MON_AGG_NO_ID,        CHANNEL_DESC(CH_PF).si32_div,           CHANNEL_DESC(CH_PF).b_signed        },
+    { EP_MON_ID_GDL_LINE_FREQ,  K_MON_AGG_NO_ID,        K_MON_AGG_NO_ID,        CHANNEL_DESC(CH_LINE_FREQ).si32_div,    CHANNEL_DESC(CH_LINE_FREQ).b_signed },
+};
+
+/*
+ * Local Variables
+ */
+static mon_agg_st                   s_agg;
+static std::atomic<uint16_t>        ui16_interval_request(0);  // minutes from setInterval(), 0 = none
+static ep_writer_st                 s_writer;                   // the interval's monitor payload, encoded as it's built ...
+static uint8_t                      aui8_monitor[K_MONITOR_BUF_LEN];    // ... straight into here
+static ENMTR_CLASS::meas_block_st   s_block;
+static harm_phase_st                as_harm[ENMTR_CLASS::NUM_DEVICES];
+static uint32_t                     ui32_last_seq;
+static uint32_t                     ui32_missed;
+static energy_acc_st                s_energy;
+static pq_detector_st               s_pq;
+static ep_event_payload_st          s_event;
+static uint8_t                      aui8_event_content[K_PAYLOAD_MAX_EVENTS_COUNT][K_PQ_EVENT_CONTENT_LEN];
+static QueueHandle_t                queue_events = NULL;   // event_msg_st, sent & removed by cloud::event
+static dlog_st                      s_log;
+#ifdef K_DLOG_PARTITION
+static dlog_map_st                  s_map;              // s_log windows the query & replay readers walk in place
+#endif
+static mon_codec_st                 s_codec;            // monitor payloads delta coded into s_log
+static journal_st                   s_journal;          // s_log RAM page & energy between their file writes
+static bool                         b_energy_journal;   // restored from the journal
+static uint32_t                     ui32_energy_seq;    // newest snapshot in it, the others are released
+static bool                         b_log;
+static bool                         b_power_good;       // last POWER_GOOD, its drop flushes everything
+static uint32_t                     ui32_reported_writes;
+static SemaphoreHandle_t            mtx_log = NULL;        // s_log, shared with the cloud replay
+static dlog_st                      as_tier_log[K_COMPACT_TIERS - 1];   // s_log downsampled, 15 min & 1 h records
+static compact_rule_st              as_rule[3 * NUM_CH];
+static compact_st                  *ps_compact = NULL;     // s_log & the tiers, under mtx_log
+static compact_stats_st             s_compact_reported;    // statistics at the last report
+static uint32_t                     ms_compact_job;         // time of the job under way so far
+static uint32_t                     ms_compact_worst;       // longest slice
+
+/*
+ * Private Functions
+ */
+static uint16_t intervalMinutes(void)
+{
+    int16_t si16_min = (2 == measure_interval_option) ? measure_interval2 : measure_interval1;
+
+    return (si16_min > 0) ? (uint16_t)si16_min : 1;
+}
+
+// tick seconds (millis) to the wall clock
+static uint32_t wallOffset(void)
+{
+    return (uint32_t)time(NULL) - millis() / 1000;
+}
+
+// a new interval from the web UI / cloud, or the clock set (time sync): the windows switch at the next second
+static void checkInterval(void)
+{
+    uint16_t    ui16_min    = ui16_interval_request.exchange(0);
+    uint32_t    ui32_offset = wallOffset();
+    int32_t     si32_step   = (int32_t)(ui32_offset - ((0 != s_agg.ui16_next_min) ? s_agg.ui32_next_offset_s : s_agg.ui32_offset_s));
+
+    if ((0 == ui16_min) && (si32_step <= K_MON_AGG_REALIGN_S) && (si32_step >= -K_MON_AGG_REALIGN_S))
+    {
+        return;
+    }
+    else if (0 == ui16_min)
+    {
+        ui16_min = (0 != s_agg.ui16_next_min) ? s_agg.ui16_next_min : s_agg.ui16_interval_min;
+        LOGI("clock stepped %ld s, windows realigned", (long)si32_step);
+    }
+    else
+    {
+        LOGI("report interval %u -> %u min", s_agg.ui16_interval_min, ui16_min);
+    }
+
+    (void)monAggSetInterval(&s_agg, ui16_min, ui32_offset);
+}
+
+static void addBlock(const ENMTR_CLASS::meas_block_st *ps_block)
+{
+    int32_t asi32_val[ENMTR_CLASS::NUM_MEAS];
+
+    for (uint8_t d = 0; d < ENMTR_CLASS::NUM_DEVICES; d++)
+    {
+        ENMTR_CLASS::decode_meas(ps_block, (ENMTR_CLASS::device_et)d, asi32_val);
+
+        for (uint8_t c = 0; c < NUM_CH; c++)
+        {
+            monAggAdd(&s_agg, d, c, asi32_val[AE_CHANNEL_MEAS[c]]);
+        }
+
+        pqDetAdd(&s_pq, d, ps_block->ms_timestamp, asi32_val[ENMTR_CLASS::MEAS_VRMS_A]);
+        energyAccAdd(&s_energy, d, ps_block->ms_timestamp, asi32_val[ENMTR_CLASS::MEAS_WATT_A],
+                     asi32_val[ENMTR_CLASS::MEAS_VAR_A], asi32_val[ENMTR_CLASS::MEAS_VA_A]);
+    }
+}
+
+// serialized monitor payload into the data log, delta coded against the previous one
+static void logInterval(int32_t si32_ts, size_t sz_len)
+{
+    if (false == b_log)
+    {
+        return;
+    }
+
+    (void)xSemaphoreTake(mtx_log, portMAX_DELAY);
+    if (false == monCodecAppend(&s_codec, &s_log, si32_ts, aui8_monitor, (uint16_t)sz_len))
+    {
+        LOGW("data log: interval %d not stored", (int)si32_ts);
+    }
+    (void)xSemaphoreGive(mtx_log);
+}
+
+// energy registers with the journal's next write unless they didn't move, the snapshots before
+// aren't needed any more
+static void journalEnergy(void)
+{
+#ifndef K_DLOG_POWER_FAIL_SIGNAL
+    static uint8_t  aui8_journaled[K_ENERGY_SNAPSHOT_LEN];
+    uint8_t         aui8_snapshot[K_ENERGY_SNAPSHOT_LEN];
+    uint16_t        ui16_len = energyAccSnapshot(&s_energy, aui8_snapshot, sizeof(aui8_snapshot));
+    uint32_t        ui32_seq;
+
+    if ((0 != memcmp(aui8_snapshot, aui8_journaled, ui16_len)) &&
+        (true == journalAppend(&s_journal, JOURNAL_STREAM_ENERGY, NULL, 0, aui8_snapshot, ui16_len, &ui32_seq)))
+    {
+        journalRelease(&s_journal, JOURNAL_STREAM_ENERGY, ui32_seq - 1);
+        memcpy(aui8_journaled, aui8_snapshot, ui16_len);
+    }
+    (void)journalSync(&s_journal, millis(), true);
+#endif
+}
+
+static void emitInterval(void)
+{
+    ep_com_header_st    s_header;
+    int32_t             si32_ts = (int32_t)time(NULL);
+    bool                b_harm  = enmtr::manager::takeHarmonics(as_harm);
+    size_t              sz_len  = 0;
+    bool                b_status;
+
+    (void)edgePayloadInitComHeader(&s_header, si32_ts);
+    edgePayloadWriterInit(&s_writer, aui8_monitor, sizeof(aui8_monitor));
+    b_status = edgePayloadWriteComHeader(&s_writer, &s_header);
+
+    for (uint8_t d = 0; (true == b_status) && (d < ENMTR_CLASS::NUM_DEVICES); d++)
+    {
+        b_status = edgePayloadWriteMonitorPhase(&s_writer, (ep_phase_index_et)(EP_PHASE_INDEX_L1 + d)) &&
+                   monAggAddMonitorParams(&s_writer, &s_agg, d) &&
+                   energyAddMonitorParams(&s_writer, &s_energy, d) &&
+                   ((false == b_harm) || harmAddMonitorParams(&s_writer, &as_harm[d]));
+    }
+
+    if ((false == b_status) || (false == edgePayloadWriterEnd(&s_writer, &sz_len)))
+    {
+        LOGW("monitor payload overflow");
+    }
+    else
+    {
+        LOGI("interval %u (%u min%s): %u phases, %u bytes, %u missed blocks", (unsigned)s_agg.ui32_done_window,
+             s_agg.ui16_done_min, (true == s_agg.b_done_cut) ? ", cut by a switch" : "", s_writer.ui8_phase_count,
+             (unsigned)sz_len, (unsigned)ui32_missed);
+        logInterval(si32_ts, sz_len);
+    }
+
+#ifndef K_DLOG_POWER_FAIL_SIGNAL
+    // the interval's record & the energy, one sector write; at most K_JOURNAL_SYNC_MIN late if set
+    if (true == journalDue(&s_journal, millis()))
+    {
+        journalEnergy();
+    }
+#endif
+}
+
+// queued for cloud::event; a full queue (link down for a while) keeps the older payloads
+static void emitEventPayload(void)
+{
+    static event_msg_st s_msg;
+    size_t              sz_len = 0;
+
+    if (false == edgePayloadEvent2Buf(s_msg.aui8_buf, sizeof(s_msg.aui8_buf), &sz_len, &s_event))
+    {
+        LOGW("event payload overflow");
+    }
+    else
+    {
+        s_msg.ui16_len = (uint16_t)sz_len;
+        if (pdTRUE != xQueueSend(queue_events, &s_msg, 0))
+        {
+            LOGW("event queue full: %u events dropped", s_event.ui8_event_count);
+        }
+        else
+        {
+            LOGI("event payload: %u events, %u bytes queued", s_event.ui8_event_count, (unsigned)sz_len);
+        }
+    }
+}
+
+// finished power quality events, K_PAYLOAD_MAX_EVENTS_COUNT per payload
+static void emitEvents(void)
+{
+    ep_com_header_st    s_header;
+    pq_event_st         s_pq_event;
+    int32_t             si32_now = (int32_t)time(NULL);
+    uint32_t            ms_now   = millis();
+
+    while (true == pqDetPop(&s_pq, &s_pq_event))
+    {
+        uint8_t ui8_idx = s_event.ui8_event_count;
+        uint8_t ui8_len;
+
+        if (0 == ui8_idx)
+        {
+            (void)edgePayloadInitComHeader(&s_header, si32_now);
+            (void)edgePayloadInitEvent(&s_event, &s_header);
+        }
+
+        ui8_len = pqEventContent(&s_pq_event, si32_now - (int32_t)((ms_now - s_pq_event.ms_start) / 1000), aui8_event_content[ui8_idx]);
+        LOGI("pq event %02x L%u: %u ms, %u.%02u V", (unsigned)s_pq_event.e_type, s_pq_event.ui8_phase + 1,
+             (unsigned)s_pq_event.ms_duration, s_pq_event.ui16_extreme_cv / 100, s_pq_event.ui16_extreme_cv % 100);
+
+        (void)edgePayloadAddEventContent(&s_event, s_pq_event.e_type, aui8_event_content[ui8_idx], ui8_len);
+        if (K_PAYLOAD_MAX_EVENTS_COUNT == s_event.ui8_event_count)
+        {
+            emitEventPayload();
+            s_event.ui8_event_count = 0;
+        }
+    }
+
+    if (0 != s_event.ui8_event_count)
+    {
+        emitEventPayload();
+        s_event.ui8_event_count = 0;
+    }
+}
+
+// orderly restart (OTA, config change) or power fail: nothing since the last checkpoint gets lost
+static void shutdownHandler(void)
+{
+    journalEnergy();    // staged records first, the smallest write
+    (void)energyAccCheckpoint(&s_energy, millis(), true);
+    if ((true == b_log) && (pdTRUE == xSemaphoreTake(mtx_log, pdMS_TO_TICKS(100))))
+    {
+        (void)dlogFlush(&s_log, millis(), true);
+        (void)xSemaphoreGive(mtx_log);
+    }
+}
+
+#ifndef K_DLOG_POWER_FAIL_SIGNAL
+static bool replayJournal(void *pv_ctx, journal_stream_et e_stream, uint32_t ui32_seq, const uint8_t *pui8_data, uint16_t ui16_len)
+{
+    (void)pv_ctx;
+
+    if (JOURNAL_STREAM_DLOG == e_stream)
+    {
+        return (true == b_log) && dlogReplay(&s_log, ui32_seq, pui8_data, ui16_len);
+    }
+
+    b_energy_journal = energyAccApply(&s_energy, pui8_data, ui16_len) || b_energy_journal;
+    ui32_energy_seq  = ui32_seq;
+
+    return true;
+}
+
+#if (0 != K_JOURNAL_SYNC_MIN)
+// staged journal entries next to the page ring, in PSRAM if the module has it; only pays off with the syncs apart
+static void attachJournalStage(void)
+{
+    size_t      sz_len     = (size_t)K_JOURNAL_STAGE_SECTORS * K_JOURNAL_SECTOR_SIZE;
+    uint8_t    *pui8_stage = NULL;
+
+#if CONFIG_SPIRAM
+    pui8_stage = (uint8_t *)heap_caps_malloc(sz_len, MALLOC_CAP_SPIRAM);
+#endif
+    if (NULL == pui8_stage)
+    {
+        pui8_stage = (uint8_t *)malloc(sz_len);
+    }
+
+    if (false == journalStage(&s_journal, pui8_stage, K_JOURNAL_STAGE_SECTORS))
+    {
+        LOGW("journal: no stage, written at each sector change");
+        free(pui8_stage);
+    }
+}
+#endif
+#endif
+
+// energy checkpoint, then the journal: records of the RAM page & energy since
+static void restoreEnergy(void)
+{
+    esp_reset_reason_t  e_reason = esp_reset_reason();
+    bool                b_checkpoint;
+
+    energyAccInit(&s_energy, ENMTR_CLASS::NUM_DEVICES, K_ENERGY_FILE);
+    b_checkpoint = energyAccRestore(&s_energy);
+
+#ifndef K_DLOG_POWER_FAIL_SIGNAL
+    if (true == journalOpen(&s_journal, K_JOURNAL_FILE, replayJournal, NULL))
+    {
+        LOGI("journal: %u entries, %u data log records restored, %u torn", (unsigned)s_journal.ui32_replayed,
+             (unsigned)s_log.ui32_replayed, (unsigned)s_journal.ui32_torn);
+        if (0 != ui32_energy_seq)
+        {
+            journalRelease(&s_journal, JOURNAL_STREAM_ENERGY, ui32_energy_seq - 1);
+        }
+    }
+    if (true == b_log)
+    {
+        dlogJournal(&s_log, &s_journal);
+    }
+#if (0 != K_JOURNAL_SYNC_MIN)
+    attachJournalStage();
+#endif
+#endif
+
+    if ((false == b_checkpoint) && (false == b_energy_journal))
+    {
+        LOGW("no energy checkpoint, counters start at 0");
+    }
+    else if ((false == b_energy_journal) && ((ESP_RST_POWERON == e_reason) || (ESP_RST_BROWNOUT == e_reason)))
+    {
+        LOGW("power loss: energy since the last checkpoint (< %u min / %u Wh) not counted",
+             K_ENERGY_CHECKPOINT_MIN, K_ENERGY_CHECKPOINT_WH);
+    }
+
+    s_energy.ms_checkpoint = millis();
+
+    if (ESP_OK != esp_register_shutdown_handler(shutdownHandler))
+    {
+        LOGW("energy shutdown handler not registered");
+    }
+}
+
+// completed data log pages wait in PSRAM if the module has it, otherwise in a small internal ring
+static void attachRing(void)
+{
+    uint8_t    *pui8_ring  = NULL;
+    uint16_t    ui16_pages = 0;
+
+#if CONFIG_SPIRAM
+    pui8_ring  = (uint8_t *)heap_caps_malloc((size_t)K_DLOG_PSRAM_RING_PAGES * K_DLOG_PAGE_SIZE, MALLOC_CAP_SPIRAM);
+    ui16_pages = K_DLOG_PSRAM_RING_PAGES;
+#endif
+    if (NULL == pui8_ring)
+    {
+        pui8_ring  = (uint8_t *)malloc((size_t)K_DLOG_RAM_RING_PAGES * K_DLOG_PAGE_SIZE);
+        ui16_pages = K_DLOG_RAM_RING_PAGES;
+    }
+
+    if (false == dlogRing(&s_log, pui8_ring, ui16_pages))
+    {
+        LOGW("data log: no page ring, every page written when full");
+        free(pui8_ring);
+    }
+    else if (K_DLOG_BATCH_PAGES != s_log.ui16_batch)
+    {
+        LOGW("data log: no PSRAM, %u pages ring, written %u KiB at a time instead of %u KiB", s_log.ui16_ring_pages,
+             (unsigned)(s_log.ui16_batch * K_DLOG_PAGE_SIZE / 1024), (unsigned)(K_DLOG_BATCH_PAGES * K_DLOG_PAGE_SIZE / 1024));
+    }
+    else
+    {
+        LOGI("data log: %u pages ring, written %u KiB at a time", s_log.ui16_ring_pages,
+             (unsigned)(s_log.ui16_batch * K_DLOG_PAGE_SIZE / 1024));
+    }
+}
+
+// mean, min & max of the channels as their monitor ids say, the rest by the library's defaults
+static uint8_t buildRules(void)
+{
+    uint8_t ui8_rules = 0;
+
+    for (uint8_t c = 0; c < NUM_CH; c++)
+    {
+        const ep_monitor_id_et  AE_ID[] = { AS_CHANNELS[c].e_mean_id, AS_CHANNELS[c].e_min_id, AS_CHANNELS[c].e_max_id };
+        const compact_op_et     AE_OP[] = { COMPACT_MEAN, COMPACT_MIN, COMPACT_MAX };
+
+        for (uint8_t i = 0; i < (sizeof(AE_ID) / sizeof(AE_ID[0])); i++)
+        {
+            if (K_MON_AGG_NO_ID != AE_ID[i])
+            {
+                as_rule[ui8_rules++] = { (uint8_t)AE_ID[i], (uint8_t)AE_OP[i], AS_CHANNELS[c].b_signed };
+            }
+        }
+    }
+
+    return ui8_rules;
+}
+
+// the volume is shared out between the tiers, the compactor's buffers go to PSRAM if the module has it
+static void initCompaction(void)
+{
+    dlog_st *aps_logs[K_COMPACT_TIERS] = { &s_log };
+
+#if CONFIG_SPIRAM
+    ps_compact = (compact_st *)heap_caps_malloc(sizeof(compact_st), MALLOC_CAP_SPIRAM);
+#endif
+    if (NULL == ps_compact)
+    {
+        ps_compact = (compact_st *)malloc(sizeof(compact_st));
+    }
+    if (NULL == ps_compact)
+    {
+        LOGW("data log compaction: no memory, the oldest segments are dropped");
+        return;
+    }
+
+#ifndef K_DLOG_PARTITION
+    dlogLimit(&s_log, AUI8_TIER_SEGMENTS[0]);
+#endif
+    for (uint8_t t = 1; t < K_COMPACT_TIERS; t++)
+    {
+        if (false == dlogInit(&as_tier_log[t - 1], APC_TIER_DIR[t]))
+        {
+            break;
+        }
+        dlogLimit(&as_tier_log[t - 1], AUI8_TIER_SEGMENTS[t]);
+        aps_logs[t] = &as_tier_log[t - 1];
+    }
+
+    compactInit(ps_compact, aps_logs, as_rule, buildRules());
+    s_compact_reported = ps_compact->s_stats;
+}
+
+// a slice per cycle, the watchdog is fed after it; a report per segment compacted
+static void compactLog(void)
+{
+    uint32_t ms_start = millis();
+    uint32_t ms_slice;
+
+    if ((NULL == ps_compact) || (false == compactStep(ps_compact)))
+    {
+        return;
+    }
+
+    ms_slice          = millis() - ms_start;
+    ms_compact_job   += ms_slice;
+    ms_compact_worst  = (ms_slice > ms_compact_worst) ? ms_slice : ms_compact_worst;
+    if ((true == compactBusy(ps_compact)) || (ps_compact->s_stats.ui32_segments == s_compact_reported.ui32_segments))
+    {
+        return;
+    }
+
+    LOGI("data log compaction: tier %u segment %u (%s), %u records into %u, %u KiB reclaimed, %u ms in %u slices (worst %u ms)",
+         ps_compact->ui8_tier, (unsigned)ps_compact->ui32_seg, (true == ps_compact->b_aged) ? "aged" : "tier full",
+         (unsigned)(ps_compact->s_stats.ui32_records_in - s_compact_reported.ui32_records_in),
+         (unsigned)(ps_compact->s_stats.ui32_records_out - s_compact_reported.ui32_records_out),
+         (unsigned)(((ps_compact->s_stats.ui64_bytes_in - s_compact_reported.ui64_bytes_in) -
+                     (ps_compact->s_stats.ui64_bytes_out - s_compact_reported.ui64_bytes_out)) / 1024),
+         (unsigned)ms_compact_job, (unsigned)(ps_compact->s_stats.ui32_slices - s_compact_reported.ui32_slices), (unsigned)ms_compact_worst);
+    s_compact_reported = ps_compact->s_stats;
+    ms_compact_job     = 0;
+}
+
 /*
  * Public Functions
  */
@@ -11,14 +533,155 @@ bool init()
 {
     LOGD("task_hb_init\n");
    // LOGD("core %u: %s", xPortGetCoreID(), __PRETTY_FUNCTION__);
-    return true;
+    edgePayloadInit();
+    ui32_last_seq = enmtr::manager::getSnapshotSeq();
+    ui32_missed   = 0;
+
+    mtx_log = xSemaphoreCreateMutex();
+    assert(NULL != mtx_log);
+    queue_events = xQueueCreate(K_EVENT_QUEUE_LEN, sizeof(event_msg_st));
+    assert(NULL != queue_events);
+#ifdef K_DLOG_PARTITION
+    b_log = dlogInitPartition(&s_log, esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, K_DLOG_PARTITION));
+    (void)dlogMap(&s_log, &s_map);
+#else
+    b_log = dlogInit(&s_log, K_DLOG_DIR);
+#endif
+    if (true == b_log)
+    {
+        attachRing();
+        initCompaction();
+    }
+    monCodecInit(&s_codec);
+    restoreEnergy();
+    pqDetInit(&s_pq, ENMTR_CLASS::NUM_DEVICES, K_PQ_NOMINAL_CV);
+
+    return monAggInit(&s_agg, AS_CHANNELS, NUM_CH, ENMTR_CLASS::NUM_DEVICES, intervalMinutes()) &&
+           monAggSetInterval(&s_agg, intervalMinutes(), wallOffset());
 }
 
+// every measurement block, in order; windows roll on the block timestamps
 void cycle()
 {
-    //
-     LOGD("dl cyc: ");
+    uint32_t ui32_latest = enmtr::manager::getSnapshotSeq();
+    bool     b_power_now = getSystemFlag(POWER_GOOD);
+
+    // power fail: the hold-up time is for the flash
+    if ((true == b_power_good) && (false == b_power_now))
+    {
+        shutdownHandler();
+        LOGW("power fail: data log & energy flushed");
+    }
+    b_power_good = b_power_now;
+
+    checkInterval();
+    if ((ui32_latest - ui32_last_seq) > K_ENMTR_SNAPSHOT_RING_LEN)
+    {
+        ui32_missed  += (ui32_latest - ui32_last_seq) - K_ENMTR_SNAPSHOT_RING_LEN;
+        ui32_last_seq = ui32_latest - K_ENMTR_SNAPSHOT_RING_LEN;
+    }
+
+    for (uint32_t ui32_seq = ui32_last_seq + 1; ui32_seq <= ui32_latest; ui32_seq++)
+    {
+        if (false == enmtr::manager::getSnapshot(ui32_seq, &s_block))
+        {
+            ui32_missed++;
+            continue;
+        }
+
+        if (true == monAggTick(&s_agg, s_block.ms_timestamp / 1000))
+        {
+            emitInterval();
+        }
+        addBlock(&s_block);
+    }
+    ui32_last_seq = ui32_latest;
+
+    emitEvents();
+
+    if (true == monAggTick(&s_agg, millis() / 1000))
+    {
+        emitInterval();
+    }
+
+    (void)energyAccCheckpoint(&s_energy, millis(), false);
+    if (true == b_log)
+    {
+        (void)xSemaphoreTake(mtx_log, portMAX_DELAY);
+#ifndef K_DLOG_POWER_FAIL_SIGNAL
+        (void)dlogFlush(&s_log, millis(), false);
+#endif
+        if (s_log.ui32_writes != ui32_reported_writes)
+        {
+            LOGI("data log: %u pages in %u writes, %u KiB each on average", (unsigned)s_log.ui32_page_writes,
+                 (unsigned)s_log.ui32_writes, (unsigned)(s_log.ui32_page_writes * (K_DLOG_PAGE_SIZE / 1024) / s_log.ui32_writes));
+            ui32_reported_writes = s_log.ui32_writes;
+        }
+        compactLog();
+        (void)xSemaphoreGive(mtx_log);
+    }
+}
+
+// readers of other tasks (cloud replay) hold the log while they read
+const dlog_st *takeLog(uint32_t ms_wait)
+{
+    if ((NULL == mtx_log) || (false == b_log) || (pdTRUE != xSemaphoreTake(mtx_log, pdMS_TO_TICKS(ms_wait))))
+    {
+        return NULL;
+    }
 
+    return &s_log;
+}
+
+void giveLog(void)
+{
+    (void)xSemaphoreGive(mtx_log);
+}
+
+// oldest event payload waiting, it stays queued until eventSent(); a single reader (cloud::event)
+bool peekEvent(uint8_t *pui8_buf, size_t sz_buf_len, size_t *psz_len)
+{
+    static event_msg_st s_msg;
+
+    if ((NULL == queue_events) || (pdTRUE != xQueuePeek(queue_events, &s_msg, 0)) || (s_msg.ui16_len > sz_buf_len))
+    {
+        return false;
+    }
+
+    memcpy(pui8_buf, s_msg.aui8_buf, s_msg.ui16_len);
+    *psz_len = s_msg.ui16_len;
+
+    return true;
+}
+
+// the payload of peekEvent() acknowledged by the server
+void eventSent(void)
+{
+    static event_msg_st s_msg;
+
+    if (NULL != queue_events)
+    {
+        (void)xQueueReceive(queue_events, &s_msg, 0);
+    }
+}
+
+// any task; the logging task switches at its next cycle, the interval under way isn't lost
+bool setInterval(int8_t si8_option, int8_t si8_interval1, int16_t si16_interval2)
+{
+    int16_t si16_min = (2 == si8_option) ? si16_interval2 : si8_interval1;
+
+    if (((1 != si8_option) && (2 != si8_option)) || (si8_interval1 <= 0) || (si16_interval2 <= 0) ||
+        (0 != (K_DAY_MIN % si8_interval1)) || (0 != (K_DAY_MIN % si16_interval2)))
+    {
+        return false;
+    }
+
+    measure_interval1       = si8_interval1;
+    measure_interval2       = si16_interval2;
+    measure_interval_option = si8_option;
+    ui16_interval_request   = (uint16_t)si16_min;
+
+    return true;
 }
 
 } // namespace data::logging
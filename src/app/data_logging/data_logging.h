@@ -1,6 +1,8 @@
 
 #pragma once
 
+#include "data_log/data_log.h"
+
 namespace data::logging
 {
 
@@ -10,5 +12,15 @@ namespace data::logging
 bool init();
 void cycle();
 
+const dlog_st *takeLog(uint32_t ms_wait);  // NULL: no log / busy
+void giveLog(void);
+
+bool peekEvent(uint8_t *pui8_buf, size_t sz_buf_len, size_t *psz_len);   // false: none waiting
+void eventSent(void);
+
+/* report interval option (1, 2) & both intervals in minutes, each a divisor of the day; switched by
+   the logging task without a restart, windows on the wall clock. false: invalid, nothing changed */
+bool setInterval(int8_t si8_option, int8_t si8_interval1, int16_t si16_interval2);
+
 
 } // namespace data::logging
@@ -22,10 +22,20 @@
 #define K_CLOUD_TIME_PATH                   "time"
 #define K_CLOUD_HEARTBEAT_PATH              "hb"
 #define K_CLOUD_MONITOR_PATH                "mn"
+#define K_CLOUD_MONITOR_BATCH_PATH          "mb"                    // several intervals per request
 #define K_CLOUD_STATUS_PATH                 "st"
 #define K_CLOUD_EVENT_PATH                  "ev"
 #define K_CLOUD_UPDATE_PATH                 "ud"
 
+/* monitor batches */
+#define K_CLOUD_MONITOR_BATCH               (0)                     // 1: the server takes "mb", 2 or more consecutive intervals per request; 0: one per request on "mn"
+#define K_CLOUD_MONITOR_BATCH_LEN           (496)                   // COAP_BUF_MAX_SIZE less the request header & path
+
+/* events */
+#define K_CLOUD_EVENT_BUF_LEN               (128)                   // serialized event payload, as the logging task queues them
+#define K_CLOUD_EVENT_RESPONSE_TIMEOUT      (30 * 1000)             // 30s event response timeout
+#define K_CLOUD_EVENT_RETRY_DELAY           (10 * 1000)             // 10s event retry delay
+
 /* coap response */
 #define K_CLOUD_RESPONSE_TIMEOUT_RETRY_LIM  (5)                     // 5 times timeout retry limit before reconnecting
 #define K_CLOUD_RESPONSE_ERROR_RETRY_LIM    (10)                    // 10 times got server error response
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "sdkconfig.h"
+
+/*
+ * Configurable Constants
+ */
+#define K_DLOG_PAGE_SIZE                (4096)      // = CONFIG_WL_SECTOR_SIZE = FAT allocation unit, one sector per page write
+#define K_DLOG_SEGMENT_PAGES            (64)        // 256 KiB segment files
+#define K_DLOG_MAX_SEGMENTS             (40)        // 10 MiB of the 13 MiB volume, the oldest segment is dropped
+#define K_DLOG_FLUSH_MIN                (60)        // a partial page goes to flash at the latest after this, unless journaled
+#define K_DLOG_RAM_RING_PAGES           (2)         // completed pages waiting in internal RAM ...
+#if CONFIG_SPIRAM
+#define K_DLOG_PSRAM_RING_PAGES         (16)        // ... or in PSRAM when the module has it
+#define K_DLOG_MAX_RING_PAGES           K_DLOG_PSRAM_RING_PAGES
+#define K_DLOG_BATCH_PAGES              (8)         // completed pages written together, 32 KiB aligned; divides K_DLOG_SEGMENT_PAGES & the PSRAM ring
+#else
+#define K_DLOG_MAX_RING_PAGES           K_DLOG_RAM_RING_PAGES
+#define K_DLOG_BATCH_PAGES              K_DLOG_RAM_RING_PAGES       // 8 KiB aligned, the whole internal RAM ring
+#endif
+// #define K_DLOG_POWER_FAIL_SIGNAL                 // POWER_GOOD drops early enough for a flush: no journal, no periodic flush
+// #define K_DLOG_PARTITION                "datalog"   // raw circular log in this partition instead of files on the FAT volume, "partitions/16MB_raw_log.csv"
+#define K_DLOG_MAP_WINDOWS              (4)         // partition readers walk pages in place through this many flash mappings ...
+#define K_DLOG_MAP_SIZE                 (65536)     // ... of one 64 KiB MMU page each, the whole partition doesn't fit the 4 MiB data window
+#define K_DLOG_PATH_LEN                 (96)
+#define K_DLOG_DIR                      K_STORAGE_BASE_PATH "/log"
@@ -0,0 +1,10 @@
+#pragma once
+
+/*
+ * Configurable Constants
+ */
+#define K_ENERGY_MAX_PHASES             (3)
+#define K_ENERGY_CHECKPOINT_MIN         (15)        // periodic checkpoint
+#define K_ENERGY_CHECKPOINT_WH          (1000)      // or earlier, once any phase moved this much
+#define K_ENERGY_MAX_GAP_MS             (5000)      // longer sample gaps are not integrated
+#define K_ENERGY_FILE                   K_STORAGE_BASE_PATH "/energy.bin"
@@ -3,3 +3,7 @@
 
 #define ENMTR_CLASS     EnMtrMSP430
 
+
+
+#define K_ENMTR_POLL_MAX_ERRORS         (5)     // consecutive failed bursts before re-init
+#define K_ENMTR_SNAPSHOT_RING_LEN       (4)     // most recent measurement blocks kept for readers
@@ -38,6 +38,29 @@ static inline void enmtr_init_pins(void)
 #define K_ENMTR_SPI_CS_CLK_DELAY_US             (10)    // delay between chip select vs clock and mosi signal in uS
 #define K_ENMTR_SPI_CS_DELAY_US                 (10)    // delay between each chip select in uS
 
+// measurement block as queued full-duplex frames: no delays around the chip select and between the
+// command phases; 0 = polled command phases with the delays above, until verified on the MSP430s
+#ifndef K_ENMTR_SPI_BURST
+#define K_ENMTR_SPI_BURST                       (0)
+#endif
+
+// bus DMA only for the queued frames (word aligned, internal ram); the polled 1-byte transfers
+// stay off it, https://docs.espressif.com/projects/esp-idf/en/v5.2.2/esp32/api-reference/peripherals/spi_slave.html#restrictions-and-known-issues
+#if (1 == K_ENMTR_SPI_BURST)
+#define K_ENMTR_SPI_DMA_CHAN                    (SPI_DMA_CH_AUTO)
+#else
+#define K_ENMTR_SPI_DMA_CHAN                    (SPI_DMA_DISABLED)
+#endif
+
 
 #define K_ENMTR_MSP430_BOOT_SIG_W1_VAL          (0x4F42)
 #define K_ENMTR_MSP430_BOOT_SIG_W2_VAL          (0x544F)
+
+// firmware update (bootloader)
+#define K_ENMTR_FW_MAGIC                        (0x3034334DUL)  // "M430", image file header
+#define K_ENMTR_FW_READ_CHUNK                   (4096)  // image bytes read from the storage at once
+#define K_ENMTR_FW_BOOTLDR_DELAY                (50)    // ms, application -> bootloader restart
+#define K_ENMTR_FW_ERASE_TIMEOUT                (1000)  // ms, app code erase
+#define K_ENMTR_FW_BLOCK_POLLS                  (64)    // status reads while a block is programmed
+#define K_ENMTR_FW_STATUS_BUSY                  (0x0001)
+#define K_ENMTR_FW_VERIFY                       (1)     // read the flash back & compare the image crc
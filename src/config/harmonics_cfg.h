@@ -0,0 +1,8 @@
+#pragma once
+
+/*
+ * Configurable Constants
+ */
+#define K_HARM_NUM_ORDERS               (10)    // odd orders 3rd..21st, as the GDL monitor ids
+#define K_HARM_FIRST_ORDER              (3)
+#define K_HARM_SETTLE_BLOCKS            (1)     // measurement blocks discarded after selecting another order
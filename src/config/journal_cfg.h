@@ -0,0 +1,12 @@
+#pragma once
+
+#include "data_log_cfg.h"
+
+/*
+ * Configurable Constants
+ */
+#define K_JOURNAL_SECTOR_SIZE           (4096)      // = CONFIG_WL_SECTOR_SIZE, an entry never spans two
+#define K_JOURNAL_SECTORS               (2 * (K_DLOG_MAX_RING_PAGES + 1) + 6)     // records of the data log pages in RAM & energy snapshots, about twice their size
+#define K_JOURNAL_STAGE_SECTORS         (2)         // with K_JOURNAL_SYNC_MIN: staged entries span sectors in the page ring's memory, a full one waits for the sync too
+#define K_JOURNAL_SYNC_MIN              (0)         // 0: the journal written with each interval's record; > 0 (wear): at most this late, a power cut the POWER_GOOD drop misses loses up to that many minutes
+#define K_JOURNAL_FILE                  K_STORAGE_BASE_PATH "/journal.bin"
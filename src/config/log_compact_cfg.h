@@ -0,0 +1,13 @@
+#pragma once
+
+#include "data_log_cfg.h"
+
+/*
+ * Configurable Constants
+ */
+#define K_COMPACT_TIERS                 (3)                     // the data log as logged, then its downsampled copies
+#define K_COMPACT_BUCKETS_S             { 0, 900, 3600 }        // record period of each tier beyond the first: 15 min, 1 h
+#define K_COMPACT_TIER_SEGMENTS         { 18, 11, 11 }          // K_DLOG_MAX_SEGMENTS shared out; the oldest segment of a full tier goes into the next ...
+#define K_COMPACT_TIER_AGE_DAYS         { 14, 0, 0 }            // ... and so does one whose records are all older than this, 0: only when full; the last tier's oldest is dropped
+#define K_COMPACT_TIER_DIRS             { K_DLOG_DIR, K_STORAGE_BASE_PATH "/log15", K_STORAGE_BASE_PATH "/log60" }
+#define K_COMPACT_SLICE_RECORDS         (32)                    // records read per compactStep(), i.e. per DataLogging cycle
@@ -0,0 +1,8 @@
+#pragma once
+
+/*
+ * Configurable Constants
+ */
+#define K_QUERY_MAX_IDS                 (16)        // monitor ids (columns) per query
+#define K_QUERY_ROW_LEN                 (256)       // "[ts,phase,<K_QUERY_MAX_IDS values>]," fits
+#define K_QUERY_SLICE_RECORDS           (64)        // records per queryFill(), i.e. per hold of the data log
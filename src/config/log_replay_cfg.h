@@ -0,0 +1,15 @@
+#pragma once
+
+/*
+ * Configurable Constants
+ */
+#define K_REPLAY_WINDOW                 (8)         // reports waiting for their acknowledge, one kept for live reports
+#define K_REPLAY_MIN_FREE_SLOTS         (3)         // udp send queue slots the backlog leaves to live reports, status & events
+#define K_REPLAY_BATCH                  (16)        // backlog requests (reports or batches of them) per batch ...
+#define K_REPLAY_BATCH_PERIOD_MS        (2000)      // ... and batch period, i.e. at most 8 backlog requests/s
+#define K_REPLAY_ACK_TIMEOUT_MS         (5000)      // then the report is sent again
+#define K_REPLAY_MAX_RANGES             (4)         // outages still being drained
+#define K_REPLAY_CHECKPOINT_ACKS        (32)        // cursor written every n acknowledged reports ...
+#define K_REPLAY_CHECKPOINT_MIN         (15)        // ... or after this
+#define K_REPLAY_MAPPED                 (0)         // 1: the readers walk a mapped partition in place; 0: pages copied, a single pass gains nothing from the map
+#define K_REPLAY_CURSOR_FILE            K_STORAGE_BASE_PATH "/replay.bin"
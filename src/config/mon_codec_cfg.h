@@ -0,0 +1,6 @@
+#pragma once
+
+/*
+ * Configurable Constants
+ */
+#define K_MON_CODEC_MAX_LEN             (768)       // serialized monitor payload, as the data logging buffer
@@ -0,0 +1,8 @@
+#pragma once
+
+/*
+ * Configurable Constants
+ */
+#define K_MON_AGG_MAX_CHANNELS          (8)     // measured quantities per phase
+#define K_MON_AGG_MAX_PHASES            (3)
+#define K_MON_AGG_REALIGN_S             (300)   // clock step (time sync) after which the windows move onto the new clock
@@ -0,0 +1,16 @@
+#pragma once
+
+/*
+ * Configurable Constants
+ */
+#define K_PQ_MAX_PHASES                 (3)
+#define K_PQ_EVENT_QUEUE_LEN            (8)         // finished events waiting to be reported
+
+#define K_PQ_NOMINAL_CV                 (23000)     // 230.00 V
+#define K_PQ_SAG_PCT                    (90)        // below: sag (dip)
+#define K_PQ_SWELL_PCT                  (110)       // above: swell
+#define K_PQ_INTERRUPTION_PCT           (10)        // below: interruption
+#define K_PQ_HYSTERESIS_PCT             (2)         // back inside the limits by this much ends the event
+
+#define K_PQ_MIN_DURATION_MS            (200)       // shorter excursions are not reported
+#define K_PQ_SUSTAINED_MS               (60000)     // longer sags / swells are reported as under / over voltage
@@ -10,4 +10,5 @@
 #endif // K_WEB_SERVER_BASIC_AUTH
 
 #define K_WEB_SERVER_MAX_URI_HANDLERS           (8)
-
+#define K_WEB_SERVER_CHUNK_LEN                  (2048)  // history response chunks, >= K_QUERY_ROW_LEN
+#define K_WEB_SERVER_LOG_WAIT_MS                (200)   // for the data log, per chunk
@@ -26,6 +26,7 @@ static struct {
     pdp::session_config_st  s_config;       // remote host configuration
     QueueHandle_t           queue_send;     // queue of payload data to send (contains pointer to elements of 'as_send_queue')
     pdp::payload_buffer_st  as_send_queue[K_CLOUD_COMMS_SEND_QUEUE_SIZE];  // reserved area for data pending to be send
+    pdp::payload_buffer_st *ps_open;        // slot of the record built in place, sendBegin() to sendSeal()
     SemaphoreHandle_t       mtx_receive;    // mutex shared access to the rx buffer
     pdp::payload_buffer_st  s_receive_buff; // buffer for modem manager callbacks
     struct {
@@ -147,6 +148,7 @@ void disconnect(void)
 {
     setCommsFlag(DTLS_COMMS, false);
     setCommsFlag(CLOUD_CONN, false);
+    monitor::offline();
 
     // disconnect dtls
     if (true == s_dtls_ctx.s_conn_status.b_state)
@@ -176,6 +178,70 @@ void flush_buff(void)
     } while (pdTRUE == result);
     // clear buffer
     memset(s_udp_ctx.as_send_queue, 0, sizeof(s_udp_ctx.as_send_queue));
+    s_udp_ctx.ps_open = NULL;
+}
+
+// back-pressure for the report replay
+uint8_t sendQueueFree(void)
+{
+    return (uint8_t)uxQueueSpacesAvailable(s_udp_ctx.queue_send);
+}
+
+// plaintext area of the DTLS record in the next free udp send queue slot, reserved until sendSeal();
+// NULL if none is free or the session isn't up
+uint8_t *sendBegin(size_t *psz_room)
+{
+    pdp::payload_buffer_st *ps_payload = NULL;
+    uint8_t *pui8_plain = NULL;
+
+    for (uint8_t ui8_idx = 0; ui8_idx < K_CLOUD_COMMS_SEND_QUEUE_SIZE; ui8_idx++)
+    {
+        if (0 == s_udp_ctx.as_send_queue[ui8_idx].sz_length)
+        {
+            ps_payload = &s_udp_ctx.as_send_queue[ui8_idx];
+            break;
+        }
+    }
+    if (NULL != ps_payload)
+    {
+        pui8_plain = dtls_write_begin(&s_dtls_ctx.s_client, ps_payload->aui8_buff, sizeof(ps_payload->aui8_buff), psz_room);
+    }
+    if (NULL != pui8_plain)
+    {
+        ps_payload->sz_length = sizeof(ps_payload->aui8_buff);     // taken, not queued yet
+        s_udp_ctx.ps_open     = ps_payload;
+    }
+
+    return pui8_plain;
+}
+
+// the sz_len bytes written since sendBegin() encrypted in place and queued, no copy of the record;
+// 0 gives the slot back
+bool sendSeal(size_t sz_len)
+{
+    pdp::payload_buffer_st *ps_payload = s_udp_ctx.ps_open;
+    int i_rlen = 0;
+
+    if (NULL == ps_payload)
+    {
+        return false;
+    }
+
+    s_udp_ctx.ps_open = NULL;
+    if (0 != sz_len)
+    {
+        i_rlen = dtls_write_seal(&s_dtls_ctx.s_client, ps_payload->aui8_buff, sz_len);
+    }
+    ps_payload->sz_length = (i_rlen > 0) ? (size_t)i_rlen : 0;
+
+    // a free slot is a free queue entry
+    if ((0 != ps_payload->sz_length) && (pdTRUE != xQueueSend(s_udp_ctx.queue_send, &ps_payload, 0)))
+    {
+        LOGW("udp queue failed");
+        ps_payload->sz_length = 0;
+    }
+
+    return (0 != ps_payload->sz_length);
 }
 
 /*
@@ -53,6 +53,9 @@ void cycle();
 void connect(void);     // [re]connect
 void disconnect(void);  // close dtls & udp session
 void flush_buff(void);  // cancel pending udp send queue
+uint8_t sendQueueFree(void);    // free udp send queue slots
+uint8_t *sendBegin(size_t *psz_room);   // plaintext of a DTLS record in a free udp send queue slot, the request is built there
+bool sendSeal(size_t sz_len);           // that record encrypted in place & queued, 0: slot given back
 
 
 } // namespace cloud::comms
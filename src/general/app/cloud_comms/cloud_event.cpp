@@ -1,24 +1,110 @@
-
 #include "global_defs.h"
 #include "cloud_comms.h"
+#include "data_logging.h"
 
 
 namespace cloud::event
 {
 
+/*
+ * Local Variables
+ */
+static net_context_et   s_net;          // cloud event stats
+static uint8_t          aui8_payload[K_CLOUD_EVENT_BUF_LEN];
+static size_t           sz_payload_len;
+
+
+/*
+ * Public Functions
+ */
+
 void init(void)
 {
-    //
+    memset(&s_net, 0, sizeof(s_net));
+    sz_payload_len  = 0;
+    s_net.e_state   = NET_STATE_IDLE;
 }
 
+// event payloads queued by the logging task, oldest first; each stays queued until acknowledged
 void cycle(void)
 {
-    //
+    switch (s_net.e_state)
+    {
+    case NET_STATE_IDLE:
+        if ((false == getCommsFlag(CLOUD_COMMS_FAULT)) &&
+            (true == data::logging::peekEvent(aui8_payload, sizeof(aui8_payload), &sz_payload_len)))
+        {
+            s_net.e_state = NET_STATE_SEND_REQ;
+        }
+        break;
+
+    case NET_STATE_SEND_REQ:
+        s_net.ui16_message_id = net::newMessageId();
+        s_net.b_resp_status   = false;
+        s_net.b_resp_received = false;
+
+        if (true == net::sendPutRequest(s_net.ui16_message_id, K_CLOUD_EVENT_PATH, aui8_payload, sz_payload_len))
+        {
+            LOGD("event request (msg %d)", s_net.ui16_message_id);
+            s_net.ms_resp_timeout = millis();
+            s_net.e_state         = NET_STATE_WAIT_RESP;
+        }
+        else
+        {
+            LOGW("request error");
+            s_net.ms_retry_delay  = millis();
+            s_net.e_state         = NET_STATE_RETRY_DELAY;
+            net::timeoutOccured(); // considered as timeout
+        }
+        break;
+
+    case NET_STATE_WAIT_RESP:
+        if (true == s_net.b_resp_received)
+        {
+            if (true == s_net.b_resp_status)
+            {
+                data::logging::eventSent();
+                s_net.e_state = NET_STATE_IDLE;
+            }
+            else
+            {
+                s_net.ms_retry_delay = millis();
+                s_net.e_state        = NET_STATE_RETRY_DELAY;
+            }
+        }
+        else if ((millis() - s_net.ms_resp_timeout) > K_CLOUD_EVENT_RESPONSE_TIMEOUT)
+        {
+            LOGW("response timeout");
+            net::timeoutOccured();
+            s_net.ms_retry_delay  = millis();
+            s_net.e_state         = NET_STATE_RETRY_DELAY;
+        }
+        break;
+
+    case NET_STATE_RETRY_DELAY:
+        if (millis() - s_net.ms_retry_delay > K_CLOUD_EVENT_RETRY_DELAY)
+        {
+            s_net.e_state = NET_STATE_IDLE; // retry, the same payload is still queued
+        }
+        break;
+
+    default:
+        init();
+        break;
+    }
 }
 
 void parseResponse(uint16_t ui16_message_id, const uint8_t *pui8_payload_buf, size_t sz_payload_len)
 {
-    //
+    (void)pui8_payload_buf;
+    (void)sz_payload_len;
+
+    if ((NET_STATE_WAIT_RESP == s_net.e_state) && (ui16_message_id == s_net.ui16_message_id))
+    {
+        s_net.b_resp_received = true;
+        s_net.b_resp_status   = true;
+        s_net.ui16_message_id = 0;    // ignore duplicate server response
+    }
 }
 
 } // namespace cloud::event
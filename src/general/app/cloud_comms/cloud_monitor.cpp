@@ -1,24 +1,187 @@
 
+#include <algorithm>  // std::min
 #include "global_defs.h"
 #include "cloud_comms.h"
+#include "data_logging.h"
+#include "coap/coap_client.h"
+#include "log_replay/log_replay.h"
 
 
 namespace cloud::monitor
 {
 
+/*
+ * Local Variables
+ */
+static replay_st    s_replay;       // live reports & outage backlog from the data log
+static bool         b_replay_init;
+
+
+/*
+ * Private Functions
+ */
+
+// payload of the next request of the replay written at pui8_payload, in the DTLS record of the send slot: a
+// single interval on K_CLOUD_MONITOR_PATH as it was logged, consecutive ones packed on K_CLOUD_MONITOR_BATCH_PATH
+// if the server takes them. 0: nothing to send
+static size_t nextPayload(const dlog_st *ps_log, uint8_t *pui8_payload, size_t sz_room, const char **ppc_path)
+{
+#if K_CLOUD_MONITOR_BATCH
+    ep_monitor_batch_st s_batch;
+
+    // the batch is packed straight into the record, no copy of the reports
+    edgePayloadBatchInit(&s_batch, pui8_payload, std::min(sz_room, (size_t)K_CLOUD_MONITOR_BATCH_LEN));
+    if (false == replayNextBatch(&s_replay, ps_log, comms::sendQueueFree(), millis(), &s_batch))
+    {
+        return 0;
+    }
+
+    if (1 < s_batch.ui8_count)
+    {
+        *ppc_path = K_CLOUD_MONITOR_BATCH_PATH;
+        return edgePayloadBatchLen(&s_batch);
+    }
+    *ppc_path = K_CLOUD_MONITOR_PATH;
+    return edgePayloadBatch2Monitor(&s_batch);
+#else
+    const uint8_t  *pui8_report;
+    int32_t         si32_ts;
+    uint16_t        ui16_len;
+
+    if ((false == replayNext(&s_replay, ps_log, comms::sendQueueFree(), millis(), &si32_ts, &pui8_report, &ui16_len)) ||
+        (ui16_len > sz_room))
+    {
+        return 0;
+    }
+
+    // the one copy left: out of the log codec, which owns the decoded report
+    memcpy(pui8_payload, pui8_report, ui16_len);
+    *ppc_path = K_CLOUD_MONITOR_PATH;
+    return ui16_len;
+#endif
+}
+
+// next request of the replay built in place in a udp send slot: CoAP header & payload in the plaintext of
+// the DTLS record, sealed there. false: no slot or nothing to send, the log is still held
+static bool sendNext(const dlog_st *ps_log, uint16_t *pui16_msg_id, bool *pb_sent)
+{
+    const char *pc_path = K_CLOUD_MONITOR_PATH;
+    size_t      sz_room;
+    uint8_t    *pui8_plain = comms::sendBegin(&sz_room);
+    uint16_t    ui16_hdr;
+    size_t      sz_len;
+
+    if (NULL == pui8_plain)
+    {
+        return false;
+    }
+
+    // header length first, both paths are the same length
+    sz_room  = std::min(sz_room, (size_t)(COAP_BUF_MAX_SIZE - 1));
+    ui16_hdr = coapClientWriteRequestHeader(pui8_plain, (uint16_t)sz_room, COAP_METHOD_PUT, 0, pc_path);
+    sz_len   = (0 != ui16_hdr) ? nextPayload(ps_log, pui8_plain + ui16_hdr, sz_room - ui16_hdr, &pc_path) : 0;
+    if (0 == sz_len)
+    {
+        (void)comms::sendSeal(0);
+        return false;
+    }
+
+    *pui16_msg_id = net::newMessageId();
+    data::logging::giveLog();
+    if (ui16_hdr != coapClientWriteRequestHeader(pui8_plain, ui16_hdr + 1, COAP_METHOD_PUT, *pui16_msg_id, pc_path))
+    {
+        sz_len = 0;
+    }
+    *pb_sent = comms::sendSeal((0 != sz_len) ? (ui16_hdr + sz_len) : 0);
+    return true;
+}
+
+
+/*
+ * Public Functions
+ */
+
 void init(void)
 {
-    //
+    b_replay_init = false;
 }
 
+// reports of the data log, live ones first; the backlog in batches while the udp send queue has room,
+// consecutive reports of a stream packed into one request with K_CLOUD_MONITOR_BATCH. The log is given
+// back while a request goes out, the logging task doesn't wait on the modem
 void cycle(void)
 {
-    //
+    const dlog_st  *ps_log = data::logging::takeLog(0);
+    uint16_t        ui16_msg_id;
+    bool            b_sent;
+
+    if (NULL == ps_log)
+    {
+        return;
+    }
+
+    if (false == b_replay_init)
+    {
+        replayInit(&s_replay, K_REPLAY_CURSOR_FILE, ps_log);
+        b_replay_init = true;
+    }
+
+    if (true == getCommsFlag(CLOUD_COMMS_FAULT))
+    {
+        replayOffline(&s_replay);
+    }
+    else
+    {
+        replayOnline(&s_replay, ps_log);
+
+        if (true == replayPoll(&s_replay, millis()))
+        {
+            LOGW("report ack timeout, resending from the cursor");
+            net::timeoutOccured();
+        }
+
+        // the request is built in the send slot, the log is given back while it is sealed & queued
+        while (true == sendNext(ps_log, &ui16_msg_id, &b_sent))
+        {
+            replaySent(&s_replay, ui16_msg_id, b_sent);
+            ps_log = data::logging::takeLog(0);
+
+            if (false == b_sent)
+            {
+                LOGW("report: request error");
+                break;
+            }
+            if (NULL == ps_log)
+            {
+                break;
+            }
+        }
+    }
+
+    if (NULL != ps_log)
+    {
+        (void)replayCheckpoint(&s_replay, millis(), false);
+        data::logging::giveLog();
+    }
 }
 
 void parseResponse(uint16_t ui16_message_id, const uint8_t *pui8_payload_buf, size_t sz_payload_len)
 {
-    //
+    (void)pui8_payload_buf;
+    (void)sz_payload_len;
+
+    if ((true == b_replay_init) && (false == replayAck(&s_replay, ui16_message_id)))
+    {
+        //LOGD("duplicate response (msg %d)", ui16_message_id);
+    }
+}
+
+void offline(void)
+{
+    if (true == b_replay_init)
+    {
+        replayOffline(&s_replay);
+    }
 }
 
 } // namespace cloud::monitor
@@ -81,6 +81,7 @@ namespace monitor
 void init(void);
 void cycle(void);
 void parseResponse(uint16_t ui16_message_id, const uint8_t *pui8_payload_buf, size_t sz_payload_len);
+void offline(void);     // link lost, reports still waiting are sent again
 } // namespace cloud::monitor
 
 /* cloud_event.cpp */
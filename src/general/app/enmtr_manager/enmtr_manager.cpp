@@ -1,6 +1,9 @@
 
 #include "global_defs.h"
+#include <atomic>
+#include <freertos/semphr.h>
 #include "general_info.h"
+#include "snapshot/snapshot_ring.h"
 #include "enmtr_manager.h"
 
 
@@ -14,7 +17,119 @@ namespace enmtr::manager
 
 ENMTR_CLASS mtr;
 
-static state_et             e_state;
+static state_et                     e_state;
+static ENMTR_CLASS::meas_block_st   s_poll;         // burst in progress
+static uint8_t                      ui8_poll_errors;
+
+// last complete bursts; written by this task only, read lock-free by any task
+static SnapshotRing<ENMTR_CLASS::meas_block_st, K_ENMTR_SNAPSHOT_RING_LEN> s_snapshots;
+
+// harmonic sweep: one order per measurement block, selected through REG_ADDR_HARM
+static SemaphoreHandle_t            mtx_harm = NULL;
+static harm_phase_st                as_harm[ENMTR_CLASS::NUM_DEVICES];
+static uint8_t                      ui8_harm_idx;
+static uint8_t                      ui8_harm_settle;
+static bool                         b_harm_selected;
+
+// firmware update, requested by any task: claimed while the path is written, pending once it is
+typedef enum
+{
+    FW_REQUEST_NONE,
+    FW_REQUEST_CLAIMED,
+    FW_REQUEST_PENDING
+} fw_request_et;
+
+static char                         ac_fw_path[64];
+static std::atomic<uint8_t>         ui8_fw_request(FW_REQUEST_NONE);
+static std::atomic<uint32_t>        ui32_fw_updates(0);
+static ENMTR_CLASS::fw_update_stats_st s_fw_stats;
+
+
+/*
+ * Private Functions
+ */
+static bool selectHarmOrder(uint8_t ui8_order_idx)
+{
+    for (uint8_t d = 0; d < ENMTR_CLASS::NUM_DEVICES; d++)
+    {
+        if (false == mtr.write_reg((ENMTR_CLASS::device_et)d, mtr.REG_ADDR_HARM, harmOrder(ui8_order_idx)))
+        {
+            LOGW("harmonic order select failed (%u)", d);
+            return false;
+        }
+    }
+
+    ui8_harm_settle = K_HARM_SETTLE_BLOCKS;
+
+    return true;
+}
+
+// channel A (line side) harmonics of each phase, for the order selected before this block
+static void sweepHarmonics(const ENMTR_CLASS::meas_block_st *ps_block)
+{
+    if (false == b_harm_selected)
+    {
+        b_harm_selected = selectHarmOrder(ui8_harm_idx);
+    }
+    else if (ui8_harm_settle > 0)
+    {
+        ui8_harm_settle--;
+    }
+    else
+    {
+        int32_t asi32_val[ENMTR_CLASS::NUM_MEAS];
+
+        if (pdTRUE == xSemaphoreTake(mtx_harm, portMAX_DELAY))
+        {
+            for (uint8_t d = 0; d < ENMTR_CLASS::NUM_DEVICES; d++)
+            {
+                mtr.decode_meas(ps_block, (ENMTR_CLASS::device_et)d, asi32_val);
+                harmPhaseAdd(&as_harm[d], ui8_harm_idx,
+                    (uint32_t)asi32_val[mtr.MEAS_VFUND_A], (uint32_t)asi32_val[mtr.MEAS_VHARM_A],
+                    (uint32_t)asi32_val[mtr.MEAS_IFUND_A], (uint32_t)asi32_val[mtr.MEAS_IHARM_A]);
+            }
+            (void)xSemaphoreGive(mtx_harm);
+        }
+
+        ui8_harm_idx    = (ui8_harm_idx + 1) % K_HARM_NUM_ORDERS;
+        b_harm_selected = selectHarmOrder(ui8_harm_idx);
+    }
+}
+
+static void updateFw(void)
+{
+    if (true == mtr.update_fw(ac_fw_path, &s_fw_stats))
+    {
+        LOGI("enmtr fw updated: %u blocks, %u frames, %u retries, %u ms", (unsigned)s_fw_stats.ui32_blocks,
+             (unsigned)s_fw_stats.ui32_frames, (unsigned)s_fw_stats.ui32_retries, (unsigned)s_fw_stats.ms_elapsed);
+    }
+    else
+    {
+        LOGW("enmtr fw update failed");
+    }
+
+    ui32_fw_updates++;
+    ui8_fw_request.store(FW_REQUEST_NONE, std::memory_order_release);
+}
+
+static void pollMeasBlock(void)
+{
+    if (true == mtr.read_meas_block(&s_poll))
+    {
+        ui8_poll_errors = 0;
+
+        s_poll.ui32_seq = s_snapshots.latest() + 1;
+        (void)s_snapshots.publish(s_poll);
+
+        sweepHarmonics(&s_poll);
+    }
+    else if (++ui8_poll_errors >= K_ENMTR_POLL_MAX_ERRORS)
+    {
+        LOGW("enmtr polling failed");
+        ui8_poll_errors = 0;
+        e_state = STATE_POLL_INIT;
+    }
+}
 
 /*
  * Public Functions
@@ -25,6 +140,19 @@ bool init()
 
     mtr.init();
 
+    ui8_poll_errors = 0;
+
+    if (NULL == mtx_harm)
+    {
+        mtx_harm = xSemaphoreCreateMutex();
+    }
+    for (uint8_t d = 0; d < ENMTR_CLASS::NUM_DEVICES; d++)
+    {
+        harmPhaseInit(&as_harm[d]);
+    }
+    ui8_harm_idx    = 0;
+    b_harm_selected = false;
+
     e_state = STATE_POLL_INIT;
 
     return true;
@@ -55,14 +183,25 @@ void cycle()
                 mtr.s_fw_info[mtr.DEVICE_PHASE_C].u16_ver & 0xff, mtr.s_fw_info[mtr.DEVICE_PHASE_C].u16_test);
             sprintf(enmtr_version,"%02x.%02x.%04x", mtr.s_fw_info[mtr.DEVICE_PHASE_A].u16_ver >> 8,
                 mtr.s_fw_info[mtr.DEVICE_PHASE_A].u16_ver & 0xff, mtr.s_fw_info[mtr.DEVICE_PHASE_A].u16_test);
-            e_state = STATE_POLL_VRMS;
+            b_harm_selected = false;    // the reset cleared the order selection
+            e_state = STATE_POLL_MEAS_BLOCK;
             break;
         }
         delayms(3 * 1000UL);
         break;
 
-    case STATE_POLL_VRMS:
-        // to do
+    case STATE_POLL_MEAS_BLOCK:
+        if (FW_REQUEST_PENDING == ui8_fw_request.load(std::memory_order_acquire))
+        {
+            e_state = STATE_FW_UPDATE;
+            break;
+        }
+        pollMeasBlock();
+        break;
+
+    case STATE_FW_UPDATE:
+        updateFw();
+        e_state = STATE_POLL_INIT;  // reset into the application, versions are read again
         break;
 
     default:
@@ -71,4 +210,66 @@ void cycle()
     }
 }
 
+bool getSnapshot(ENMTR_CLASS::meas_block_st *ps_snapshot)
+{
+    return (0 != s_snapshots.read_latest(ps_snapshot));
+}
+
+bool getSnapshot(uint32_t ui32_seq, ENMTR_CLASS::meas_block_st *ps_snapshot)
+{
+    return s_snapshots.read(ui32_seq, ps_snapshot);
+}
+
+uint32_t getSnapshotSeq()
+{
+    return s_snapshots.latest();
+}
+
+bool takeHarmonics(harm_phase_st *pas_harm)
+{
+    bool b_status = false;
+
+    if ((NULL != mtx_harm) && (pdTRUE == xSemaphoreTake(mtx_harm, portMAX_DELAY)))
+    {
+        for (uint8_t d = 0; d < ENMTR_CLASS::NUM_DEVICES; d++)
+        {
+            pas_harm[d] = as_harm[d];
+            harmPhaseNewInterval(&as_harm[d]);
+        }
+        (void)xSemaphoreGive(mtx_harm);
+        b_status = true;
+    }
+
+    return b_status;
+}
+
+bool requestFwUpdate(const char *pc_path)
+{
+    uint8_t ui8_none = FW_REQUEST_NONE;
+
+    // the path is only written by the one task that claimed the request
+    if ((strlen(pc_path) >= sizeof(ac_fw_path)) ||
+        (false == ui8_fw_request.compare_exchange_strong(ui8_none, FW_REQUEST_CLAIMED, std::memory_order_acquire)))
+    {
+        return false;
+    }
+
+    strcpy(ac_fw_path, pc_path);
+    ui8_fw_request.store(FW_REQUEST_PENDING, std::memory_order_release);
+
+    return true;
+}
+
+bool getFwUpdateStats(ENMTR_CLASS::fw_update_stats_st *ps_stats)
+{
+    if ((0 == ui32_fw_updates) || (FW_REQUEST_NONE != ui8_fw_request.load(std::memory_order_acquire)))
+    {
+        return false;
+    }
+
+    *ps_stats = s_fw_stats;
+
+    return true;
+}
+
 } // namespace enmtr::manager
@@ -2,6 +2,7 @@
 #pragma once
 
 #include "enmtr/msp430.h"
+#include "harmonics/harmonics.h"
 #include "enmtr_manager_cfg.h"
 
 
@@ -11,11 +12,7 @@ namespace enmtr
 typedef enum
 {
     STATE_POLL_INIT,
-    STATE_POLL_VRMS,
-    STATE_POLL_IRMS,
-    STATE_POLL_PF,
-    //STATE_POLL_WATT,
-    //STATE_POLL_VA,
+    STATE_POLL_MEAS_BLOCK,  // whole measurement block, all phases
     STATE_POLL_LOW_RATE,
     STATE_FW_UPDATE
 } state_et;
@@ -29,5 +26,27 @@ namespace manager
 bool init();
 void cycle();
 
+/* copy of the last complete measurement block; false if none yet. Lock-free, never blocks
+   the polling task. */
+bool getSnapshot(ENMTR_CLASS::meas_block_st *ps_snapshot);
+
+/* copy of block "ui32_seq" while it is among the K_ENMTR_SNAPSHOT_RING_LEN most recent ones;
+   lets a consumer follow every block without missing one */
+bool getSnapshot(uint32_t ui32_seq, ENMTR_CLASS::meas_block_st *ps_snapshot);
+
+/* sequence number of the last complete block, 0 = none yet */
+uint32_t getSnapshotSeq();
+
+/* harmonic statistics of the interval so far, one entry per phase (NUM_DEVICES); starts the
+   next interval */
+bool takeHarmonics(harm_phase_st *pas_harm);
+
+/* flash all phases from the image file (see ENMTR_CLASS::fw_image_hdr_st) at the next cycle;
+   polling stops meanwhile. false if one is already pending. */
+bool requestFwUpdate(const char *pc_path);
+
+/* statistics of the last finished update; false if none finished yet */
+bool getFwUpdateStats(ENMTR_CLASS::fw_update_stats_st *ps_stats);
+
 } // namespace enmtr::manager
 } // namespace enmtr
@@ -7,6 +7,9 @@
 #include <cJSON.h> // Include cJSON for JSON handling
 #include "device_id/device_id.h"
 #include "modem/quectel.h"
+#include "enmtr_manager.h"
+#include "data_logging.h"
+#include "log_query/log_query.h"
 namespace web::server
 {
 
@@ -18,6 +21,9 @@ static bool b_started = false;
 
 static char recv_buf[1024];
 static char send_buf[256];
+static char chunk_buf[K_WEB_SERVER_CHUNK_LEN];
+static query_st s_query;            // one history query at a time, the server task handles the requests in turn
+static_assert(K_WEB_SERVER_CHUNK_LEN >= K_QUERY_ROW_LEN, "a history row fits a chunk");
 
 #ifdef WEB_SERVER_BASIC_AUTH
 static char *http_auth_basic(const char *username, const char *password)
@@ -183,7 +189,7 @@ WebAppData get_web_app_data() {
     // char temp_wifi_buffer[12]  = "";
     // char temp_blufi_buffer[12] = "";
 
-    data.enmtr_version       = "1.0.0"; 
+    data.enmtr_version       = enmtr_version;
     data.modem               = "a";
     data.active_comms        = "4G,LoRa,WiFi,BlueFi";
 
@@ -232,6 +238,7 @@ esp_err_t get_dynamic_data_handler(httpd_req_t *req)
     cJSON_AddStringToObject(json, "device_id", device_id);
     cJSON_AddStringToObject(json, "fw_version", fw_version);
     cJSON_AddStringToObject(json, "enmtr_version", data.enmtr_version);
+    cJSON_AddNumberToObject(json, "enmtr_seq", enmtr::manager::getSnapshotSeq());
     cJSON_AddStringToObject(json, "modem", data.modem);
     cJSON_AddStringToObject(json, "imei", ac_imei);
     cJSON_AddStringToObject(json, "imsi", ac_imsi);
@@ -240,6 +247,9 @@ esp_err_t get_dynamic_data_handler(httpd_req_t *req)
     cJSON_AddStringToObject(json, "active_comms_status", data.active_comms_status);
     cJSON_AddStringToObject(json, "comms_link_status", data.comms_link_status);
     cJSON_AddStringToObject(json, "signal_strength", data.signal_strength);
+    cJSON_AddNumberToObject(json, "interval_option", measure_interval_option);
+    cJSON_AddNumberToObject(json, "interval1", measure_interval1);
+    cJSON_AddNumberToObject(json, "interval2", measure_interval2);
 
     // Print the JSON response
     const char *response = cJSON_Print(json);
@@ -253,6 +263,102 @@ esp_err_t get_dynamic_data_handler(httpd_req_t *req)
     return ESP_OK;
 }
 
+/* Logged intervals: /history?from=<epoch>&to=<epoch>&ids=<monitor ids>[&phase=1,2,3,4][&every=<n>],
+   streamed in chunks, the data log is held for one chunk at a time */
+esp_err_t get_history_handler(httpd_req_t *req)
+{
+    const dlog_st  *ps_log;
+    uint16_t        ui16_len;
+    bool            b_started = false;
+    esp_err_t       err = ESP_OK;
+
+#ifdef WEB_SERVER_BASIC_AUTH
+    if (!authenticate(req)) {
+        return request_auth(req);
+    }
+#endif
+
+    if ((ESP_OK != httpd_req_get_url_query_str(req, recv_buf, sizeof(recv_buf))) ||
+        (false == queryParse(&s_query, recv_buf)))
+    {
+        return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "from, to & ids expected");
+    }
+
+    httpd_resp_set_type(req, "application/json");
+    while ((ESP_OK == err) && (false == queryDone(&s_query)))
+    {
+        if (NULL == (ps_log = data::logging::takeLog(K_WEB_SERVER_LOG_WAIT_MS)))
+        {
+            LOGW("history: data log not available");
+            err = ESP_FAIL;
+            break;
+        }
+        ui16_len = queryFill(&s_query, ps_log, chunk_buf, sizeof(chunk_buf));
+        data::logging::giveLog();
+
+        if (0 != ui16_len)
+        {
+            err = httpd_resp_send_chunk(req, chunk_buf, ui16_len);
+            b_started = true;
+        }
+    }
+
+    if (false == b_started)
+    {
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "data log not available");
+    }
+
+    LOGD("history %ld..%ld: %u intervals, %u rows, %u page reads", (long)s_query.si32_from, (long)s_query.si32_to,
+         (unsigned)s_query.ui32_records, (unsigned)s_query.ui32_rows, (unsigned)s_query.s_reader.ui32_page_reads);
+
+    // a failed transfer ends the response early, the client sees an incomplete JSON
+    (void)httpd_resp_send_chunk(req, NULL, 0);
+
+    return err;
+}
+
+/* Report interval: /interval?option=1|2[&interval1=<min>][&interval2=<min>], the others stay;
+   the data logging task switches without a restart */
+esp_err_t post_interval_handler(httpd_req_t *req)
+{
+    char    ac_val[8];
+    long    l_option = measure_interval_option;
+    long    l_interval1 = measure_interval1;
+    long    l_interval2 = measure_interval2;
+
+#ifdef WEB_SERVER_BASIC_AUTH
+    if (!authenticate(req)) {
+        return request_auth(req);
+    }
+#endif
+
+    if (ESP_OK != httpd_req_get_url_query_str(req, recv_buf, sizeof(recv_buf)))
+    {
+        return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "option, interval1 or interval2 expected");
+    }
+    if (ESP_OK == httpd_query_key_value(recv_buf, "option", ac_val, sizeof(ac_val)))
+    {
+        l_option = strtol(ac_val, NULL, 10);
+    }
+    if (ESP_OK == httpd_query_key_value(recv_buf, "interval1", ac_val, sizeof(ac_val)))
+    {
+        l_interval1 = strtol(ac_val, NULL, 10);
+    }
+    if (ESP_OK == httpd_query_key_value(recv_buf, "interval2", ac_val, sizeof(ac_val)))
+    {
+        l_interval2 = strtol(ac_val, NULL, 10);
+    }
+
+    if ((l_option < 1) || (l_option > 2) || (l_interval1 < 1) || (l_interval1 > INT8_MAX) ||
+        (l_interval2 < 1) || (l_interval2 > INT16_MAX) ||
+        (false == data::logging::setInterval((int8_t)l_option, (int8_t)l_interval1, (int16_t)l_interval2)))
+    {
+        return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "option 1 or 2, intervals dividing 1440 min");
+    }
+
+    LOGI("report interval option %ld: %ld / %ld min", l_option, l_interval1, l_interval2);
+    return resp_home_after(req, "interval set", "", 2000UL);
+}
 
 /* Handle file uploads */
 esp_err_t post_upload_handler(httpd_req_t *req)
@@ -313,8 +419,8 @@ esp_err_t post_upload_handler(httpd_req_t *req)
                 fclose(fp);
                 fp = NULL;
                 err = ESP_FAIL;
-                // Try to clear storage
-                (void)esp_vfs_fat_spiflash_format_rw_wl("/mnt", "storage");
+                // only the partial upload goes, the data log & journal stay
+                (void)remove(fname);
                 break;
             }
 
@@ -365,8 +471,10 @@ bool start()
         REGISTER_GET_HANDLER("/style.css", stylecss);
         REGISTER_GET_HANDLER("/script.js", scriptjs);
         REGISTER_GET_HANDLER("/data", dynamic_data); // New dynamic data endpoint
+        REGISTER_GET_HANDLER("/history", history);
 
         REGISTER_POST_HANDLER("/upload", upload);
+        REGISTER_POST_HANDLER("/interval", interval);
 
         b_started = true;
     }
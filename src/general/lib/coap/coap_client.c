@@ -86,12 +86,8 @@ static int parseOption(coap_option_st *option, uint16_t *running_delta, const ui
     return 0;
 }
 
-/*
- * Public Functions
- */
-
-/* send a request without any token! */
-bool coapClientSendRequest(coap_client_context_st *ps_client_ctx, coap_method_et e_method, uint16_t ui16_msg_id, const char *pc_path, const uint8_t *pui8_payload, uint16_t ui16_payloadlen)
+/* header and options of a request without any token, 0: doesn't fit into ui16_buf_len */
+static uint16_t writeRequestHeader(uint8_t *pui8_buf, uint16_t ui16_buf_len, coap_method_et e_method, uint16_t ui16_msg_id, const char *pc_path)
 {
     coap_packet_st s_packet;
     uint8_t *p              = NULL;
@@ -100,7 +96,9 @@ bool coapClientSendRequest(coap_client_context_st *ps_client_ctx, coap_method_et
     uint16_t running_delta  = 0;
     uint16_t packetSize     = 0;
 
-    //LOGD("%s: %u %s (%u-%u)", __func__, e_method, pc_path, ui16_msg_id, ui16_payloadlen);
+    if (ui16_buf_len < COAP_HEADER_SIZE) {
+        return 0;
+    }
 
     memset(&s_packet, 0, sizeof(s_packet));
     s_packet.s_header.ui2_version   = COAP_VERSION;
@@ -111,7 +109,7 @@ bool coapClientSendRequest(coap_client_context_st *ps_client_ctx, coap_method_et
     s_packet.s_header.ui8_msg_id_l  = ui16_msg_id & 0xff;
 
     // make coap packet base header
-    p = ps_client_ctx->aui8_buffer;
+    p = pui8_buf;
     memcpy(p, &s_packet.s_header, sizeof(s_packet.s_header));
 
     // if this fails, please fix 'coap_header_st' struct
@@ -132,8 +130,8 @@ bool coapClientSendRequest(coap_client_context_st *ps_client_ctx, coap_method_et
 
     // make option header
     for (int i = 0; i < s_packet.ui8_optioncount; i++)  {
-        if (packetSize + 5 + s_packet.as_options[i].ui8_len >= COAP_BUF_MAX_SIZE) {
-            return false;
+        if (packetSize + 5 + s_packet.as_options[i].ui8_len >= ui16_buf_len) {
+            return 0;
         }
         optdelta = s_packet.as_options[i].e_option - running_delta;
         COAP_OPTION_DELTA(optdelta, &delta);
@@ -162,6 +160,27 @@ bool coapClientSendRequest(coap_client_context_st *ps_client_ctx, coap_method_et
         running_delta = s_packet.as_options[i].e_option;
     }
 
+    return packetSize;
+}
+
+/*
+ * Public Functions
+ */
+
+/* send a request without any token! */
+bool coapClientSendRequest(coap_client_context_st *ps_client_ctx, coap_method_et e_method, uint16_t ui16_msg_id, const char *pc_path, const uint8_t *pui8_payload, uint16_t ui16_payloadlen)
+{
+    uint8_t *p;
+    uint16_t packetSize;
+
+    //LOGD("%s: %u %s (%u-%u)", __func__, e_method, pc_path, ui16_msg_id, ui16_payloadlen);
+
+    packetSize = writeRequestHeader(ps_client_ctx->aui8_buffer, COAP_BUF_MAX_SIZE, e_method, ui16_msg_id, pc_path);
+    if (0 == packetSize) {
+        return false;
+    }
+    p = ps_client_ctx->aui8_buffer + packetSize;
+
     // make payload
     if (ui16_payloadlen > 0) {
         if ((packetSize + 1 + ui16_payloadlen) >= COAP_BUF_MAX_SIZE) {
@@ -181,6 +200,21 @@ bool coapClientSendRequest(coap_client_context_st *ps_client_ctx, coap_method_et
     return true;
 }
 
+/* request with a payload built in place after it: header, options and the payload marker into
+   pui8_buf, returns their length (0: no room), the payload goes right behind and must keep the
+   whole message below COAP_BUF_MAX_SIZE like coapClientSendRequest() does */
+uint16_t coapClientWriteRequestHeader(uint8_t *pui8_buf, uint16_t ui16_buf_len, coap_method_et e_method, uint16_t ui16_msg_id, const char *pc_path)
+{
+    uint16_t packetSize = writeRequestHeader(pui8_buf, ui16_buf_len, e_method, ui16_msg_id, pc_path);
+
+    if ((0 == packetSize) || (packetSize + 1 >= ui16_buf_len)) {
+        return 0;
+    }
+    pui8_buf[packetSize++] = COAP_PAYLOAD_MARKER;
+
+    return packetSize;
+}
+
 bool coapClientHandleMsg(coap_client_context_st *ps_client_ctx, const uint8_t *pui8_msg, uint16_t ui16_msg_len)
 {
     coap_packet_st s_packet;
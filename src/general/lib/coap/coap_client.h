@@ -151,6 +151,7 @@ typedef struct
 
 bool coapClientHandleMsg(coap_client_context_st *ps_client_ctx, const uint8_t *pui8_msg, uint16_t ui16_msg_len);
 bool coapClientSendRequest(coap_client_context_st *ps_client_ctx, coap_method_et e_method, uint16_t ui16_msg_id, const char *pc_path, const uint8_t *pui8_payload, uint16_t ui16_payloadlen);
+uint16_t coapClientWriteRequestHeader(uint8_t *pui8_buf, uint16_t ui16_buf_len, coap_method_et e_method, uint16_t ui16_msg_id, const char *pc_path);
 
 #define coapClientInit(ctx, f_send, f_resp)   memset(&ctx, 0, sizeof(ctx));   \
                                               ctx.fpi_send_handler = f_send;  \
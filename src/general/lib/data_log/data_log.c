@@ -0,0 +1,1106 @@
+/*****************************************************************************************//**
+* \file         data_log.c
+*
+* \brief        Measurement log library source file.
+* \details      Segment files "<dir>/<segment, 8 hex digits>.LOG" of K_DLOG_SEGMENT_PAGES pages,
+*               or in a raw partition segment n in slot n % slots of K_DLOG_SEGMENT_PAGES erase
+*               sectors: a circular log without FAT and wear levelling underneath, every sector
+*               erased once per lap. Pages of an earlier lap fail the page number check.
+*               A page is only written whole at its page aligned offset: when it is full, or
+*               partial on a flush, in which case it is written again in place once it grew
+*               (in the partition its sector is erased again).
+*               Completed pages in the ring are written in runs that stay in one segment file,
+*               readers find them there until then.
+*               Readers take a record where its page is: the RAM page, the ring, a mapped window
+*               of the partition (crc checked once per page), else a copy in their own buffer.
+*               The segment table (first timestamp of each segment) is the RAM part of the
+*               time index, the pages of a segment are binary searched on their headers.
+*
+* \version      v00.01.00
+* \date         20261017
+*********************************************************************************************/
+/*
+ * Included Modules
+ */
+#include "global_defs.h"
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include "data_log.h"
+
+/*
+ * Local Constants
+ */
+#define K_DLOG_MAGIC                    (0x4C50U)       // "PL"
+#define K_DLOG_NO_PAGE                  (UINT32_MAX)
+
+static const uint32_t   MS_DLOG_FLUSH   = (uint32_t)K_DLOG_FLUSH_MIN * 60UL * 1000UL;
+
+_Static_assert(sizeof(dlog_page_hdr_st) == K_DLOG_PAGE_HDR_LEN, "dlog page header layout");
+_Static_assert(0 == (K_DLOG_SEGMENT_PAGES % K_DLOG_BATCH_PAGES), "dlog batches within the segments");
+_Static_assert(0 == (K_DLOG_MAX_RING_PAGES % K_DLOG_BATCH_PAGES), "dlog batches within the largest ring");
+_Static_assert(0 == (K_DLOG_MAP_SIZE % K_DLOG_PAGE_SIZE), "dlog pages within the mapped windows");
+
+/*
+ * Private Functions
+ */
+static void getHdr(const uint8_t *pui8_page, dlog_page_hdr_st *ps_hdr)
+{
+    memcpy(ps_hdr, pui8_page, sizeof(dlog_page_hdr_st));
+}
+
+static void putHdr(uint8_t *pui8_page, const dlog_page_hdr_st *ps_hdr)
+{
+    memcpy(pui8_page, ps_hdr, sizeof(dlog_page_hdr_st));
+}
+
+static uint16_t pageCrc(const uint8_t *pui8_page, uint16_t ui16_used)
+{
+    return crc16CalcBlock((uint8_t *)&pui8_page[offsetof(dlog_page_hdr_st, ui32_page)],
+                          (uint16_t)(K_DLOG_PAGE_HDR_LEN - offsetof(dlog_page_hdr_st, ui32_page) + ui16_used));
+}
+
+/* magic, page number & used length, the crc with b_crc */
+static bool pageValid(const uint8_t *pui8_page, uint32_t ui32_abs, bool b_crc, dlog_page_hdr_st *ps_hdr)
+{
+    getHdr(pui8_page, ps_hdr);
+
+    return (K_DLOG_MAGIC == ps_hdr->ui16_magic) && (ui32_abs == ps_hdr->ui32_page) &&
+           (ps_hdr->ui16_used <= (K_DLOG_PAGE_SIZE - K_DLOG_PAGE_HDR_LEN)) &&
+           ((false == b_crc) || (pageCrc(pui8_page, ps_hdr->ui16_used) == ps_hdr->ui16_crc));
+}
+
+static void segPath(const dlog_st *ps_log, uint32_t ui32_seg, char *pc_path)
+{
+    snprintf(pc_path, K_DLOG_PATH_LEN, "%s/%08lX.LOG", ps_log->pc_dir, (unsigned long)ui32_seg);
+}
+
+/* the slot is simply written over in the partition */
+static void removeSeg(const dlog_st *ps_log, uint32_t ui32_seg)
+{
+    char ac_path[K_DLOG_PATH_LEN];
+
+    if (NULL == ps_log->ps_part)
+    {
+        segPath(ps_log, ui32_seg, ac_path);
+        (void)remove(ac_path);
+    }
+}
+
+static size_t partOffset(const dlog_st *ps_log, uint32_t ui32_seg, uint16_t ui16_page)
+{
+    return ((size_t)(ui32_seg % ps_log->ui8_slots) * K_DLOG_SEGMENT_PAGES + ui16_page) * K_DLOG_PAGE_SIZE;
+}
+
+static uint32_t headAbs(const dlog_st *ps_log)
+{
+    return ps_log->as_seg[ps_log->ui8_segs - 1].ui32_seg * K_DLOG_SEGMENT_PAGES + ps_log->ui16_page;
+}
+
+/* completed page still in the ring, NULL if it's written */
+static const uint8_t *ringPage(const dlog_st *ps_log, uint32_t ui32_abs)
+{
+    uint32_t ui32_head = headAbs(ps_log);
+
+    if ((ui32_abs >= ui32_head) || ((ui32_head - ui32_abs) > ps_log->ui16_queued))
+    {
+        return NULL;
+    }
+
+    return &ps_log->pui8_ring[(size_t)(ui32_abs % ps_log->ui16_ring_pages) * K_DLOG_PAGE_SIZE];
+}
+
+/* partition page in a mapped window, NULL without a map or if mapping fails; a new window
+   takes the place of the least recently used one */
+static const uint8_t *mapPage(const dlog_st *ps_log, uint32_t ui32_seg, uint16_t ui16_page)
+{
+    dlog_map_st    *ps_map = ps_log->ps_map;
+    dlog_window_st *ps_win;
+    size_t          sz_off;
+    uint32_t        ui32_base;
+    uint32_t        ui32_len;
+    uint8_t         ui8_lru = 0;
+
+    if (NULL == ps_map)
+    {
+        return NULL;
+    }
+
+    sz_off    = partOffset(ps_log, ui32_seg, ui16_page);
+    ui32_base = (uint32_t)(sz_off - (sz_off % K_DLOG_MAP_SIZE));
+    ui32_len  = ps_log->ps_part->size - ui32_base;
+    for (uint8_t i = 0; i < K_DLOG_MAP_WINDOWS; i++)
+    {
+        ps_win = &ps_map->as_win[i];
+        if ((NULL != ps_win->pv_base) && (ui32_base == ps_win->ui32_off))
+        {
+            ps_win->ui32_used = ++ps_map->ui32_tick;
+            return (const uint8_t *)ps_win->pv_base + (sz_off - ui32_base);
+        }
+        else if (ps_win->ui32_used < ps_map->as_win[ui8_lru].ui32_used)
+        {
+            ui8_lru = i;                            // unused ones have 0
+        }
+    }
+
+    ps_win = &ps_map->as_win[ui8_lru];
+    if (NULL != ps_win->pv_base)
+    {
+        esp_partition_munmap(ps_win->h_map);
+        ps_win->pv_base = NULL;
+    }
+
+    ui32_len = (ui32_len > K_DLOG_MAP_SIZE) ? K_DLOG_MAP_SIZE : ui32_len;
+    if (ESP_OK != esp_partition_mmap(ps_log->ps_part, ui32_base, ui32_len, ESP_PARTITION_MMAP_DATA, &ps_win->pv_base, &ps_win->h_map))
+    {
+        ps_win->pv_base   = NULL;
+        ps_win->ui32_used = 0;
+        ps_map->ui32_map_fails++;
+        return NULL;
+    }
+
+    ps_win->ui32_off  = ui32_base;
+    ps_win->ui32_used = ++ps_map->ui32_tick;
+    ps_map->ui32_maps++;
+
+    return (const uint8_t *)ps_win->pv_base + (sz_off - ui32_base);
+}
+
+/* whole page, or just the header with pui8_page == NULL: magic, page number & used length
+   checked, the crc only with the whole page; from the mapped partition unless b_read */
+static bool readPage(const dlog_st *ps_log, uint32_t ui32_seg, uint16_t ui16_page, uint8_t *pui8_page, dlog_page_hdr_st *ps_hdr,
+                     bool b_read)
+{
+    char            ac_path[K_DLOG_PATH_LEN];
+    uint8_t         aui8_hdr[K_DLOG_PAGE_HDR_LEN];
+    uint8_t        *pui8_buf  = (NULL != pui8_page) ? pui8_page : aui8_hdr;
+    size_t          sz_len    = (NULL != pui8_page) ? K_DLOG_PAGE_SIZE : K_DLOG_PAGE_HDR_LEN;
+    const uint8_t  *pui8_ring = ringPage(ps_log, ui32_seg * K_DLOG_SEGMENT_PAGES + ui16_page);
+    const uint8_t  *pui8_map  = ((NULL == pui8_ring) && (false == b_read)) ? mapPage(ps_log, ui32_seg, ui16_page) : NULL;
+    FILE           *ps_file;
+    bool            b_status;
+
+    if (NULL != pui8_ring)
+    {
+        memcpy(pui8_buf, pui8_ring, sz_len);
+        b_status = true;
+    }
+    else if (NULL != pui8_map)
+    {
+        memcpy(pui8_buf, pui8_map, sz_len);
+        b_status = true;
+    }
+    else if (NULL != ps_log->ps_part)
+    {
+        b_status = (ESP_OK == esp_partition_read(ps_log->ps_part, partOffset(ps_log, ui32_seg, ui16_page), pui8_buf, sz_len));
+    }
+    else
+    {
+        segPath(ps_log, ui32_seg, ac_path);
+        ps_file = fopen(ac_path, "rb");
+        if (NULL == ps_file)
+        {
+            return false;
+        }
+
+        b_status = (0 == fseek(ps_file, (long)ui16_page * K_DLOG_PAGE_SIZE, SEEK_SET)) &&
+                   (1 == fread(pui8_buf, sz_len, 1, ps_file));
+        fclose(ps_file);
+    }
+
+    return (true == b_status) && (true == pageValid(pui8_buf, ui32_seg * K_DLOG_SEGMENT_PAGES + ui16_page, (NULL != pui8_page), ps_hdr));
+}
+
+static void sealPage(uint8_t *pui8_page)
+{
+    dlog_page_hdr_st s_hdr;
+
+    getHdr(pui8_page, &s_hdr);
+    s_hdr.ui16_crc = pageCrc(pui8_page, s_hdr.ui16_used);
+    putHdr(pui8_page, &s_hdr);
+}
+
+static bool writeFile(dlog_st *ps_log, uint32_t ui32_abs, const uint8_t *pui8_pages, uint16_t ui16_pages)
+{
+    char        ac_path[K_DLOG_PATH_LEN];
+    uint16_t    ui16_page = (uint16_t)(ui32_abs % K_DLOG_SEGMENT_PAGES);
+    FILE       *ps_file;
+    bool        b_status;
+
+    segPath(ps_log, ui32_abs / K_DLOG_SEGMENT_PAGES, ac_path);
+    ps_file = fopen(ac_path, "r+b");
+    if (NULL == ps_file)
+    {
+        ps_file = fopen(ac_path, "w+b");
+    }
+
+    if (NULL == ps_file)
+    {
+        LOGW("data log: open %s failed", ac_path);
+        return false;
+    }
+
+    b_status = (0 == fseek(ps_file, (long)ui16_page * K_DLOG_PAGE_SIZE, SEEK_SET)) &&
+               (1 == fwrite(pui8_pages, (size_t)ui16_pages * K_DLOG_PAGE_SIZE, 1, ps_file));
+    b_status = (0 == fclose(ps_file)) && b_status;
+
+    if (false == b_status)
+    {
+        LOGW("data log: write %s page %u failed", ac_path, ui16_page);
+        return false;
+    }
+
+    return true;
+}
+
+static bool writePartition(dlog_st *ps_log, uint32_t ui32_abs, const uint8_t *pui8_pages, uint16_t ui16_pages)
+{
+    size_t  sz_off = partOffset(ps_log, ui32_abs / K_DLOG_SEGMENT_PAGES, (uint16_t)(ui32_abs % K_DLOG_SEGMENT_PAGES));
+    size_t  sz_len = (size_t)ui16_pages * K_DLOG_PAGE_SIZE;
+
+    if ((ESP_OK != esp_partition_erase_range(ps_log->ps_part, sz_off, sz_len)) ||
+        (ESP_OK != esp_partition_write(ps_log->ps_part, sz_off, pui8_pages, sz_len)))
+    {
+        LOGW("data log: write %s page %lu failed", ps_log->ps_part->label, (unsigned long)ui32_abs);
+        return false;
+    }
+    ps_log->ui32_erases += ui16_pages;
+
+    return true;
+}
+
+/* ui16_pages consecutive pages from absolute page ui32_abs in one write, within one segment */
+static bool writePages(dlog_st *ps_log, uint32_t ui32_abs, const uint8_t *pui8_pages, uint16_t ui16_pages)
+{
+    if (((NULL != ps_log->ps_part) && (false == writePartition(ps_log, ui32_abs, pui8_pages, ui16_pages))) ||
+        ((NULL == ps_log->ps_part) && (false == writeFile(ps_log, ui32_abs, pui8_pages, ui16_pages))))
+    {
+        return false;
+    }
+
+    ps_log->ui32_page_writes += ui16_pages;
+    ps_log->ui32_writes++;
+
+    return true;
+}
+
+static bool writePage(dlog_st *ps_log)
+{
+    sealPage(ps_log->aui8_page);
+    if (false == writePages(ps_log, headAbs(ps_log), ps_log->aui8_page, 1))
+    {
+        return false;
+    }
+
+    ps_log->b_dirty = false;
+
+    return true;
+}
+
+/* the ring in runs that neither wrap it nor leave a segment; then its records are stored */
+static bool writeQueued(dlog_st *ps_log)
+{
+    while (0 != ps_log->ui16_queued)
+    {
+        uint32_t ui32_abs  = headAbs(ps_log) - ps_log->ui16_queued;
+        uint16_t ui16_slot = (uint16_t)(ui32_abs % ps_log->ui16_ring_pages);
+        uint16_t ui16_run  = ps_log->ui16_queued;
+
+        ui16_run = (ui16_run > (ps_log->ui16_ring_pages - ui16_slot)) ? (ps_log->ui16_ring_pages - ui16_slot) : ui16_run;
+        ui16_run = (ui16_run > (K_DLOG_SEGMENT_PAGES - (ui32_abs % K_DLOG_SEGMENT_PAGES))) ?
+                   (uint16_t)(K_DLOG_SEGMENT_PAGES - (ui32_abs % K_DLOG_SEGMENT_PAGES)) : ui16_run;
+
+        if (false == writePages(ps_log, ui32_abs, &ps_log->pui8_ring[(size_t)ui16_slot * K_DLOG_PAGE_SIZE], ui16_run))
+        {
+            return false;
+        }
+        ps_log->ui16_queued -= ui16_run;
+    }
+
+    if (NULL != ps_log->ps_journal)
+    {
+        journalRelease(ps_log->ps_journal, JOURNAL_STREAM_DLOG, ps_log->ui32_queued_seq);
+    }
+
+    return true;
+}
+
+static void startPage(dlog_st *ps_log, uint16_t ui16_page)
+{
+    dlog_page_hdr_st s_hdr;
+
+    memset(ps_log->aui8_page, 0, sizeof(ps_log->aui8_page));
+    memset(&s_hdr, 0, sizeof(s_hdr));
+    s_hdr.ui16_magic = K_DLOG_MAGIC;
+    s_hdr.ui32_page  = ps_log->as_seg[ps_log->ui8_segs - 1].ui32_seg * K_DLOG_SEGMENT_PAGES + ui16_page;
+    putHdr(ps_log->aui8_page, &s_hdr);
+
+    ps_log->ui16_page = ui16_page;
+    ps_log->b_dirty   = false;
+}
+
+static void nextPage(dlog_st *ps_log)
+{
+    if ((ps_log->ui16_page + 1) < K_DLOG_SEGMENT_PAGES)
+    {
+        startPage(ps_log, ps_log->ui16_page + 1);
+        return;
+    }
+
+    // a lowered limit drops several
+    while (ps_log->ui8_segs >= ps_log->ui8_max_segs)
+    {
+        removeSeg(ps_log, ps_log->as_seg[0].ui32_seg);
+        memmove(&ps_log->as_seg[0], &ps_log->as_seg[1], (ps_log->ui8_segs - 1) * sizeof(dlog_seg_st));
+        ps_log->ui8_segs--;
+        ps_log->ui32_segs_dropped++;
+    }
+
+    ps_log->as_seg[ps_log->ui8_segs].ui32_seg      = ps_log->as_seg[ps_log->ui8_segs - 1].ui32_seg + 1;
+    ps_log->as_seg[ps_log->ui8_segs].si32_first_ts = INT32_MAX;
+    ps_log->ui8_segs++;
+    startPage(ps_log, 0);
+}
+
+/* the full RAM page to flash, or into the ring, which is written at the end of each batch */
+static bool completePage(dlog_st *ps_log)
+{
+    uint32_t ui32_abs = headAbs(ps_log);
+
+    if ((NULL != ps_log->pui8_ring) && (true == ps_log->b_dirty))
+    {
+        // a failed batch filled it
+        if ((ps_log->ui16_queued == ps_log->ui16_ring_pages) && (false == writeQueued(ps_log)))
+        {
+            return false;
+        }
+        sealPage(ps_log->aui8_page);
+        memcpy(&ps_log->pui8_ring[(size_t)(ui32_abs % ps_log->ui16_ring_pages) * K_DLOG_PAGE_SIZE], ps_log->aui8_page, K_DLOG_PAGE_SIZE);
+        ps_log->ui16_queued++;
+        ps_log->ui32_queued_seq = ps_log->ui32_journal_seq;
+    }
+    else if ((true == ps_log->b_dirty) && (false == writePage(ps_log)))
+    {
+        return false;
+    }
+    else if ((0 == ps_log->ui16_queued) && (NULL != ps_log->ps_journal))
+    {
+        // never written again, a torn write can't take its records any more
+        journalRelease(ps_log->ps_journal, JOURNAL_STREAM_DLOG, ps_log->ui32_journal_seq);
+    }
+    nextPage(ps_log);
+
+    if ((0 != ps_log->ui16_queued) && (0 == ((ui32_abs + 1) % ps_log->ui16_batch)))
+    {
+        (void)writeQueued(ps_log);                  // or with the next page, the next flush
+    }
+
+    return true;
+}
+
+/* sorted insert of a segment found on mount, beyond ui8_max_segs the oldest goes */
+static void addSeg(dlog_st *ps_log, uint32_t ui32_seg)
+{
+    uint8_t i = ps_log->ui8_segs;
+
+    if ((ps_log->ui8_max_segs == ps_log->ui8_segs) && (ui32_seg < ps_log->as_seg[0].ui32_seg))
+    {
+        removeSeg(ps_log, ui32_seg);
+        return;
+    }
+    else if (ps_log->ui8_max_segs == ps_log->ui8_segs)
+    {
+        removeSeg(ps_log, ps_log->as_seg[0].ui32_seg);
+        memmove(&ps_log->as_seg[0], &ps_log->as_seg[1], (ps_log->ui8_max_segs - 1) * sizeof(dlog_seg_st));
+        ps_log->ui8_segs--;
+        i--;
+    }
+
+    for ( ; (i > 0) && (ps_log->as_seg[i - 1].ui32_seg > ui32_seg); i--)
+    {
+        ps_log->as_seg[i] = ps_log->as_seg[i - 1];
+    }
+    ps_log->as_seg[i].ui32_seg = ui32_seg;
+    ps_log->ui8_segs++;
+}
+
+/* pages written to a segment: the file size, in the partition the pages of this lap */
+static int32_t segPages(const dlog_st *ps_log, uint32_t ui32_seg)
+{
+    char                ac_path[K_DLOG_PATH_LEN];
+    struct stat         s_stat;
+    dlog_page_hdr_st    s_hdr;
+    int32_t             si32_pages = 0;
+
+    if (NULL != ps_log->ps_part)
+    {
+        while ((si32_pages < K_DLOG_SEGMENT_PAGES) && (true == readPage(ps_log, ui32_seg, (uint16_t)si32_pages, NULL, &s_hdr, false)))
+        {
+            si32_pages++;
+        }
+        return si32_pages;
+    }
+
+    segPath(ps_log, ui32_seg, ac_path);
+    if (0 == stat(ac_path, &s_stat))
+    {
+        si32_pages = (int32_t)(s_stat.st_size / K_DLOG_PAGE_SIZE);
+        si32_pages = (si32_pages > K_DLOG_SEGMENT_PAGES) ? K_DLOG_SEGMENT_PAGES : si32_pages;
+    }
+
+    return si32_pages;
+}
+
+/* the last valid page of the last segment becomes the RAM page, torn pages after it are
+   overwritten */
+static void restoreHead(dlog_st *ps_log)
+{
+    dlog_page_hdr_st    s_hdr;
+    uint32_t            ui32_seg  = ps_log->as_seg[ps_log->ui8_segs - 1].ui32_seg;
+    int32_t             si32_page = segPages(ps_log, ui32_seg);
+
+    for (si32_page--; si32_page >= 0; si32_page--)
+    {
+        if (true == readPage(ps_log, ui32_seg, (uint16_t)si32_page, ps_log->aui8_page, &s_hdr, false))
+        {
+            ps_log->ui16_page = (uint16_t)si32_page;
+            ps_log->b_dirty   = false;
+            return;
+        }
+    }
+
+    startPage(ps_log, 0);
+}
+
+static int16_t segIndex(const dlog_st *ps_log, uint32_t ui32_seg)
+{
+    for (uint8_t i = 0; i < ps_log->ui8_segs; i++)
+    {
+        if (ps_log->as_seg[i].ui32_seg >= ui32_seg)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+static bool isHeadPage(const dlog_st *ps_log, uint32_t ui32_seg, uint16_t ui16_page)
+{
+    return (ps_log->as_seg[ps_log->ui8_segs - 1].ui32_seg == ui32_seg) && (ps_log->ui16_page == ui16_page);
+}
+
+static bool pageFirstTs(const dlog_st *ps_log, uint32_t ui32_seg, uint16_t ui16_page, int32_t *psi32_ts)
+{
+    dlog_page_hdr_st s_hdr;
+
+    if (true == isHeadPage(ps_log, ui32_seg, ui16_page))
+    {
+        getHdr(ps_log->aui8_page, &s_hdr);
+    }
+    else if (false == readPage(ps_log, ui32_seg, ui16_page, NULL, &s_hdr, false))
+    {
+        return false;
+    }
+
+    *psi32_ts = s_hdr.si32_first_ts;
+
+    return (0 != s_hdr.ui16_count);
+}
+
+/* page at the reader position, in place unless it's only in a file or the unmapped partition;
+   NULL if it's unreadable */
+static const uint8_t *loadPage(const dlog_st *ps_log, dlog_reader_st *ps_reader)
+{
+    const dlog_pos_st  *ps_pos    = &ps_reader->s_pos;
+    uint32_t            ui32_abs  = ps_pos->ui32_seg * K_DLOG_SEGMENT_PAGES + ps_pos->ui16_page;
+    const uint8_t      *pui8_page = ringPage(ps_log, ui32_abs);
+    dlog_page_hdr_st    s_hdr;
+
+    if (true == isHeadPage(ps_log, ps_pos->ui32_seg, ps_pos->ui16_page))
+    {
+        return ps_log->aui8_page;                   // keeps growing
+    }
+    else if (NULL != pui8_page)
+    {
+        return pui8_page;
+    }
+
+    pui8_page = (false == ps_reader->b_copy) ? mapPage(ps_log, ps_pos->ui32_seg, ps_pos->ui16_page) : NULL;
+    if (NULL != pui8_page)
+    {
+        if (ui32_abs != ps_reader->ui32_checked)
+        {
+            ps_reader->ui32_page_maps++;
+            ps_reader->ui32_checked = (true == pageValid(pui8_page, ui32_abs, true, &s_hdr)) ? ui32_abs : K_DLOG_NO_PAGE;
+        }
+        return (ui32_abs == ps_reader->ui32_checked) ? pui8_page : NULL;
+    }
+
+    if (ui32_abs != ps_reader->ui32_buffered)
+    {
+        ps_reader->ui32_page_reads++;
+        ps_reader->ui64_copied  += K_DLOG_PAGE_SIZE;
+        ps_reader->ui32_buffered = (true == readPage(ps_log, ps_pos->ui32_seg, ps_pos->ui16_page, ps_reader->aui8_page, &s_hdr, ps_reader->b_copy)) ?
+                                   ui32_abs : K_DLOG_NO_PAGE;
+    }
+
+    return (ui32_abs == ps_reader->ui32_buffered) ? ps_reader->aui8_page : NULL;
+}
+
+/* record at the reader position, moves over page and segment ends; NULL at the end of the log */
+static const uint8_t *peek(const dlog_st *ps_log, dlog_reader_st *ps_reader, int32_t *psi32_ts, uint16_t *pui16_len)
+{
+    dlog_pos_st        *ps_pos  = &ps_reader->s_pos;
+    const dlog_seg_st  *ps_head = &ps_log->as_seg[ps_log->ui8_segs - 1];
+    dlog_page_hdr_st    s_hdr;
+
+    if (ps_pos->ui32_seg < ps_log->as_seg[0].ui32_seg)
+    {
+        // dropped meanwhile
+        ps_pos->ui32_seg    = ps_log->as_seg[0].ui32_seg;
+        ps_pos->ui16_page   = 0;
+        ps_pos->ui16_rec    = 0;
+        ps_reader->ui32_loaded = K_DLOG_NO_PAGE;
+    }
+
+    while ((ps_pos->ui32_seg < ps_head->ui32_seg) ||
+           ((ps_pos->ui32_seg == ps_head->ui32_seg) && (ps_pos->ui16_page <= ps_log->ui16_page)))
+    {
+        uint32_t        ui32_abs  = ps_pos->ui32_seg * K_DLOG_SEGMENT_PAGES + ps_pos->ui16_page;
+        bool            b_head    = isHeadPage(ps_log, ps_pos->ui32_seg, ps_pos->ui16_page);
+        const uint8_t  *pui8_page = loadPage(ps_log, ps_reader);
+
+        memset(&s_hdr, 0, sizeof(s_hdr));
+        if (NULL != pui8_page)
+        {
+            getHdr(pui8_page, &s_hdr);
+        }
+
+        if (ui32_abs != ps_reader->ui32_loaded)
+        {
+            ps_reader->ui32_loaded = ui32_abs;
+            ps_reader->ui16_off    = K_DLOG_PAGE_HDR_LEN;
+            for (uint16_t r = 0; (r < ps_pos->ui16_rec) && (r < s_hdr.ui16_count); r++)
+            {
+                uint16_t ui16_len;
+
+                memcpy(&ui16_len, &pui8_page[ps_reader->ui16_off + 4], sizeof(ui16_len));
+                ps_reader->ui16_off += K_DLOG_REC_HDR_LEN + ui16_len;
+            }
+        }
+
+        if (ps_pos->ui16_rec < s_hdr.ui16_count)
+        {
+            const uint8_t *pui8_rec = &pui8_page[ps_reader->ui16_off];
+
+            memcpy(psi32_ts, &pui8_rec[0], sizeof(int32_t));
+            memcpy(pui16_len, &pui8_rec[4], sizeof(uint16_t));
+            if ((ps_reader->ui16_off + K_DLOG_REC_HDR_LEN + *pui16_len) <= (K_DLOG_PAGE_HDR_LEN + s_hdr.ui16_used))
+            {
+                return &pui8_rec[K_DLOG_REC_HDR_LEN];
+            }
+        }
+
+        if (true == b_head)
+        {
+            return NULL;
+        }
+
+        // next page, next segment
+        ps_pos->ui16_rec = 0;
+        if ((ps_pos->ui16_page + 1) < K_DLOG_SEGMENT_PAGES)
+        {
+            ps_pos->ui16_page++;
+        }
+        else
+        {
+            int16_t si16_next = segIndex(ps_log, ps_pos->ui32_seg + 1);
+
+            ps_pos->ui32_seg  = (si16_next >= 0) ? ps_log->as_seg[si16_next].ui32_seg : ps_head->ui32_seg + 1;
+            ps_pos->ui16_page = 0;
+        }
+    }
+
+    return NULL;
+}
+
+static void advance(dlog_reader_st *ps_reader, uint16_t ui16_len)
+{
+    ps_reader->s_pos.ui16_rec++;
+    ps_reader->ui16_off += K_DLOG_REC_HDR_LEN + ui16_len;
+}
+
+/* the record in the journal until its page is complete; it stays in the RAM page if that fails */
+static void journalRecord(dlog_st *ps_log, const dlog_page_hdr_st *ps_hdr, int32_t si32_ts, const uint8_t *pui8_data, uint16_t ui16_len)
+{
+    uint8_t     aui8_pre[K_DLOG_JOURNAL_PRE_LEN];
+    uint16_t    ui16_rec = ps_hdr->ui16_count - 1;
+
+    memcpy(&aui8_pre[0], &ps_hdr->ui32_page, sizeof(uint32_t));
+    memcpy(&aui8_pre[4], &ui16_rec, sizeof(uint16_t));
+    memcpy(&aui8_pre[6], &si32_ts, sizeof(int32_t));
+
+    if (false == journalAppend(ps_log->ps_journal, JOURNAL_STREAM_DLOG, aui8_pre, sizeof(aui8_pre), pui8_data, ui16_len,
+                               &ps_log->ui32_journal_seq))
+    {
+        ps_log->ui32_journal_misses++;
+        ps_log->b_unjournaled = true;
+    }
+}
+
+/* the segments found: the newest continues in its last page, or segment 0 starts */
+static void mount(dlog_st *ps_log)
+{
+    if (0 == ps_log->ui8_segs)
+    {
+        ps_log->as_seg[0].ui32_seg      = 0;
+        ps_log->as_seg[0].si32_first_ts = INT32_MAX;
+        ps_log->ui8_segs                = 1;
+        startPage(ps_log, 0);
+        return;
+    }
+
+    restoreHead(ps_log);
+
+    // unreadable first pages keep the table ascending
+    for (uint8_t i = 0; i < ps_log->ui8_segs; i++)
+    {
+        if (false == pageFirstTs(ps_log, ps_log->as_seg[i].ui32_seg, 0, &ps_log->as_seg[i].si32_first_ts))
+        {
+            ps_log->as_seg[i].si32_first_ts = (0 == i) ? INT32_MIN : ps_log->as_seg[i - 1].si32_first_ts;
+        }
+    }
+}
+
+/*
+ * Public Functions
+ */
+/* finds the segments in pc_dir and continues in the last page of the newest one */
+bool dlogInit(dlog_st *ps_log, const char *pc_dir)
+{
+    DIR            *ps_dir;
+    struct dirent  *ps_ent;
+
+    memset(ps_log, 0, sizeof(dlog_st));
+    ps_log->pc_dir       = pc_dir;
+    ps_log->ui8_max_segs = K_DLOG_MAX_SEGMENTS;
+
+    if ((0 != mkdir(pc_dir, 0755)) && (EEXIST != errno))
+    {
+        LOGW("data log: cannot create %s", pc_dir);
+        return false;
+    }
+
+    ps_dir = opendir(pc_dir);
+    if (NULL == ps_dir)
+    {
+        LOGW("data log: cannot open %s", pc_dir);
+        return false;
+    }
+
+    while (NULL != (ps_ent = readdir(ps_dir)))
+    {
+        unsigned long   ul_seg;
+        char            ac_ext[4];
+
+        if ((12 == strlen(ps_ent->d_name)) &&
+            (2 == sscanf(ps_ent->d_name, "%8lx.%3s", &ul_seg, ac_ext)) &&
+            (0 == strcasecmp(ac_ext, "LOG")))
+        {
+            addSeg(ps_log, (uint32_t)ul_seg);
+        }
+    }
+    closedir(ps_dir);
+    mount(ps_log);
+
+    return true;
+}
+
+/* finds the segments in the slots of a raw partition of K_DLOG_PAGE_SIZE erase sectors and
+   continues in the last page of the newest one */
+bool dlogInitPartition(dlog_st *ps_log, const esp_partition_t *ps_part)
+{
+    const size_t SZ_SEG = (size_t)K_DLOG_SEGMENT_PAGES * K_DLOG_PAGE_SIZE;
+
+    memset(ps_log, 0, sizeof(dlog_st));
+    ps_log->ps_part = ps_part;
+
+    if (NULL == ps_part)
+    {
+        LOGW("data log: no partition");
+        return false;
+    }
+    else if ((K_DLOG_PAGE_SIZE != ps_part->erase_size) || (ps_part->size < (2 * SZ_SEG)))
+    {
+        LOGW("data log: partition %s of %lu bytes, %lu byte sectors unusable", ps_part->label,
+             (unsigned long)ps_part->size, (unsigned long)ps_part->erase_size);
+        return false;
+    }
+
+    ps_log->ui8_slots    = ((ps_part->size / SZ_SEG) > K_DLOG_MAX_SEGMENTS) ? K_DLOG_MAX_SEGMENTS : (uint8_t)(ps_part->size / SZ_SEG);
+    ps_log->ui8_max_segs = ps_log->ui8_slots;
+    for (uint8_t i = 0; i < ps_log->ui8_slots; i++)
+    {
+        dlog_page_hdr_st s_hdr;
+
+        if ((ESP_OK == esp_partition_read(ps_part, (size_t)i * SZ_SEG, &s_hdr, sizeof(s_hdr))) &&
+            (K_DLOG_MAGIC == s_hdr.ui16_magic) && (0 == (s_hdr.ui32_page % K_DLOG_SEGMENT_PAGES)) &&
+            (i == ((s_hdr.ui32_page / K_DLOG_SEGMENT_PAGES) % ps_log->ui8_slots)))
+        {
+            addSeg(ps_log, s_hdr.ui32_page / K_DLOG_SEGMENT_PAGES);
+        }
+    }
+    mount(ps_log);
+
+    return true;
+}
+
+/* into the RAM page; a full page is written before the record goes to the next one */
+bool dlogAppend(dlog_st *ps_log, int32_t si32_ts, const uint8_t *pui8_data, uint16_t ui16_len)
+{
+    dlog_page_hdr_st    s_hdr;
+    uint8_t            *pui8_rec;
+
+    if (ui16_len > K_DLOG_MAX_REC_LEN)
+    {
+        return false;
+    }
+
+    getHdr(ps_log->aui8_page, &s_hdr);
+    if ((K_DLOG_PAGE_HDR_LEN + s_hdr.ui16_used + K_DLOG_REC_HDR_LEN + ui16_len) > K_DLOG_PAGE_SIZE)
+    {
+        if (false == completePage(ps_log))
+        {
+            return false;
+        }
+        getHdr(ps_log->aui8_page, &s_hdr);
+    }
+
+    if (0 == s_hdr.ui16_count)
+    {
+        s_hdr.si32_first_ts = si32_ts;
+        if (0 == ps_log->ui16_page)
+        {
+            ps_log->as_seg[ps_log->ui8_segs - 1].si32_first_ts = si32_ts;
+        }
+    }
+    s_hdr.si32_last_ts = si32_ts;
+
+    pui8_rec = &ps_log->aui8_page[K_DLOG_PAGE_HDR_LEN + s_hdr.ui16_used];
+    memcpy(&pui8_rec[0], &si32_ts, sizeof(si32_ts));
+    memcpy(&pui8_rec[4], &ui16_len, sizeof(ui16_len));
+    memcpy(&pui8_rec[K_DLOG_REC_HDR_LEN], pui8_data, ui16_len);
+
+    s_hdr.ui16_used += K_DLOG_REC_HDR_LEN + ui16_len;
+    s_hdr.ui16_count++;
+    putHdr(ps_log->aui8_page, &s_hdr);
+
+    ps_log->b_dirty = true;
+    ps_log->ui32_records++;
+    ps_log->ui64_record_bytes += ui16_len;
+
+    if (NULL != ps_log->ps_journal)
+    {
+        journalRecord(ps_log, &s_hdr, si32_ts, pui8_data, ui16_len);
+    }
+
+    return true;
+}
+
+/* true if the record goes after others in the RAM page, false if it would start a page */
+bool dlogFits(const dlog_st *ps_log, uint16_t ui16_len)
+{
+    dlog_page_hdr_st s_hdr;
+
+    getHdr(ps_log->aui8_page, &s_hdr);
+
+    return (0 != s_hdr.ui16_count) && ((K_DLOG_PAGE_HDR_LEN + s_hdr.ui16_used + K_DLOG_REC_HDR_LEN + ui16_len) <= K_DLOG_PAGE_SIZE);
+}
+
+/* after the restore: every record appended from now on goes to the journal first */
+void dlogJournal(dlog_st *ps_log, journal_st *ps_journal)
+{
+    ps_log->ps_journal = ps_journal;
+}
+
+/* completed pages wait in pui8_pages (ui16_pages of K_DLOG_PAGE_SIZE), written K_DLOG_BATCH_PAGES
+   aligned at a time (the whole of a smaller ring) or all on a forced flush; right after dlogInit() */
+bool dlogRing(dlog_st *ps_log, uint8_t *pui8_pages, uint16_t ui16_pages)
+{
+    uint16_t ui16_batch = (ui16_pages < K_DLOG_BATCH_PAGES) ? ui16_pages : K_DLOG_BATCH_PAGES;
+
+    if ((NULL == pui8_pages) || (0 == ui16_batch) || (0 != (ui16_pages % ui16_batch)) || (0 != (K_DLOG_SEGMENT_PAGES % ui16_batch)))
+    {
+        return false;
+    }
+
+    ps_log->pui8_ring       = pui8_pages;
+    ps_log->ui16_ring_pages = ui16_pages;
+    ps_log->ui16_batch      = ui16_batch;
+    ps_log->ui16_queued     = 0;
+
+    return true;
+}
+
+/* partition readers walk the pages in place through K_DLOG_MAP_WINDOWS mapped windows of ps_map;
+   false for a log of files */
+bool dlogMap(dlog_st *ps_log, dlog_map_st *ps_map)
+{
+    if ((NULL == ps_log->ps_part) || (NULL == ps_map))
+    {
+        return false;
+    }
+
+    memset(ps_map, 0, sizeof(dlog_map_st));
+    ps_log->ps_map = ps_map;
+
+    return true;
+}
+
+/* fewer segments than the volume / partition holds, e.g. for logs sharing it; the segments beyond
+   go when the next one starts */
+void dlogLimit(dlog_st *ps_log, uint8_t ui8_max_segs)
+{
+    if ((0 != ui8_max_segs) && (ui8_max_segs < ps_log->ui8_max_segs))
+    {
+        ps_log->ui8_max_segs = ui8_max_segs;
+    }
+}
+
+/* the oldest segment goes before its time, e.g. once compacted elsewhere; false if it's the one
+   written */
+bool dlogDropOldest(dlog_st *ps_log)
+{
+    if (ps_log->ui8_segs < 2)
+    {
+        return false;
+    }
+
+    removeSeg(ps_log, ps_log->as_seg[0].ui32_seg);
+    memmove(&ps_log->as_seg[0], &ps_log->as_seg[1], (ps_log->ui8_segs - 1) * sizeof(dlog_seg_st));
+    ps_log->ui8_segs--;
+
+    return true;
+}
+
+/* timestamp of the newest record, INT32_MIN for an empty log */
+int32_t dlogLastTs(const dlog_st *ps_log)
+{
+    dlog_page_hdr_st    s_hdr;
+    uint32_t            ui32_abs = headAbs(ps_log);
+
+    getHdr(ps_log->aui8_page, &s_hdr);
+    if (0 != s_hdr.ui16_count)
+    {
+        return s_hdr.si32_last_ts;
+    }
+    else if ((0 != ps_log->ui16_page) || (ps_log->ui8_segs > 1))
+    {
+        // a page just started, the one before it is complete
+        ui32_abs--;
+        if ((true == readPage(ps_log, ui32_abs / K_DLOG_SEGMENT_PAGES, (uint16_t)(ui32_abs % K_DLOG_SEGMENT_PAGES), NULL, &s_hdr, false)) &&
+            (0 != s_hdr.ui16_count))
+        {
+            return s_hdr.si32_last_ts;
+        }
+    }
+
+    return INT32_MIN;
+}
+
+/* journal entry of a record, before dlogJournal(): appended if the restored pages don't hold
+   it; false once its page is complete */
+bool dlogReplay(dlog_st *ps_log, uint32_t ui32_seq, const uint8_t *pui8_entry, uint16_t ui16_len)
+{
+    dlog_page_hdr_st    s_hdr;
+    uint32_t            ui32_page;
+    uint16_t            ui16_rec;
+    int32_t             si32_ts;
+
+    if (ui16_len < K_DLOG_JOURNAL_PRE_LEN)
+    {
+        return false;
+    }
+
+    memcpy(&ui32_page, &pui8_entry[0], sizeof(uint32_t));
+    memcpy(&ui16_rec, &pui8_entry[4], sizeof(uint16_t));
+    memcpy(&si32_ts, &pui8_entry[6], sizeof(int32_t));
+    getHdr(ps_log->aui8_page, &s_hdr);
+
+    if (ui32_page < s_hdr.ui32_page)
+    {
+        return false;
+    }
+    else if ((ui32_page > s_hdr.ui32_page) || (ui16_rec >= s_hdr.ui16_count))
+    {
+        if (false == dlogAppend(ps_log, si32_ts, &pui8_entry[K_DLOG_JOURNAL_PRE_LEN], ui16_len - K_DLOG_JOURNAL_PRE_LEN))
+        {
+            return false;
+        }
+        ps_log->ui32_replayed++;
+    }
+    ps_log->ui32_journal_seq = ui32_seq;
+
+    return true;
+}
+
+/* the ring and the partial RAM page: forced (shutdown, power fail), or K_DLOG_FLUSH_MIN after the
+   RAM page became dirty unless the journal holds every record */
+bool dlogFlush(dlog_st *ps_log, uint32_t ms_now, bool b_force)
+{
+    if ((false == ps_log->b_dirty) && (0 == ps_log->ui16_queued))
+    {
+        ps_log->ms_flush = ms_now;
+        return false;
+    }
+    else if ((false == b_force) &&
+             (((NULL != ps_log->ps_journal) && (false == ps_log->b_unjournaled)) || ((ms_now - ps_log->ms_flush) < MS_DLOG_FLUSH)))
+    {
+        return false;
+    }
+    else if ((false == writeQueued(ps_log)) || ((true == ps_log->b_dirty) && (false == writePage(ps_log))))
+    {
+        return false;
+    }
+
+    ps_log->ms_flush      = ms_now;
+    ps_log->b_unjournaled = false;
+
+    return true;
+}
+
+/* position the next appended record gets */
+void dlogEnd(const dlog_st *ps_log, dlog_pos_st *ps_pos)
+{
+    dlog_page_hdr_st s_hdr;
+
+    getHdr(ps_log->aui8_page, &s_hdr);
+    ps_pos->ui32_seg  = ps_log->as_seg[ps_log->ui8_segs - 1].ui32_seg;
+    ps_pos->ui16_page = ps_log->ui16_page;
+    ps_pos->ui16_rec  = s_hdr.ui16_count;
+}
+
+bool dlogPosBefore(const dlog_pos_st *ps_a, const dlog_pos_st *ps_b)
+{
+    if (ps_a->ui32_seg != ps_b->ui32_seg)
+    {
+        return (ps_a->ui32_seg < ps_b->ui32_seg);
+    }
+    else if (ps_a->ui16_page != ps_b->ui16_page)
+    {
+        return (ps_a->ui16_page < ps_b->ui16_page);
+    }
+
+    return (ps_a->ui16_rec < ps_b->ui16_rec);
+}
+
+/* positioned at the oldest record */
+void dlogReaderInit(dlog_reader_st *ps_reader)
+{
+    memset(&ps_reader->s_pos, 0, sizeof(ps_reader->s_pos));
+    ps_reader->ui32_loaded     = K_DLOG_NO_PAGE;
+    ps_reader->ui16_off        = K_DLOG_PAGE_HDR_LEN;
+    ps_reader->ui32_buffered   = K_DLOG_NO_PAGE;
+    ps_reader->ui32_checked    = K_DLOG_NO_PAGE;
+    ps_reader->b_copy          = false;
+    ps_reader->ui32_page_reads = 0;
+    ps_reader->ui32_page_maps  = 0;
+    ps_reader->ui64_copied     = 0;
+}
+
+/* a position taken from dlogEnd() or an earlier reader, e.g. a persisted cursor */
+void dlogReaderSetPos(dlog_reader_st *ps_reader, const dlog_pos_st *ps_pos)
+{
+    ps_reader->s_pos       = *ps_pos;
+    ps_reader->ui32_loaded = K_DLOG_NO_PAGE;
+}
+
+/* partition pages read into the reader's buffer (esp_partition_read()) even with dlogMap(): a
+   sequential walk touches each page once, the cache misses of the mapping cost more than the read */
+void dlogReaderCopy(dlog_reader_st *ps_reader, bool b_copy)
+{
+    ps_reader->b_copy        = b_copy;
+    ps_reader->ui32_loaded   = K_DLOG_NO_PAGE;
+    ps_reader->ui32_buffered = K_DLOG_NO_PAGE;
+    ps_reader->ui32_checked  = K_DLOG_NO_PAGE;
+}
+
+/* first record at or after si32_ts: segment table, then binary search of the page headers */
+void dlogSeek(const dlog_st *ps_log, dlog_reader_st *ps_reader, int32_t si32_ts)
+{
+    uint8_t     ui8_seg = 0;
+    uint16_t    ui16_lo = 0;
+    uint16_t    ui16_hi;
+    int32_t     si32_page_ts;
+    uint16_t    ui16_len;
+
+    for (uint8_t i = 1; (i < ps_log->ui8_segs) && (ps_log->as_seg[i].si32_first_ts <= si32_ts); i++)
+    {
+        ui8_seg = i;
+    }
+
+    ui16_hi = ((ps_log->ui8_segs - 1) == ui8_seg) ? ps_log->ui16_page : (K_DLOG_SEGMENT_PAGES - 1);
+    while (ui16_lo < ui16_hi)
+    {
+        uint16_t ui16_mid = (uint16_t)((ui16_lo + ui16_hi + 1) / 2);
+
+        if ((true == pageFirstTs(ps_log, ps_log->as_seg[ui8_seg].ui32_seg, ui16_mid, &si32_page_ts)) &&
+            (si32_page_ts <= si32_ts))
+        {
+            ui16_lo = ui16_mid;
+        }
+        else
+        {
+            ui16_hi = ui16_mid - 1;
+        }
+    }
+
+    ps_reader->s_pos.ui32_seg  = ps_log->as_seg[ui8_seg].ui32_seg;
+    ps_reader->s_pos.ui16_page = ui16_lo;
+    ps_reader->s_pos.ui16_rec  = 0;
+    ps_reader->ui32_loaded     = K_DLOG_NO_PAGE;
+
+    while ((NULL != peek(ps_log, ps_reader, &si32_page_ts, &ui16_len)) && (si32_page_ts < si32_ts))
+    {
+        advance(ps_reader, ui16_len);
+    }
+}
+
+/* next record where it is, valid until the log or another of its readers is used; NULL at the
+   end of the log or at ps_end (NULL: no limit) */
+const uint8_t *dlogReadRef(const dlog_st *ps_log, dlog_reader_st *ps_reader, const dlog_pos_st *ps_end, int32_t *psi32_ts, uint16_t *pui16_len)
+{
+    const uint8_t *pui8_rec = peek(ps_log, ps_reader, psi32_ts, pui16_len);
+
+    if ((NULL == pui8_rec) || ((NULL != ps_end) && (false == dlogPosBefore(&ps_reader->s_pos, ps_end))))
+    {
+        return NULL;
+    }
+
+    advance(ps_reader, *pui16_len);
+
+    return pui8_rec;
+}
+
+/* dlogReadRef() copied into pui8_buf; false as well if the record doesn't fit ui16_buf_len */
+bool dlogRead(const dlog_st *ps_log, dlog_reader_st *ps_reader, const dlog_pos_st *ps_end, int32_t *psi32_ts, uint8_t *pui8_buf, uint16_t ui16_buf_len, uint16_t *pui16_len)
+{
+    const uint8_t *pui8_rec = peek(ps_log, ps_reader, psi32_ts, pui16_len);
+
+    if ((NULL == pui8_rec) ||
+        ((NULL != ps_end) && (false == dlogPosBefore(&ps_reader->s_pos, ps_end))) ||
+        (*pui16_len > ui16_buf_len))
+    {
+        return false;
+    }
+
+    memcpy(pui8_buf, pui8_rec, *pui16_len);
+    ps_reader->ui64_copied += *pui16_len;
+    advance(ps_reader, *pui16_len);
+
+    return true;
+}
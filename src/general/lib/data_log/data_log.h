@@ -0,0 +1,170 @@
+/*****************************************************************************************//**
+* \file         data_log.h
+*
+* \brief        Measurement log library header file.
+* \details      Append-only log of time stamped records in segments of fixed size pages, files on
+*               the FAT volume or the slots of a raw partition.
+*               Every page carries its first / last timestamp and a crc16, records are batched
+*               in a RAM page and written as whole, sector aligned pages; with a ring attached
+*               the completed pages wait there and go to flash K_DLOG_BATCH_PAGES in one write.
+*               Readers walk the records in place where the page is in memory: the RAM page,
+*               the ring, or with mapped windows attached the partition through the flash cache
+*               unless the reader copies its pages (dlogReaderCopy(), sequential walks).
+*
+* \version      v00.01.00
+* \date         20261017
+*********************************************************************************************/
+// *INDENT-OFF*
+#ifndef __DATA_LOG_H__
+#define __DATA_LOG_H__
+// *INDENT-ON*
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Include .h Library Files
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "esp_partition.h"
+
+#include "data_log_cfg.h"
+#include "journal/journal.h"
+
+/*
+ * Global Constants
+ */
+#define K_DLOG_PAGE_HDR_LEN             (20)
+#define K_DLOG_REC_HDR_LEN              (6)         // timestamp + length
+#define K_DLOG_MAX_REC_LEN              (K_DLOG_PAGE_SIZE - K_DLOG_PAGE_HDR_LEN - K_DLOG_REC_HDR_LEN)
+#define K_DLOG_JOURNAL_PRE_LEN          (10)        // journal entry of a record: page, record, timestamp
+
+/*
+ * Global Structs
+ */
+typedef struct
+{
+    uint16_t    ui16_magic;
+    uint16_t    ui16_crc;                           // rest of the header and the used bytes
+    uint32_t    ui32_page;                          // segment * K_DLOG_SEGMENT_PAGES + page
+    int32_t     si32_first_ts;
+    int32_t     si32_last_ts;
+    uint16_t    ui16_used;                          // record bytes after the header
+    uint16_t    ui16_count;
+} dlog_page_hdr_st;
+
+typedef struct
+{
+    uint32_t    ui32_seg;
+    int32_t     si32_first_ts;                      // sparse index, pages are searched in the file
+} dlog_seg_st;
+
+typedef struct
+{
+    const void     *pv_base;                        // NULL: unused
+    esp_partition_mmap_handle_t h_map;
+    uint32_t        ui32_off;                       // partition offset, K_DLOG_MAP_SIZE aligned
+    uint32_t        ui32_used;                      // least recently used goes first
+} dlog_window_st;
+
+typedef struct
+{
+    dlog_window_st  as_win[K_DLOG_MAP_WINDOWS];
+    uint32_t        ui32_tick;
+
+    // statistics
+    uint32_t        ui32_maps;
+    uint32_t        ui32_map_fails;                 // read into the reader's buffer instead
+} dlog_map_st;
+
+typedef struct
+{
+    const char     *pc_dir;
+    const esp_partition_t *ps_part;                 // NULL: segment files in pc_dir
+    dlog_seg_st     as_seg[K_DLOG_MAX_SEGMENTS];    // oldest first, the last one is written
+    uint8_t         ui8_segs;
+    uint8_t         ui8_max_segs;                   // the oldest is dropped beyond, K_DLOG_MAX_SEGMENTS or dlogLimit()
+    uint8_t         ui8_slots;                      // segments the partition holds
+    uint16_t        ui16_page;                      // page of the last segment held in aui8_page
+    bool            b_dirty;
+    uint32_t        ms_flush;
+    uint8_t         aui8_page[K_DLOG_PAGE_SIZE];
+    journal_st     *ps_journal;                     // NULL: the RAM page is lost on a reset
+    uint32_t        ui32_journal_seq;               // entry of the last record
+    bool            b_unjournaled;                  // a record in RAM the journal missed
+    uint8_t        *pui8_ring;                      // completed pages not written yet, NULL: each written when full
+    uint16_t        ui16_ring_pages;
+    uint16_t        ui16_batch;                     // pages per write, aligned to it
+    uint16_t        ui16_queued;                    // the pages before the RAM page still in the ring
+    uint32_t        ui32_queued_seq;                // journal entry of their last record
+    dlog_map_st    *ps_map;                         // NULL: partition pages read into the reader
+
+    // statistics
+    uint32_t        ui32_records;
+    uint64_t        ui64_record_bytes;
+    uint32_t        ui32_page_writes;
+    uint32_t        ui32_writes;                    // file writes of one or more pages
+    uint32_t        ui32_erases;                    // sectors erased in the partition
+    uint32_t        ui32_segs_dropped;
+    uint32_t        ui32_replayed;                  // records restored from the journal
+    uint32_t        ui32_journal_misses;
+} dlog_st;
+
+typedef struct
+{
+    uint32_t    ui32_seg;
+    uint16_t    ui16_page;
+    uint16_t    ui16_rec;
+} dlog_pos_st;
+
+typedef struct
+{
+    dlog_pos_st s_pos;
+    uint32_t    ui32_loaded;                        // absolute page ui16_off is of, UINT32_MAX none
+    uint16_t    ui16_off;                           // offset of record s_pos.ui16_rec
+    uint32_t    ui32_buffered;                      // absolute page in aui8_page, UINT32_MAX none
+    uint32_t    ui32_checked;                       // mapped page whose crc was checked, UINT32_MAX none
+    bool        b_copy;                             // partition pages read into aui8_page even with a mapping
+    uint8_t     aui8_page[K_DLOG_PAGE_SIZE];        // pages of files, of the partition without a mapping
+
+    // statistics
+    uint32_t    ui32_page_reads;
+    uint32_t    ui32_page_maps;                     // pages walked in the mapped partition
+    uint64_t    ui64_copied;                        // bytes read into aui8_page or copied out by dlogRead()
+} dlog_reader_st;
+
+/*
+ * Public Function Prototypes
+ */
+bool dlogInit(dlog_st *ps_log, const char *pc_dir);
+bool dlogInitPartition(dlog_st *ps_log, const esp_partition_t *ps_part);
+bool dlogAppend(dlog_st *ps_log, int32_t si32_ts, const uint8_t *pui8_data, uint16_t ui16_len);
+bool dlogFits(const dlog_st *ps_log, uint16_t ui16_len);
+bool dlogFlush(dlog_st *ps_log, uint32_t ms_now, bool b_force);
+void dlogJournal(dlog_st *ps_log, journal_st *ps_journal);
+bool dlogRing(dlog_st *ps_log, uint8_t *pui8_pages, uint16_t ui16_pages);
+bool dlogMap(dlog_st *ps_log, dlog_map_st *ps_map);
+void dlogLimit(dlog_st *ps_log, uint8_t ui8_max_segs);
+bool dlogDropOldest(dlog_st *ps_log);
+int32_t dlogLastTs(const dlog_st *ps_log);
+bool dlogReplay(dlog_st *ps_log, uint32_t ui32_seq, const uint8_t *pui8_entry, uint16_t ui16_len);
+
+void dlogEnd(const dlog_st *ps_log, dlog_pos_st *ps_pos);
+bool dlogPosBefore(const dlog_pos_st *ps_a, const dlog_pos_st *ps_b);
+
+void dlogReaderInit(dlog_reader_st *ps_reader);
+void dlogReaderSetPos(dlog_reader_st *ps_reader, const dlog_pos_st *ps_pos);
+void dlogReaderCopy(dlog_reader_st *ps_reader, bool b_copy);
+void dlogSeek(const dlog_st *ps_log, dlog_reader_st *ps_reader, int32_t si32_ts);
+const uint8_t *dlogReadRef(const dlog_st *ps_log, dlog_reader_st *ps_reader, const dlog_pos_st *ps_end, int32_t *psi32_ts, uint16_t *pui16_len);
+bool dlogRead(const dlog_st *ps_log, dlog_reader_st *ps_reader, const dlog_pos_st *ps_end, int32_t *psi32_ts, uint8_t *pui8_buf, uint16_t ui16_buf_len, uint16_t *pui16_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif/* end of data_log.h */
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------
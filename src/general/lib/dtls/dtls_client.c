@@ -121,6 +121,8 @@ static int dtls_send_multi(dtls_client_context_st *ctx,
                 dtls_security_parameters_st *security,
                 uint8_t type, uint8_t *buf_array[],
                 size_t buf_len_array[], size_t buf_array_len);
+static int dtls_seal_record(dtls_client_context_st *ctx, dtls_security_parameters_st *security,
+                            uint8_t type, uint8_t *sendbuf, size_t plain_len, size_t *rlen);
 
 /**
  * Sends the fragment of length \p buflen given in \p buf to the
@@ -149,6 +151,44 @@ int dtls_write(dtls_client_context_st *ctx, const uint8_t *buf, size_t len)
   }
 }
 
+uint8_t *dtls_write_begin(dtls_client_context_st *ctx, uint8_t *record, size_t record_len, size_t *room)
+{
+  dtls_security_parameters_st *security = ctx->ps_active_security_param;
+  size_t offset = DTLS_RH_LENGTH;
+  size_t mac = 0;
+
+  if (DTLS_STATE_CONNECTED != ctx->e_state) {
+    return NULL;
+  }
+  if (security && security->e_cipher != TLS_NULL_WITH_NULL_NULL) {
+    offset += 8;                    /* nonce_explicit */
+    mac = 8;                        /* CCM_8 */
+  }
+  if (record_len <= offset + mac) {
+    return NULL;
+  }
+
+  *room = record_len - offset - mac;
+  return record + offset;
+}
+
+int dtls_write_seal(dtls_client_context_st *ctx, uint8_t *record, size_t len)
+{
+  dtls_security_parameters_st *security = ctx->ps_active_security_param;
+  size_t rlen;
+  int res;
+
+  if (DTLS_STATE_CONNECTED != ctx->e_state) {
+    return 0;
+  }
+  if (security && security->e_cipher != TLS_NULL_WITH_NULL_NULL) {
+    len += 8;                       /* nonce_explicit */
+  }
+
+  res = dtls_seal_record(ctx, security, DTLS_CT_APPLICATION_DATA, record, len, &rlen);
+  return res < 0 ? res : (int)rlen;
+}
+
 /* used to check if a received datagram contains a DTLS message */
 static char const content_types[] = {
   DTLS_CT_CHANGE_CIPHER_SPEC,
@@ -537,8 +577,8 @@ static int dtls_prepare_record(dtls_client_context_st *ctx, dtls_security_parame
                     uint8_t type, uint8_t *data_array[], size_t data_len_array[],
                     size_t data_array_len, uint8_t *sendbuf, size_t *rlen)
 {
-  uint8_t *p, *start;
-  int res;
+  uint8_t *p;
+  size_t res;
   unsigned int i;
 
   if (*rlen < DTLS_RH_LENGTH) {
@@ -546,24 +586,43 @@ static int dtls_prepare_record(dtls_client_context_st *ctx, dtls_security_parame
     return dtls_alert_fatal_create(DTLS_ALERT_INTERNAL_ERROR);
   }
 
-  p = dtls_set_record_header(type, security, sendbuf);
-  start = p;
+  /* TLS_PSK_WITH_AES_128_CCM_8 or TLS_ECDHE_ECDSA_WITH_AES_128_CCM_8: nonce_explicit before the data */
+  res = (!security || security->e_cipher == TLS_NULL_WITH_NULL_NULL) ? 0 : 8;
+  p = sendbuf + DTLS_RH_LENGTH + res;
 
-  if (!security || security->e_cipher == TLS_NULL_WITH_NULL_NULL) {
-    /* no cipher suite */
+  for (i = 0; i < data_array_len; i++) {
+    /* check the minimum that we need for packets that are not encrypted */
+    if (*rlen < res + DTLS_RH_LENGTH + data_len_array[i]) {
+      dtls_debug("dtls_prepare_record: send buffer too small");
+      return dtls_alert_fatal_create(DTLS_ALERT_INTERNAL_ERROR);
+    }
 
-    res = 0;
-    for (i = 0; i < data_array_len; i++) {
-      /* check the minimum that we need for packets that are not encrypted */
-      if (*rlen < res + DTLS_RH_LENGTH + data_len_array[i]) {
-        dtls_debug("dtls_prepare_record: send buffer too small");
-        return dtls_alert_fatal_create(DTLS_ALERT_INTERNAL_ERROR);
-      }
+    memcpy(p, data_array[i], data_len_array[i]);
+    p += data_len_array[i];
+    res += data_len_array[i];
+  }
 
-      memcpy(p, data_array[i], data_len_array[i]);
-      p += data_len_array[i];
-      res += data_len_array[i];
-    }
+  return dtls_seal_record(ctx, security, type, sendbuf, p - (sendbuf + DTLS_RH_LENGTH), rlen);
+}
+
+/**
+ * Sets the record header of \p sendbuf and protects the fragment that
+ * follows it in place: \p plain_len bytes from sendbuf + DTLS_RH_LENGTH,
+ * the first 8 of them reserved for the nonce_explicit if a cipher is
+ * active. The MAC is appended, \p rlen is set to the size of the record.
+ * \return Less than zero on error, or zero on success.
+ */
+static int dtls_seal_record(dtls_client_context_st *ctx, dtls_security_parameters_st *security,
+                            uint8_t type, uint8_t *sendbuf, size_t plain_len, size_t *rlen)
+{
+  uint8_t *start;
+  int res;
+
+  start = dtls_set_record_header(type, security, sendbuf);
+
+  if (!security || security->e_cipher == TLS_NULL_WITH_NULL_NULL) {
+    /* no cipher suite */
+    res = plain_len;
   } else { /* TLS_PSK_WITH_AES_128_CCM_8 or TLS_ECDHE_ECDSA_WITH_AES_128_CCM_8 */
     /**
      * length of additional_data for the AEAD cipher which consists of
@@ -619,21 +678,8 @@ static int dtls_prepare_record(dtls_client_context_st *ctx, dtls_security_parame
                        } CCMNonceExample;
     */
 
-    memcpy(p, &DTLS_RECORD_HEADER(sendbuf)->u16_epoch, 8);
-    p += 8;
-    res = 8;
-
-    for (i = 0; i < data_array_len; i++) {
-      /* check the minimum that we need for packets that are not encrypted */
-      if (*rlen < res + DTLS_RH_LENGTH + data_len_array[i]) {
-        dtls_debug("dtls_prepare_record: send buffer too small");
-        return dtls_alert_fatal_create(DTLS_ALERT_INTERNAL_ERROR);
-      }
-
-      memcpy(p, data_array[i], data_len_array[i]);
-      p += data_len_array[i];
-      res += data_len_array[i];
-    }
+    memcpy(start, &DTLS_RECORD_HEADER(sendbuf)->u16_epoch, 8);
+    res = plain_len;
 
     memset(nonce, 0, DTLS_CCM_BLOCKSIZE);
     memcpy(nonce, dtls_kb_local_iv(security, DTLS_CLIENT), DTLS_IV_LENGTH);
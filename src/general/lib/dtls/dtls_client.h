@@ -53,6 +53,12 @@ int dtls_close(dtls_client_context_st *ctx);
 int dtls_renegotiate(dtls_client_context_st *ctx);
 /* writes the application data */
 int dtls_write(dtls_client_context_st *ctx, const uint8_t *buf, size_t len);
+/* application data built in place: the plaintext area of a record of up to record_len bytes at
+   record (NULL: not connected or no room), room set to what fits into it */
+uint8_t *dtls_write_begin(dtls_client_context_st *ctx, uint8_t *record, size_t record_len, size_t *room);
+/* protects len bytes written into the area from dtls_write_begin(), returns the record length
+   to send from record, less than zero on error */
+int dtls_write_seal(dtls_client_context_st *ctx, uint8_t *record, size_t len);
 /* handles incoming data as DTLS message */
 int dtls_handle_message(dtls_client_context_st *ctx, uint8_t *msg, int msglen);
 
@@ -21,13 +21,24 @@
 #include "edge_payload_cfg.h"
 #include "edge_payload.h"
 
+_Static_assert(K_PAYLOAD_MAX_MON_PARAMS <= UINT8_MAX, "monitor parameter counts in uint8_t");
+
 /*
  * Local Constants
  */
 static const uint8_t                UI8_PAYLOAD_MAX_MON_PARAM_COUNT     = (uint8_t)K_PAYLOAD_MAX_MON_PARAM_COUNT;
+static const uint8_t                UI8_PAYLOAD_MAX_MON_PARAM32_COUNT   = (uint8_t)K_PAYLOAD_MAX_MON_PARAM32_COUNT;
 static const uint8_t                UI8_PAYLOAD_MAX_MON_PHASE_COUNT     = (uint8_t)K_PAYLOAD_MAX_MON_PHASE_COUNT;
+static const uint8_t                UI8_PAYLOAD_MAX_MON_PARAMS          = (uint8_t)K_PAYLOAD_MAX_MON_PARAMS;
+static const uint8_t                UI8_PAYLOAD_MAX_MON_PARAMS32        = (uint8_t)K_PAYLOAD_MAX_MON_PARAMS32;
 static const uint8_t                UI8_PAYLOAD_MAX_STATUS_TAG_COUNT    = (uint8_t)K_PAYLOAD_MAX_STATUS_TAG_COUNT;
 static const uint8_t                UI8_PAYLOAD_MAX_EVENTS_COUNT        = (uint8_t)K_PAYLOAD_MAX_EVENTS_COUNT;
+static const uint8_t                UI8_PAYLOAD_MAX_GROUP_PARAMS        = (uint8_t)0x1F;                       // 5 bit parameter count of a phase group
+#if (1 == K_PAYLOAD_SPLIT_PHASE_GROUPS)
+static const uint8_t                UI8_PAYLOAD_MAX_PHASE_PARAMS        = (uint8_t)(K_PAYLOAD_MAX_MON_PARAM_COUNT + K_PAYLOAD_MAX_MON_PARAM32_COUNT);
+#else
+static const uint8_t                UI8_PAYLOAD_MAX_PHASE_PARAMS        = (uint8_t)0x1F;                       // one group per phase
+#endif
 
 static const ep_protocol_ver_et     E_PAYLOAD_PROTOCOL_VER              = (ep_protocol_ver_et)K_PAYLOAD_PROTOCOL_VER;
 static const ep_dev_type_et         E_PAYLOAD_DEVICE_TYPE               = (ep_dev_type_et)K_PAYLOAD_DEVICE_TYPE;
@@ -35,13 +46,17 @@ static const ep_dev_type_et         E_PAYLOAD_DEVICE_TYPE               = (ep_de
 /*
  * Local Variables
  */
-static uint8_t      aui8_dev_id[K_PAYLOAD_MAX_DEV_ID_LEN];
-static uint8_t      ui8_dev_id_len;
+/* this device's header up to the timestamp, serialized once by edgePayloadInit(); room for the
+   timestamp & a spare byte, copied whole where the buffer allows */
+static uint8_t      aui8_hdr_prefix[16] = { (uint8_t)K_PAYLOAD_PROTOCOL_VER, (uint8_t)K_PAYLOAD_DEVICE_TYPE, 0 };
+static uint8_t      ui8_hdr_prefix_len = 3;
 
 /*
  * Private Function Prototypes
  */
-/* none */
+static size_t comHeaderLen(const ep_com_header_st *ps_header);
+static void writerParam(ep_writer_st *ps_writer, uint8_t ui8_id, uint32_t ui32_value, uint8_t ui8_value_len);
+static void writerClosePhase(ep_writer_st *ps_writer);
 
 
 /*
@@ -51,30 +66,23 @@ static uint8_t      ui8_dev_id_len;
 void edgePayloadInit(void)
 {
     uint8_t aui8_temp_dev_id[K_DEV_ID_LEN];
+    uint8_t ui8_dev_id_len;
 
-	memset(aui8_dev_id, 0, sizeof(aui8_dev_id));
     get_device_id(aui8_temp_dev_id);
+    ui8_dev_id_len = (K_PAYLOAD_MAX_DEV_ID_LEN < K_DEV_ID_LEN) ? (uint8_t)K_PAYLOAD_MAX_DEV_ID_LEN : (uint8_t)K_DEV_ID_LEN;
 
-    if (sizeof(aui8_dev_id) < sizeof(aui8_temp_dev_id))
-    {
-	    memcpy(aui8_dev_id, aui8_temp_dev_id, sizeof(aui8_dev_id));
-	    ui8_dev_id_len = (uint8_t)K_PAYLOAD_MAX_DEV_ID_LEN;
-    }
-    else
-    {
-	    memcpy(aui8_dev_id, aui8_temp_dev_id, sizeof(aui8_temp_dev_id));
-	    ui8_dev_id_len = (uint8_t)K_DEV_ID_LEN;
-    }
+    aui8_hdr_prefix[0]  = (uint8_t)E_PAYLOAD_PROTOCOL_VER;
+    aui8_hdr_prefix[1]  = (uint8_t)E_PAYLOAD_DEVICE_TYPE;
+    aui8_hdr_prefix[2]  = ui8_dev_id_len;
+    memcpy(&aui8_hdr_prefix[3], aui8_temp_dev_id, (size_t)ui8_dev_id_len);
+    ui8_hdr_prefix_len  = (uint8_t)(3 + ui8_dev_id_len);
 }
 
+/* this device's header: only the timestamp is kept, the rest comes from the template */
 bool edgePayloadInitComHeader(ep_com_header_st *ps_header, int32_t si32_timestamp)
 {
-    ps_header->e_protocol_ver   = E_PAYLOAD_PROTOCOL_VER;
-    ps_header->e_dev_type       = E_PAYLOAD_DEVICE_TYPE;
     ps_header->si32_timestamp   = si32_timestamp;
-
-    ps_header->s_dev_id.ui8_len = ui8_dev_id_len;
-    memcpy(ps_header->s_dev_id.aui8_id, aui8_dev_id, (size_t)ps_header->s_dev_id.ui8_len);
+    ps_header->b_template       = true;
 
     return true;
 }
@@ -85,6 +93,11 @@ bool edgePayloadComHeader2Buf(uint8_t *pui8_buf, size_t sz_buf_len, size_t *psz_
     uint8_t *pui8_end = pui8_buf;
     bool     b_status = false;
 
+    if (true == ps_header->b_template)
+    {
+        return edgePayloadHeaderPrefix2Buf(pui8_buf, sz_buf_len, psz_res_len, ps_header->si32_timestamp);
+    }
+
     sz_req_len  = (size_t)(1 + 1 + 1 + ps_header->s_dev_id.ui8_len + 4);                // header: protocol version + device type + device id length + device id bytes + timestamp
     if (sz_buf_len >= sz_req_len)
     {
@@ -111,12 +124,76 @@ bool edgePayloadComHeader2Buf(uint8_t *pui8_buf, size_t sz_buf_len, size_t *psz_
     return b_status;
 }
 
+/* this device's header: the template from edgePayloadInit(), then the timestamp */
+bool edgePayloadHeaderPrefix2Buf(uint8_t *pui8_buf, size_t sz_buf_len, size_t *psz_res_len, int32_t si32_timestamp)
+{
+    size_t  sz_req_len = (size_t)ui8_hdr_prefix_len + 4;
+    bool    b_status = false;
+
+    if (sz_buf_len >= sz_req_len)
+    {
+        // whole if there's room: a fixed size copy is a few word moves, the bytes past the header are the caller's anyway
+        if (sz_buf_len >= sizeof(aui8_hdr_prefix))
+        {
+            memcpy(pui8_buf, aui8_hdr_prefix, sizeof(aui8_hdr_prefix));
+        }
+        else
+        {
+            memcpy(pui8_buf, aui8_hdr_prefix, (size_t)ui8_hdr_prefix_len);
+        }
+
+        /* lsb first */
+        pui8_buf[ui8_hdr_prefix_len]        = (uint8_t)((si32_timestamp)       & 0xFF);
+        pui8_buf[ui8_hdr_prefix_len + 1]    = (uint8_t)((si32_timestamp >> 8)  & 0xFF);
+        pui8_buf[ui8_hdr_prefix_len + 2]    = (uint8_t)((si32_timestamp >> 16) & 0xFF);
+        pui8_buf[ui8_hdr_prefix_len + 3]    = (uint8_t)((si32_timestamp >> 24) & 0xFF);
+
+        *psz_res_len = sz_req_len;
+        b_status = true;
+    }
+
+    return b_status;
+}
+
+/* header of a received payload, the device id copied; false if it's cut short or not of a known
+   protocol version, device type or device id length */
+bool edgePayloadBuf2ComHeader(const uint8_t *pui8_buf, size_t sz_buf_len, size_t *psz_hdr_len, ep_com_header_st *ps_header)
+{
+    size_t  sz_req_len;
+    bool    b_status = false;
+
+    if ((sz_buf_len >= 3) &&
+        (pui8_buf[0] >= EP_PROTOCOL_VER_MIN) && (pui8_buf[0] <= EP_PROTOCOL_VER_MAX) &&
+        (pui8_buf[1] >= EP_DEVICE_TYPE_MIN) && (pui8_buf[1] <= EP_DEVICE_TYPE_MAX) &&
+        (pui8_buf[2] <= K_PAYLOAD_MAX_DEV_ID_LEN))
+    {
+        sz_req_len = (size_t)(1 + 1 + 1 + pui8_buf[2] + 4);                                 // protocol version + device type + device id length + device id bytes + timestamp
+        if (sz_buf_len >= sz_req_len)
+        {
+            ps_header->b_template       = false;
+            ps_header->e_protocol_ver   = (ep_protocol_ver_et)pui8_buf[0];
+            ps_header->e_dev_type       = (ep_dev_type_et)pui8_buf[1];
+            ps_header->s_dev_id.ui8_len = pui8_buf[2];
+            memcpy(ps_header->s_dev_id.aui8_id, &pui8_buf[3], (size_t)pui8_buf[2]);
+
+            /* lsb first */
+            ps_header->si32_timestamp   = (int32_t)((uint32_t)pui8_buf[sz_req_len - 4] | ((uint32_t)pui8_buf[sz_req_len - 3] << 8) |
+                                                    ((uint32_t)pui8_buf[sz_req_len - 2] << 16) | ((uint32_t)pui8_buf[sz_req_len - 1] << 24));
+
+            *psz_hdr_len = sz_req_len;
+            b_status = true;
+        }
+    }
+
+    return b_status;
+}
+
 bool edgePayloadInitMonitor(ep_monitor_payload_st *ps_monitor, const ep_com_header_st *ps_header)
 {
-    memset(ps_monitor, 0, sizeof(ep_monitor_payload_st));
     memcpy(&ps_monitor->s_header, ps_header, sizeof(ep_com_header_st));
     ps_monitor->ui8_phase_count = 0;
-    ps_monitor->as_mon_phase[0].e_phase_index = 0;
+    ps_monitor->ui8_params      = 0;
+    ps_monitor->ui8_params32    = 0;
 
     return true;
 }
@@ -130,8 +207,13 @@ bool edgePayloadNewMonitorPhase(ep_monitor_payload_st *ps_monitor, ep_phase_inde
     {
         if (ps_monitor->ui8_phase_count < (UI8_PAYLOAD_MAX_MON_PHASE_COUNT))
         {
-            ps_monitor->ui8_phase_count++;
-            ps_monitor->as_mon_phase[ps_monitor->ui8_phase_count - 1].e_phase_index = e_phase;
+            ep_monitor_phase_st *ps_phase = &ps_monitor->as_mon_phase[ps_monitor->ui8_phase_count++];
+
+            ps_phase->ui8_phase_index   = (uint8_t)e_phase;
+            ps_phase->ui8_first         = ps_monitor->ui8_params;
+            ps_phase->ui8_param_count   = 0;
+            ps_phase->ui8_first32       = ps_monitor->ui8_params32;
+            ps_phase->ui8_param32_count = 0;
             b_status = true;
         }
     }
@@ -141,14 +223,16 @@ bool edgePayloadNewMonitorPhase(ep_monitor_payload_st *ps_monitor, ep_phase_inde
 
 bool edgePayloadAddMonitorParam(ep_monitor_payload_st *ps_monitor, ep_monitor_id_et e_mon_id, uint16_t ui16_value)
 {
-    uint8_t ui8_phase_index = ps_monitor->ui8_phase_count - 1;
-    uint8_t ui8_param_index = ps_monitor->as_mon_phase[ui8_phase_index].ui8_param_count;
+    uint8_t ui8_phase_index = ps_monitor->ui8_phase_count - 1;       // 0xFF: no phase yet
     bool b_status           = false;
 
-    if (ui8_param_index < UI8_PAYLOAD_MAX_MON_PARAM_COUNT)
+    if ((ui8_phase_index < UI8_PAYLOAD_MAX_MON_PHASE_COUNT) &&
+        (ps_monitor->as_mon_phase[ui8_phase_index].ui8_param_count < UI8_PAYLOAD_MAX_MON_PARAM_COUNT) && (ps_monitor->ui8_params < UI8_PAYLOAD_MAX_MON_PARAMS) &&
+        ((ps_monitor->as_mon_phase[ui8_phase_index].ui8_param_count + ps_monitor->as_mon_phase[ui8_phase_index].ui8_param32_count) < UI8_PAYLOAD_MAX_PHASE_PARAMS))
     {
-        ps_monitor->as_mon_phase[ui8_phase_index].as_params[ui8_param_index].e_id       = e_mon_id;
-        ps_monitor->as_mon_phase[ui8_phase_index].as_params[ui8_param_index].ui16_value = ui16_value;
+        ps_monitor->as_params[ps_monitor->ui8_params].ui8_id        = (uint8_t)e_mon_id;
+        ps_monitor->as_params[ps_monitor->ui8_params].ui16_value    = ui16_value;
+        ps_monitor->ui8_params++;
         ps_monitor->as_mon_phase[ui8_phase_index].ui8_param_count++;
         b_status = true;
     }
@@ -158,14 +242,16 @@ bool edgePayloadAddMonitorParam(ep_monitor_payload_st *ps_monitor, ep_monitor_id
 
 bool edgePayloadAddMonitorParam32(ep_monitor_payload_st *ps_monitor, ep_monitor_id_et e_mon_id, uint32_t ui32_value)
 {
-    uint8_t ui8_phase_index = ps_monitor->ui8_phase_count - 1;
-    uint8_t ui8_param_index = ps_monitor->as_mon_phase[ui8_phase_index].ui8_param32_count;
+    uint8_t ui8_phase_index = ps_monitor->ui8_phase_count - 1;       // 0xFF: no phase yet
     bool b_status           = false;
 
-    if (ui8_param_index < UI8_PAYLOAD_MAX_MON_PARAM_COUNT)
+    if ((ui8_phase_index < UI8_PAYLOAD_MAX_MON_PHASE_COUNT) &&
+        (ps_monitor->as_mon_phase[ui8_phase_index].ui8_param32_count < UI8_PAYLOAD_MAX_MON_PARAM32_COUNT) && (ps_monitor->ui8_params32 < UI8_PAYLOAD_MAX_MON_PARAMS32) &&
+        ((ps_monitor->as_mon_phase[ui8_phase_index].ui8_param_count + ps_monitor->as_mon_phase[ui8_phase_index].ui8_param32_count) < UI8_PAYLOAD_MAX_PHASE_PARAMS))
     {
-        ps_monitor->as_mon_phase[ui8_phase_index].as_params32[ui8_param_index].e_id         = e_mon_id;
-        ps_monitor->as_mon_phase[ui8_phase_index].as_params32[ui8_param_index].ui32_value   = ui32_value;
+        ps_monitor->as_params32[ps_monitor->ui8_params32].ui8_id        = (uint8_t)e_mon_id;
+        ps_monitor->as_params32[ps_monitor->ui8_params32].ui32_value    = ui32_value;
+        ps_monitor->ui8_params32++;
         ps_monitor->as_mon_phase[ui8_phase_index].ui8_param32_count++;
         b_status = true;
     }
@@ -173,23 +259,53 @@ bool edgePayloadAddMonitorParam32(ep_monitor_payload_st *ps_monitor, ep_monitor_
     return b_status;
 }
 
+/* 16-bit parameters edgePayloadAddMonitorParam() still accepts for the current phase, 0 without a
+   phase */
+uint8_t edgePayloadMonitorPhaseRoom(const ep_monitor_payload_st *ps_monitor)
+{
+    uint8_t ui8_phase_index = ps_monitor->ui8_phase_count - 1;       // 0xFF: no phase yet
+    uint8_t ui8_room        = 0;
+
+    if (ui8_phase_index < UI8_PAYLOAD_MAX_MON_PHASE_COUNT)
+    {
+        const ep_monitor_phase_st *ps_phase = &ps_monitor->as_mon_phase[ui8_phase_index];
+
+        ui8_room = UI8_PAYLOAD_MAX_MON_PARAM_COUNT - ps_phase->ui8_param_count;
+        if ((UI8_PAYLOAD_MAX_PHASE_PARAMS - (ps_phase->ui8_param_count + ps_phase->ui8_param32_count)) < ui8_room)
+        {
+            ui8_room = (uint8_t)(UI8_PAYLOAD_MAX_PHASE_PARAMS - (ps_phase->ui8_param_count + ps_phase->ui8_param32_count));
+        }
+        if ((UI8_PAYLOAD_MAX_MON_PARAMS - ps_monitor->ui8_params) < ui8_room)
+        {
+            ui8_room = (uint8_t)(UI8_PAYLOAD_MAX_MON_PARAMS - ps_monitor->ui8_params);
+        }
+    }
+
+    return ui8_room;
+}
+
+/* a phase of more than UI8_PAYLOAD_MAX_GROUP_PARAMS parameters continues in further groups of
+   the same phase index (K_PAYLOAD_SPLIT_PHASE_GROUPS, otherwise it can't have that many) */
 bool edgePayloadMonitor2Buf(uint8_t *pui8_buf, size_t sz_buf_len, size_t *psz_res_len, const ep_monitor_payload_st *ps_monitor)
 {
     uint8_t ui8_phase;
     uint8_t ui8_param;
     uint8_t ui8_param_count;
+    uint8_t ui8_group_count;
     size_t  sz_hdr_len;
     size_t  sz_req_len;
 
     uint8_t *pui8_end = pui8_buf;
     bool b_status = false;
 
-    sz_req_len  = (size_t)(1 + 1 + 1 + ps_monitor->s_header.s_dev_id.ui8_len + 4);              // header: protocol version + device type + device id length + device id bytes + timestamp
+    sz_req_len  = comHeaderLen(&ps_monitor->s_header);
 
     for (ui8_phase = 0; ui8_phase < ps_monitor->ui8_phase_count; ui8_phase++)
     {
-        // monitor payload: phase index and parameter count  + 3 bytes per parameter (id + value) + 5 bytes per 32-bit parameter (id + 32-bit value)
-        sz_req_len += (size_t)(1 + (3 * ps_monitor->as_mon_phase[ui8_phase].ui8_param_count) + (5 * ps_monitor->as_mon_phase[ui8_phase].ui8_param32_count));
+        // monitor payload: phase index and parameter count per group + 3 bytes per parameter (id + value) + 5 bytes per 32-bit parameter (id + 32-bit value)
+        ui8_param_count = ps_monitor->as_mon_phase[ui8_phase].ui8_param_count + ps_monitor->as_mon_phase[ui8_phase].ui8_param32_count;
+        ui8_group_count = (0 == ui8_param_count) ? 1 : (uint8_t)((ui8_param_count + UI8_PAYLOAD_MAX_GROUP_PARAMS - 1) / UI8_PAYLOAD_MAX_GROUP_PARAMS);
+        sz_req_len += (size_t)(ui8_group_count + (3 * ps_monitor->as_mon_phase[ui8_phase].ui8_param_count) + (5 * ps_monitor->as_mon_phase[ui8_phase].ui8_param32_count));
     }
 
     if ((sz_buf_len >= sz_req_len) &&
@@ -201,23 +317,42 @@ bool edgePayloadMonitor2Buf(uint8_t *pui8_buf, size_t sz_buf_len, size_t *psz_re
         /* monitor payload */
         for (ui8_phase = 0; ui8_phase < ps_monitor->ui8_phase_count; ui8_phase++)
         {
-            ui8_param_count = ps_monitor->as_mon_phase[ui8_phase].ui8_param_count + ps_monitor->as_mon_phase[ui8_phase].ui8_param32_count;
-            *pui8_end++ = (uint8_t)(((ps_monitor->as_mon_phase[ui8_phase].e_phase_index << 5) & 0xE0) | (ui8_param_count & 0x1F));
+            const ep_monitor_phase_st *ps_phase = &ps_monitor->as_mon_phase[ui8_phase];
 
-            for (ui8_param = 0; ui8_param < ps_monitor->as_mon_phase[ui8_phase].ui8_param_count; ui8_param++)
+            const ep_monitor_param_st   *ps_params   = &ps_monitor->as_params[ps_phase->ui8_first];
+            const ep_monitor_param32_st *ps_params32 = &ps_monitor->as_params32[ps_phase->ui8_first32];
+
+            ui8_param_count = ps_phase->ui8_param_count + ps_phase->ui8_param32_count;
+            if (0 == ui8_param_count)
             {
-                *pui8_end++ = (uint8_t)(ps_monitor->as_mon_phase[ui8_phase].as_params[ui8_param].e_id);
-                *pui8_end++ = (uint8_t)((ps_monitor->as_mon_phase[ui8_phase].as_params[ui8_param].ui16_value)       & 0xFF);
-                *pui8_end++ = (uint8_t)((ps_monitor->as_mon_phase[ui8_phase].as_params[ui8_param].ui16_value >> 8)  & 0xFF);
+                *pui8_end++ = (uint8_t)((ps_phase->ui8_phase_index << 5) & 0xE0);
             }
 
-            for (ui8_param = 0; ui8_param < ps_monitor->as_mon_phase[ui8_phase].ui8_param32_count; ui8_param++)
+            for (ui8_param = 0; ui8_param < ui8_param_count; ui8_param++)
             {
-                *pui8_end++ = (uint8_t)(ps_monitor->as_mon_phase[ui8_phase].as_params32[ui8_param].e_id);
-                *pui8_end++ = (uint8_t)((ps_monitor->as_mon_phase[ui8_phase].as_params32[ui8_param].ui32_value)         & 0xFF);
-                *pui8_end++ = (uint8_t)((ps_monitor->as_mon_phase[ui8_phase].as_params32[ui8_param].ui32_value >> 8)    & 0xFF);
-                *pui8_end++ = (uint8_t)((ps_monitor->as_mon_phase[ui8_phase].as_params32[ui8_param].ui32_value >> 16)   & 0xFF);
-                *pui8_end++ = (uint8_t)((ps_monitor->as_mon_phase[ui8_phase].as_params32[ui8_param].ui32_value >> 24)   & 0xFF);
+                if (0 == (ui8_param % UI8_PAYLOAD_MAX_GROUP_PARAMS))
+                {
+                    ui8_group_count = ui8_param_count - ui8_param;
+                    ui8_group_count = (ui8_group_count > UI8_PAYLOAD_MAX_GROUP_PARAMS) ? UI8_PAYLOAD_MAX_GROUP_PARAMS : ui8_group_count;
+                    *pui8_end++ = (uint8_t)(((ps_phase->ui8_phase_index << 5) & 0xE0) | (ui8_group_count & 0x1F));
+                }
+
+                if (ui8_param < ps_phase->ui8_param_count)
+                {
+                    *pui8_end++ = ps_params[ui8_param].ui8_id;
+                    *pui8_end++ = (uint8_t)((ps_params[ui8_param].ui16_value)       & 0xFF);
+                    *pui8_end++ = (uint8_t)((ps_params[ui8_param].ui16_value >> 8)  & 0xFF);
+                }
+                else
+                {
+                    const ep_monitor_param32_st *ps_param32 = &ps_params32[ui8_param - ps_phase->ui8_param_count];
+
+                    *pui8_end++ = ps_param32->ui8_id;
+                    *pui8_end++ = (uint8_t)((ps_param32->ui32_value)         & 0xFF);
+                    *pui8_end++ = (uint8_t)((ps_param32->ui32_value >> 8)    & 0xFF);
+                    *pui8_end++ = (uint8_t)((ps_param32->ui32_value >> 16)   & 0xFF);
+                    *pui8_end++ = (uint8_t)((ps_param32->ui32_value >> 24)   & 0xFF);
+                }
             }
         }
 
@@ -231,6 +366,346 @@ bool edgePayloadMonitor2Buf(uint8_t *pui8_buf, size_t sz_buf_len, size_t *psz_re
     return b_status;
 }
 
+/* id + value bytes of a monitor parameter in the payload, the 32-bit ones by their id */
+uint8_t edgePayloadMonitorParamLen(uint8_t ui8_mon_id)
+{
+    return ((ui8_mon_id >= EP_MON_ID_GDL_EXPORT_KWH_32) && (ui8_mon_id <= EP_MON_ID_GDL_KVAH_32)) ? 5 : 3;
+}
+
+/* a received monitor payload checked against what edgePayloadMonitor2Buf() produces: every
+   parameter within the buffer, the 16-bit ones of a phase before its 32-bit ones, the limits of
+   ep_monitor_payload_st; a group following a full one of the same phase index continues that
+   phase (K_PAYLOAD_SPLIT_PHASE_GROUPS). Nothing is copied but the header */
+bool edgePayloadBuf2Monitor(const uint8_t *pui8_buf, size_t sz_buf_len, ep_monitor_view_st *ps_view)
+{
+    const uint8_t              *pui8_end = pui8_buf + sz_buf_len;
+    const uint8_t              *pui8_pos;
+    ep_monitor_phase_view_st   *ps_phase = NULL;
+    size_t                      sz_hdr_len;
+    uint16_t                    ui16_params = 0;
+    uint16_t                    ui16_params32 = 0;
+    uint8_t                     ui8_group_count = 0;                                        // parameters in the previous group
+
+    ps_view->ui8_phase_count = 0;
+    if (false == edgePayloadBuf2ComHeader(pui8_buf, sz_buf_len, &sz_hdr_len, &ps_view->s_header))
+    {
+        return false;
+    }
+
+    for (pui8_pos = pui8_buf + sz_hdr_len; pui8_pos < pui8_end; )
+    {
+        uint8_t ui8_phase = (uint8_t)(*pui8_pos >> 5);
+        uint8_t ui8_count = (uint8_t)(*pui8_pos & 0x1F);
+
+        if (ui8_phase > EP_PHASE_INDEX_MAX)
+        {
+            return false;
+        }
+
+        // an empty group is an empty phase
+        if ((NULL == ps_phase) || (UI8_PAYLOAD_MAX_PHASE_PARAMS <= UI8_PAYLOAD_MAX_GROUP_PARAMS) || (UI8_PAYLOAD_MAX_GROUP_PARAMS != ui8_group_count) ||
+            (ui8_phase != ps_phase->ui8_phase_index) || (0 == ui8_count))
+        {
+            if (ps_view->ui8_phase_count >= UI8_PAYLOAD_MAX_MON_PHASE_COUNT)
+            {
+                return false;
+            }
+            ps_phase = &ps_view->as_phases[ps_view->ui8_phase_count++];
+            ps_phase->ui8_phase_index   = ui8_phase;
+            ps_phase->ui8_param_count   = 0;
+            ps_phase->ui8_param32_count = 0;
+            ps_phase->pui8_group        = pui8_pos;
+        }
+        pui8_pos++;
+
+        for (uint8_t ui8_i = 0; ui8_i < ui8_count; ui8_i++)
+        {
+            uint8_t ui8_len;
+
+            if (pui8_pos >= pui8_end)
+            {
+                return false;
+            }
+
+            ui8_len = edgePayloadMonitorParamLen(*pui8_pos);
+            if ((pui8_end - pui8_pos) < ui8_len)
+            {
+                return false;
+            }
+
+            if (5 == ui8_len)
+            {
+                ps_phase->ui8_param32_count++;
+                ui16_params32++;
+            }
+            else if (0 == ps_phase->ui8_param32_count)
+            {
+                ps_phase->ui8_param_count++;
+                ui16_params++;
+            }
+            else
+            {
+                return false;
+            }
+            pui8_pos += ui8_len;
+        }
+
+        if ((ps_phase->ui8_param_count > UI8_PAYLOAD_MAX_MON_PARAM_COUNT) || (ps_phase->ui8_param32_count > UI8_PAYLOAD_MAX_MON_PARAM32_COUNT) ||
+            (ui16_params > UI8_PAYLOAD_MAX_MON_PARAMS) || (ui16_params32 > UI8_PAYLOAD_MAX_MON_PARAMS32))
+        {
+            return false;
+        }
+        ps_phase->ui16_len  = (uint16_t)(pui8_pos - ps_phase->pui8_group);
+        ui8_group_count     = ui8_count;
+    }
+
+    return true;
+}
+
+void edgePayloadMonitorViewCursor(const ep_monitor_phase_view_st *ps_phase, ep_monitor_cursor_st *ps_cursor)
+{
+    ps_cursor->pui8_next        = ps_phase->pui8_group;
+    ps_cursor->ui8_param        = 0;
+    ps_cursor->ui8_param_count  = ps_phase->ui8_param_count + ps_phase->ui8_param32_count;
+}
+
+/* next parameter of a phase of a checked payload in the payload's order, false past the last */
+bool edgePayloadMonitorViewNext(ep_monitor_cursor_st *ps_cursor, uint8_t *pui8_mon_id, uint32_t *pui32_value)
+{
+    const uint8_t *pui8_next = ps_cursor->pui8_next;
+
+    if (ps_cursor->ui8_param >= ps_cursor->ui8_param_count)
+    {
+        return false;
+    }
+
+    if (0 == (ps_cursor->ui8_param % UI8_PAYLOAD_MAX_GROUP_PARAMS))
+    {
+        pui8_next++;                                                                        // phase index & parameter count
+    }
+
+    /* lsb first */
+    if (5 == edgePayloadMonitorParamLen(pui8_next[0]))
+    {
+        *pui32_value = (uint32_t)pui8_next[1] | ((uint32_t)pui8_next[2] << 8) | ((uint32_t)pui8_next[3] << 16) | ((uint32_t)pui8_next[4] << 24);
+    }
+    else
+    {
+        *pui32_value = (uint32_t)pui8_next[1] | ((uint32_t)pui8_next[2] << 8);
+    }
+    *pui8_mon_id = pui8_next[0];
+
+    ps_cursor->pui8_next = pui8_next + edgePayloadMonitorParamLen(pui8_next[0]);
+    ps_cursor->ui8_param++;
+
+    return true;
+}
+
+void edgePayloadWriterInit(ep_writer_st *ps_writer, uint8_t *pui8_buf, size_t sz_buf_len)
+{
+    memset(ps_writer, 0, sizeof(ep_writer_st));
+    ps_writer->pui8_buf     = pui8_buf;
+    ps_writer->pui8_end     = pui8_buf;
+    ps_writer->pui8_limit   = pui8_buf + sz_buf_len;
+}
+
+bool edgePayloadWriteComHeader(ep_writer_st *ps_writer, const ep_com_header_st *ps_header)
+{
+    size_t sz_hdr_len = 0;
+
+    if ((ps_writer->pui8_end != ps_writer->pui8_buf) ||
+        (false == edgePayloadComHeader2Buf(ps_writer->pui8_end, (size_t)(ps_writer->pui8_limit - ps_writer->pui8_end), &sz_hdr_len, ps_header)))
+    {
+        ps_writer->b_overflow = true;
+    }
+    ps_writer->pui8_end += sz_hdr_len;
+
+    return (false == ps_writer->b_overflow);
+}
+
+bool edgePayloadWriteMonitorPhase(ep_writer_st *ps_writer, ep_phase_index_et e_phase)
+{
+    writerClosePhase(ps_writer);
+
+    if ((e_phase > EP_PHASE_INDEX_MAX) || (ps_writer->ui8_phase_count >= UI8_PAYLOAD_MAX_MON_PHASE_COUNT) ||
+        (ps_writer->pui8_end >= ps_writer->pui8_limit))
+    {
+        ps_writer->b_overflow = true;
+    }
+    else
+    {
+        ps_writer->ui8_phase_count++;
+        ps_writer->e_phase_index     = e_phase;
+        ps_writer->ui8_param_count   = 0;
+        ps_writer->ui8_param32_count = 0;
+        ps_writer->pui8_group        = ps_writer->pui8_end;
+        *ps_writer->pui8_end++       = (uint8_t)((e_phase << 5) & 0xE0);
+    }
+
+    return (false == ps_writer->b_overflow);
+}
+
+bool edgePayloadWriteMonitorParam(ep_writer_st *ps_writer, ep_monitor_id_et e_mon_id, uint16_t ui16_value)
+{
+    if ((NULL == ps_writer->pui8_group) || (ps_writer->ui8_param_count >= UI8_PAYLOAD_MAX_MON_PARAM_COUNT) ||
+        ((ps_writer->ui8_param_count + ps_writer->ui8_param32_count) >= UI8_PAYLOAD_MAX_PHASE_PARAMS))
+    {
+        ps_writer->b_overflow = true;
+    }
+    else
+    {
+        ps_writer->ui8_param_count++;
+        writerParam(ps_writer, (uint8_t)e_mon_id, ui16_value, 2);
+    }
+
+    return (false == ps_writer->b_overflow);
+}
+
+/* kept until the phase ends: the 32-bit parameters follow the 16-bit ones */
+bool edgePayloadWriteMonitorParam32(ep_writer_st *ps_writer, ep_monitor_id_et e_mon_id, uint32_t ui32_value)
+{
+    if ((NULL == ps_writer->pui8_group) || (ps_writer->ui8_param32_count >= UI8_PAYLOAD_MAX_MON_PARAM32_COUNT) ||
+        ((ps_writer->ui8_param_count + ps_writer->ui8_param32_count) >= UI8_PAYLOAD_MAX_PHASE_PARAMS))
+    {
+        ps_writer->b_overflow = true;
+    }
+    else
+    {
+        ps_writer->as_params32[ps_writer->ui8_param32_count].ui8_id     = (uint8_t)e_mon_id;
+        ps_writer->as_params32[ps_writer->ui8_param32_count].ui32_value = ui32_value;
+        ps_writer->ui8_param32_count++;
+    }
+
+    return (false == ps_writer->b_overflow);
+}
+
+/* 16-bit parameters edgePayloadWriteMonitorParam() still takes for the open phase, as
+   edgePayloadMonitorPhaseRoom(); 0 without a phase */
+uint8_t edgePayloadWriterPhaseRoom(const ep_writer_st *ps_writer)
+{
+    uint8_t ui8_room = 0;
+
+    if ((NULL != ps_writer->pui8_group) && (false == ps_writer->b_overflow))
+    {
+        ui8_room = UI8_PAYLOAD_MAX_MON_PARAM_COUNT - ps_writer->ui8_param_count;
+        if ((UI8_PAYLOAD_MAX_PHASE_PARAMS - (ps_writer->ui8_param_count + ps_writer->ui8_param32_count)) < ui8_room)
+        {
+            ui8_room = (uint8_t)(UI8_PAYLOAD_MAX_PHASE_PARAMS - (ps_writer->ui8_param_count + ps_writer->ui8_param32_count));
+        }
+    }
+
+    return ui8_room;
+}
+
+bool edgePayloadWriterEnd(ep_writer_st *ps_writer, size_t *psz_res_len)
+{
+    writerClosePhase(ps_writer);
+
+    if (false == ps_writer->b_overflow)
+    {
+        *psz_res_len = (size_t)(ps_writer->pui8_end - ps_writer->pui8_buf);
+    }
+
+    return (false == ps_writer->b_overflow);
+}
+
+void edgePayloadBatchInit(ep_monitor_batch_st *ps_batch, uint8_t *pui8_buf, size_t sz_buf_len)
+{
+    memset(ps_batch, 0, sizeof(ep_monitor_batch_st));
+    ps_batch->pui8_buf      = pui8_buf;
+    ps_batch->pui8_end      = pui8_buf;
+    ps_batch->pui8_limit    = pui8_buf + sz_buf_len;
+}
+
+/* a serialized monitor payload (edgePayloadMonitor2Buf()) as the next interval; false, and the
+   batch unchanged, if it doesn't fit, is of another device or not within 0..65535 s of the first */
+bool edgePayloadBatchAddMonitor(ep_monitor_batch_st *ps_batch, const uint8_t *pui8_payload, size_t sz_payload_len)
+{
+    size_t      sz_hdr_len;
+    size_t      sz_body_len;
+    size_t      sz_req_len;
+    int32_t     si32_ts;
+    int64_t     si64_delta;
+
+    if ((sz_payload_len < 3) || (pui8_payload[2] > K_PAYLOAD_MAX_DEV_ID_LEN))
+    {
+        return false;
+    }
+
+    sz_hdr_len  = (size_t)(1 + 1 + 1 + pui8_payload[2]);                                       // protocol version + device type + device id length + device id bytes
+    if (sz_payload_len < (sz_hdr_len + 4))
+    {
+        return false;
+    }
+
+    si32_ts     = (int32_t)((uint32_t)pui8_payload[sz_hdr_len] | ((uint32_t)pui8_payload[sz_hdr_len + 1] << 8) |
+                            ((uint32_t)pui8_payload[sz_hdr_len + 2] << 16) | ((uint32_t)pui8_payload[sz_hdr_len + 3] << 24));
+    sz_body_len = sz_payload_len - sz_hdr_len - 4;
+    sz_req_len  = 2 + 2 + sz_body_len;                                                          // seconds after the first + length + phase groups
+
+    si64_delta  = (0 == ps_batch->ui8_hdr_len) ? 0 : ((int64_t)si32_ts - ps_batch->si32_first_ts);
+
+    if ((si64_delta < 0) || (si64_delta > UINT16_MAX) || (sz_body_len > UINT16_MAX))
+    {
+        return false;
+    }
+    else if (0 == ps_batch->ui8_hdr_len)
+    {
+        // common header & count
+        if ((size_t)(ps_batch->pui8_limit - ps_batch->pui8_end) < (sz_hdr_len + 4 + 1 + sz_req_len))
+        {
+            return false;
+        }
+        memcpy(ps_batch->pui8_end, pui8_payload, sz_hdr_len + 4);
+        ps_batch->pui8_end     += sz_hdr_len + 4;
+        *ps_batch->pui8_end++   = 0;
+        ps_batch->ui8_hdr_len   = (uint8_t)sz_hdr_len;
+        ps_batch->si32_first_ts = si32_ts;
+    }
+    else if ((sz_hdr_len != ps_batch->ui8_hdr_len) || (0 != memcmp(ps_batch->pui8_buf, pui8_payload, sz_hdr_len)) ||
+             (UINT8_MAX == ps_batch->ui8_count) || ((size_t)(ps_batch->pui8_limit - ps_batch->pui8_end) < sz_req_len))
+    {
+        return false;
+    }
+
+    *ps_batch->pui8_end++ = (uint8_t)(si64_delta & 0xFF);
+    *ps_batch->pui8_end++ = (uint8_t)((si64_delta >> 8) & 0xFF);
+    *ps_batch->pui8_end++ = (uint8_t)(sz_body_len & 0xFF);
+    *ps_batch->pui8_end++ = (uint8_t)((sz_body_len >> 8) & 0xFF);
+    memcpy(ps_batch->pui8_end, &pui8_payload[sz_hdr_len + 4], sz_body_len);
+    ps_batch->pui8_end += sz_body_len;
+
+    ps_batch->ui8_count++;
+    ps_batch->pui8_buf[ps_batch->ui8_hdr_len + 4] = ps_batch->ui8_count;
+
+    return true;
+}
+
+/* bytes of the batch so far, 0 without an interval */
+size_t edgePayloadBatchLen(const ep_monitor_batch_st *ps_batch)
+{
+    return (size_t)(ps_batch->pui8_end - ps_batch->pui8_buf);
+}
+
+/* a batch of one interval back to its monitor payload, in place, not to be added to afterwards;
+   its length, 0 (the batch unchanged) for any other count */
+size_t edgePayloadBatch2Monitor(ep_monitor_batch_st *ps_batch)
+{
+    size_t sz_ts_end = (size_t)ps_batch->ui8_hdr_len + 4;
+
+    if (1 != ps_batch->ui8_count)
+    {
+        return 0;
+    }
+
+    // drop the count, the delta & the length in front of the phase groups
+    memmove(&ps_batch->pui8_buf[sz_ts_end], &ps_batch->pui8_buf[sz_ts_end + 1 + 2 + 2],
+            edgePayloadBatchLen(ps_batch) - (sz_ts_end + 1 + 2 + 2));
+    ps_batch->pui8_end -= 1 + 2 + 2;
+
+    return edgePayloadBatchLen(ps_batch);
+}
+
 bool edgePayloadInitStatus(ep_status_payload_st *ps_status, const ep_com_header_st *ps_header)
 {
     memset(ps_status, 0, sizeof(ep_status_payload_st));
@@ -268,7 +743,7 @@ bool edgePayloadStatus2Buf(uint8_t *pui8_buf, size_t sz_buf_len, size_t *psz_res
     uint8_t *pui8_end = pui8_buf;
     bool b_status = false;
 
-    sz_req_len  = (size_t)(1 + 1 + 1 + ps_status->s_header.s_dev_id.ui8_len + 4);       // header: protocol version + device type + device id length + device id bytes + timestamp
+    sz_req_len  = comHeaderLen(&ps_status->s_header);
     sz_req_len += (size_t)(1);                                                          // status payload: tag count + length of each tag
     for (ui8_i = 0; ui8_i < ps_status->ui8_tag_count; ui8_i++)
     {
@@ -301,6 +776,43 @@ bool edgePayloadStatus2Buf(uint8_t *pui8_buf, size_t sz_buf_len, size_t *psz_res
     return b_status;
 }
 
+/* a received status payload, the tag values pointing into the buffer; false if a tag is unknown
+   or cut short, there are too many or bytes left over */
+bool edgePayloadBuf2Status(const uint8_t *pui8_buf, size_t sz_buf_len, ep_status_payload_st *ps_status)
+{
+    uint8_t ui8_i;
+    uint8_t ui8_tag_count;
+    size_t  sz_off = 0;
+    bool    b_status = false;
+
+    memset(ps_status, 0, sizeof(ep_status_payload_st));
+    if ((true == edgePayloadBuf2ComHeader(pui8_buf, sz_buf_len, &sz_off, &ps_status->s_header)) &&
+        (sz_off < sz_buf_len) && (pui8_buf[sz_off] <= UI8_PAYLOAD_MAX_STATUS_TAG_COUNT))
+    {
+        ui8_tag_count = pui8_buf[sz_off++];
+        b_status      = true;
+        for (ui8_i = 0; (ui8_i < ui8_tag_count) && (true == b_status); ui8_i++)
+        {
+            if (((sz_buf_len - sz_off) < 2) || (pui8_buf[sz_off] < EP_STATUS_TAG_MIN) || (pui8_buf[sz_off] > EP_STATUS_TAG_MAX) ||
+                ((sz_buf_len - sz_off - 2) < pui8_buf[sz_off + 1]))
+            {
+                b_status = false;
+            }
+            else
+            {
+                ps_status->as_tags[ui8_i].e_id          = (ep_tag_id_et)pui8_buf[sz_off];
+                ps_status->as_tags[ui8_i].ui8_len       = pui8_buf[sz_off + 1];
+                ps_status->as_tags[ui8_i].pui8_value    = &pui8_buf[sz_off + 2];
+                ps_status->ui8_tag_count++;
+                sz_off += (size_t)(2 + pui8_buf[sz_off + 1]);
+            }
+        }
+        b_status = b_status && (sz_off == sz_buf_len);
+    }
+
+    return b_status;
+}
+
 bool edgePayloadInitEvent(ep_event_payload_st *ps_event, const ep_com_header_st *ps_header)
 {
     memset(ps_event, 0, sizeof(ep_event_payload_st));
@@ -335,7 +847,7 @@ bool edgePayloadEvent2Buf(uint8_t *pui8_buf, size_t sz_buf_len, size_t *psz_res_
     uint8_t *pui8_end = pui8_buf;
     bool b_status = false;
 
-    sz_req_len  = (size_t)(1 + 1 + 1 + ps_event->s_header.s_dev_id.ui8_len + 4);        // header: protocol version + device type + device id length + device id bytes + timestamp
+    sz_req_len  = comHeaderLen(&ps_event->s_header);
     sz_req_len += (size_t)(1);                                                          // event payload: event count + length of each event content
     for (ui8_i = 0; ui8_i < ps_event->ui8_event_count; ui8_i++)
     {
@@ -368,10 +880,46 @@ bool edgePayloadEvent2Buf(uint8_t *pui8_buf, size_t sz_buf_len, size_t *psz_res_
     return b_status;
 }
 
+/* a received event payload, the contents pointing into the buffer; false if an event is cut
+   short, there are too many or bytes left over */
+bool edgePayloadBuf2Event(const uint8_t *pui8_buf, size_t sz_buf_len, ep_event_payload_st *ps_event)
+{
+    uint8_t ui8_i;
+    uint8_t ui8_event_count;
+    size_t  sz_off = 0;
+    bool    b_status = false;
+
+    memset(ps_event, 0, sizeof(ep_event_payload_st));
+    if ((true == edgePayloadBuf2ComHeader(pui8_buf, sz_buf_len, &sz_off, &ps_event->s_header)) &&
+        (sz_off < sz_buf_len) && (pui8_buf[sz_off] <= UI8_PAYLOAD_MAX_EVENTS_COUNT))
+    {
+        ui8_event_count = pui8_buf[sz_off++];
+        b_status        = true;
+        for (ui8_i = 0; (ui8_i < ui8_event_count) && (true == b_status); ui8_i++)
+        {
+            if (((sz_buf_len - sz_off) < 2) || ((sz_buf_len - sz_off - 2) < pui8_buf[sz_off + 1]))
+            {
+                b_status = false;
+            }
+            else
+            {
+                ps_event->as_events[ui8_i].e_type       = (ep_event_type_et)pui8_buf[sz_off];
+                ps_event->as_events[ui8_i].ui8_len      = pui8_buf[sz_off + 1];
+                ps_event->as_events[ui8_i].pui8_content = &pui8_buf[sz_off + 2];
+                ps_event->ui8_event_count++;
+                sz_off += (size_t)(2 + pui8_buf[sz_off + 1]);
+            }
+        }
+        b_status = b_status && (sz_off == sz_buf_len);
+    }
+
+    return b_status;
+}
+
 bool edgePayloadInitUpdateGet(ep_update_get_payload_st *ps_update_get, const ep_com_header_st *ps_header)
 {
     memset(ps_update_get, 0, sizeof(ep_update_get_payload_st));
-    memcpy(&ps_update_get->s_header, ps_header, sizeof(ep_update_get_payload_st));
+    memcpy(&ps_update_get->s_header, ps_header, sizeof(ep_com_header_st));
 
     return true;
 }
@@ -392,7 +940,7 @@ bool edgePayloadUpdateGet2Buf(uint8_t *pui8_buf, size_t sz_buf_len, size_t *psz_
     uint8_t *pui8_end = pui8_buf;
     bool b_status = false;
 
-    sz_req_len  = (size_t)(1 + 1 + 1 + ps_update_get->s_header.s_dev_id.ui8_len + 4);   // header: protocol version + device type + device id length + device id bytes + timestamp
+    sz_req_len  = comHeaderLen(&ps_update_get->s_header);
     sz_req_len += (size_t)(4 + 2);                                                      // 4 bytes chunk offset + 2 bytes chunk length
 
     if ((sz_buf_len >= sz_req_len) &&
@@ -420,10 +968,118 @@ bool edgePayloadUpdateGet2Buf(uint8_t *pui8_buf, size_t sz_buf_len, size_t *psz_
 }
 
 
+bool edgePayloadBuf2UpdateGet(const uint8_t *pui8_buf, size_t sz_buf_len, ep_update_get_payload_st *ps_update_get)
+{
+    size_t  sz_off = 0;
+    bool    b_status = false;
+
+    memset(ps_update_get, 0, sizeof(ep_update_get_payload_st));
+    if ((true == edgePayloadBuf2ComHeader(pui8_buf, sz_buf_len, &sz_off, &ps_update_get->s_header)) &&
+        ((sz_off + 4 + 2) == sz_buf_len))                                                   // 4 bytes chunk offset + 2 bytes chunk length
+    {
+        /* lsb first */
+        ps_update_get->ui32_chunk_offset = (uint32_t)pui8_buf[sz_off] | ((uint32_t)pui8_buf[sz_off + 1] << 8) |
+                                           ((uint32_t)pui8_buf[sz_off + 2] << 16) | ((uint32_t)pui8_buf[sz_off + 3] << 24);
+        ps_update_get->ui16_chunk_length = (uint16_t)(pui8_buf[sz_off + 4] | (pui8_buf[sz_off + 5] << 8));
+        b_status = true;
+    }
+
+    return b_status;
+}
+
+/* a payload relayed for another device decoded the way the server would: false if it would
+   reject it */
+bool edgePayloadCheck(ep_payload_kind_et e_kind, const uint8_t *pui8_buf, size_t sz_buf_len)
+{
+    union {
+        ep_com_header_st            s_header;
+        ep_monitor_view_st          s_monitor;
+        ep_status_payload_st        s_status;
+        ep_event_payload_st         s_event;
+        ep_update_get_payload_st    s_update_get;
+    } u_payload;
+    size_t  sz_hdr_len = 0;
+    bool    b_status = false;
+
+    switch (e_kind)
+    {
+        case EP_PAYLOAD_MONITOR:
+            b_status = edgePayloadBuf2Monitor(pui8_buf, sz_buf_len, &u_payload.s_monitor);
+            break;
+
+        case EP_PAYLOAD_STATUS:
+            b_status = edgePayloadBuf2Status(pui8_buf, sz_buf_len, &u_payload.s_status);
+            break;
+
+        case EP_PAYLOAD_STATUS_GET:
+            b_status = (true == edgePayloadBuf2ComHeader(pui8_buf, sz_buf_len, &sz_hdr_len, &u_payload.s_header)) &&
+                       (sz_hdr_len == sz_buf_len);
+            break;
+
+        case EP_PAYLOAD_EVENT:
+            b_status = edgePayloadBuf2Event(pui8_buf, sz_buf_len, &u_payload.s_event);
+            break;
+
+        case EP_PAYLOAD_UPDATE_GET:
+            b_status = edgePayloadBuf2UpdateGet(pui8_buf, sz_buf_len, &u_payload.s_update_get);
+            break;
+
+        default:
+            break;
+    }
+
+    return b_status;
+}
+
+
 /*
  * Private Functions
  */
-/* none */
+/* header: protocol version + device type + device id length + device id bytes + timestamp */
+static size_t comHeaderLen(const ep_com_header_st *ps_header)
+{
+    return (true == ps_header->b_template) ? ((size_t)ui8_hdr_prefix_len + 4) : (size_t)(1 + 1 + 1 + ps_header->s_dev_id.ui8_len + 4);
+}
+
+/* id & value lsb first into the open group, a full group continues in a new one of the same phase */
+static void writerParam(ep_writer_st *ps_writer, uint8_t ui8_id, uint32_t ui32_value, uint8_t ui8_value_len)
+{
+    bool b_new_group = ((*ps_writer->pui8_group & 0x1F) == UI8_PAYLOAD_MAX_GROUP_PARAMS);
+
+    if ((ps_writer->pui8_limit - ps_writer->pui8_end) < (1 + ui8_value_len + (b_new_group ? 1 : 0)))
+    {
+        ps_writer->b_overflow = true;
+        return;
+    }
+
+    if (true == b_new_group)
+    {
+        ps_writer->pui8_group   = ps_writer->pui8_end;
+        *ps_writer->pui8_end++  = (uint8_t)((ps_writer->e_phase_index << 5) & 0xE0);
+    }
+    (*ps_writer->pui8_group)++;
+
+    *ps_writer->pui8_end++ = ui8_id;
+    for (uint8_t ui8_i = 0; ui8_i < ui8_value_len; ui8_i++)
+    {
+        *ps_writer->pui8_end++ = (uint8_t)((ui32_value >> (8 * ui8_i)) & 0xFF);
+    }
+}
+
+static void writerClosePhase(ep_writer_st *ps_writer)
+{
+    if (NULL == ps_writer->pui8_group)
+    {
+        return;
+    }
+
+    for (uint8_t ui8_i = 0; ui8_i < ps_writer->ui8_param32_count; ui8_i++)
+    {
+        writerParam(ps_writer, ps_writer->as_params32[ui8_i].ui8_id, ps_writer->as_params32[ui8_i].ui32_value, 4);
+    }
+    ps_writer->ui8_param32_count = 0;
+    ps_writer->pui8_group        = NULL;
+}
 
 /* end of edge_payload.c */
 //--------------------------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -12,6 +12,19 @@ extern "C" {
 #endif
 
 
+/*
+ * Global Enums
+ */
+typedef enum
+{
+    EP_PAYLOAD_MONITOR                  = 0
+    , EP_PAYLOAD_STATUS                             /* status put: the tags */
+    , EP_PAYLOAD_STATUS_GET                         /* the common header only */
+    , EP_PAYLOAD_EVENT
+    , EP_PAYLOAD_UPDATE_GET
+} ep_payload_kind_et;
+
+
 /*
  * Global Structs
  */
@@ -27,27 +40,28 @@ typedef struct
     ep_dev_type_et          e_dev_type;
     ep_dev_id_st            s_dev_id;
     int32_t                 si32_timestamp;
+    bool                    b_template;                 // this device's header from edgePayloadInitComHeader(): written from the template, the fields above but the timestamp not set
 } ep_com_header_st;
 
-typedef struct
+typedef struct __attribute__((__packed__))
 {
-    ep_monitor_id_et        e_id;
+    uint8_t                 ui8_id;                     // ep_monitor_id_et
     uint16_t                ui16_value;
 } ep_monitor_param_st;
 
-typedef struct
+typedef struct __attribute__((__packed__))
 {
-    ep_monitor_id_et        e_id;
+    uint8_t                 ui8_id;                     // ep_monitor_id_et
     uint32_t                ui32_value;
 } ep_monitor_param32_st;
 
 typedef struct
 {
-    ep_phase_index_et       e_phase_index;
+    uint8_t                 ui8_phase_index;            // ep_phase_index_et
+    uint8_t                 ui8_first;                  // of the phase's parameters in as_params
     uint8_t                 ui8_param_count;
+    uint8_t                 ui8_first32;                // in as_params32
     uint8_t                 ui8_param32_count;
-    ep_monitor_param_st     as_params[K_PAYLOAD_MAX_MON_PARAM_COUNT];
-    ep_monitor_param32_st   as_params32[K_PAYLOAD_MAX_MON_PARAM32_COUNT];
 } ep_monitor_phase_st;
 
 typedef struct
@@ -64,11 +78,17 @@ typedef struct
     const uint8_t           *pui8_content;
 } ep_event_content_st;
 
+/* parameters of all phases in one flat array each, a phase's in a row: parameters can only be
+   added to the last phase */
 typedef struct
 {
     ep_com_header_st        s_header;
     uint8_t                 ui8_phase_count;
+    uint8_t                 ui8_params;                 // used of as_params
+    uint8_t                 ui8_params32;               // used of as_params32
     ep_monitor_phase_st     as_mon_phase[K_PAYLOAD_MAX_MON_PHASE_COUNT];
+    ep_monitor_param_st     as_params[K_PAYLOAD_MAX_MON_PARAMS];
+    ep_monitor_param32_st   as_params32[K_PAYLOAD_MAX_MON_PARAMS32];
 } ep_monitor_payload_st;
 
 typedef struct
@@ -92,6 +112,60 @@ typedef struct
     uint16_t                ui16_chunk_length;
 } ep_update_get_payload_st;
 
+/* monitor payload encoded as it's built, straight into the caller's buffer (e.g. the plaintext
+   area of a DTLS record); same bytes as edgePayloadMonitor2Buf() */
+typedef struct
+{
+    uint8_t                *pui8_buf;
+    uint8_t                *pui8_end;                   // next byte
+    uint8_t                *pui8_limit;
+    bool                    b_overflow;                 // sticky: something didn't fit, the payload is invalid
+    uint8_t                 ui8_phase_count;
+    ep_phase_index_et       e_phase_index;
+    uint8_t                *pui8_group;                 // phase index & parameter count byte of the open group
+    uint8_t                 ui8_param_count;
+    uint8_t                 ui8_param32_count;
+    ep_monitor_param32_st   as_params32[K_PAYLOAD_MAX_MON_PARAM32_COUNT];   // of the phase, written after its 16-bit ones
+} ep_writer_st;
+
+/* monitor payloads of several intervals of one device in one message: the common header with
+   the first interval's timestamp, the interval count, then per interval its seconds after the
+   first (16 bit), the length of its phase groups (16 bit) and the phase groups, all lsb first */
+typedef struct
+{
+    uint8_t                *pui8_buf;
+    uint8_t                *pui8_end;                   // next byte
+    uint8_t                *pui8_limit;
+    uint8_t                 ui8_hdr_len;                // common header, without the timestamp; 0: no interval yet
+    int32_t                 si32_first_ts;
+    uint8_t                 ui8_count;
+} ep_monitor_batch_st;
+
+/* a received monitor payload checked by edgePayloadBuf2Monitor(): its phases as spans into the
+   buffer, valid as long as it is; the parameters read with edgePayloadMonitorViewNext() */
+typedef struct
+{
+    uint8_t                 ui8_phase_index;            // ep_phase_index_et
+    uint8_t                 ui8_param_count;
+    uint8_t                 ui8_param32_count;
+    const uint8_t          *pui8_group;                 // first phase group byte
+    uint16_t                ui16_len;                   // of the phase's groups
+} ep_monitor_phase_view_st;
+
+typedef struct
+{
+    ep_com_header_st            s_header;
+    uint8_t                     ui8_phase_count;
+    ep_monitor_phase_view_st    as_phases[K_PAYLOAD_MAX_MON_PHASE_COUNT];
+} ep_monitor_view_st;
+
+typedef struct
+{
+    const uint8_t          *pui8_next;
+    uint8_t                 ui8_param;                  // of the phase, 16 and 32 bit
+    uint8_t                 ui8_param_count;
+} ep_monitor_cursor_st;
+
 /*
  * Public Function Prototypes
  */
@@ -99,24 +173,49 @@ void edgePayloadInit(void);
 
 bool edgePayloadInitComHeader(ep_com_header_st *ps_header, int32_t si32_timestamp);
 bool edgePayloadComHeader2Buf(uint8_t *pui8_buf, size_t sz_buf_len, size_t *psz_res_len, const ep_com_header_st *ps_header);
+bool edgePayloadHeaderPrefix2Buf(uint8_t *pui8_buf, size_t sz_buf_len, size_t *psz_res_len, int32_t si32_timestamp);
+bool edgePayloadBuf2ComHeader(const uint8_t *pui8_buf, size_t sz_buf_len, size_t *psz_hdr_len, ep_com_header_st *ps_header);
 
 bool edgePayloadInitMonitor(ep_monitor_payload_st *ps_monitor, const ep_com_header_st *ps_header);
 bool edgePayloadNewMonitorPhase(ep_monitor_payload_st *ps_monitor, ep_phase_index_et e_phase);
 bool edgePayloadAddMonitorParam(ep_monitor_payload_st *ps_monitor, ep_monitor_id_et e_mon_id, uint16_t ui16_value);
 bool edgePayloadAddMonitorParam32(ep_monitor_payload_st *ps_monitor, ep_monitor_id_et e_mon_id, uint32_t ui32_value);
+uint8_t edgePayloadMonitorPhaseRoom(const ep_monitor_payload_st *ps_monitor);
 bool edgePayloadMonitor2Buf(uint8_t *pui8_buf, size_t sz_buf_len, size_t *psz_res_len, const ep_monitor_payload_st *ps_monitor);
+uint8_t edgePayloadMonitorParamLen(uint8_t ui8_mon_id);
+bool edgePayloadBuf2Monitor(const uint8_t *pui8_buf, size_t sz_buf_len, ep_monitor_view_st *ps_view);
+void edgePayloadMonitorViewCursor(const ep_monitor_phase_view_st *ps_phase, ep_monitor_cursor_st *ps_cursor);
+bool edgePayloadMonitorViewNext(ep_monitor_cursor_st *ps_cursor, uint8_t *pui8_mon_id, uint32_t *pui32_value);
+
+void edgePayloadWriterInit(ep_writer_st *ps_writer, uint8_t *pui8_buf, size_t sz_buf_len);
+bool edgePayloadWriteComHeader(ep_writer_st *ps_writer, const ep_com_header_st *ps_header);
+bool edgePayloadWriteMonitorPhase(ep_writer_st *ps_writer, ep_phase_index_et e_phase);
+bool edgePayloadWriteMonitorParam(ep_writer_st *ps_writer, ep_monitor_id_et e_mon_id, uint16_t ui16_value);
+bool edgePayloadWriteMonitorParam32(ep_writer_st *ps_writer, ep_monitor_id_et e_mon_id, uint32_t ui32_value);
+uint8_t edgePayloadWriterPhaseRoom(const ep_writer_st *ps_writer);
+bool edgePayloadWriterEnd(ep_writer_st *ps_writer, size_t *psz_res_len);
+
+void edgePayloadBatchInit(ep_monitor_batch_st *ps_batch, uint8_t *pui8_buf, size_t sz_buf_len);
+bool edgePayloadBatchAddMonitor(ep_monitor_batch_st *ps_batch, const uint8_t *pui8_payload, size_t sz_payload_len);
+size_t edgePayloadBatchLen(const ep_monitor_batch_st *ps_batch);
+size_t edgePayloadBatch2Monitor(ep_monitor_batch_st *ps_batch);
 
 bool edgePayloadInitStatus(ep_status_payload_st *ps_status, const ep_com_header_st *ps_header);
 bool edgePayloadAddStatusTag(ep_status_payload_st *ps_status, ep_tag_id_et e_tag_id, const uint8_t *pui8_value, uint8_t ui8_len);
 bool edgePayloadStatus2Buf(uint8_t *pui8_buf, size_t sz_buf_len, size_t *psz_res_len, const ep_status_payload_st *ps_status);
+bool edgePayloadBuf2Status(const uint8_t *pui8_buf, size_t sz_buf_len, ep_status_payload_st *ps_status);
 
 bool edgePayloadInitEvent(ep_event_payload_st *ps_event, const ep_com_header_st *ps_header);
 bool edgePayloadAddEventContent(ep_event_payload_st *ps_event, ep_event_type_et e_event_type, const uint8_t *pui8_content, uint8_t ui8_len);
 bool edgePayloadEvent2Buf(uint8_t *pui8_buf, size_t sz_buf_len, size_t *psz_res_len, const ep_event_payload_st *ps_event);
+bool edgePayloadBuf2Event(const uint8_t *pui8_buf, size_t sz_buf_len, ep_event_payload_st *ps_event);
 
 bool edgePayloadInitUpdateGet(ep_update_get_payload_st *ps_update_get, const ep_com_header_st *ps_header);
 bool edgePayloadSetUpdateGetContent(ep_update_get_payload_st *ps_update_get, uint32_t ui32_chunk_offset, uint16_t ui16_chunk_length);
 bool edgePayloadUpdateGet2Buf(uint8_t *pui8_buf, size_t sz_buf_len, size_t *psz_res_len, const ep_update_get_payload_st *ps_update_get);
+bool edgePayloadBuf2UpdateGet(const uint8_t *pui8_buf, size_t sz_buf_len, ep_update_get_payload_st *ps_update_get);
+
+bool edgePayloadCheck(ep_payload_kind_et e_kind, const uint8_t *pui8_buf, size_t sz_buf_len);
 
 #ifdef __cplusplus
 }
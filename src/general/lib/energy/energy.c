@@ -0,0 +1,253 @@
+/*****************************************************************************************//**
+* \file         energy.c
+*
+* \brief        Energy accumulation library source file.
+* \details      Trapezoidal integration of each phase at the sample rate. A checkpoint goes
+*               to the older of two records of the file, so a write cut by a reset leaves the
+*               previous one intact and the restore only reads both records.
+*
+* \version      v00.01.00
+* \date         20261017
+*********************************************************************************************/
+/*
+ * Included Modules
+ */
+#include "global_defs.h"
+#include <stdio.h>
+#include "energy.h"
+
+/*
+ * Local Constants
+ */
+#define K_ENERGY_MAGIC                  (0x454E5231UL)      // "ENR1"
+
+static const uint32_t   MS_ENERGY_CHECKPOINT    = (uint32_t)K_ENERGY_CHECKPOINT_MIN * 60UL * 1000UL;
+static const uint64_t   UI64_CHECKPOINT_MWMS    = (uint64_t)K_ENERGY_CHECKPOINT_WH * K_ENERGY_MWMS_PER_WH;
+
+/*
+ * Local Definitions
+ */
+typedef struct
+{
+    uint32_t        ui32_magic;
+    uint32_t        ui32_seq;
+    uint8_t         ui8_phases;
+    uint8_t         aui8_reserved[3];
+    energy_phase_st as_phase[K_ENERGY_MAX_PHASES];
+    uint16_t        ui16_crc;
+} energy_record_st;
+
+_Static_assert(sizeof(energy_record_st) <= K_ENERGY_SNAPSHOT_LEN, "energy snapshot length");
+
+/*
+ * Private Functions
+ */
+static uint16_t recordCrc(const energy_record_st *ps_rec)
+{
+    return crc16CalcBlock((uint8_t *)ps_rec, (uint16_t)offsetof(energy_record_st, ui16_crc));
+}
+
+static void accumulate(energy_phase_st *ps_phase, energy_reg_et e_pos, energy_reg_et e_neg, int64_t si64_2x)
+{
+    // si64_2x: twice the energy of the interval (trapezoid sum)
+    if (si64_2x >= 0)
+    {
+        ps_phase->aui64_mwms[e_pos] += (uint64_t)si64_2x / 2;
+    }
+    else
+    {
+        ps_phase->aui64_mwms[e_neg] += (uint64_t)(-si64_2x) / 2;
+    }
+}
+
+/*
+ * Public Functions
+ */
+void energyAccInit(energy_acc_st *ps_acc, uint8_t ui8_phases, const char *pc_path)
+{
+    memset(ps_acc, 0, sizeof(energy_acc_st));
+    ps_acc->pc_path    = pc_path;
+    ps_acc->ui8_phases = (ui8_phases < K_ENERGY_MAX_PHASES) ? ui8_phases : K_ENERGY_MAX_PHASES;
+}
+
+/* newest valid record of the two, O(1) */
+bool energyAccRestore(energy_acc_st *ps_acc)
+{
+    energy_record_st    s_rec;
+    FILE               *ps_file = fopen(ps_acc->pc_path, "rb");
+    bool                b_status = false;
+
+    if (NULL == ps_file)
+    {
+        return false;
+    }
+
+    for (uint8_t ui8_slot = 0; ui8_slot < 2; ui8_slot++)
+    {
+        if ((1 != fread(&s_rec, sizeof(s_rec), 1, ps_file)) ||
+            (K_ENERGY_MAGIC != s_rec.ui32_magic) ||
+            (s_rec.ui8_phases != ps_acc->ui8_phases) ||
+            (recordCrc(&s_rec) != s_rec.ui16_crc))
+        {
+            continue;
+        }
+        else if ((false == b_status) || ((int32_t)(s_rec.ui32_seq - ps_acc->ui32_seq) > 0))
+        {
+            ps_acc->ui32_seq = s_rec.ui32_seq;
+            memcpy(ps_acc->as_phase, s_rec.as_phase, sizeof(ps_acc->as_phase));
+            memcpy(ps_acc->as_checkpoint, s_rec.as_phase, sizeof(ps_acc->as_checkpoint));
+            b_status = true;
+        }
+    }
+    fclose(ps_file);
+
+    return b_status;
+}
+
+/* power sample of one phase; the first sample after a gap only starts the integration */
+void energyAccAdd(energy_acc_st *ps_acc, uint8_t ui8_phase, uint32_t ms_timestamp, int32_t si32_mw, int32_t si32_mvar, int32_t si32_mva)
+{
+    uint32_t ms_dt;
+
+    if (ui8_phase >= ps_acc->ui8_phases)
+    {
+        return;
+    }
+
+    ms_dt = ms_timestamp - ps_acc->ams_last[ui8_phase];
+    if ((true == ps_acc->ab_have_last[ui8_phase]) && (ms_dt <= K_ENERGY_MAX_GAP_MS))
+    {
+        energy_phase_st *ps_phase = &ps_acc->as_phase[ui8_phase];
+        const int32_t   *psi32_last = ps_acc->asi32_last[ui8_phase];
+
+        accumulate(ps_phase, ENERGY_IMPORT,   ENERGY_EXPORT,  ((int64_t)psi32_last[0] + si32_mw)   * ms_dt);
+        accumulate(ps_phase, ENERGY_LAGGING,  ENERGY_LEADING, ((int64_t)psi32_last[1] + si32_mvar) * ms_dt);
+        accumulate(ps_phase, ENERGY_APPARENT, ENERGY_APPARENT, ((int64_t)psi32_last[2] + si32_mva) * ms_dt);
+    }
+
+    ps_acc->ab_have_last[ui8_phase]     = true;
+    ps_acc->ams_last[ui8_phase]         = ms_timestamp;
+    ps_acc->asi32_last[ui8_phase][0]    = si32_mw;
+    ps_acc->asi32_last[ui8_phase][1]    = si32_mvar;
+    ps_acc->asi32_last[ui8_phase][2]    = si32_mva;
+}
+
+/* every K_ENERGY_CHECKPOINT_MIN, once a register moved K_ENERGY_CHECKPOINT_WH, or forced */
+bool energyAccCheckpoint(energy_acc_st *ps_acc, uint32_t ms_now, bool b_force)
+{
+    energy_record_st    s_rec;
+    FILE               *ps_file;
+    bool                b_due = b_force || ((ms_now - ps_acc->ms_checkpoint) >= MS_ENERGY_CHECKPOINT);
+
+    for (uint8_t p = 0; (false == b_due) && (p < ps_acc->ui8_phases); p++)
+    {
+        for (uint8_t r = 0; (false == b_due) && (r < ENERGY_NUM_REGS); r++)
+        {
+            b_due = ((ps_acc->as_phase[p].aui64_mwms[r] - ps_acc->as_checkpoint[p].aui64_mwms[r]) >= UI64_CHECKPOINT_MWMS);
+        }
+    }
+
+    if ((false == b_due) || (0 == memcmp(ps_acc->as_phase, ps_acc->as_checkpoint, sizeof(ps_acc->as_phase))))
+    {
+        return false;
+    }
+
+    memset(&s_rec, 0, sizeof(s_rec));
+    s_rec.ui32_magic = K_ENERGY_MAGIC;
+    s_rec.ui32_seq   = ps_acc->ui32_seq + 1;
+    s_rec.ui8_phases = ps_acc->ui8_phases;
+    memcpy(s_rec.as_phase, ps_acc->as_phase, sizeof(s_rec.as_phase));
+    s_rec.ui16_crc   = recordCrc(&s_rec);
+
+    ps_file = fopen(ps_acc->pc_path, "r+b");
+    if (NULL == ps_file)
+    {
+        ps_file = fopen(ps_acc->pc_path, "w+b");
+    }
+
+    if (NULL == ps_file)
+    {
+        LOGW("energy checkpoint: open %s failed", ps_acc->pc_path);
+        return false;
+    }
+    else if ((0 != fseek(ps_file, (long)((s_rec.ui32_seq & 1) * sizeof(s_rec)), SEEK_SET)) ||
+             (1 != fwrite(&s_rec, sizeof(s_rec), 1, ps_file)))
+    {
+        LOGW("energy checkpoint: write failed");
+        fclose(ps_file);
+        return false;
+    }
+    fclose(ps_file);
+
+    ps_acc->ui32_seq        = s_rec.ui32_seq;
+    ps_acc->ms_checkpoint   = ms_now;
+    ps_acc->ui32_writes++;
+    memcpy(ps_acc->as_checkpoint, ps_acc->as_phase, sizeof(ps_acc->as_checkpoint));
+
+    return true;
+}
+
+/* checkpoint record of the registers as they are now, for the journal */
+uint16_t energyAccSnapshot(const energy_acc_st *ps_acc, uint8_t *pui8_buf, uint16_t ui16_buf_len)
+{
+    energy_record_st s_rec;
+
+    if (ui16_buf_len < sizeof(s_rec))
+    {
+        return 0;
+    }
+
+    memset(&s_rec, 0, sizeof(s_rec));
+    s_rec.ui32_magic = K_ENERGY_MAGIC;
+    s_rec.ui32_seq   = ps_acc->ui32_seq;
+    s_rec.ui8_phases = ps_acc->ui8_phases;
+    memcpy(s_rec.as_phase, ps_acc->as_phase, sizeof(s_rec.as_phase));
+    s_rec.ui16_crc   = recordCrc(&s_rec);
+    memcpy(pui8_buf, &s_rec, sizeof(s_rec));
+
+    return (uint16_t)sizeof(s_rec);
+}
+
+/* snapshot from the journal after energyAccRestore(): taken unless it's older than the
+   checkpoint; the next checkpoint writes it */
+bool energyAccApply(energy_acc_st *ps_acc, const uint8_t *pui8_buf, uint16_t ui16_len)
+{
+    energy_record_st s_rec;
+
+    if (sizeof(s_rec) != ui16_len)
+    {
+        return false;
+    }
+
+    memcpy(&s_rec, pui8_buf, sizeof(s_rec));
+    if ((K_ENERGY_MAGIC != s_rec.ui32_magic) || (s_rec.ui8_phases != ps_acc->ui8_phases) ||
+        (recordCrc(&s_rec) != s_rec.ui16_crc) || ((int32_t)(s_rec.ui32_seq - ps_acc->ui32_seq) < 0))
+    {
+        return false;
+    }
+
+    ps_acc->ui32_seq = s_rec.ui32_seq;
+    memcpy(ps_acc->as_phase, s_rec.as_phase, sizeof(ps_acc->as_phase));
+
+    return true;
+}
+
+uint32_t energyAccWh(const energy_acc_st *ps_acc, uint8_t ui8_phase, energy_reg_et e_reg)
+{
+    if ((ui8_phase >= ps_acc->ui8_phases) || (e_reg >= ENERGY_NUM_REGS))
+    {
+        return 0;
+    }
+
+    return (uint32_t)(ps_acc->as_phase[ui8_phase].aui64_mwms[e_reg] / K_ENERGY_MWMS_PER_WH);
+}
+
+/* 32 bit energy registers into the open monitor phase of ps_writer, Wh / varh / VAh */
+bool energyAddMonitorParams(ep_writer_st *ps_writer, const energy_acc_st *ps_acc, uint8_t ui8_phase)
+{
+    return edgePayloadWriteMonitorParam32(ps_writer, EP_MON_ID_GDL_IMPORT_KWH_32,     energyAccWh(ps_acc, ui8_phase, ENERGY_IMPORT)) &&
+           edgePayloadWriteMonitorParam32(ps_writer, EP_MON_ID_GDL_EXPORT_KWH_32,     energyAccWh(ps_acc, ui8_phase, ENERGY_EXPORT)) &&
+           edgePayloadWriteMonitorParam32(ps_writer, EP_MON_ID_GDL_LEADING_KVARH_32,  energyAccWh(ps_acc, ui8_phase, ENERGY_LEADING)) &&
+           edgePayloadWriteMonitorParam32(ps_writer, EP_MON_ID_GDL_LAGGING_KVARH_32,  energyAccWh(ps_acc, ui8_phase, ENERGY_LAGGING)) &&
+           edgePayloadWriteMonitorParam32(ps_writer, EP_MON_ID_GDL_KVAH_32,           energyAccWh(ps_acc, ui8_phase, ENERGY_APPARENT));
+}
@@ -0,0 +1,91 @@
+/*****************************************************************************************//**
+* \file         energy.h
+*
+* \brief        Energy accumulation library header file.
+* \details      Per phase import/export Wh, leading/lagging varh and VAh, integrated from the
+*               power samples in 64 bit mW*ms (exact, no drift), checkpointed to a file with
+*               two alternating records; snapshots in between go to the journal.
+*
+* \version      v00.01.00
+* \date         20261017
+*********************************************************************************************/
+// *INDENT-OFF*
+#ifndef __ENERGY_H__
+#define __ENERGY_H__
+// *INDENT-ON*
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Include .h Library Files
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "energy_cfg.h"
+#include "edge_payload/edge_payload.h"
+
+/*
+ * Global Constants
+ */
+#define K_ENERGY_MWMS_PER_WH            (3600000000ULL)
+
+typedef enum
+{
+    ENERGY_IMPORT,
+    ENERGY_EXPORT,
+    ENERGY_LEADING,
+    ENERGY_LAGGING,
+    ENERGY_APPARENT,
+    ENERGY_NUM_REGS
+} energy_reg_et;
+
+#define K_ENERGY_SNAPSHOT_LEN           (16 + 8 * ENERGY_NUM_REGS * K_ENERGY_MAX_PHASES + 8)    // header, registers, crc; 8 byte aligned
+
+/*
+ * Global Structs
+ */
+typedef struct
+{
+    uint64_t        aui64_mwms[ENERGY_NUM_REGS];    // mW*ms, mvar*ms, mVA*ms
+} energy_phase_st;
+
+typedef struct
+{
+    const char     *pc_path;
+    uint8_t         ui8_phases;
+    energy_phase_st as_phase[K_ENERGY_MAX_PHASES];
+
+    // integration
+    bool            ab_have_last[K_ENERGY_MAX_PHASES];
+    uint32_t        ams_last[K_ENERGY_MAX_PHASES];
+    int32_t         asi32_last[K_ENERGY_MAX_PHASES][3];     // mW, mvar, mVA
+
+    // checkpoints
+    uint32_t        ui32_seq;
+    uint32_t        ms_checkpoint;
+    energy_phase_st as_checkpoint[K_ENERGY_MAX_PHASES];
+    uint32_t        ui32_writes;
+} energy_acc_st;
+
+/*
+ * Public Function Prototypes
+ */
+void energyAccInit(energy_acc_st *ps_acc, uint8_t ui8_phases, const char *pc_path);
+bool energyAccRestore(energy_acc_st *ps_acc);
+void energyAccAdd(energy_acc_st *ps_acc, uint8_t ui8_phase, uint32_t ms_timestamp, int32_t si32_mw, int32_t si32_mvar, int32_t si32_mva);
+bool energyAccCheckpoint(energy_acc_st *ps_acc, uint32_t ms_now, bool b_force);
+uint16_t energyAccSnapshot(const energy_acc_st *ps_acc, uint8_t *pui8_buf, uint16_t ui16_buf_len);
+bool energyAccApply(energy_acc_st *ps_acc, const uint8_t *pui8_buf, uint16_t ui16_len);
+
+uint32_t energyAccWh(const energy_acc_st *ps_acc, uint8_t ui8_phase, energy_reg_et e_reg);
+bool energyAddMonitorParams(ep_writer_st *ps_writer, const energy_acc_st *ps_acc, uint8_t ui8_phase);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif/* end of energy.h */
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -3,7 +3,7 @@
 #include "enmtr.h"
 
 
-bool EnergyMeter::init(int miso, int mosi, int sclk, int cs)
+bool EnergyMeter::init(int miso, int mosi, int sclk, int cs, spi_dma_chan_t e_dma_chan, transaction_cb_t fp_pre_cb, transaction_cb_t fp_post_cb)
 {
     spi_bus_config_t                buscfg;
     spi_device_interface_config_t   devcfg;
@@ -16,11 +16,8 @@ bool EnergyMeter::init(int miso, int mosi, int sclk, int cs)
     buscfg.quadhd_io_num    = -1;
     buscfg.max_transfer_sz  = ENMTR_SPI_MAX_TRANSFER_SIZE;
 
-#if 0 // https://docs.espressif.com/projects/esp-idf/en/v5.2.2/esp32/api-reference/peripherals/spi_slave.html#restrictions-and-known-issues
-    ESP_ERROR_CHECK( spi_bus_initialize(ENMTR_SPI_HOST, &buscfg, SPI_DMA_CH_AUTO) );
-#else
-    ESP_ERROR_CHECK( spi_bus_initialize(ENMTR_SPI_HOST, &buscfg, SPI_DMA_DISABLED) );
-#endif
+    // with DMA, queued rx buffers must be word aligned & in internal ram (no bounce buffer then)
+    ESP_ERROR_CHECK( spi_bus_initialize(ENMTR_SPI_HOST, &buscfg, e_dma_chan) );
 
     memset(&devcfg, 0, sizeof(devcfg));
     //devcfg.duty_cycle_pos   = 128; // default = 128/256
@@ -29,7 +26,9 @@ bool EnergyMeter::init(int miso, int mosi, int sclk, int cs)
     //devcfg.input_delay_ns   = 32;
     devcfg.mode             = ENMTR_SPI_MODE;
     devcfg.spics_io_num     = cs;
-    devcfg.queue_size       = 1;
+    devcfg.queue_size       = ENMTR_SPI_QUEUE_SIZE;
+    devcfg.pre_cb           = fp_pre_cb;    // called from isr
+    devcfg.post_cb          = fp_post_cb;
 
     ESP_ERROR_CHECK( spi_bus_add_device(ENMTR_SPI_HOST, &devcfg, &spi) );
 
@@ -61,3 +60,38 @@ bool EnergyMeter::transfer(const uint8_t *pui8_tx_buf, uint8_t *pui8_rx_buf, uin
 
     return (ESP_OK == ret);
 }
+
+bool EnergyMeter::queue_transfer(spi_transaction_t *ps_trans)
+{
+    return (ESP_OK == spi_device_queue_trans(spi, ps_trans, ENMTR_SPI_TRANSFER_TIMEOUT));
+}
+
+spi_transaction_t *EnergyMeter::wait_transfer(void)
+{
+    spi_transaction_t *ps_trans = NULL;
+
+    if (ESP_OK != spi_device_get_trans_result(spi, &ps_trans, ENMTR_SPI_TRANSFER_TIMEOUT))
+    {
+        ps_trans = NULL;
+    }
+
+    return ps_trans;
+}
+
+// results of "ui8_n" transactions left in flight by an error, each waited for at most the transfer
+// timeout; returns those that didn't come back (their buffers still belong to the driver)
+uint8_t EnergyMeter::drain_transfers(uint8_t ui8_n)
+{
+    spi_transaction_t  *ps_trans;
+    uint8_t             ui8_left = ui8_n;
+
+    for (uint8_t i = 0; i < ui8_n; i++)
+    {
+        if (ESP_OK == spi_device_get_trans_result(spi, &ps_trans, ENMTR_SPI_TRANSFER_TIMEOUT))
+        {
+            ui8_left--;
+        }
+    }
+
+    return ui8_left;
+}
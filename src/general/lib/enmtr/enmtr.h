@@ -14,9 +14,15 @@ class EnergyMeter
 {
 public:
     EnergyMeter() { }
-    bool init(int miso, int mosi, int clk, int cs);
+    bool init(int miso, int mosi, int clk, int cs, spi_dma_chan_t e_dma_chan = SPI_DMA_DISABLED,
+              transaction_cb_t fp_pre_cb = NULL, transaction_cb_t fp_post_cb = NULL);
     bool transfer(const uint8_t *pui8_tx_buf, uint8_t *pui8_rx_buf, uint16_t ui16_size);
 
+    // queued transactions: buffers must be DMA capable, results come back in queue order
+    bool queue_transfer(spi_transaction_t *ps_trans);
+    spi_transaction_t *wait_transfer(void);
+    uint8_t drain_transfers(uint8_t ui8_n);
+
 protected:
     spi_device_handle_t spi;
 };
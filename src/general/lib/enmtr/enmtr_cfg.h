@@ -7,3 +7,4 @@
 #define ENMTR_SPI_CLOCK_SPEED_HZ        (360*1000)
 #define ENMTR_SPI_MODE                  (0)
 #define ENMTR_SPI_TRANSFER_TIMEOUT      (100)
+#define ENMTR_SPI_QUEUE_SIZE            (4)     // queued transactions in flight
@@ -1,4 +1,7 @@
 
+#include <algorithm>  // std::min
+#include <esp_attr.h>
+#include <hal/gpio_ll.h>
 #include <rom/ets_sys.h> // for ets_delay_us()
 
 #include "global_defs.h"
@@ -8,14 +11,16 @@
 
 EnMtrMSP430::EnMtrMSP430()
 {
-    //
+    ui8_burst_lost = 0;
 }
 
 bool EnMtrMSP430::init()
 {
     enmtr_init_pins();
+    init_burst();
 
-    return EnergyMeter::init(ENMTR_SPI_MISO_PIN, ENMTR_SPI_MOSI_PIN, ENMTR_SPI_CLK_PIN, -1);
+    return EnergyMeter::init(ENMTR_SPI_MISO_PIN, ENMTR_SPI_MOSI_PIN, ENMTR_SPI_CLK_PIN, -1,
+                             K_ENMTR_SPI_DMA_CHAN, burst_pre_cb, burst_post_cb);
 }
 
 bool EnMtrMSP430::reset()
@@ -38,22 +43,88 @@ bool EnMtrMSP430::reset()
     return true;
 }
 
-void EnMtrMSP430::write_ss(device_et e_device, bool b_active)
+// register writes, also called from the spi isr ("gpio_set_level()" isn't in iram)
+void IRAM_ATTR EnMtrMSP430::write_ss(device_et e_device, bool b_active)
 {
     switch (e_device)
     {
     // active low
-    case DEVICE_PHASE_A: gpio_set_level(ENMTR_SPI_SSA_PIN, b_active ? 0 : 1); break;
-    case DEVICE_PHASE_B: gpio_set_level(ENMTR_SPI_SSB_PIN, b_active ? 0 : 1); break;
-    case DEVICE_PHASE_C: gpio_set_level(ENMTR_SPI_SSC_PIN, b_active ? 0 : 1); break;
+    case DEVICE_PHASE_A: gpio_ll_set_level(&GPIO, ENMTR_SPI_SSA_PIN, b_active ? 0 : 1); break;
+    case DEVICE_PHASE_B: gpio_ll_set_level(&GPIO, ENMTR_SPI_SSB_PIN, b_active ? 0 : 1); break;
+    case DEVICE_PHASE_C: gpio_ll_set_level(&GPIO, ENMTR_SPI_SSC_PIN, b_active ? 0 : 1); break;
     default: break; // ignore
     }
 }
 
+// chip select of queued transactions, from the spi isr (no delays there); polled transfers
+// ("user" = NULL) drive it themselves
+void IRAM_ATTR EnMtrMSP430::burst_pre_cb(spi_transaction_t *ps_trans)
+{
+    if (NULL != ps_trans->user)
+    {
+        write_ss((device_et)((uintptr_t)ps_trans->user - 1), true);
+    }
+}
+
+void IRAM_ATTR EnMtrMSP430::burst_post_cb(spi_transaction_t *ps_trans)
+{
+    if (NULL != ps_trans->user)
+    {
+        write_ss((device_et)((uintptr_t)ps_trans->user - 1), false);
+    }
+}
+
+// one full-duplex transaction per command frame; read: cmd, dummy, data, crc & ack,
+// write ("pui16_data"): cmd, data, crc, dummy & ack. Both are "2 * n + READ_REPLY_OVERHEAD" bytes.
+void EnMtrMSP430::init_frame(burst_frame_st *ps_frame, device_et e_device, reg_addr_et e_reg_addr, const uint16_t *pui16_data, uint8_t ui8_nreg)
+{
+    uint16_t ui16_crc;
+
+    memset(ps_frame->aui8_tx, 0, sizeof(ps_frame->aui8_tx));
+    ps_frame->aui8_tx[0] = ((((ui8_nreg - 1) & 0x0F) << 4) | (((uint8_t)e_reg_addr & 0xC0) >> 4) | (0x01));
+    ps_frame->aui8_tx[1] = (((uint8_t)e_reg_addr & 0x3F) << 2);
+
+    if (NULL != pui16_data)
+    {
+        ps_frame->aui8_tx[1] |= 0x02;
+        for (uint8_t i = 0; i < ui8_nreg; i++)
+        {
+            ps_frame->aui8_tx[2 + 2 * i] = (uint8_t)((pui16_data[i] >> 8) & 0xFF);
+            ps_frame->aui8_tx[3 + 2 * i] = (uint8_t)((pui16_data[i] >> 0) & 0xFF);
+        }
+        ui16_crc = crc16CalcBlock(&ps_frame->aui8_tx[2], (uint16_t)(2 * ui8_nreg));
+        ps_frame->aui8_tx[2 + 2 * ui8_nreg] = (uint8_t)((ui16_crc >> 0) & 0xFF);
+        ps_frame->aui8_tx[3 + 2 * ui8_nreg] = (uint8_t)((ui16_crc >> 8) & 0xFF);
+    }
+
+    ps_frame->ui8_nreg          = ui8_nreg;
+    ps_frame->s_trans.length    = (2 * ui8_nreg + READ_REPLY_OVERHEAD) * 8;
+    ps_frame->s_trans.tx_buffer = ps_frame->aui8_tx;
+    ps_frame->s_trans.rx_buffer = ps_frame->aui8_rx;
+    ps_frame->s_trans.user      = (void *)(uintptr_t)(e_device + 1);
+}
+
+// measurement block read frames, frame-major order
+void EnMtrMSP430::init_burst()
+{
+    uint8_t         ui8_idx;
+    burst_frame_st *ps_frame;
+
+    memset(as_burst, 0, sizeof(as_burst));
+
+    for (ui8_idx = 0; ui8_idx < BURST_NFRAMES; ui8_idx++)
+    {
+        ps_frame             = &as_burst[ui8_idx];
+        ps_frame->ui8_offset = (ui8_idx / NUM_DEVICES) * MAX_CMD_NREG;
+        init_frame(ps_frame, (device_et)(ui8_idx % NUM_DEVICES), (reg_addr_et)(MEAS_BLOCK_FIRST + ps_frame->ui8_offset),
+                   NULL, std::min<uint8_t>(MAX_CMD_NREG, MEAS_BLOCK_NREG - ps_frame->ui8_offset));
+    }
+}
+
 bool EnMtrMSP430::send_cmd(device_et e_device, command_et e_cmd, reg_addr_et e_reg_addr, uint16_t *pui16_reg_data, uint8_t ui8_nreg)
 {
     uint8_t     aui8_cmd[2];
-    uint8_t     aui8_data_buf[32];
+    uint8_t     aui8_data_buf[2 * MAX_CMD_NREG + 4]; // + crc & ack on reads
     uint8_t     aui8_crc_buf[2];
     uint8_t     aui8_ack_stat[2];
     uint8_t     ui8_dummy;
@@ -61,11 +132,10 @@ bool EnMtrMSP430::send_cmd(device_et e_device, command_et e_cmd, reg_addr_et e_r
     uint8_t     ui8_reg_ctr;
     uint8_t     ui8_ndata_bytes;
     uint16_t    ui16_crc_calc;
-    uint16_t    ui16_crc_recv;
     bool        b_status = false;
 
     if ((NULL == pui16_reg_data) || (e_device > DEVICE_PHASE_C) ||
-        (0 == ui8_nreg) || (ui8_nreg > 16))
+        (0 == ui8_nreg) || (ui8_nreg > MAX_CMD_NREG))
     {
         // invalid args
     }
@@ -102,37 +172,17 @@ bool EnMtrMSP430::send_cmd(device_et e_device, command_et e_cmd, reg_addr_et e_r
             {
                 //
             }
-            else if (false == transfer(NULL, &aui8_crc_buf[0], 2))
+            else if (false == transfer(NULL, &aui8_data_buf[ui8_ndata_bytes], 2)) // crc
             {
                 //
             }
-            else if (false == transfer(NULL, &aui8_ack_stat[0], 2))
+            else if (false == transfer(NULL, &aui8_data_buf[ui8_ndata_bytes + 2], 2)) // ack
             {
                 //
             }
-            else if ((0xA5 != aui8_ack_stat[0]) || (0x5A != aui8_ack_stat[1]))
-            {
-                LOGW("cmd %x-%02x (%d) ack error %02x-%02x", e_cmd, e_reg_addr, e_device, aui8_ack_stat[0], aui8_ack_stat[1]);
-            }
             else
             {
-                ui16_crc_calc = crc16CalcBlock(&aui8_data_buf[0], (uint16_t)ui8_ndata_bytes);
-                ui16_crc_recv = (((uint16_t)aui8_crc_buf[1] << 8) | ((uint16_t)aui8_crc_buf[0]));
-
-                if (ui16_crc_calc != ui16_crc_recv)
-                {
-                    LOGW("cmd %x (%d) crc failed (%04x != %04x)", e_cmd, e_device, ui16_crc_calc, ui16_crc_recv);
-                }
-                else
-                {
-                    ui8_data_ctr = 0;
-                    for (ui8_reg_ctr = 0; ui8_reg_ctr < ui8_nreg; ui8_reg_ctr++)
-                    {
-                        pui16_reg_data[ui8_reg_ctr]  = (((uint16_t)aui8_data_buf[ui8_data_ctr++] & 0xFF) << 8);
-                        pui16_reg_data[ui8_reg_ctr] |= (((uint16_t)aui8_data_buf[ui8_data_ctr++] & 0xFF) << 0);
-                    }
-                    b_status = true;
-                }
+                b_status = parse_read_reply(e_device, e_cmd, e_reg_addr, &aui8_data_buf[0], pui16_reg_data, ui8_nreg);
             }
             break;
 
@@ -194,6 +244,43 @@ bool EnMtrMSP430::send_cmd(device_et e_device, command_et e_cmd, reg_addr_et e_r
     return b_status;
 }
 
+// "pui8_reply" = data[2*n], crc[2], ack[2]
+bool EnMtrMSP430::parse_read_reply(device_et e_device, command_et e_cmd, reg_addr_et e_reg_addr, const uint8_t *pui8_reply, uint16_t *pui16_reg_data, uint8_t ui8_nreg)
+{
+    const uint8_t  *pui8_crc        = &pui8_reply[2 * ui8_nreg];
+    const uint8_t  *pui8_ack        = &pui8_reply[2 * ui8_nreg + 2];
+    uint16_t        ui16_crc_calc;
+    uint16_t        ui16_crc_recv;
+    uint8_t         ui8_reg_ctr;
+    bool            b_status = false;
+
+    if ((0xA5 != pui8_ack[0]) || (0x5A != pui8_ack[1]))
+    {
+        LOGW("cmd %x-%02x (%d) ack error %02x-%02x", e_cmd, e_reg_addr, e_device, pui8_ack[0], pui8_ack[1]);
+    }
+    else
+    {
+        ui16_crc_calc = crc16CalcBlock((uint8_t *)pui8_reply, (uint16_t)(2 * ui8_nreg));
+        ui16_crc_recv = (((uint16_t)pui8_crc[1] << 8) | ((uint16_t)pui8_crc[0]));
+
+        if (ui16_crc_calc != ui16_crc_recv)
+        {
+            LOGW("cmd %x (%d) crc failed (%04x != %04x)", e_cmd, e_device, ui16_crc_calc, ui16_crc_recv);
+        }
+        else
+        {
+            for (ui8_reg_ctr = 0; ui8_reg_ctr < ui8_nreg; ui8_reg_ctr++)
+            {
+                pui16_reg_data[ui8_reg_ctr]  = (((uint16_t)pui8_reply[2 * ui8_reg_ctr + 0] & 0xFF) << 8);
+                pui16_reg_data[ui8_reg_ctr] |= (((uint16_t)pui8_reply[2 * ui8_reg_ctr + 1] & 0xFF) << 0);
+            }
+            b_status = true;
+        }
+    }
+
+    return b_status;
+}
+
 bool EnMtrMSP430::init_config(device_et e_device)
 {
     uint16_t    aui16_boot_sig[2];
@@ -249,3 +336,676 @@ bool EnMtrMSP430::read_versions(device_et e_device)
 
     return b_status;
 }
+
+#if (1 == K_ENMTR_SPI_BURST)
+bool EnMtrMSP430::read_meas_block(meas_block_st *ps_block)
+{
+    spi_transaction_t  *ps_done;
+    burst_frame_st     *ps_frame;
+    uint8_t             ui8_queued  = 0;
+    uint8_t             ui8_done    = 0;
+    uint8_t             ui8_limit   = BURST_NFRAMES;
+    bool                b_status    = true;
+
+    ps_block->ms_timestamp = millis();
+
+    // frames an earlier error left with the driver, maybe firmware update ones
+    if (0 != ui8_burst_lost)
+    {
+        if (0 != (ui8_burst_lost = drain_transfers(ui8_burst_lost)))
+        {
+            return false;
+        }
+        init_burst();
+    }
+
+    // keep the queue full: the next phase is on the wire while the previous reply is checked
+    while (ui8_done < ui8_limit)
+    {
+        while ((ui8_queued < ui8_limit) && ((ui8_queued - ui8_done) < ENMTR_SPI_QUEUE_SIZE))
+        {
+            if (false == queue_transfer(&as_burst[ui8_queued].s_trans))
+            {
+                LOGW("burst queue failed");
+                b_status  = false;
+                ui8_limit = ui8_queued;
+                break;
+            }
+            ui8_queued++;
+        }
+
+        if (ui8_done == ui8_queued)
+        {
+            break; // nothing in flight
+        }
+        else if (NULL == (ps_done = wait_transfer()))
+        {
+            LOGW("burst transfer timeout");
+            b_status = false;
+            break;
+        }
+
+        ps_frame = &as_burst[ui8_done++];
+
+        if (ps_done != &ps_frame->s_trans) // completions are in queue order, unless a late one from a timeout
+        {
+            LOGW("burst out of order");
+            b_status  = false;
+            ui8_limit = ui8_queued;
+        }
+        else if ((true == b_status) &&
+                 (false == parse_read_reply((device_et)((uintptr_t)ps_done->user - 1), CMD_MULTIPLE_REG_READ,
+                                            (reg_addr_et)(MEAS_BLOCK_FIRST + ps_frame->ui8_offset),
+                                            &ps_frame->aui8_rx[3], // after cmd & dummy
+                                            &ps_block->aui16_reg[(uintptr_t)ps_done->user - 1][ps_frame->ui8_offset],
+                                            ps_frame->ui8_nreg)))
+        {
+            b_status  = false;
+            ui8_limit = ui8_queued; // drain, don't queue more
+        }
+    }
+
+    // after a timeout or a lost frame: nothing may stay queued on the burst frames
+    if (ui8_done != ui8_queued)
+    {
+        ui8_burst_lost = drain_transfers(ui8_queued - ui8_done);
+        LOGW("burst: %u frames drained, %u lost", (unsigned)(ui8_queued - ui8_done - ui8_burst_lost), (unsigned)ui8_burst_lost);
+    }
+
+    return b_status; // incomplete block is never published
+}
+#else
+bool EnMtrMSP430::read_meas_block(meas_block_st *ps_block)
+{
+    uint8_t     ui8_offset;
+    uint8_t     ui8_nreg;
+    int         i_device;
+
+    ps_block->ms_timestamp = millis();
+
+    // frame-major order: the phases are sampled (nearly) together for each part of the block
+    for (uint8_t ui8_frame = 0; ui8_frame < MEAS_BLOCK_NFRAMES; ui8_frame++)
+    {
+        ui8_offset = ui8_frame * MAX_CMD_NREG;
+        ui8_nreg   = std::min<uint8_t>(MAX_CMD_NREG, MEAS_BLOCK_NREG - ui8_offset);
+
+        for (i_device = DEVICE_PHASE_A; i_device < NUM_DEVICES; i_device++)
+        {
+            if (false == read_mult_regs((device_et)i_device, (reg_addr_et)(MEAS_BLOCK_FIRST + ui8_offset),
+                                        &ps_block->aui16_reg[i_device][ui8_offset], ui8_nreg))
+            {
+                return false; // incomplete block is never published
+            }
+        }
+    }
+
+    return true;
+}
+#endif
+
+/*
+ * Firmware update
+ *
+ * Per block and phase: REG_ADDR_BTLDR_FLASH_ADDR, REG_ADDR_BTLDR_FLASH_DATA_0..15 and
+ * CMD_BTLDR_WRITE_FLASH, one frame each. The phases are interleaved and the frames queued
+ * back-to-back: "addr & data" of a block, then the command of the previous one once its
+ * address & data frames are acknowledged. A phase gets its next block while the other two are
+ * written, which is about the time it needs to program one. A frame refused because the phase
+ * is still busy (or a crc error) only costs that block a rewrite on the polled path.
+ */
+bool EnMtrMSP430::fw_read_header(FILE *ps_file, fw_image_hdr_st *ps_hdr, uint8_t *pui8_chunk)
+{
+    uint16_t    ui16_crc = crc16GetSeed();
+    uint32_t    ui32_left;
+    size_t      sz_len;
+
+    if (1 != fread(ps_hdr, sizeof(fw_image_hdr_st), 1, ps_file))
+    {
+        LOGW("fw image: no header");
+        return false;
+    }
+    else if ((K_ENMTR_FW_MAGIC != ps_hdr->ui32_magic) || (0 == ps_hdr->ui32_length) ||
+             (0 != (ps_hdr->ui16_load_addr % FLASH_BLOCK_BYTES)) ||
+             ((ps_hdr->ui16_load_addr + ps_hdr->ui32_length) > 0x10000UL))
+    {
+        LOGW("fw image: invalid header (%08x, %04x + %u)", (unsigned)ps_hdr->ui32_magic, ps_hdr->ui16_load_addr,
+             (unsigned)ps_hdr->ui32_length);
+        return false;
+    }
+
+    // whole image before touching the devices
+    for (ui32_left = ps_hdr->ui32_length; ui32_left > 0; ui32_left -= sz_len)
+    {
+        sz_len = fread(pui8_chunk, 1, std::min<uint32_t>(ui32_left, K_ENMTR_FW_READ_CHUNK), ps_file);
+        if (0 == sz_len)
+        {
+            LOGW("fw image: truncated");
+            return false;
+        }
+        for (size_t i = 0; i < sz_len; i++)
+        {
+            ui16_crc = crc16CalcByte(ui16_crc, pui8_chunk[i]);
+        }
+    }
+
+    if (ui16_crc != ps_hdr->ui16_crc)
+    {
+        LOGW("fw image: crc failed (%04x != %04x)", ui16_crc, ps_hdr->ui16_crc);
+        return false;
+    }
+
+    return (0 == fseek(ps_file, sizeof(fw_image_hdr_st), SEEK_SET));
+}
+
+bool EnMtrMSP430::fw_enter_bootloader(device_et e_device)
+{
+    uint16_t aui16_sig[2];
+
+    for (uint8_t ui8_try = 0; ui8_try < 2; ui8_try++)
+    {
+        if (false == read_mult_regs(e_device, REG_ADDR_BTLDR_BOOTSIG_W1, aui16_sig, 2))
+        {
+            //
+        }
+        else if ((K_ENMTR_MSP430_BOOT_SIG_W1_VAL == aui16_sig[0]) && (K_ENMTR_MSP430_BOOT_SIG_W2_VAL == aui16_sig[1]))
+        {
+            return true;
+        }
+        else if (0 == ui8_try)
+        {
+            (void)write_reg(e_device, REG_ADDR_COMMAND, CMD_ENTR_BOOTLDR);
+            delayms(K_ENMTR_FW_BOOTLDR_DELAY);
+        }
+    }
+
+    LOGW("bootloader (%d) not entered", e_device);
+
+    return false;
+}
+
+// "ms_timeout" = 0: up to K_ENMTR_FW_BLOCK_POLLS back-to-back status reads (block programming)
+bool EnMtrMSP430::fw_wait_ready(device_et e_device, uint32_t ms_timeout, fw_update_stats_st *ps_stats)
+{
+    uint32_t    ms_start = millis();
+    uint16_t    ui16_status;
+
+    for (uint32_t ui32_poll = 0; ; ui32_poll++)
+    {
+        ps_stats->ui32_frames++;
+        if (false == read_reg(e_device, REG_ADDR_STATUS, &ui16_status))
+        {
+            return false;
+        }
+        else if (0 == (ui16_status & K_ENMTR_FW_STATUS_BUSY))
+        {
+            return true;
+        }
+        else if (0 == ms_timeout)
+        {
+            if (ui32_poll >= K_ENMTR_FW_BLOCK_POLLS)
+            {
+                break;
+            }
+        }
+        else if ((millis() - ms_start) >= ms_timeout)
+        {
+            break;
+        }
+        else
+        {
+            delayms(1);
+        }
+    }
+
+    LOGW("bootloader (%d) busy", e_device);
+
+    return false;
+}
+
+bool EnMtrMSP430::fw_write_block_polled(const fw_unit_st *ps_unit, fw_update_stats_st *ps_stats)
+{
+    uint16_t aui16_data[FLASH_BLOCK_NREG];
+
+    memcpy(aui16_data, ps_unit->aui16_data, sizeof(aui16_data));
+    ps_stats->ui32_frames += 3;
+
+    return fw_wait_ready(ps_unit->e_device, 0, ps_stats) &&
+           write_reg(ps_unit->e_device, REG_ADDR_BTLDR_FLASH_ADDR, ps_unit->ui16_addr) &&
+           send_cmd(ps_unit->e_device, CMD_MULTIPLE_REG_WRITE, REG_ADDR_BTLDR_FLASH_DATA_0, aui16_data, FLASH_BLOCK_NREG) &&
+           write_reg(ps_unit->e_device, REG_ADDR_COMMAND, CMD_BTLDR_WRITE_FLASH);
+}
+
+// image block at "ui32_off", the next chunk read from the file at a chunk start
+bool EnMtrMSP430::fw_image_block(FILE *ps_file, const fw_image_hdr_st *ps_hdr, uint32_t ui32_off, uint8_t *pui8_chunk, uint16_t *pui16_data)
+{
+    uint32_t ui32_pos = ui32_off % K_ENMTR_FW_READ_CHUNK;
+
+    if (0 == ui32_pos)
+    {
+        memset(pui8_chunk, 0xFF, K_ENMTR_FW_READ_CHUNK); // pads the last block
+        if (0 == fread(pui8_chunk, 1, std::min<uint32_t>(ps_hdr->ui32_length - ui32_off, K_ENMTR_FW_READ_CHUNK), ps_file))
+        {
+            LOGW("fw image: read failed");
+            return false;
+        }
+    }
+    for (uint8_t i = 0; i < FLASH_BLOCK_NREG; i++)
+    {
+        pui16_data[i] = (uint16_t)(pui8_chunk[ui32_pos + 2 * i] | ((uint16_t)pui8_chunk[ui32_pos + 2 * i + 1] << 8));
+    }
+
+    return true;
+}
+
+// read back block of a phase into its image crc
+void EnMtrMSP430::fw_crc_block(fw_pipe_st *ps_pipe, device_et e_device, const uint16_t *pui16_data)
+{
+    uint32_t *pui32_left = &ps_pipe->aui32_left[e_device];
+
+    for (uint8_t i = 0; (i < FLASH_BLOCK_BYTES) && (*pui32_left > 0); i++, (*pui32_left)--)
+    {
+        ps_pipe->aui16_crc[e_device] = crc16CalcByte(ps_pipe->aui16_crc[e_device], (uint8_t)(pui16_data[i / 2] >> ((i & 1) * 8)));
+    }
+}
+
+EnMtrMSP430::fw_unit_st *EnMtrMSP430::fw_next_unit(fw_pipe_st *ps_pipe, device_et e_device, uint16_t ui16_addr)
+{
+    fw_unit_st *ps_unit = &ps_pipe->as_unit[ps_pipe->ui32_units++ % FW_NUM_UNITS];
+
+    ps_unit->e_device   = e_device;
+    ps_unit->ui16_addr  = ui16_addr;
+    ps_unit->ui8_done   = 0;
+    ps_unit->ui8_acked  = 0;
+
+    return ps_unit;
+}
+
+#if (1 == K_ENMTR_SPI_BURST)
+// frames back-to-back on the burst frames, no chip select delays: only with the queued measurement
+// block, verified on the same bus timing
+bool EnMtrMSP430::fw_queue(fw_pipe_st *ps_pipe, fw_unit_st *ps_unit, fw_frame_et e_type)
+{
+    burst_frame_st *ps_frame;
+    uint16_t        ui16_cmd = CMD_BTLDR_WRITE_FLASH;
+
+    while ((ps_pipe->ui32_queued - ps_pipe->ui32_completed) >= ENMTR_SPI_QUEUE_SIZE)
+    {
+        if (false == fw_complete(ps_pipe))
+        {
+            return false;
+        }
+    }
+
+    ps_frame = &as_burst[ps_pipe->ui32_queued % BURST_NFRAMES];
+    switch (e_type)
+    {
+    case FW_FRAME_ADDR: init_frame(ps_frame, ps_unit->e_device, REG_ADDR_BTLDR_FLASH_ADDR, &ps_unit->ui16_addr, 1); break;
+    case FW_FRAME_DATA: init_frame(ps_frame, ps_unit->e_device, REG_ADDR_BTLDR_FLASH_DATA_0, ps_unit->aui16_data, FLASH_BLOCK_NREG); break;
+    case FW_FRAME_CMD:  init_frame(ps_frame, ps_unit->e_device, REG_ADDR_COMMAND, &ui16_cmd, 1); break;
+    default:            init_frame(ps_frame, ps_unit->e_device, REG_ADDR_BTLDR_FLASH_DATA_0, NULL, FLASH_BLOCK_NREG); break;
+    }
+    ps_frame->ui8_fw_unit = (uint8_t)(ps_unit - ps_pipe->as_unit);
+    ps_frame->ui8_fw_type = (uint8_t)e_type;
+
+    if (false == queue_transfer(&ps_frame->s_trans))
+    {
+        LOGW("fw frame queue failed");
+        ps_pipe->b_error = true;
+        return false;
+    }
+    ps_pipe->ui32_queued++;
+    ps_pipe->ps_stats->ui32_frames++;
+
+    return true;
+}
+
+void EnMtrMSP430::fw_add_failed(fw_pipe_st *ps_pipe, const fw_unit_st *ps_unit)
+{
+    if (ps_pipe->ui8_failed < FW_NUM_UNITS)
+    {
+        ps_pipe->as_failed[ps_pipe->ui8_failed++] = *ps_unit;
+    }
+    else
+    {
+        ps_pipe->b_error = true;
+    }
+}
+
+// oldest frame in flight
+bool EnMtrMSP430::fw_complete(fw_pipe_st *ps_pipe)
+{
+    burst_frame_st     *ps_frame = &as_burst[ps_pipe->ui32_completed % BURST_NFRAMES];
+    fw_unit_st         *ps_unit  = &ps_pipe->as_unit[ps_frame->ui8_fw_unit];
+    const uint8_t      *pui8_ack = &ps_frame->aui8_rx[(ps_frame->s_trans.length / 8) - 2];
+    uint16_t            aui16_data[FLASH_BLOCK_NREG];
+    spi_transaction_t  *ps_done  = wait_transfer();
+    bool                b_acked;
+
+    if (&ps_frame->s_trans != ps_done)
+    {
+        LOGW("fw frame lost");
+        ps_pipe->b_error = true;
+        ps_pipe->ui32_completed += (NULL != ps_done) ? 1 : 0; // a result came back, not this one's
+        return false;
+    }
+    else if (FW_FRAME_READ == ps_frame->ui8_fw_type)
+    {
+        b_acked = (0 != (ps_unit->ui8_acked & (1 << FW_FRAME_ADDR))) &&
+                  parse_read_reply(ps_unit->e_device, CMD_MULTIPLE_REG_READ, REG_ADDR_BTLDR_FLASH_DATA_0,
+                                   &ps_frame->aui8_rx[3], aui16_data, FLASH_BLOCK_NREG);
+    }
+    else
+    {
+        b_acked = (0xA5 == pui8_ack[0]) && (0x5A == pui8_ack[1]);
+    }
+    ps_pipe->ui32_completed++;
+
+    ps_unit->ui8_done  |= (1 << ps_frame->ui8_fw_type);
+    ps_unit->ui8_acked |= b_acked ? (1 << ps_frame->ui8_fw_type) : 0;
+
+    if ((FW_FRAME_CMD == ps_frame->ui8_fw_type) && (false == b_acked))
+    {
+        fw_add_failed(ps_pipe, ps_unit);
+    }
+    else if (FW_FRAME_READ == ps_frame->ui8_fw_type)
+    {
+        ps_pipe->b_error |= !b_acked;
+        if (true == b_acked)
+        {
+            fw_crc_block(ps_pipe, ps_unit->e_device, aui16_data);
+        }
+    }
+
+    return true;
+}
+
+bool EnMtrMSP430::fw_drain(fw_pipe_st *ps_pipe)
+{
+    while (ps_pipe->ui32_completed != ps_pipe->ui32_queued)
+    {
+        if (false == fw_complete(ps_pipe))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// write command of a block whose address & data are acknowledged
+bool EnMtrMSP430::fw_queue_cmd(fw_pipe_st *ps_pipe, fw_unit_st *ps_unit)
+{
+    const uint8_t ui8_addr_data = (1 << FW_FRAME_ADDR) | (1 << FW_FRAME_DATA);
+
+    while (ui8_addr_data != (ps_unit->ui8_done & ui8_addr_data))
+    {
+        if (false == fw_complete(ps_pipe))
+        {
+            return false;
+        }
+    }
+
+    if (ui8_addr_data == (ps_unit->ui8_acked & ui8_addr_data))
+    {
+        return fw_queue(ps_pipe, ps_unit, FW_FRAME_CMD);
+    }
+
+    fw_add_failed(ps_pipe, ps_unit);
+
+    return (false == ps_pipe->b_error);
+}
+
+// refused blocks, polled; the queue must be empty for the polled transfers
+bool EnMtrMSP430::fw_retry(fw_pipe_st *ps_pipe)
+{
+    if (false == fw_drain(ps_pipe))
+    {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < ps_pipe->ui8_failed; i++)
+    {
+        ps_pipe->ps_stats->ui32_retries++;
+        if (false == fw_write_block_polled(&ps_pipe->as_failed[i], ps_pipe->ps_stats))
+        {
+            LOGW("fw block %04x (%d) failed", ps_pipe->as_failed[i].ui16_addr, ps_pipe->as_failed[i].e_device);
+            return false;
+        }
+    }
+    ps_pipe->ui8_failed = 0;
+
+    return true;
+}
+
+bool EnMtrMSP430::fw_write_image(FILE *ps_file, const fw_image_hdr_st *ps_hdr, uint8_t *pui8_chunk, fw_pipe_st *ps_pipe)
+{
+    fw_unit_st *ps_prev = NULL;
+    uint32_t    ui32_off;
+
+    for (ui32_off = 0; ui32_off < ps_hdr->ui32_length; ui32_off += FLASH_BLOCK_BYTES)
+    {
+        uint16_t aui16_data[FLASH_BLOCK_NREG];
+
+        if (false == fw_image_block(ps_file, ps_hdr, ui32_off, pui8_chunk, aui16_data))
+        {
+            return false;
+        }
+
+        for (uint8_t d = 0; d < NUM_DEVICES; d++)
+        {
+            fw_unit_st *ps_unit = fw_next_unit(ps_pipe, (device_et)d, (uint16_t)(ps_hdr->ui16_load_addr + ui32_off));
+
+            memcpy(ps_unit->aui16_data, aui16_data, sizeof(aui16_data));
+            if ((false == fw_queue(ps_pipe, ps_unit, FW_FRAME_ADDR)) ||
+                (false == fw_queue(ps_pipe, ps_unit, FW_FRAME_DATA)) ||
+                ((NULL != ps_prev) && (false == fw_queue_cmd(ps_pipe, ps_prev))) ||
+                ((0 != ps_pipe->ui8_failed) && (false == fw_retry(ps_pipe))))
+            {
+                return false;
+            }
+            ps_prev = ps_unit;
+        }
+        ps_pipe->ps_stats->ui32_blocks++;
+    }
+
+    if ((NULL != ps_prev) && (false == fw_queue_cmd(ps_pipe, ps_prev)))
+    {
+        return false;
+    }
+
+    return fw_retry(ps_pipe);
+}
+
+bool EnMtrMSP430::fw_verify_image(const fw_image_hdr_st *ps_hdr, fw_pipe_st *ps_pipe)
+{
+    for (uint8_t d = 0; d < NUM_DEVICES; d++)
+    {
+        if (false == fw_wait_ready((device_et)d, 0, ps_pipe->ps_stats))
+        {
+            return false;
+        }
+        ps_pipe->aui16_crc[d]  = crc16GetSeed();
+        ps_pipe->aui32_left[d] = ps_hdr->ui32_length;
+    }
+
+    for (uint32_t ui32_off = 0; ui32_off < ps_hdr->ui32_length; ui32_off += FLASH_BLOCK_BYTES)
+    {
+        for (uint8_t d = 0; d < NUM_DEVICES; d++)
+        {
+            fw_unit_st *ps_unit = fw_next_unit(ps_pipe, (device_et)d, (uint16_t)(ps_hdr->ui16_load_addr + ui32_off));
+
+            if ((false == fw_queue(ps_pipe, ps_unit, FW_FRAME_ADDR)) ||
+                (false == fw_queue(ps_pipe, ps_unit, FW_FRAME_READ)))
+            {
+                return false;
+            }
+        }
+    }
+
+    if ((false == fw_drain(ps_pipe)) || (true == ps_pipe->b_error))
+    {
+        LOGW("fw verify: read back failed");
+        return false;
+    }
+
+    for (uint8_t d = 0; d < NUM_DEVICES; d++)
+    {
+        if (ps_pipe->aui16_crc[d] != ps_hdr->ui16_crc)
+        {
+            LOGW("fw verify (%d): crc %04x != %04x", d, ps_pipe->aui16_crc[d], ps_hdr->ui16_crc);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+#else
+// polled command phases with their chip select delays, one block of one phase at a time
+bool EnMtrMSP430::fw_write_image(FILE *ps_file, const fw_image_hdr_st *ps_hdr, uint8_t *pui8_chunk, fw_pipe_st *ps_pipe)
+{
+    uint32_t    ui32_off;
+
+    for (ui32_off = 0; ui32_off < ps_hdr->ui32_length; ui32_off += FLASH_BLOCK_BYTES)
+    {
+        uint16_t aui16_data[FLASH_BLOCK_NREG];
+
+        if (false == fw_image_block(ps_file, ps_hdr, ui32_off, pui8_chunk, aui16_data))
+        {
+            return false;
+        }
+
+        for (uint8_t d = 0; d < NUM_DEVICES; d++)
+        {
+            fw_unit_st *ps_unit = fw_next_unit(ps_pipe, (device_et)d, (uint16_t)(ps_hdr->ui16_load_addr + ui32_off));
+
+            memcpy(ps_unit->aui16_data, aui16_data, sizeof(aui16_data));
+            if (false == fw_write_block_polled(ps_unit, ps_pipe->ps_stats))
+            {
+                LOGW("fw block %04x (%d) failed", ps_unit->ui16_addr, d);
+                return false;
+            }
+        }
+        ps_pipe->ps_stats->ui32_blocks++;
+    }
+
+    return true;
+}
+
+bool EnMtrMSP430::fw_verify_image(const fw_image_hdr_st *ps_hdr, fw_pipe_st *ps_pipe)
+{
+    uint16_t aui16_data[FLASH_BLOCK_NREG];
+
+    for (uint8_t d = 0; d < NUM_DEVICES; d++)
+    {
+        if (false == fw_wait_ready((device_et)d, 0, ps_pipe->ps_stats))
+        {
+            return false;
+        }
+        ps_pipe->aui16_crc[d]  = crc16GetSeed();
+        ps_pipe->aui32_left[d] = ps_hdr->ui32_length;
+    }
+
+    for (uint32_t ui32_off = 0; ui32_off < ps_hdr->ui32_length; ui32_off += FLASH_BLOCK_BYTES)
+    {
+        for (uint8_t d = 0; d < NUM_DEVICES; d++)
+        {
+            ps_pipe->ps_stats->ui32_frames += 2;
+            if ((false == write_reg((device_et)d, REG_ADDR_BTLDR_FLASH_ADDR, (uint16_t)(ps_hdr->ui16_load_addr + ui32_off))) ||
+                (false == read_mult_regs((device_et)d, REG_ADDR_BTLDR_FLASH_DATA_0, aui16_data, FLASH_BLOCK_NREG)))
+            {
+                LOGW("fw verify: read back failed");
+                return false;
+            }
+            fw_crc_block(ps_pipe, (device_et)d, aui16_data);
+        }
+    }
+
+    for (uint8_t d = 0; d < NUM_DEVICES; d++)
+    {
+        if (ps_pipe->aui16_crc[d] != ps_hdr->ui16_crc)
+        {
+            LOGW("fw verify (%d): crc %04x != %04x", d, ps_pipe->aui16_crc[d], ps_hdr->ui16_crc);
+            return false;
+        }
+    }
+
+    return true;
+}
+#endif
+
+bool EnMtrMSP430::update_fw(const char *pc_path, fw_update_stats_st *ps_stats)
+{
+    static fw_pipe_st   s_pipe;
+    fw_image_hdr_st     s_hdr;
+    FILE               *ps_file     = fopen(pc_path, "rb");
+    uint8_t            *pui8_chunk  = (uint8_t *)malloc(K_ENMTR_FW_READ_CHUNK);
+    uint32_t            ms_start    = millis();
+
+    memset(ps_stats, 0, sizeof(fw_update_stats_st));
+    memset(&s_pipe, 0, sizeof(s_pipe));
+    s_pipe.ps_stats = ps_stats;
+
+    if (NULL == ps_file)
+    {
+        LOGW("fw image %s not found", pc_path);
+    }
+    else if (NULL == pui8_chunk)
+    {
+        LOGE("malloc error");
+    }
+    else if (false == fw_read_header(ps_file, &s_hdr, pui8_chunk))
+    {
+        //
+    }
+    else if ((false == fw_enter_bootloader(DEVICE_PHASE_A)) ||
+             (false == fw_enter_bootloader(DEVICE_PHASE_B)) ||
+             (false == fw_enter_bootloader(DEVICE_PHASE_C)))
+    {
+        //
+    }
+    else if ((false == write_reg(DEVICE_PHASE_A, REG_ADDR_COMMAND, CMD_BTLDR_ERASE_APPCODE)) ||
+             (false == write_reg(DEVICE_PHASE_B, REG_ADDR_COMMAND, CMD_BTLDR_ERASE_APPCODE)) ||
+             (false == write_reg(DEVICE_PHASE_C, REG_ADDR_COMMAND, CMD_BTLDR_ERASE_APPCODE)) ||
+             (false == fw_wait_ready(DEVICE_PHASE_A, K_ENMTR_FW_ERASE_TIMEOUT, ps_stats)) ||
+             (false == fw_wait_ready(DEVICE_PHASE_B, K_ENMTR_FW_ERASE_TIMEOUT, ps_stats)) ||
+             (false == fw_wait_ready(DEVICE_PHASE_C, K_ENMTR_FW_ERASE_TIMEOUT, ps_stats)))
+    {
+        LOGW("app code erase failed");
+    }
+    else if (false == fw_write_image(ps_file, &s_hdr, pui8_chunk, &s_pipe))
+    {
+        LOGW("fw write failed");
+    }
+#if (1 == K_ENMTR_FW_VERIFY)
+    else if (false == fw_verify_image(&s_hdr, &s_pipe))
+    {
+        //
+    }
+#endif
+    else
+    {
+        ps_stats->b_ok = true;
+    }
+
+#if (1 == K_ENMTR_SPI_BURST)
+    // nothing may stay queued on the burst frames
+    if (false == fw_drain(&s_pipe))
+    {
+        ui8_burst_lost = drain_transfers((uint8_t)(s_pipe.ui32_queued - s_pipe.ui32_completed));
+    }
+    if (0 == ui8_burst_lost)
+    {
+        init_burst();
+    }
+#endif
+
+    if (NULL != ps_file)
+    {
+        fclose(ps_file);
+    }
+    free(pui8_chunk);
+    ps_stats->ms_elapsed = millis() - ms_start;
+
+    return ps_stats->b_ok;
+}
@@ -1,7 +1,9 @@
 
 #pragma once
 
+#include <stdio.h>
 #include "enmtr.h"
+#include "edge_payload/edge_payload_defs.h"
 
 
 class EnMtrMSP430 : public EnergyMeter
@@ -137,6 +139,152 @@ public:
         uint16_t    u16_test;   // test version
     } fw_info_st;
 
+    /* decoded measurements, see AS_MEAS_DESC */
+    typedef enum
+    {
+        MEAS_LINE_FREQ,
+        MEAS_VRMS_A,
+        MEAS_VRMS_B,
+        MEAS_IRMS_A,
+        MEAS_IRMS_B,
+        MEAS_PF_A,
+        MEAS_PF_B,
+        MEAS_WATT_A,
+        MEAS_WATT_B,
+        MEAS_VAR_A,
+        MEAS_VAR_B,
+        MEAS_VA_A,
+        MEAS_VA_B,
+        MEAS_VFUND_A,
+        MEAS_VHARM_A,
+        MEAS_VFUND_B,
+        MEAS_VHARM_B,
+        MEAS_IFUND_A,
+        MEAS_IHARM_A,
+        MEAS_IFUND_B,
+        MEAS_IHARM_B,
+        NUM_MEAS
+    } meas_et;
+
+    typedef struct
+    {
+        reg_addr_et         e_addr;     // most significant word ("_H", "_W2")
+        uint8_t             ui8_words;  // 1..3
+        bool                b_signed;
+        int32_t             si32_div;   // register units per monitor payload unit
+        ep_monitor_id_et    e_mon_id;   // instantaneous monitor id, 0 = none
+    } meas_desc_st;
+
+    // in "meas_et" order; units: 0.01 Hz, mV, mA, 0.0001, mW, mvar, mVA
+    static constexpr meas_desc_st AS_MEAS_DESC[NUM_MEAS] =
+    {
+        { REG_ADDR_LINE_FREQ,   1,  false,  1,      EP_MON_ID_GDL_LINE_FREQ },
+        { REG_ADDR_VRMS_A_H,    2,  false,  100,    EP_MON_ID_GDL_VRMS      },  // 0.1 V
+        { REG_ADDR_VRMS_B_H,    2,  false,  100,    (ep_monitor_id_et)0     },
+        { REG_ADDR_IRMS_A_H,    2,  false,  10,     EP_MON_ID_GDL_IRMS      },  // 0.01 A
+        { REG_ADDR_IRMS_B_H,    2,  false,  10,     (ep_monitor_id_et)0     },
+        { REG_ADDR_PF_A_H,      2,  true,   1,      EP_MON_ID_GDL_PF        },
+        { REG_ADDR_PF_B_H,      2,  true,   1,      (ep_monitor_id_et)0     },
+        { REG_ADDR_WATT_A_W2,   3,  true,   1000,   EP_MON_ID_GDL_WATT      },  // W
+        { REG_ADDR_WATT_B_W2,   3,  true,   1000,   (ep_monitor_id_et)0     },
+        { REG_ADDR_VAR_A_W2,    3,  true,   1000,   EP_MON_ID_GDL_VAR       },  // var
+        { REG_ADDR_VAR_B_W2,    3,  true,   1000,   (ep_monitor_id_et)0     },
+        { REG_ADDR_VA_A_W2,     3,  false,  1000,   EP_MON_ID_GDL_VA        },  // VA
+        { REG_ADDR_VA_B_W2,     3,  false,  1000,   (ep_monitor_id_et)0     },
+        { REG_ADDR_VFUND_A_H,   2,  false,  100,    EP_MON_ID_GDL_V_FUND    },
+        { REG_ADDR_VHARM_A_H,   2,  false,  100,    EP_MON_ID_GDL_VHARM     },  // order selected by REG_ADDR_HARM
+        { REG_ADDR_VFUND_B_H,   2,  false,  100,    (ep_monitor_id_et)0     },
+        { REG_ADDR_VHARM_B_H,   2,  false,  100,    (ep_monitor_id_et)0     },
+        { REG_ADDR_IFUND_A_H,   2,  false,  10,     EP_MON_ID_GDL_I_FUND    },
+        { REG_ADDR_IHARM_A_H,   2,  false,  10,     EP_MON_ID_GDL_IHARM     },
+        { REG_ADDR_IFUND_B_H,   2,  false,  10,     (ep_monitor_id_et)0     },
+        { REG_ADDR_IHARM_B_H,   2,  false,  10,     (ep_monitor_id_et)0     },
+    };
+
+    // burst read plan: the register span of the table, in command frames
+    static constexpr uint8_t    MAX_CMD_NREG        = 16;   // registers per command frame
+    static constexpr uint8_t    MEAS_BLOCK_FIRST    = []
+    {
+        uint8_t ui8_first = UINT8_MAX;
+        for (const meas_desc_st &s_desc : AS_MEAS_DESC)
+        {
+            ui8_first = (s_desc.e_addr < ui8_first) ? (uint8_t)s_desc.e_addr : ui8_first;
+        }
+        return ui8_first;
+    }();
+    static constexpr uint8_t    MEAS_BLOCK_NREG     = []
+    {
+        uint8_t ui8_end = 0;
+        for (const meas_desc_st &s_desc : AS_MEAS_DESC)
+        {
+            ui8_end = ((s_desc.e_addr + s_desc.ui8_words) > ui8_end) ? (uint8_t)(s_desc.e_addr + s_desc.ui8_words) : ui8_end;
+        }
+        return (uint8_t)(ui8_end - MEAS_BLOCK_FIRST);
+    }();
+    static constexpr uint8_t    MEAS_BLOCK_NFRAMES  = ((MEAS_BLOCK_NREG + MAX_CMD_NREG - 1) / MAX_CMD_NREG);
+
+    // decode plan: block offsets of the 3 words gathered per measurement (clamped inside the
+    // block), right shift to drop the unused words and left shift for the sign extension
+    typedef struct
+    {
+        uint8_t     aui8_off[3];
+        uint8_t     ui8_shr;
+        uint8_t     ui8_sext;
+    } meas_plan_st;
+
+    typedef struct
+    {
+        meas_plan_st    as[NUM_MEAS];
+    } meas_plans_st;
+
+    static constexpr meas_plans_st MEAS_PLAN = []
+    {
+        meas_plans_st s_plan = {};
+        for (uint8_t i = 0; i < NUM_MEAS; i++)
+        {
+            for (uint8_t w = 0; w < 3; w++)
+            {
+                uint8_t ui8_off = (uint8_t)(AS_MEAS_DESC[i].e_addr - MEAS_BLOCK_FIRST + w);
+                s_plan.as[i].aui8_off[w] = (ui8_off < MEAS_BLOCK_NREG) ? ui8_off : (uint8_t)(MEAS_BLOCK_NREG - 1);
+            }
+            s_plan.as[i].ui8_shr  = (uint8_t)(16 * (3 - AS_MEAS_DESC[i].ui8_words));
+            s_plan.as[i].ui8_sext = AS_MEAS_DESC[i].b_signed ? (uint8_t)(64 - 16 * AS_MEAS_DESC[i].ui8_words) : 0;
+        }
+        return s_plan;
+    }();
+
+    static constexpr uint8_t    READ_REPLY_OVERHEAD = (2 + 1 + 2 + 2); // cmd, dummy, crc, ack
+    static constexpr uint8_t    BURST_NFRAMES       = (MEAS_BLOCK_NFRAMES * NUM_DEVICES);
+
+    typedef struct
+    {
+        uint32_t    ui32_seq;       // snapshot sequence number, set by the publisher
+        uint32_t    ms_timestamp;   // millis() at the start of the burst
+        uint16_t    aui16_reg[NUM_DEVICES][MEAS_BLOCK_NREG]; // 0x20..0x4F, per phase
+    } meas_block_st;
+
+
+    // firmware image file: header, then the image bytes, flashed from "ui16_load_addr" on
+    typedef struct __attribute__((packed))
+    {
+        uint32_t    ui32_magic;         // K_ENMTR_FW_MAGIC
+        uint16_t    ui16_load_addr;     // flash byte address, FLASH_BLOCK_BYTES aligned
+        uint16_t    ui16_crc;           // crc16 of the image bytes
+        uint32_t    ui32_length;        // image bytes
+    } fw_image_hdr_st;
+
+    typedef struct
+    {
+        bool        b_ok;
+        uint32_t    ui32_blocks;        // flash blocks per device
+        uint32_t    ui32_frames;        // command frames (chip selects), all devices
+        uint32_t    ui32_retries;       // blocks rewritten on the polled path (busy, crc)
+        uint32_t    ms_elapsed;
+    } fw_update_stats_st;
+
+    static constexpr uint8_t    FLASH_BLOCK_NREG    = 16;   // REG_ADDR_BTLDR_FLASH_DATA_0..15
+    static constexpr uint8_t    FLASH_BLOCK_BYTES   = (2 * FLASH_BLOCK_NREG);
+
 
     fw_info_st      s_fw_info[NUM_DEVICES];
 
@@ -149,10 +297,111 @@ public:
     bool read_mult_regs(device_et e_device, reg_addr_et e_reg_addr, uint16_t *pui16_reg_val, uint8_t ui8_n_reg);
 
     bool read_versions(device_et e_device);
+    bool read_meas_block(meas_block_st *ps_block);
+
+    /* all phases from the image file, through the bootloader; the caller resets afterwards */
+    bool update_fw(const char *pc_path, fw_update_stats_st *ps_stats);
+
+    static uint16_t meas_reg(const meas_block_st *ps_block, device_et e_device, reg_addr_et e_reg_addr)
+    {
+        return ps_block->aui16_reg[e_device][(uint8_t)e_reg_addr - MEAS_BLOCK_FIRST];
+    }
+
+    /* all measurements of one phase, register units; no per-register branches */
+    static void decode_meas(const meas_block_st *ps_block, device_et e_device, int32_t *psi32_val)
+    {
+        const uint16_t *pui16_reg = ps_block->aui16_reg[e_device];
+
+        for (uint8_t i = 0; i < NUM_MEAS; i++)
+        {
+            const meas_plan_st &s_plan = MEAS_PLAN.as[i];
+            uint64_t ui64_raw = ((uint64_t)pui16_reg[s_plan.aui8_off[0]] << 32) |
+                                ((uint64_t)pui16_reg[s_plan.aui8_off[1]] << 16) |
+                                 (uint64_t)pui16_reg[s_plan.aui8_off[2]];
+            int64_t si64_val  = (int64_t)((ui64_raw >> s_plan.ui8_shr) << s_plan.ui8_sext) >> s_plan.ui8_sext;
+
+            si64_val = (si64_val > INT32_MAX) ? INT32_MAX : si64_val;
+            psi32_val[i] = (int32_t)((si64_val < INT32_MIN) ? INT32_MIN : si64_val);
+        }
+    }
 
 private:
-    void write_ss(device_et e_device, bool b_active);
+    typedef struct
+    {
+        spi_transaction_t   s_trans;        // "user" = device + 1, see "burst_pre_cb()"
+        uint8_t             ui8_offset;     // first register, relative to the measurement block
+        uint8_t             ui8_nreg;
+        uint8_t             ui8_fw_unit;    // firmware update: block in "fw_pipe_st", frame type
+        uint8_t             ui8_fw_type;
+        alignas(4) uint8_t  aui8_tx[(2 * MAX_CMD_NREG + READ_REPLY_OVERHEAD + 3) & ~3];
+        alignas(4) uint8_t  aui8_rx[(2 * MAX_CMD_NREG + READ_REPLY_OVERHEAD + 3) & ~3];
+    } burst_frame_st;
+
+    burst_frame_st  as_burst[BURST_NFRAMES]; // DMA capable as long as the object is in internal ram
+    uint8_t         ui8_burst_lost;          // frames still with the driver after an error
+
+    // firmware update: the burst frames are reused as a ring of queued command frames
+    typedef enum
+    {
+        FW_FRAME_ADDR,                      // REG_ADDR_BTLDR_FLASH_ADDR write
+        FW_FRAME_DATA,                      // REG_ADDR_BTLDR_FLASH_DATA_0..15 write
+        FW_FRAME_CMD,                       // CMD_BTLDR_WRITE_FLASH
+        FW_FRAME_READ                       // REG_ADDR_BTLDR_FLASH_DATA_0..15 read back
+    } fw_frame_et;
+
+    static constexpr uint8_t    FW_NUM_UNITS = 4;
+
+    typedef struct
+    {
+        device_et   e_device;
+        uint16_t    ui16_addr;
+        uint16_t    aui16_data[FLASH_BLOCK_NREG];
+        uint8_t     ui8_done;               // completed frames, bit per "fw_frame_et"
+        uint8_t     ui8_acked;
+    } fw_unit_st;
+
+    typedef struct
+    {
+        fw_unit_st          as_unit[FW_NUM_UNITS];      // blocks in flight, by unit number
+        uint32_t            ui32_units;
+        uint32_t            ui32_queued;                // frames, ring index into "as_burst"
+        uint32_t            ui32_completed;
+        fw_unit_st          as_failed[FW_NUM_UNITS];    // to rewrite on the polled path
+        uint8_t             ui8_failed;
+        bool                b_error;
+        uint16_t            aui16_crc[NUM_DEVICES];     // read back
+        uint32_t            aui32_left[NUM_DEVICES];
+        fw_update_stats_st *ps_stats;
+    } fw_pipe_st;
+
+    static_assert(BURST_NFRAMES > ENMTR_SPI_QUEUE_SIZE, "a frame is reused only once completed");
+
+    static void write_ss(device_et e_device, bool b_active);
+    static void burst_pre_cb(spi_transaction_t *ps_trans);
+    static void burst_post_cb(spi_transaction_t *ps_trans);
+    void init_burst();
+    void init_frame(burst_frame_st *ps_frame, device_et e_device, reg_addr_et e_reg_addr, const uint16_t *pui16_data, uint8_t ui8_nreg);
     bool send_cmd(device_et e_device, command_et e_cmd, reg_addr_et e_reg_addr, uint16_t *pui16_reg_data, uint8_t ui8_nreg);
+    bool parse_read_reply(device_et e_device, command_et e_cmd, reg_addr_et e_reg_addr, const uint8_t *pui8_reply, uint16_t *pui16_reg_data, uint8_t ui8_nreg);
     bool init_config(device_et e_device);
 
+    bool fw_read_header(FILE *ps_file, fw_image_hdr_st *ps_hdr, uint8_t *pui8_chunk);
+    bool fw_enter_bootloader(device_et e_device);
+    bool fw_wait_ready(device_et e_device, uint32_t ms_timeout, fw_update_stats_st *ps_stats);
+    bool fw_write_block_polled(const fw_unit_st *ps_unit, fw_update_stats_st *ps_stats);
+    bool fw_image_block(FILE *ps_file, const fw_image_hdr_st *ps_hdr, uint32_t ui32_off, uint8_t *pui8_chunk, uint16_t *pui16_data);
+    void fw_crc_block(fw_pipe_st *ps_pipe, device_et e_device, const uint16_t *pui16_data);
+    bool fw_queue(fw_pipe_st *ps_pipe, fw_unit_st *ps_unit, fw_frame_et e_type);
+    void fw_add_failed(fw_pipe_st *ps_pipe, const fw_unit_st *ps_unit);
+    bool fw_complete(fw_pipe_st *ps_pipe);
+    bool fw_drain(fw_pipe_st *ps_pipe);
+    bool fw_queue_cmd(fw_pipe_st *ps_pipe, fw_unit_st *ps_unit);
+    bool fw_retry(fw_pipe_st *ps_pipe);
+    fw_unit_st *fw_next_unit(fw_pipe_st *ps_pipe, device_et e_device, uint16_t ui16_addr);
+    bool fw_write_image(FILE *ps_file, const fw_image_hdr_st *ps_hdr, uint8_t *pui8_chunk, fw_pipe_st *ps_pipe);
+    bool fw_verify_image(const fw_image_hdr_st *ps_hdr, fw_pipe_st *ps_pipe);
+
 };
+
+static_assert((EnMtrMSP430::REG_ADDR_LINE_FREQ == EnMtrMSP430::MEAS_BLOCK_FIRST) && (0x30 == EnMtrMSP430::MEAS_BLOCK_NREG),
+              "measurement block is polled as 0x20..0x4F");
@@ -0,0 +1,207 @@
+/*****************************************************************************************//**
+* \file         harmonics.c
+*
+* \brief        Harmonic & THD aggregation library source file.
+* \details      Per order ratios to the fundamental, per interval min/max/mean and THD, all
+*               in unsigned Q15 (0x8000 = 100 %, saturating at 0xFFFF).
+*
+* \version      v00.01.00
+* \date         20261017
+*********************************************************************************************/
+/*
+ * Included Modules
+ */
+#include "global_defs.h"
+#include "harmonics.h"
+
+/*
+ * Local Constants
+ */
+static const uint8_t    UI8_HARM_NUM_ORDERS     = (uint8_t)K_HARM_NUM_ORDERS;
+
+/*
+ * Private Functions
+ */
+static uint32_t isqrt64(uint64_t ui64_val)
+{
+    uint64_t ui64_res = 0;
+    uint64_t ui64_bit = (uint64_t)1 << 62;
+
+    while (ui64_bit > ui64_val)
+    {
+        ui64_bit >>= 2;
+    }
+
+    while (0 != ui64_bit)
+    {
+        if (ui64_val >= (ui64_res + ui64_bit))
+        {
+            ui64_val -= ui64_res + ui64_bit;
+            ui64_res  = (ui64_res >> 1) + ui64_bit;
+        }
+        else
+        {
+            ui64_res >>= 1;
+        }
+        ui64_bit >>= 2;
+    }
+
+    return (uint32_t)ui64_res;
+}
+
+/*
+ * Public Functions
+ */
+
+/* harmonic / fundamental; 32 bit arithmetic only (no 64 bit division on the ESP32) */
+uint16_t harmRatioQ15(uint32_t ui32_fund, uint32_t ui32_harm)
+{
+    if (0 == ui32_fund)
+    {
+        return 0;
+    }
+    else if ((ui32_harm >> 1) >= ui32_fund)
+    {
+        return UINT16_MAX;  // saturate at 200 %
+    }
+
+    // keep (harm << 15) within 32 bit: harm < 2 * fund <= 2^17
+    while (ui32_fund > 0xFFFFUL)
+    {
+        ui32_fund >>= 1;
+        ui32_harm >>= 1;
+    }
+
+    ui32_harm = (ui32_harm << 15) / ui32_fund;
+
+    return (ui32_harm > UINT16_MAX) ? UINT16_MAX : (uint16_t)ui32_harm;
+}
+
+/* sqrt(sum(ratio^2)), Q30 sum */
+uint16_t harmThdQ15(const uint16_t *pui16_ratio_q15, uint8_t ui8_count)
+{
+    uint64_t ui64_sum = 0;
+    uint32_t ui32_thd;
+
+    for (uint8_t i = 0; i < ui8_count; i++)
+    {
+        ui64_sum += (uint32_t)pui16_ratio_q15[i] * pui16_ratio_q15[i];
+    }
+
+    ui32_thd = isqrt64(ui64_sum);
+
+    return (ui32_thd > UINT16_MAX) ? UINT16_MAX : (uint16_t)ui32_thd;
+}
+
+/* payload unit: 0.01 % of the fundamental */
+uint16_t harmQ15ToCentiPercent(uint16_t ui16_q15)
+{
+    return (uint16_t)((((uint32_t)ui16_q15 * 10000UL) + (K_HARM_Q15_ONE / 2)) >> 15);
+}
+
+void harmStatReset(harm_stat_st *ps_stat)
+{
+    ps_stat->ui16_min   = UINT16_MAX;
+    ps_stat->ui16_max   = 0;
+    ps_stat->ui32_sum   = 0;
+    ps_stat->ui16_count = 0;
+}
+
+void harmStatAdd(harm_stat_st *ps_stat, uint16_t ui16_value)
+{
+    if (UINT16_MAX == ps_stat->ui16_count)
+    {
+        return; // interval too long, keep the statistics of the first 65535 samples
+    }
+
+    ps_stat->ui16_min  = (ui16_value < ps_stat->ui16_min) ? ui16_value : ps_stat->ui16_min;
+    ps_stat->ui16_max  = (ui16_value > ps_stat->ui16_max) ? ui16_value : ps_stat->ui16_max;
+    ps_stat->ui32_sum += ui16_value;
+    ps_stat->ui16_count++;
+}
+
+uint16_t harmStatMean(const harm_stat_st *ps_stat)
+{
+    if (0 == ps_stat->ui16_count)
+    {
+        return 0;
+    }
+
+    return (uint16_t)((ps_stat->ui32_sum + (ps_stat->ui16_count / 2)) / ps_stat->ui16_count);
+}
+
+void harmPhaseInit(harm_phase_st *ps_phase)
+{
+    memset(ps_phase, 0, sizeof(harm_phase_st));
+    harmPhaseNewInterval(ps_phase);
+}
+
+/* restart the min/max/mean statistics; the latest ratios are kept for the THD */
+void harmPhaseNewInterval(harm_phase_st *ps_phase)
+{
+    for (uint8_t i = 0; i < UI8_HARM_NUM_ORDERS; i++)
+    {
+        harmStatReset(&ps_phase->as_v[i]);
+        harmStatReset(&ps_phase->as_i[i]);
+    }
+    harmStatReset(&ps_phase->s_vthd);
+    harmStatReset(&ps_phase->s_ithd);
+}
+
+/* one order of one phase; the THD is updated each time the order sweep completes */
+void harmPhaseAdd(harm_phase_st *ps_phase, uint8_t ui8_order_idx, uint32_t ui32_vfund, uint32_t ui32_vharm, uint32_t ui32_ifund, uint32_t ui32_iharm)
+{
+    if (ui8_order_idx >= UI8_HARM_NUM_ORDERS)
+    {
+        return;
+    }
+
+    ps_phase->aui16_v_q15[ui8_order_idx] = harmRatioQ15(ui32_vfund, ui32_vharm);
+    ps_phase->aui16_i_q15[ui8_order_idx] = harmRatioQ15(ui32_ifund, ui32_iharm);
+    ps_phase->ui16_valid_mask |= (uint16_t)(1u << ui8_order_idx);
+
+    harmStatAdd(&ps_phase->as_v[ui8_order_idx], ps_phase->aui16_v_q15[ui8_order_idx]);
+    harmStatAdd(&ps_phase->as_i[ui8_order_idx], ps_phase->aui16_i_q15[ui8_order_idx]);
+
+    if (((UI8_HARM_NUM_ORDERS - 1) == ui8_order_idx) && (K_HARM_ALL_ORDERS_MASK == ps_phase->ui16_valid_mask))
+    {
+        harmStatAdd(&ps_phase->s_vthd, harmThdQ15(ps_phase->aui16_v_q15, UI8_HARM_NUM_ORDERS));
+        harmStatAdd(&ps_phase->s_ithd, harmThdQ15(ps_phase->aui16_i_q15, UI8_HARM_NUM_ORDERS));
+    }
+}
+
+/* interval means into the open monitor phase of ps_writer: V/I 3rd..21st harmonic & THD, 0.01 %; only the
+   THD when the orders don't fit the phase (31 parameters without K_PAYLOAD_SPLIT_PHASE_GROUPS) */
+bool harmAddMonitorParams(ep_writer_st *ps_writer, const harm_phase_st *ps_phase)
+{
+    bool    b_status    = true;
+    bool    b_orders;
+    uint8_t ui8_needed  = (0 != ps_phase->s_vthd.ui16_count) ? 2 : 0;
+
+    for (uint8_t i = 0; i < UI8_HARM_NUM_ORDERS; i++)
+    {
+        ui8_needed += (0 != ps_phase->as_v[i].ui16_count) ? 2 : 0;
+    }
+    b_orders = (edgePayloadWriterPhaseRoom(ps_writer) >= ui8_needed);
+
+    for (uint8_t i = 0; (true == b_orders) && (true == b_status) && (i < UI8_HARM_NUM_ORDERS); i++)
+    {
+        if (0 == ps_phase->as_v[i].ui16_count)
+        {
+            continue;
+        }
+
+        b_status = edgePayloadWriteMonitorParam(ps_writer, (ep_monitor_id_et)(EP_MON_ID_GDL_V_3RD_HARM + i),
+                                                harmQ15ToCentiPercent(harmStatMean(&ps_phase->as_v[i]))) &&
+                   edgePayloadWriteMonitorParam(ps_writer, (ep_monitor_id_et)(EP_MON_ID_GDL_I_3RD_HARM + i),
+                                                harmQ15ToCentiPercent(harmStatMean(&ps_phase->as_i[i])));
+    }
+
+    if ((true == b_status) && (0 != ps_phase->s_vthd.ui16_count))
+    {
+        b_status = edgePayloadWriteMonitorParam(ps_writer, EP_MON_ID_GDL_VTHD, harmQ15ToCentiPercent(harmStatMean(&ps_phase->s_vthd))) &&
+                   edgePayloadWriteMonitorParam(ps_writer, EP_MON_ID_GDL_ITHD, harmQ15ToCentiPercent(harmStatMean(&ps_phase->s_ithd)));
+    }
+
+    return b_status;
+}
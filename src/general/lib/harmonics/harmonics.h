@@ -0,0 +1,85 @@
+/*****************************************************************************************//**
+* \file         harmonics.h
+*
+* \brief        Harmonic & THD aggregation library header file.
+* \details      Q15 fixed point: ratios to the fundamental, 0x8000 = 100 %. Integer only, no
+*               FPU use so it can run from any context.
+*
+* \version      v00.01.00
+* \date         20261017
+*********************************************************************************************/
+// *INDENT-OFF*
+#ifndef __HARMONICS_H__
+#define __HARMONICS_H__
+// *INDENT-ON*
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Include .h Library Files
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "harmonics_cfg.h"
+#include "edge_payload/edge_payload.h"
+
+/*
+ * Global Constants
+ */
+#define K_HARM_Q15_ONE                  (0x8000)
+#define K_HARM_ALL_ORDERS_MASK          ((uint16_t)((1u << K_HARM_NUM_ORDERS) - 1))
+
+/*
+ * Global Structs
+ */
+typedef struct
+{
+    uint16_t        ui16_min;
+    uint16_t        ui16_max;
+    uint32_t        ui32_sum;
+    uint16_t        ui16_count;
+} harm_stat_st;
+
+typedef struct
+{
+    uint16_t        aui16_v_q15[K_HARM_NUM_ORDERS];     // latest ratio per order
+    uint16_t        aui16_i_q15[K_HARM_NUM_ORDERS];
+    uint16_t        ui16_valid_mask;                    // orders with a latest ratio
+
+    harm_stat_st    as_v[K_HARM_NUM_ORDERS];            // current interval
+    harm_stat_st    as_i[K_HARM_NUM_ORDERS];
+    harm_stat_st    s_vthd;
+    harm_stat_st    s_ithd;
+} harm_phase_st;
+
+/*
+ * Public Function Prototypes
+ */
+uint16_t harmRatioQ15(uint32_t ui32_fund, uint32_t ui32_harm);
+uint16_t harmThdQ15(const uint16_t *pui16_ratio_q15, uint8_t ui8_count);
+uint16_t harmQ15ToCentiPercent(uint16_t ui16_q15);
+
+void harmStatReset(harm_stat_st *ps_stat);
+void harmStatAdd(harm_stat_st *ps_stat, uint16_t ui16_value);
+uint16_t harmStatMean(const harm_stat_st *ps_stat);
+
+void harmPhaseInit(harm_phase_st *ps_phase);
+void harmPhaseNewInterval(harm_phase_st *ps_phase);
+void harmPhaseAdd(harm_phase_st *ps_phase, uint8_t ui8_order_idx, uint32_t ui32_vfund, uint32_t ui32_vharm, uint32_t ui32_ifund, uint32_t ui32_iharm);
+
+bool harmAddMonitorParams(ep_writer_st *ps_writer, const harm_phase_st *ps_phase);
+
+static inline uint8_t harmOrder(uint8_t ui8_order_idx)
+{
+    return (uint8_t)(K_HARM_FIRST_ORDER + (2 * ui8_order_idx));
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif/* end of harmonics.h */
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,368 @@
+/*****************************************************************************************//**
+* \file         journal.c
+*
+* \brief        Write-ahead journal library source file.
+* \details      A sector holds a chain of entries from its start, each the sequence number of
+*               the one before + 1. Writing into a reused sector leaves the older entries
+*               behind the new ones, their sequence numbers end the chain; so does an entry cut
+*               by a reset (crc).
+*
+* \version      v00.01.00
+* \date         20261017
+*********************************************************************************************/
+/*
+ * Included Modules
+ */
+#include "global_defs.h"
+#include <stdio.h>
+#include "journal.h"
+
+/*
+ * Local Constants
+ */
+#define K_JOURNAL_MAGIC                 (0x4A4EU)       // "NJ"
+
+static const uint32_t   MS_JOURNAL_SYNC = (uint32_t)K_JOURNAL_SYNC_MIN * 60UL * 1000UL;
+
+_Static_assert(sizeof(journal_entry_hdr_st) == K_JOURNAL_ENTRY_HDR_LEN, "journal entry header layout");
+
+/*
+ * Private Functions
+ */
+static uint16_t entryCrc(uint8_t *pui8_entry, uint16_t ui16_len)
+{
+    return crc16CalcBlock(&pui8_entry[offsetof(journal_entry_hdr_st, ui16_len)],
+                          (uint16_t)(K_JOURNAL_ENTRY_HDR_LEN - offsetof(journal_entry_hdr_st, ui16_len) + ui16_len));
+}
+
+/* a short file reads as empty sectors */
+static void readSector(journal_st *ps_journal, FILE *ps_file, uint8_t ui8_sector)
+{
+    memset(ps_journal->aui8_sector, 0, sizeof(ps_journal->aui8_sector));
+    if (0 == fseek(ps_file, (long)ui8_sector * K_JOURNAL_SECTOR_SIZE, SEEK_SET))
+    {
+        (void)fread(ps_journal->aui8_sector, 1, sizeof(ps_journal->aui8_sector), ps_file);
+    }
+}
+
+/* entry at ui16_off of the sector read, with sequence number ui32_seq unless 0 */
+static bool chainEntry(journal_st *ps_journal, uint16_t ui16_off, uint32_t ui32_seq, journal_entry_hdr_st *ps_hdr)
+{
+    if ((ui16_off + K_JOURNAL_ENTRY_HDR_LEN) > K_JOURNAL_SECTOR_SIZE)
+    {
+        return false;
+    }
+
+    memcpy(ps_hdr, &ps_journal->aui8_sector[ui16_off], sizeof(journal_entry_hdr_st));
+
+    return (K_JOURNAL_MAGIC == ps_hdr->ui16_magic) &&
+           (ps_hdr->ui8_stream < JOURNAL_NUM_STREAMS) &&
+           (ps_hdr->ui16_len <= (K_JOURNAL_SECTOR_SIZE - K_JOURNAL_ENTRY_HDR_LEN - ui16_off)) &&
+           (0 != ps_hdr->ui32_seq) && ((0 == ui32_seq) || (ui32_seq == ps_hdr->ui32_seq)) &&
+           (entryCrc(&ps_journal->aui8_sector[ui16_off], ps_hdr->ui16_len) == ps_hdr->ui16_crc);
+}
+
+/* chain of the sector read, its end offset */
+static uint16_t walkChain(journal_st *ps_journal, uint8_t ui8_sector, uint32_t *pui32_first, uint32_t *pui32_last)
+{
+    journal_entry_hdr_st    s_hdr;
+    uint16_t                ui16_off = 0;
+
+    *pui32_first = 0;
+    *pui32_last  = 0;
+    while (true == chainEntry(ps_journal, ui16_off, (0 == *pui32_last) ? 0 : (*pui32_last + 1), &s_hdr))
+    {
+        *pui32_first = (0 == *pui32_first) ? s_hdr.ui32_seq : *pui32_first;
+        *pui32_last  = s_hdr.ui32_seq;
+        ps_journal->aui32_last[ui8_sector][s_hdr.ui8_stream] = s_hdr.ui32_seq;
+        ui16_off += K_JOURNAL_ENTRY_HDR_LEN + s_hdr.ui16_len;
+    }
+
+    // the next entry of the chain, but cut
+    if ((0 != *pui32_last) && ((ui16_off + K_JOURNAL_ENTRY_HDR_LEN) <= K_JOURNAL_SECTOR_SIZE) &&
+        (K_JOURNAL_MAGIC == s_hdr.ui16_magic) && ((*pui32_last + 1) == s_hdr.ui32_seq))
+    {
+        ps_journal->ui32_torn++;
+    }
+
+    return ui16_off;
+}
+
+/* image of a sector written to; the stage holds them in file order from the first one with
+   staged entries, a single write unless the file wraps */
+static uint8_t *sectorImage(journal_st *ps_journal, uint8_t ui8_sector)
+{
+    if (NULL == ps_journal->pui8_stage)
+    {
+        return ps_journal->aui8_sector;
+    }
+
+    return &ps_journal->pui8_stage[(size_t)((ui8_sector + K_JOURNAL_SECTORS - ps_journal->ui8_synced_sector) % K_JOURNAL_SECTORS) * K_JOURNAL_SECTOR_SIZE];
+}
+
+/* sectors holding staged entries, the one written to included */
+static uint8_t stagedSectors(const journal_st *ps_journal)
+{
+    return (uint8_t)(((ps_journal->ui8_sector + K_JOURNAL_SECTORS - ps_journal->ui8_synced_sector) % K_JOURNAL_SECTORS) + 1);
+}
+
+/* the staged entries of the sector images, one file write */
+static bool writeStaged(journal_st *ps_journal)
+{
+    uint8_t     ui8_sector = ps_journal->ui8_synced_sector;
+    uint16_t    ui16_from  = ps_journal->ui16_synced;
+    uint8_t     ui8_staged = stagedSectors(ps_journal);
+    FILE       *ps_file;
+    bool        b_status   = true;
+
+    if ((ui8_sector == ps_journal->ui8_sector) && (ui16_from == ps_journal->ui16_off))
+    {
+        return true;
+    }
+
+    ps_file = fopen(ps_journal->pc_path, "r+b");
+    if (NULL == ps_file)
+    {
+        ps_file = fopen(ps_journal->pc_path, "w+b");
+    }
+
+    if (NULL == ps_file)
+    {
+        ps_journal->ui32_write_errors++;
+        return false;
+    }
+
+    // full sectors to their end: what's behind the last entry was cleared; split where the file wraps
+    for (uint8_t n = ui8_staged; (true == b_status) && (0 != n); )
+    {
+        uint8_t     ui8_run = ((ui8_sector + n) > K_JOURNAL_SECTORS) ? (uint8_t)(K_JOURNAL_SECTORS - ui8_sector) : n;
+        size_t      sz_to   = (ui8_run == n) ? ((size_t)(n - 1) * K_JOURNAL_SECTOR_SIZE + ps_journal->ui16_off) :
+                                               ((size_t)ui8_run * K_JOURNAL_SECTOR_SIZE);
+
+        b_status = (sz_to == ui16_from) ||
+                   ((0 == fseek(ps_file, (long)ui8_sector * K_JOURNAL_SECTOR_SIZE + ui16_from, SEEK_SET)) &&
+                    (1 == fwrite(&sectorImage(ps_journal, ui8_sector)[ui16_from], sz_to - ui16_from, 1, ps_file)));
+        ui8_sector = (uint8_t)((ui8_sector + ui8_run) % K_JOURNAL_SECTORS);
+        ui16_from  = 0;
+        n         -= ui8_run;
+    }
+    b_status = (0 == fclose(ps_file)) && b_status;
+
+    if (false == b_status)
+    {
+        ps_journal->ui32_write_errors++;
+        return false;
+    }
+
+    // the sector written to becomes the first image
+    if (1 < ui8_staged)
+    {
+        memmove(ps_journal->pui8_stage, sectorImage(ps_journal, ps_journal->ui8_sector), K_JOURNAL_SECTOR_SIZE);
+    }
+    ps_journal->ui8_synced_sector = ps_journal->ui8_sector;
+    ps_journal->ui16_synced       = ps_journal->ui16_off;
+    ps_journal->ui32_syncs++;
+
+    return true;
+}
+
+/*
+ * Public Functions
+ */
+/* entries of every sector to pf_replay, oldest first; the journal goes on after the newest.
+   Entries a stream doesn't need before its first needed one are released. False: no journal
+   file yet. */
+bool journalOpen(journal_st *ps_journal, const char *pc_path, journal_replay_pt pf_replay, void *pv_ctx)
+{
+    uint32_t    aui32_first[K_JOURNAL_SECTORS];
+    uint32_t    ui32_newest = 0;
+    bool        ab_needed[JOURNAL_NUM_STREAMS] = { false };
+    FILE       *ps_file;
+
+    memset(ps_journal, 0, sizeof(journal_st));
+    ps_journal->pc_path  = pc_path;
+    ps_journal->ui32_seq = 1;
+
+    ps_file = fopen(pc_path, "rb");
+    if (NULL == ps_file)
+    {
+        return false;
+    }
+
+    for (uint8_t s = 0; s < K_JOURNAL_SECTORS; s++)
+    {
+        uint32_t ui32_last;
+        uint16_t ui16_end;
+
+        readSector(ps_journal, ps_file, s);
+        ui16_end = walkChain(ps_journal, s, &aui32_first[s], &ui32_last);
+        if (ui32_last > ui32_newest)
+        {
+            ui32_newest           = ui32_last;
+            ps_journal->ui8_sector = s;
+            ps_journal->ui16_off   = ui16_end;
+            ps_journal->ui32_seq   = ui32_last + 1;
+        }
+    }
+
+    for (uint8_t n = 0; n < K_JOURNAL_SECTORS; n++)
+    {
+        journal_entry_hdr_st    s_hdr;
+        int16_t                 si16_oldest = -1;
+        uint16_t                ui16_off = 0;
+
+        for (uint8_t s = 0; s < K_JOURNAL_SECTORS; s++)
+        {
+            if ((0 != aui32_first[s]) && ((si16_oldest < 0) || (aui32_first[s] < aui32_first[si16_oldest])))
+            {
+                si16_oldest = s;
+            }
+        }
+        if (si16_oldest < 0)
+        {
+            break;
+        }
+
+        readSector(ps_journal, ps_file, (uint8_t)si16_oldest);
+        while (true == chainEntry(ps_journal, ui16_off, aui32_first[si16_oldest], &s_hdr))
+        {
+            journal_stream_et e_stream = (journal_stream_et)s_hdr.ui8_stream;
+
+            if (true == pf_replay(pv_ctx, e_stream, s_hdr.ui32_seq, &ps_journal->aui8_sector[ui16_off + K_JOURNAL_ENTRY_HDR_LEN], s_hdr.ui16_len))
+            {
+                ab_needed[e_stream] = true;
+            }
+            else if (false == ab_needed[e_stream])
+            {
+                ps_journal->aui32_released[e_stream] = s_hdr.ui32_seq;
+            }
+            ps_journal->ui32_replayed++;
+            aui32_first[si16_oldest]++;
+            ui16_off += K_JOURNAL_ENTRY_HDR_LEN + s_hdr.ui16_len;
+        }
+        aui32_first[si16_oldest] = 0;
+    }
+    fclose(ps_file);
+    ps_journal->ui8_synced_sector = ps_journal->ui8_sector;
+    ps_journal->ui16_synced       = ps_journal->ui16_off;
+
+    return true;
+}
+
+/* pui8_pre & pui8_data as one entry, staged for journalSync(); false if the next sector still
+   holds needed entries, or the staged ones had to be written first and that failed */
+bool journalAppend(journal_st *ps_journal, journal_stream_et e_stream, const uint8_t *pui8_pre, uint16_t ui16_pre_len,
+                   const uint8_t *pui8_data, uint16_t ui16_data_len, uint32_t *pui32_seq)
+{
+    journal_entry_hdr_st    s_hdr;
+    uint8_t                 ui8_sector = ps_journal->ui8_sector;
+    uint16_t                ui16_len   = ui16_pre_len + ui16_data_len;
+    uint8_t                *pui8_entry;
+
+    if ((ui16_pre_len > K_JOURNAL_MAX_DATA_LEN) || (ui16_data_len > (K_JOURNAL_MAX_DATA_LEN - ui16_pre_len)))
+    {
+        return false;
+    }
+
+    if ((ps_journal->ui16_off + K_JOURNAL_ENTRY_HDR_LEN + ui16_len) > K_JOURNAL_SECTOR_SIZE)
+    {
+        ui8_sector = (uint8_t)((ui8_sector + 1) % K_JOURNAL_SECTORS);
+        for (uint8_t st = 0; st < JOURNAL_NUM_STREAMS; st++)
+        {
+            if (ps_journal->aui32_last[ui8_sector][st] > ps_journal->aui32_released[st])
+            {
+                ps_journal->ui32_full++;
+                return false;
+            }
+        }
+        if ((NULL == ps_journal->pui8_stage) || (stagedSectors(ps_journal) >= ps_journal->ui8_stage_sectors))
+        {
+            if (false == writeStaged(ps_journal))
+            {
+                return false;
+            }
+            ps_journal->ui8_synced_sector = ui8_sector;
+            ps_journal->ui16_synced       = 0;
+        }
+        else
+        {
+            memset(&sectorImage(ps_journal, ps_journal->ui8_sector)[ps_journal->ui16_off], 0, K_JOURNAL_SECTOR_SIZE - ps_journal->ui16_off);
+        }
+
+        memset(ps_journal->aui32_last[ui8_sector], 0, sizeof(ps_journal->aui32_last[ui8_sector]));
+        ps_journal->ui8_sector = ui8_sector;
+        ps_journal->ui16_off   = 0;
+    }
+
+    pui8_entry = &sectorImage(ps_journal, ui8_sector)[ps_journal->ui16_off];
+    memset(&s_hdr, 0, sizeof(s_hdr));
+    s_hdr.ui16_magic = K_JOURNAL_MAGIC;
+    s_hdr.ui16_len   = ui16_len;
+    s_hdr.ui8_stream = (uint8_t)e_stream;
+    s_hdr.ui32_seq   = ps_journal->ui32_seq;
+    memcpy(pui8_entry, &s_hdr, sizeof(s_hdr));
+    if (0 != ui16_pre_len)
+    {
+        memcpy(&pui8_entry[K_JOURNAL_ENTRY_HDR_LEN], pui8_pre, ui16_pre_len);
+    }
+    memcpy(&pui8_entry[K_JOURNAL_ENTRY_HDR_LEN + ui16_pre_len], pui8_data, ui16_data_len);
+    s_hdr.ui16_crc = entryCrc(pui8_entry, ui16_len);
+    memcpy(pui8_entry, &s_hdr, sizeof(s_hdr));
+
+    ps_journal->aui32_last[ui8_sector][e_stream] = s_hdr.ui32_seq;
+    ps_journal->ui16_off = (uint16_t)(ps_journal->ui16_off + K_JOURNAL_ENTRY_HDR_LEN + ui16_len);
+    ps_journal->ui32_seq++;
+    ps_journal->ui32_appends++;
+
+    if (NULL != pui32_seq)
+    {
+        *pui32_seq = s_hdr.ui32_seq;
+    }
+
+    return true;
+}
+
+/* the stream's entries up to ui32_seq are stored elsewhere */
+void journalRelease(journal_st *ps_journal, journal_stream_et e_stream, uint32_t ui32_seq)
+{
+    if (ui32_seq > ps_journal->aui32_released[e_stream])
+    {
+        ps_journal->aui32_released[e_stream] = ui32_seq;
+    }
+}
+
+/* after journalOpen(): entries staged in the images of up to ui8_sectors sectors, written with
+   the next sync unless the stage is full; false (nothing changed) for less than 2 or all the
+   sectors, or if the entries staged so far couldn't be written */
+bool journalStage(journal_st *ps_journal, uint8_t *pui8_sectors, uint8_t ui8_sectors)
+{
+    if ((NULL == pui8_sectors) || (ui8_sectors < 2) || (ui8_sectors >= K_JOURNAL_SECTORS) ||
+        (false == writeStaged(ps_journal)))
+    {
+        return false;
+    }
+
+    ps_journal->pui8_stage        = pui8_sectors;
+    ps_journal->ui8_stage_sectors = ui8_sectors;
+
+    return true;
+}
+
+/* K_JOURNAL_SYNC_MIN since the last due journalSync() */
+bool journalDue(const journal_st *ps_journal, uint32_t ms_now)
+{
+    return (ms_now - ps_journal->ms_synced) >= MS_JOURNAL_SYNC;
+}
+
+/* staged entries to the file when forced or due; false if that write failed, they stay staged */
+bool journalSync(journal_st *ps_journal, uint32_t ms_now, bool b_force)
+{
+    if ((false == b_force) && (false == journalDue(ps_journal, ms_now)))
+    {
+        return true;
+    }
+
+    ps_journal->ms_synced = ms_now;
+
+    return writeStaged(ps_journal);
+}
@@ -0,0 +1,104 @@
+/*****************************************************************************************//**
+* \file         journal.h
+*
+* \brief        Write-ahead journal library header file.
+* \details      Fixed size file of K_JOURNAL_SECTORS sectors used as a ring: entries with a
+*               sequence number & crc16 for the state that only lives in RAM until its own
+*               file is written (data log RAM page, energy registers). Entries are staged in
+*               the sector image and written together by journalSync(), one sector write per
+*               interval or K_JOURNAL_SYNC_MIN; with a stage ring attached (journalStage()) the staged
+*               entries span up to its sectors, a full sector waits for the next sync as
+*               well. A stream releases its entries once they are stored
+*               elsewhere, a sector is reused when all of its entries are released. The
+*               restore reads the file twice, whatever was logged before.
+*
+* \version      v00.01.00
+* \date         20261017
+*********************************************************************************************/
+// *INDENT-OFF*
+#ifndef __JOURNAL_H__
+#define __JOURNAL_H__
+// *INDENT-ON*
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Include .h Library Files
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "journal_cfg.h"
+
+/*
+ * Global Constants
+ */
+#define K_JOURNAL_ENTRY_HDR_LEN         (12)
+#define K_JOURNAL_MAX_DATA_LEN          (K_JOURNAL_SECTOR_SIZE - K_JOURNAL_ENTRY_HDR_LEN)
+
+typedef enum
+{
+    JOURNAL_STREAM_DLOG,                            // data log records of the RAM page
+    JOURNAL_STREAM_ENERGY,                          // energy register snapshots
+    JOURNAL_NUM_STREAMS
+} journal_stream_et;
+
+/*
+ * Global Structs
+ */
+typedef struct
+{
+    uint16_t    ui16_magic;
+    uint16_t    ui16_crc;                           // rest of the header and the data
+    uint16_t    ui16_len;                           // data bytes
+    uint8_t     ui8_stream;
+    uint8_t     ui8_reserved;
+    uint32_t    ui32_seq;                           // +1 per entry, over all sectors
+} journal_entry_hdr_st;
+
+/* restore: an entry in sequence order, false if the stream no longer needs it */
+typedef bool (*journal_replay_pt)(void *pv_ctx, journal_stream_et e_stream, uint32_t ui32_seq, const uint8_t *pui8_data, uint16_t ui16_len);
+
+typedef struct
+{
+    const char     *pc_path;
+    uint8_t         ui8_sector;                     // written
+    uint16_t        ui16_off;                       // next entry in it
+    uint8_t         ui8_synced_sector;              // entries from here ...
+    uint16_t        ui16_synced;                    // ... to ui16_off of ui8_sector only staged
+    uint32_t        ms_synced;                      // last journalSync() that was due
+    uint32_t        ui32_seq;                       // of the next entry
+    uint32_t        aui32_last[K_JOURNAL_SECTORS][JOURNAL_NUM_STREAMS];    // last entry of each stream, 0 none
+    uint32_t        aui32_released[JOURNAL_NUM_STREAMS];                    // entries up to this one
+    uint8_t         aui8_sector[K_JOURNAL_SECTOR_SIZE];                     // the sector written, the sector restored
+    uint8_t        *pui8_stage;                     // images of the sectors written, NULL: aui8_sector
+    uint8_t         ui8_stage_sectors;
+
+    // statistics
+    uint32_t        ui32_appends;
+    uint32_t        ui32_syncs;                     // writes of staged entries
+    uint32_t        ui32_full;                      // no released sector to go on
+    uint32_t        ui32_write_errors;
+    uint32_t        ui32_replayed;                  // restore: entries passed on ...
+    uint32_t        ui32_torn;                      // ... sectors ending in a broken entry
+} journal_st;
+
+/*
+ * Public Function Prototypes
+ */
+bool journalOpen(journal_st *ps_journal, const char *pc_path, journal_replay_pt pf_replay, void *pv_ctx);
+bool journalAppend(journal_st *ps_journal, journal_stream_et e_stream, const uint8_t *pui8_pre, uint16_t ui16_pre_len,
+                   const uint8_t *pui8_data, uint16_t ui16_data_len, uint32_t *pui32_seq);
+void journalRelease(journal_st *ps_journal, journal_stream_et e_stream, uint32_t ui32_seq);
+bool journalStage(journal_st *ps_journal, uint8_t *pui8_sectors, uint8_t ui8_sectors);
+bool journalDue(const journal_st *ps_journal, uint32_t ms_now);
+bool journalSync(journal_st *ps_journal, uint32_t ms_now, bool b_force);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif/* end of journal.h */
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------
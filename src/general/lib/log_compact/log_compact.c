@@ -0,0 +1,403 @@
+/*****************************************************************************************//**
+* \file         log_compact.c
+*
+* \brief        Data log retention compaction library source file.
+* \details      A tier is full one segment before its limit; then, or once the next segment's
+*               first record is K_COMPACT_TIER_AGE_DAYS behind the newest record of the first
+*               tier (the oldest segment's records all older), its oldest segment is read up
+*               to the bucket boundary after the next segment's first record, so the bucket it
+*               ends in is complete. Each bucket of the next tier's period becomes one monitor
+*               payload stamped with the bucket start: per phase & id the mean, min, max or last
+*               value of the records that had it. The next tier is flushed before the segment
+*               is dropped; a job cut by a reset starts again after the newest record there.
+*
+* \version      v00.01.00
+* \date         20261017
+*********************************************************************************************/
+/*
+ * Included Modules
+ */
+#include "global_defs.h"
+#include "log_compact.h"
+
+/*
+ * Local Constants
+ */
+static const int32_t    ASI32_BUCKET_S[K_COMPACT_TIERS] = K_COMPACT_BUCKETS_S;
+static const uint16_t   AUI16_AGE_DAYS[K_COMPACT_TIERS] = K_COMPACT_TIER_AGE_DAYS;
+
+/*
+ * Private Functions
+ */
+static int32_t bucketStart(int32_t si32_ts, int32_t si32_bucket_s)
+{
+    int32_t si32_mod = si32_ts % si32_bucket_s;
+
+    return si32_ts - ((si32_mod < 0) ? (si32_mod + si32_bucket_s) : si32_mod);
+}
+
+static const compact_rule_st *findRule(const compact_st *ps_compact, uint8_t ui8_id)
+{
+    for (uint8_t r = 0; r < ps_compact->ui8_rules; r++)
+    {
+        if (ui8_id == ps_compact->ps_rules[r].ui8_id)
+        {
+            return &ps_compact->ps_rules[r];
+        }
+    }
+
+    return NULL;
+}
+
+/* column of phase & id, a new one after the last column of the phase; ui16_hint is tried first,
+   the position in a record of the same layout */
+static compact_col_st *getColumn(compact_st *ps_compact, uint8_t ui8_phase, uint8_t ui8_id, bool b_wide, uint16_t ui16_hint)
+{
+    const compact_rule_st  *ps_rule;
+    compact_col_st         *ps_col;
+    uint16_t                ui16_at = ps_compact->ui16_cols;
+
+    if ((ui16_hint < ps_compact->ui16_cols) &&
+        (ui8_phase == ps_compact->as_col[ui16_hint].ui8_phase) && (ui8_id == ps_compact->as_col[ui16_hint].ui8_id))
+    {
+        return &ps_compact->as_col[ui16_hint];
+    }
+
+    for (uint16_t c = 0; c < ps_compact->ui16_cols; c++)
+    {
+        if (ui8_phase != ps_compact->as_col[c].ui8_phase)
+        {
+            continue;
+        }
+        else if (ui8_id == ps_compact->as_col[c].ui8_id)
+        {
+            return &ps_compact->as_col[c];
+        }
+        ui16_at = c + 1;
+    }
+
+    if (K_COMPACT_MAX_COLUMNS == ps_compact->ui16_cols)
+    {
+        return NULL;
+    }
+
+    memmove(&ps_compact->as_col[ui16_at + 1], &ps_compact->as_col[ui16_at], (ps_compact->ui16_cols - ui16_at) * sizeof(compact_col_st));
+    ps_compact->ui16_cols++;
+
+    ps_rule = findRule(ps_compact, ui8_id);
+    ps_col  = &ps_compact->as_col[ui16_at];
+    memset(ps_col, 0, sizeof(compact_col_st));
+    ps_col->ui8_phase = ui8_phase;
+    ps_col->ui8_id    = ui8_id;
+    ps_col->b_wide    = b_wide;
+    ps_col->ui8_op    = (NULL != ps_rule) ? ps_rule->ui8_op : ((true == b_wide) ? COMPACT_LAST : COMPACT_MEAN);
+    ps_col->b_signed  = (NULL != ps_rule) && ps_rule->b_signed;
+
+    return ps_col;
+}
+
+static void aggregate(compact_col_st *ps_col, int64_t si64_val)
+{
+    if (0 == ps_col->ui16_n)
+    {
+        ps_col->si64_val = si64_val;
+    }
+    else if (COMPACT_MEAN == ps_col->ui8_op)
+    {
+        ps_col->si64_val += si64_val;
+    }
+    else if (COMPACT_MIN == ps_col->ui8_op)
+    {
+        ps_col->si64_val = (si64_val < ps_col->si64_val) ? si64_val : ps_col->si64_val;
+    }
+    else if (COMPACT_MAX == ps_col->ui8_op)
+    {
+        ps_col->si64_val = (si64_val > ps_col->si64_val) ? si64_val : ps_col->si64_val;
+    }
+    else
+    {
+        ps_col->si64_val = si64_val;
+    }
+    ps_col->ui16_n++;
+}
+
+/* the parameters of the monitor payload in pui8_rec, checked with b_apply false, into the
+   columns with b_apply true */
+static bool walkParams(compact_st *ps_compact, uint16_t ui16_len, bool b_apply)
+{
+    const uint8_t  *pui8_rec = ps_compact->pui8_rec;
+    uint16_t        ui16_off;
+    uint16_t        ui16_pos = 0;
+
+    if ((ui16_len < 3) || (pui8_rec[2] > K_PAYLOAD_MAX_DEV_ID_LEN) || (ui16_len < (3 + pui8_rec[2] + 4)))
+    {
+        return false;
+    }
+
+    // header: protocol version, device type, device id length & id, timestamp
+    ui16_off = (uint16_t)(3 + pui8_rec[2] + 4);
+    while (ui16_off < ui16_len)
+    {
+        uint8_t ui8_phase = (uint8_t)(pui8_rec[ui16_off] >> 5);
+        uint8_t ui8_count = (uint8_t)(pui8_rec[ui16_off] & 0x1F);
+
+        ui16_off++;
+        for (uint8_t p = 0; p < ui8_count; p++, ui16_pos++)
+        {
+            uint8_t         ui8_id;
+            uint8_t         ui8_plen;
+            compact_col_st *ps_col;
+            int64_t         si64_val;
+
+            if (ui16_off >= ui16_len)
+            {
+                return false;
+            }
+
+            ui8_id   = pui8_rec[ui16_off];
+            ui8_plen = edgePayloadMonitorParamLen(ui8_id);
+            if ((ui16_off + ui8_plen) > ui16_len)
+            {
+                return false;
+            }
+            else if (true == b_apply)
+            {
+                ps_col = getColumn(ps_compact, ui8_phase, ui8_id, (5 == ui8_plen), ui16_pos);
+                if (NULL == ps_col)
+                {
+                    return false;
+                }
+
+                si64_val  = (int64_t)((uint32_t)pui8_rec[ui16_off + 1] | ((uint32_t)pui8_rec[ui16_off + 2] << 8));
+                si64_val |= (5 == ui8_plen) ? (int64_t)(((uint32_t)pui8_rec[ui16_off + 3] << 16) | ((uint32_t)pui8_rec[ui16_off + 4] << 24)) : 0;
+                si64_val  = ((false == ps_col->b_wide) && (true == ps_col->b_signed)) ? (int64_t)(int16_t)si64_val : si64_val;
+                aggregate(ps_col, si64_val);
+            }
+            ui16_off += ui8_plen;
+        }
+    }
+
+    return true;
+}
+
+/* the aggregates of the bucket as one record of the next tier */
+static void emitBucket(compact_st *ps_compact)
+{
+    static uint8_t  aui8_buf[K_MON_CODEC_MAX_LEN];
+    dlog_st        *ps_dst   = ps_compact->aps_log[ps_compact->ui8_tier + 1];
+    uint64_t        ui64_coded = ps_compact->s_dst_codec.ui64_coded_bytes;
+    size_t          sz_len   = 0;
+    bool            b_status;
+
+    ps_compact->s_header.si32_timestamp = ps_compact->si32_bucket;
+    b_status = edgePayloadInitMonitor(&ps_compact->s_monitor, &ps_compact->s_header);
+
+    for (uint16_t c = 0; (true == b_status) && (c < ps_compact->ui16_cols); c++)
+    {
+        compact_col_st *ps_col = &ps_compact->as_col[c];
+        int64_t         si64_val = ps_col->si64_val;
+
+        if (0 == ps_col->ui16_n)
+        {
+            continue;
+        }
+        else if (COMPACT_MEAN == ps_col->ui8_op)
+        {
+            si64_val = ((si64_val < 0) ? (si64_val - (ps_col->ui16_n / 2)) : (si64_val + (ps_col->ui16_n / 2))) / ps_col->ui16_n;
+        }
+
+        if ((0 == ps_compact->s_monitor.ui8_phase_count) ||
+            (ps_col->ui8_phase != ps_compact->s_monitor.as_mon_phase[ps_compact->s_monitor.ui8_phase_count - 1].ui8_phase_index))
+        {
+            b_status = edgePayloadNewMonitorPhase(&ps_compact->s_monitor, (ep_phase_index_et)ps_col->ui8_phase);
+        }
+
+        if ((true == b_status) && (true == ps_col->b_wide))
+        {
+            b_status = edgePayloadAddMonitorParam32(&ps_compact->s_monitor, (ep_monitor_id_et)ps_col->ui8_id, (uint32_t)si64_val);
+        }
+        else if (true == b_status)
+        {
+            b_status = edgePayloadAddMonitorParam(&ps_compact->s_monitor, (ep_monitor_id_et)ps_col->ui8_id, (uint16_t)si64_val);
+        }
+        ps_col->ui16_n = 0;
+    }
+
+    if ((false == b_status) || (false == edgePayloadMonitor2Buf(aui8_buf, sizeof(aui8_buf), &sz_len, &ps_compact->s_monitor)) ||
+        (false == monCodecAppend(&ps_compact->s_dst_codec, ps_dst, ps_compact->si32_bucket, aui8_buf, (uint16_t)sz_len)))
+    {
+        ps_compact->s_stats.ui32_errors++;
+    }
+    else
+    {
+        ps_compact->s_stats.ui32_records_out++;
+        ps_compact->s_stats.ui64_bytes_out += (ps_compact->s_dst_codec.ui64_coded_bytes - ui64_coded) + K_DLOG_REC_HDR_LEN;
+    }
+
+    for (uint16_t c = 0; c < ps_compact->ui16_cols; c++)
+    {
+        ps_compact->as_col[c].ui16_n = 0;
+    }
+    ps_compact->si32_bucket         = INT32_MIN;
+    ps_compact->ui16_bucket_records = 0;
+}
+
+/* record in pui8_rec into its bucket, the bucket before goes out */
+static void takeRecord(compact_st *ps_compact, int32_t si32_ts, uint16_t ui16_len)
+{
+    const uint8_t  *pui8_rec = ps_compact->pui8_rec;
+    int32_t         si32_start = bucketStart(si32_ts, ASI32_BUCKET_S[ps_compact->ui8_tier + 1]);
+
+    if ((si32_ts < ps_compact->si32_from) || ((INT32_MIN != ps_compact->si32_bucket) && (si32_start < ps_compact->si32_bucket)))
+    {
+        ps_compact->s_stats.ui32_skipped++;
+        return;
+    }
+    else if (false == walkParams(ps_compact, ui16_len, false))
+    {
+        ps_compact->s_stats.ui32_errors++;
+        return;
+    }
+    else if ((INT32_MIN != ps_compact->si32_bucket) && (si32_start != ps_compact->si32_bucket))
+    {
+        emitBucket(ps_compact);
+    }
+
+    if (INT32_MIN == ps_compact->si32_bucket)
+    {
+        ps_compact->si32_bucket               = si32_start;
+        ps_compact->s_header.b_template       = false;                 // the record's, not necessarily this device's
+        ps_compact->s_header.e_protocol_ver   = (ep_protocol_ver_et)pui8_rec[0];
+        ps_compact->s_header.e_dev_type       = (ep_dev_type_et)pui8_rec[1];
+        ps_compact->s_header.s_dev_id.ui8_len = pui8_rec[2];
+        memcpy(ps_compact->s_header.s_dev_id.aui8_id, &pui8_rec[3], pui8_rec[2]);
+    }
+
+    if (false == walkParams(ps_compact, ui16_len, true))
+    {
+        ps_compact->s_stats.ui32_errors++;
+        return;
+    }
+    ps_compact->ui16_bucket_records++;
+    ps_compact->s_stats.ui32_records_in++;
+}
+
+/* the highest tier that is full or has aged, it makes room for the ones below */
+static bool startJob(compact_st *ps_compact)
+{
+    int32_t si32_now = INT32_MAX;                       // newest record, read when a tier's age is in question
+
+    for (int8_t t = K_COMPACT_TIERS - 2; t >= 0; t--)
+    {
+        dlog_st    *ps_src = ps_compact->aps_log[t];
+        dlog_st    *ps_dst = ps_compact->aps_log[t + 1];
+        int32_t     si32_last;
+        bool        b_full;
+        bool        b_aged;
+
+        if ((NULL == ps_src) || (NULL == ps_dst) || (ps_src->ui8_segs < 2) || (INT32_MAX == ps_src->as_seg[1].si32_first_ts))
+        {
+            continue;
+        }
+
+        b_full = ((ps_src->ui8_segs + 1) >= ps_src->ui8_max_segs);
+        if ((false == b_full) && (0 != AUI16_AGE_DAYS[t]) && (INT32_MAX == si32_now))
+        {
+            si32_now = dlogLastTs(ps_compact->aps_log[0]);
+        }
+        b_aged = (false == b_full) && (0 != AUI16_AGE_DAYS[t]) && (INT32_MIN != si32_now) && (INT32_MAX != si32_now) &&
+                 (((int64_t)si32_now - ps_src->as_seg[1].si32_first_ts) >= ((int64_t)AUI16_AGE_DAYS[t] * 86400));
+        if ((false == b_full) && (false == b_aged))
+        {
+            continue;
+        }
+
+        si32_last = dlogLastTs(ps_dst);
+        ps_compact->b_aged              = !b_full;
+        ps_compact->ui8_tier            = (uint8_t)t;
+        ps_compact->ui32_seg            = ps_src->as_seg[0].ui32_seg;
+        ps_compact->si32_end            = bucketStart(ps_src->as_seg[1].si32_first_ts, ASI32_BUCKET_S[t + 1]) + ASI32_BUCKET_S[t + 1];
+        ps_compact->si32_from           = (INT32_MIN == si32_last) ? INT32_MIN : (si32_last + ASI32_BUCKET_S[t + 1]);
+        ps_compact->si32_bucket         = INT32_MIN;
+        ps_compact->ui16_bucket_records = 0;
+        ps_compact->ui16_cols           = 0;
+        dlogReaderInit(&ps_compact->s_reader);
+        dlogSeek(ps_src, &ps_compact->s_reader, ps_compact->si32_from);
+        monCodecInit(&ps_compact->s_src_codec);
+        monCodecInit(&ps_compact->s_dst_codec);
+        ps_compact->b_job = true;
+
+        return true;
+    }
+
+    return false;
+}
+
+/* the last bucket out & on flash before the segment goes */
+static void finishJob(compact_st *ps_compact)
+{
+    dlog_st *ps_src = ps_compact->aps_log[ps_compact->ui8_tier];
+    dlog_st *ps_dst = ps_compact->aps_log[ps_compact->ui8_tier + 1];
+
+    if (INT32_MIN != ps_compact->si32_bucket)
+    {
+        emitBucket(ps_compact);
+    }
+    (void)dlogFlush(ps_dst, 0, true);
+
+    if ((ps_src->as_seg[0].ui32_seg == ps_compact->ui32_seg) && (true == dlogDropOldest(ps_src)))
+    {
+        ps_compact->s_stats.ui32_segments++;
+        ps_compact->s_stats.ui32_aged += (true == ps_compact->b_aged) ? 1 : 0;
+        ps_compact->s_stats.ui64_bytes_in += (uint64_t)K_DLOG_SEGMENT_PAGES * K_DLOG_PAGE_SIZE;
+    }
+    ps_compact->b_job = false;
+}
+
+/*
+ * Public Functions
+ */
+/* pps_logs: K_COMPACT_TIERS logs, the first one as logged; ps_rules: how an id is aggregated,
+   kept by the caller */
+void compactInit(compact_st *ps_compact, dlog_st *const *pps_logs, const compact_rule_st *ps_rules, uint8_t ui8_rules)
+{
+    memset(ps_compact, 0, sizeof(compact_st));
+    memcpy(ps_compact->aps_log, pps_logs, sizeof(ps_compact->aps_log));
+    ps_compact->ps_rules    = ps_rules;
+    ps_compact->ui8_rules   = ui8_rules;
+    ps_compact->si32_bucket = INT32_MIN;
+}
+
+/* at most K_COMPACT_SLICE_RECORDS records of the job, a new job if a tier is full or has aged;
+   false: nothing to do. The logs are held by the caller. */
+bool compactStep(compact_st *ps_compact)
+{
+    dlog_st    *ps_src;
+    int32_t     si32_ts;
+    uint16_t    ui16_len;
+
+    if ((false == ps_compact->b_job) && (false == startJob(ps_compact)))
+    {
+        return false;
+    }
+
+    ps_src = ps_compact->aps_log[ps_compact->ui8_tier];
+    ps_compact->s_stats.ui32_slices++;
+    for (uint8_t r = 0; r < K_COMPACT_SLICE_RECORDS; r++)
+    {
+        ps_compact->pui8_rec = monCodecReadRef(&ps_compact->s_src_codec, ps_src, &ps_compact->s_reader, NULL, &si32_ts, &ui16_len);
+        if ((NULL == ps_compact->pui8_rec) || (si32_ts >= ps_compact->si32_end))
+        {
+            finishJob(ps_compact);
+            break;
+        }
+        takeRecord(ps_compact, si32_ts, ui16_len);
+    }
+
+    return true;
+}
+
+bool compactBusy(const compact_st *ps_compact)
+{
+    return ps_compact->b_job;
+}
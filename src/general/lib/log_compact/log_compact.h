@@ -0,0 +1,120 @@
+/*****************************************************************************************//**
+* \file         log_compact.h
+*
+* \brief        Data log retention compaction library header file.
+* \details      Tiers of data logs at falling resolution (1 min, 15 min, 1 h records): once a
+*               tier is full, or its oldest segment has aged past K_COMPACT_TIER_AGE_DAYS, that
+*               segment is aggregated into records of the next tier's period and dropped, a few
+*               records per call, so the compaction runs in the background of the logging task.
+*
+* \version      v00.01.00
+* \date         20261017
+*********************************************************************************************/
+// *INDENT-OFF*
+#ifndef __LOG_COMPACT_H__
+#define __LOG_COMPACT_H__
+// *INDENT-ON*
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Include .h Library Files
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "log_compact_cfg.h"
+#include "data_log/data_log.h"
+#include "edge_payload/edge_payload.h"
+#include "mon_codec/mon_codec.h"
+
+/*
+ * Global Constants
+ */
+#define K_COMPACT_MAX_COLUMNS           (K_PAYLOAD_MAX_MON_PHASE_COUNT * (K_PAYLOAD_MAX_MON_PARAM_COUNT + K_PAYLOAD_MAX_MON_PARAM32_COUNT))
+
+typedef enum
+{
+    COMPACT_MEAN,                                       // 16-bit parameters without a rule
+    COMPACT_MIN,
+    COMPACT_MAX,
+    COMPACT_LAST                                        // 32-bit parameters (counters) without a rule
+} compact_op_et;
+
+/*
+ * Global Structs
+ */
+typedef struct
+{
+    uint8_t         ui8_id;                             // ep_monitor_id_et
+    uint8_t         ui8_op;                             // compact_op_et
+    bool            b_signed;                           // 16-bit value as int16_t
+} compact_rule_st;
+
+typedef struct
+{
+    uint8_t         ui8_phase;                          // ep_phase_index_et
+    uint8_t         ui8_id;
+    uint8_t         ui8_op;
+    bool            b_signed;
+    bool            b_wide;                             // 32-bit parameter
+    uint16_t        ui16_n;                             // records of the bucket with the parameter
+    int64_t         si64_val;                           // sum, min, max or last
+} compact_col_st;
+
+typedef struct
+{
+    uint32_t        ui32_records_in;
+    uint32_t        ui32_records_out;
+    uint64_t        ui64_bytes_in;                      // segments dropped
+    uint64_t        ui64_bytes_out;                     // records written into the next tiers
+    uint32_t        ui32_segments;
+    uint32_t        ui32_aged;                          // of them compacted for their age, the tier not full
+    uint32_t        ui32_slices;
+    uint32_t        ui32_skipped;                       // compacted before a restart, or the clock stepped back
+    uint32_t        ui32_errors;                        // undecodable payloads, aggregates not stored
+} compact_stats_st;
+
+typedef struct
+{
+    dlog_st        *aps_log[K_COMPACT_TIERS];           // NULL: the tiers before it only
+    const compact_rule_st *ps_rules;
+    uint8_t         ui8_rules;
+
+    // job: oldest segment of tier ui8_tier into the next one
+    bool            b_job;
+    bool            b_aged;                             // started for the segment's age
+    uint8_t         ui8_tier;
+    uint32_t        ui32_seg;                           // the segment compacted
+    int32_t         si32_from;                          // records before are in the next tier already
+    int32_t         si32_end;                           // bucket boundary after the segment
+    dlog_reader_st  s_reader;
+    mon_codec_st    s_src_codec;
+    mon_codec_st    s_dst_codec;
+    const uint8_t  *pui8_rec;                           // payload decoded in s_src_codec
+    ep_com_header_st s_header;                          // of the bucket's first record
+    int32_t         si32_bucket;                        // start of the bucket being aggregated, INT32_MIN none
+    uint16_t        ui16_bucket_records;
+    compact_col_st  as_col[K_COMPACT_MAX_COLUMNS];      // by phase in the order they came
+    uint16_t        ui16_cols;
+    ep_monitor_payload_st s_monitor;
+
+    // statistics
+    compact_stats_st s_stats;
+} compact_st;
+
+/*
+ * Public Function Prototypes
+ */
+void compactInit(compact_st *ps_compact, dlog_st *const *pps_logs, const compact_rule_st *ps_rules, uint8_t ui8_rules);
+bool compactStep(compact_st *ps_compact);
+bool compactBusy(const compact_st *ps_compact);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif/* end of log_compact.h */
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,342 @@
+/*****************************************************************************************//**
+* \file         log_query.c
+*
+* \brief        Data log range query library source file.
+* \details      The range starts with dlogSeek(), the sparse time index of the data log, and
+*               ends at the first record after si32_to; nothing before or after is read.
+*               Output: {"from":..,"to":..,"every":..,"ids":[..],"rows":[[ts,phase,v..],..],
+*               "records":..,"count":..}, the values as in the monitor payload, null if the
+*               phase didn't report the id. A row that doesn't fit the chunk waits for the next.
+*
+* \version      v00.01.00
+* \date         20261017
+*********************************************************************************************/
+/*
+ * Included Modules
+ */
+#include "global_defs.h"
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include "log_query.h"
+
+/*
+ * Local Constants
+ */
+#define K_QUERY_NO_PHASE                (EP_PHASE_INDEX_MAX + 1)
+
+/*
+ * Private Functions
+ */
+static void rowPrintf(query_st *ps_query, const char *pc_fmt, ...)
+{
+    va_list s_args;
+    int     si_len;
+
+    va_start(s_args, pc_fmt);
+    si_len = vsnprintf(&ps_query->ac_row[ps_query->ui16_row_len], sizeof(ps_query->ac_row) - ps_query->ui16_row_len, pc_fmt, s_args);
+    va_end(s_args);
+
+    if (si_len > 0)
+    {
+        ps_query->ui16_row_len += (uint16_t)si_len;
+        ps_query->ui16_row_len  = (ps_query->ui16_row_len < sizeof(ps_query->ac_row)) ? ps_query->ui16_row_len : (uint16_t)(sizeof(ps_query->ac_row) - 1);
+    }
+}
+
+/* "key=" at the start or after a '&' */
+static const char *queryValue(const char *pc_query, const char *pc_key)
+{
+    size_t sz_key = strlen(pc_key);
+
+    for (const char *pc = pc_query; NULL != pc; pc = strchr(pc, '&'))
+    {
+        pc += ('&' == *pc) ? 1 : 0;
+        if ((0 == strncmp(pc, pc_key, sz_key)) && ('=' == pc[sz_key]))
+        {
+            return &pc[sz_key + 1];
+        }
+    }
+
+    return NULL;
+}
+
+static bool parseNumber(const char *pc_val, long *psl_val)
+{
+    char *pc_end;
+
+    *psl_val = strtol(pc_val, &pc_end, 10);
+
+    return (pc_end != pc_val) && (('\0' == *pc_end) || ('&' == *pc_end));
+}
+
+/* comma separated, decimal or 0x.. */
+static bool parseList(const char *pc_val, unsigned long ul_min, unsigned long ul_max, uint8_t *pui8_out, uint8_t ui8_max, uint8_t *pui8_count)
+{
+    char *pc_end;
+
+    *pui8_count = 0;
+    do
+    {
+        unsigned long ul_val = strtoul(pc_val, &pc_end, 0);
+
+        if ((pc_end == pc_val) || (ul_val < ul_min) || (ul_val > ul_max) || (ui8_max == *pui8_count))
+        {
+            return false;
+        }
+        pui8_out[(*pui8_count)++] = (uint8_t)ul_val;
+        pc_val = pc_end + 1;
+    } while (',' == *pc_end);
+
+    return ('\0' == *pc_end) || ('&' == *pc_end);
+}
+
+/* phase groups of the monitor payload in pui8_rec; a phase may continue in a second group */
+static bool parseGroups(query_st *ps_query)
+{
+    const uint8_t  *pui8_rec = ps_query->pui8_rec;
+    uint16_t        ui16_len = ps_query->ui16_rec_len;
+    uint16_t        ui16_off;
+
+    ps_query->ui8_groups = 0;
+    if (ui16_len < 3)
+    {
+        return false;
+    }
+
+    // header: protocol version, device type, device id length & id, timestamp
+    ui16_off = (uint16_t)(3 + pui8_rec[2] + 4);
+    while (ui16_off < ui16_len)
+    {
+        query_group_st *ps_group;
+
+        if ((sizeof(ps_query->as_group) / sizeof(ps_query->as_group[0])) == ps_query->ui8_groups)
+        {
+            return false;
+        }
+
+        ps_group = &ps_query->as_group[ps_query->ui8_groups];
+
+        ps_group->ui8_phase = (uint8_t)(pui8_rec[ui16_off] >> 5);
+        ps_group->ui8_count = (uint8_t)(pui8_rec[ui16_off] & 0x1F);
+        ps_group->ui16_off  = ++ui16_off;
+        for (uint8_t p = 0; (p < ps_group->ui8_count) && (ui16_off < ui16_len); p++)
+        {
+            ui16_off += edgePayloadMonitorParamLen(pui8_rec[ui16_off]);
+        }
+        ps_query->ui8_groups++;
+    }
+
+    return (ui16_off == ui16_len);
+}
+
+static bool hasPhase(const query_st *ps_query, uint8_t ui8_phase)
+{
+    for (uint8_t g = 0; g < ps_query->ui8_groups; g++)
+    {
+        if (ui8_phase == ps_query->as_group[g].ui8_phase)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void dataRow(query_st *ps_query, uint8_t ui8_phase)
+{
+    const uint8_t  *pui8_rec = ps_query->pui8_rec;
+    uint32_t        aui32_val[K_QUERY_MAX_IDS];
+    uint16_t        ui16_found = 0;
+
+    for (uint8_t g = 0; g < ps_query->ui8_groups; g++)
+    {
+        uint16_t ui16_off = ps_query->as_group[g].ui16_off;
+
+        for (uint8_t p = 0; (ui8_phase == ps_query->as_group[g].ui8_phase) && (p < ps_query->as_group[g].ui8_count); p++)
+        {
+            uint8_t ui8_id  = pui8_rec[ui16_off];
+            uint8_t ui8_len = edgePayloadMonitorParamLen(ui8_id);
+
+            for (uint8_t i = 0; i < ps_query->ui8_ids; i++)
+            {
+                if (ui8_id == ps_query->aui8_id[i])
+                {
+                    aui32_val[i]  = (uint32_t)pui8_rec[ui16_off + 1] | ((uint32_t)pui8_rec[ui16_off + 2] << 8);
+                    aui32_val[i] |= (5 == ui8_len) ? (((uint32_t)pui8_rec[ui16_off + 3] << 16) | ((uint32_t)pui8_rec[ui16_off + 4] << 24)) : 0;
+                    ui16_found   |= (uint16_t)(1U << i);
+                }
+            }
+            ui16_off += ui8_len;
+        }
+    }
+
+    rowPrintf(ps_query, "%s[%ld,%u", (0 != ps_query->ui32_rows) ? "," : "", (long)ps_query->si32_rec_ts, ui8_phase + 1);
+    for (uint8_t i = 0; i < ps_query->ui8_ids; i++)
+    {
+        if (0 != (ui16_found & (1U << i)))
+        {
+            rowPrintf(ps_query, ",%lu", (unsigned long)aui32_val[i]);
+        }
+        else
+        {
+            rowPrintf(ps_query, ",null");
+        }
+    }
+    rowPrintf(ps_query, "]");
+
+    ps_query->ui32_rows++;
+}
+
+/* every n-th record of the range with a decodable payload is kept for its rows */
+static void takeRecord(query_st *ps_query)
+{
+    if (ps_query->si32_rec_ts < ps_query->si32_from)
+    {
+        // clock stepped back
+        return;
+    }
+
+    ps_query->ui32_records++;
+    if (0 != ((ps_query->ui32_records - 1) % ps_query->ui16_every))
+    {
+        return;
+    }
+    else if (false == parseGroups(ps_query))
+    {
+        ps_query->ui32_bad_records++;
+        return;
+    }
+
+    ps_query->ui8_next_phase = 0;
+}
+
+/*
+ * Public Functions
+ */
+/* from=<epoch>&to=<epoch>&ids=<monitor ids>[&phase=<1..4, L1..L3 & general>][&every=<n>] */
+bool queryParse(query_st *ps_query, const char *pc_query)
+{
+    const char *pc_from  = queryValue(pc_query, "from");
+    const char *pc_to    = queryValue(pc_query, "to");
+    const char *pc_ids   = queryValue(pc_query, "ids");
+    const char *pc_phase = queryValue(pc_query, "phase");
+    const char *pc_every = queryValue(pc_query, "every");
+    uint8_t     aui8_phase[K_PAYLOAD_MAX_MON_PHASE_COUNT];
+    uint8_t     ui8_phases;
+    long        sl_from;
+    long        sl_to;
+    long        sl_every = 1;
+
+    memset(ps_query, 0, sizeof(query_st));
+    dlogReaderInit(&ps_query->s_reader);
+    monCodecInit(&ps_query->s_codec);
+    ps_query->e_state        = QUERY_HEAD;
+    ps_query->ui8_next_phase = K_QUERY_NO_PHASE;
+    ps_query->ui8_phase_mask = (uint8_t)((1U << (EP_PHASE_INDEX_MAX + 1)) - 1);
+
+    if ((NULL == pc_from) || (NULL == pc_to) || (NULL == pc_ids) ||
+        (false == parseNumber(pc_from, &sl_from)) || (false == parseNumber(pc_to, &sl_to)) || (sl_from > sl_to) ||
+        (false == parseList(pc_ids, 0, UINT8_MAX, ps_query->aui8_id, K_QUERY_MAX_IDS, &ps_query->ui8_ids)))
+    {
+        return false;
+    }
+    else if ((NULL != pc_every) && ((false == parseNumber(pc_every, &sl_every)) || (sl_every < 1) || (sl_every > UINT16_MAX)))
+    {
+        return false;
+    }
+    else if (NULL != pc_phase)
+    {
+        if (false == parseList(pc_phase, 1, EP_PHASE_INDEX_MAX + 1, aui8_phase, sizeof(aui8_phase), &ui8_phases))
+        {
+            return false;
+        }
+
+        ps_query->ui8_phase_mask = 0;
+        for (uint8_t p = 0; p < ui8_phases; p++)
+        {
+            ps_query->ui8_phase_mask |= (uint8_t)(1U << (aui8_phase[p] - 1));
+        }
+    }
+
+    ps_query->si32_from  = (int32_t)sl_from;
+    ps_query->si32_to    = (int32_t)sl_to;
+    ps_query->ui16_every = (uint16_t)sl_every;
+
+    return true;
+}
+
+/* next part of the response into pc_buf (>= K_QUERY_ROW_LEN), at most K_QUERY_SLICE_RECORDS
+   records read; 0 bytes is possible before the end, see queryDone() */
+uint16_t queryFill(query_st *ps_query, const dlog_st *ps_log, char *pc_buf, uint16_t ui16_buf_len)
+{
+    uint16_t    ui16_used  = 0;
+    uint8_t     ui8_slice  = 0;
+    uint16_t    ui16_len;
+
+    while (QUERY_DONE != ps_query->e_state)
+    {
+        if (0 != ps_query->ui16_row_len)
+        {
+            if (ps_query->ui16_row_len > (ui16_buf_len - ui16_used))
+            {
+                break;
+            }
+            memcpy(&pc_buf[ui16_used], ps_query->ac_row, ps_query->ui16_row_len);
+            ui16_used += ps_query->ui16_row_len;
+            ps_query->ui16_row_len = 0;
+        }
+
+        if (QUERY_HEAD == ps_query->e_state)
+        {
+            rowPrintf(ps_query, "{\"from\":%ld,\"to\":%ld,\"every\":%u,\"ids\":[", (long)ps_query->si32_from,
+                      (long)ps_query->si32_to, ps_query->ui16_every);
+            for (uint8_t i = 0; i < ps_query->ui8_ids; i++)
+            {
+                rowPrintf(ps_query, "%s%u", (0 != i) ? "," : "", ps_query->aui8_id[i]);
+            }
+            rowPrintf(ps_query, "],\"rows\":[");
+
+            dlogSeek(ps_log, &ps_query->s_reader, ps_query->si32_from);
+            ps_query->e_state = QUERY_ROWS;
+        }
+        else if (QUERY_TAIL == ps_query->e_state)
+        {
+            ps_query->e_state = QUERY_DONE;
+        }
+        else if (ps_query->ui8_next_phase <= EP_PHASE_INDEX_MAX)
+        {
+            uint8_t ui8_phase = ps_query->ui8_next_phase++;
+
+            if ((0 != (ps_query->ui8_phase_mask & (1U << ui8_phase))) && (true == hasPhase(ps_query, ui8_phase)))
+            {
+                dataRow(ps_query, ui8_phase);
+            }
+        }
+        else if (K_QUERY_SLICE_RECORDS == ui8_slice)
+        {
+            break;
+        }
+        else if ((NULL == (ps_query->pui8_rec = monCodecReadRef(&ps_query->s_codec, ps_log, &ps_query->s_reader, NULL,
+                                                                &ps_query->si32_rec_ts, &ui16_len))) ||
+                 (ps_query->si32_rec_ts > ps_query->si32_to))
+        {
+            rowPrintf(ps_query, "],\"records\":%lu,\"count\":%lu}", (unsigned long)ps_query->ui32_records,
+                      (unsigned long)ps_query->ui32_rows);
+            ps_query->e_state = QUERY_TAIL;
+        }
+        else
+        {
+            ui8_slice++;
+            ps_query->ui16_rec_len = ui16_len;
+            takeRecord(ps_query);
+        }
+    }
+
+    return ui16_used;
+}
+
+bool queryDone(const query_st *ps_query)
+{
+    return (QUERY_DONE == ps_query->e_state);
+}
@@ -0,0 +1,93 @@
+/*****************************************************************************************//**
+* \file         log_query.h
+*
+* \brief        Data log range query library header file.
+* \details      Time range queries over the monitor reports of the data log: selected phases &
+*               monitor ids, every n-th interval, streamed as JSON in caller sized chunks.
+*
+* \version      v00.01.00
+* \date         20261017
+*********************************************************************************************/
+// *INDENT-OFF*
+#ifndef __LOG_QUERY_H__
+#define __LOG_QUERY_H__
+// *INDENT-ON*
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Include .h Library Files
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "log_query_cfg.h"
+#include "data_log/data_log.h"
+#include "edge_payload/edge_payload.h"
+#include "mon_codec/mon_codec.h"
+
+/*
+ * Global Constants
+ */
+typedef enum
+{
+    QUERY_HEAD,
+    QUERY_ROWS,
+    QUERY_TAIL,
+    QUERY_DONE
+} query_state_et;
+
+/*
+ * Global Structs
+ */
+typedef struct
+{
+    uint8_t         ui8_phase;                          // ep_phase_index_et
+    uint8_t         ui8_count;
+    uint16_t        ui16_off;                           // first parameter in the record
+} query_group_st;
+
+typedef struct
+{
+    // request
+    int32_t         si32_from;
+    int32_t         si32_to;
+    uint8_t         ui8_phase_mask;                     // bit n: phase index n
+    uint8_t         ui8_ids;
+    uint8_t         aui8_id[K_QUERY_MAX_IDS];
+    uint16_t        ui16_every;                         // downsampling: every n-th interval
+
+    // stream
+    query_state_et  e_state;
+    dlog_reader_st  s_reader;
+    mon_codec_st    s_codec;
+    const uint8_t  *pui8_rec;                           // payload decoded in s_codec, walked in place
+    uint16_t        ui16_rec_len;
+    int32_t         si32_rec_ts;
+    query_group_st  as_group[2 * K_PAYLOAD_MAX_MON_PHASE_COUNT];
+    uint8_t         ui8_groups;
+    uint8_t         ui8_next_phase;                     // of the record in pui8_rec, > EP_PHASE_INDEX_MAX none
+    char            ac_row[K_QUERY_ROW_LEN];            // didn't fit the last chunk
+    uint16_t        ui16_row_len;
+
+    // statistics
+    uint32_t        ui32_records;                       // in the range
+    uint32_t        ui32_rows;
+    uint32_t        ui32_bad_records;
+} query_st;
+
+/*
+ * Public Function Prototypes
+ */
+bool queryParse(query_st *ps_query, const char *pc_query);
+uint16_t queryFill(query_st *ps_query, const dlog_st *ps_log, char *pc_buf, uint16_t ui16_buf_len);
+bool queryDone(const query_st *ps_query);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif/* end of log_query.h */
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,536 @@
+/*****************************************************************************************//**
+* \file         log_replay.c
+*
+* \brief        Data log replay library source file.
+* \details      The acknowledges of a stream move its cursor over the contiguous acknowledged
+*               reports only; a report whose acknowledge timed out is read again from its position
+*               and sent before anything new.
+*               Each reconnection adds the reports of the outage as a backlog range; the live
+*               stream restarts at the end of the log.
+*
+* \version      v00.01.00
+* \date         20261017
+*********************************************************************************************/
+/*
+ * Included Modules
+ */
+#include "global_defs.h"
+#include <stdio.h>
+#include "log_replay.h"
+
+/*
+ * Local Constants
+ */
+#define K_REPLAY_MAGIC                  (0x52504C31UL)      // "RPL1"
+
+static const uint32_t   MS_REPLAY_CHECKPOINT    = (uint32_t)K_REPLAY_CHECKPOINT_MIN * 60UL * 1000UL;
+
+/*
+ * Local Definitions
+ */
+typedef struct
+{
+    uint32_t            ui32_magic;
+    uint32_t            ui32_seq;
+    replay_cursor_st    s_cursor;
+    uint16_t            ui16_crc;
+} replay_record_st;
+
+/*
+ * Private Functions
+ */
+static uint16_t recordCrc(const replay_record_st *ps_rec)
+{
+    return crc16CalcBlock((uint8_t *)ps_rec, (uint16_t)offsetof(replay_record_st, ui16_crc));
+}
+
+static bool restoreCursor(replay_st *ps_rp)
+{
+    replay_record_st    s_rec;
+    FILE               *ps_file = fopen(ps_rp->pc_path, "rb");
+    bool                b_status = false;
+
+    if (NULL == ps_file)
+    {
+        return false;
+    }
+
+    for (uint8_t ui8_slot = 0; ui8_slot < 2; ui8_slot++)
+    {
+        if ((1 != fread(&s_rec, sizeof(s_rec), 1, ps_file)) ||
+            (K_REPLAY_MAGIC != s_rec.ui32_magic) ||
+            (s_rec.s_cursor.ui8_ranges > K_REPLAY_MAX_RANGES) ||
+            (recordCrc(&s_rec) != s_rec.ui16_crc))
+        {
+            continue;
+        }
+        else if ((false == b_status) || ((int32_t)(s_rec.ui32_seq - ps_rp->ui32_seq) > 0))
+        {
+            ps_rp->ui32_seq = s_rec.ui32_seq;
+            ps_rp->s_cursor = s_rec.s_cursor;
+            b_status = true;
+        }
+    }
+    fclose(ps_file);
+
+    return b_status;
+}
+
+/* readers back to the cursors, whatever was in flight is sent again */
+static void rewindStreams(replay_st *ps_rp)
+{
+    ps_rp->ui8_flights = 0;
+    ps_rp->si8_pending = -1;
+    dlogReaderSetPos(&ps_rp->as_reader[REPLAY_LIVE], &ps_rp->s_cursor.s_live);
+    if (0 != ps_rp->s_cursor.ui8_ranges)
+    {
+        dlogReaderSetPos(&ps_rp->as_reader[REPLAY_BACKLOG], &ps_rp->s_cursor.as_range[0].s_from);
+    }
+}
+
+static uint8_t inFlight(const replay_st *ps_rp, replay_stream_et e_stream)
+{
+    uint8_t ui8_count = 0;
+
+    for (uint8_t f = 0; f < ps_rp->ui8_flights; f++)
+    {
+        ui8_count += (e_stream == ps_rp->as_flight[f].ui8_stream) ? 1 : 0;
+    }
+
+    return ui8_count;
+}
+
+static void popRange(replay_st *ps_rp)
+{
+    replay_cursor_st *ps_cur = &ps_rp->s_cursor;
+
+    memmove(&ps_cur->as_range[0], &ps_cur->as_range[1], (K_REPLAY_MAX_RANGES - 1) * sizeof(replay_range_st));
+    ps_cur->ui8_ranges--;
+    ps_rp->ui16_unsaved++;
+
+    if (0 != ps_cur->ui8_ranges)
+    {
+        dlogReaderSetPos(&ps_rp->as_reader[REPLAY_BACKLOG], &ps_cur->as_range[0].s_from);
+    }
+}
+
+static void addFlight(replay_st *ps_rp, replay_stream_et e_stream, const dlog_pos_st *ps_prev, uint32_t ms_now)
+{
+    replay_flight_st *ps_flight = &ps_rp->as_flight[ps_rp->ui8_flights++];
+
+    ps_flight->ui16_ticket  = 0;
+    ps_flight->ui8_stream   = (uint8_t)e_stream;
+    ps_flight->b_acked      = false;
+    ps_flight->b_resend     = false;
+    ps_flight->ui8_reports  = 1;
+    ps_flight->s_prev       = *ps_prev;
+    ps_flight->s_next       = ps_rp->as_reader[e_stream].s_pos;
+    ps_flight->ms_sent      = ms_now;
+    ps_rp->aui32_sent[e_stream]++;
+    ps_rp->si8_pending      = (int8_t)(ps_rp->ui8_flights - 1);
+    ps_rp->b_pending_resend = false;
+}
+
+/* acknowledged reports leave the window, a stream's cursor moves over its contiguous ones */
+static void settle(replay_st *ps_rp)
+{
+    bool    ab_blocked[REPLAY_NUM_STREAMS] = { false, false };
+    uint8_t ui8_keep = 0;
+
+    for (uint8_t f = 0; f < ps_rp->ui8_flights; f++)
+    {
+        replay_flight_st *ps_flight = &ps_rp->as_flight[f];
+
+        if ((true == ps_flight->b_acked) && (false == ab_blocked[ps_flight->ui8_stream]))
+        {
+            if (REPLAY_LIVE == ps_flight->ui8_stream)
+            {
+                ps_rp->s_cursor.s_live = ps_flight->s_next;
+            }
+            else if (0 != ps_rp->s_cursor.ui8_ranges)
+            {
+                ps_rp->s_cursor.as_range[0].s_from = ps_flight->s_next;
+            }
+            ps_rp->aui32_acked[ps_flight->ui8_stream] += ps_flight->ui8_reports;
+            ps_rp->ui16_unsaved++;
+        }
+        else
+        {
+            ab_blocked[ps_flight->ui8_stream] = true;
+            ps_rp->as_flight[ui8_keep++] = *ps_flight;
+        }
+    }
+    ps_rp->ui8_flights = ui8_keep;
+}
+
+/* the flight's report and the stream's next ones up to ps_end into the batch, the flight grows
+   over them; the first that doesn't fit is read again for the next request */
+static void fillBatch(replay_st *ps_rp, const dlog_st *ps_log, replay_flight_st *ps_flight, const dlog_pos_st *ps_end,
+                      const uint8_t *pui8_report, uint16_t ui16_len, ep_monitor_batch_st *ps_batch)
+{
+    dlog_reader_st     *ps_reader = &ps_rp->as_reader[ps_flight->ui8_stream];
+    dlog_pos_st         s_prev;
+    int32_t             si32_ts;
+
+    (void)edgePayloadBatchAddMonitor(ps_batch, pui8_report, ui16_len);
+    while (UINT8_MAX != ps_flight->ui8_reports)
+    {
+        s_prev      = ps_reader->s_pos;
+        pui8_report = monCodecReadRef(&ps_rp->as_codec[ps_flight->ui8_stream], ps_log, ps_reader, ps_end, &si32_ts, &ui16_len);
+        if (NULL == pui8_report)
+        {
+            break;
+        }
+        else if (false == edgePayloadBatchAddMonitor(ps_batch, pui8_report, ui16_len))
+        {
+            dlogReaderSetPos(ps_reader, &s_prev);
+            break;
+        }
+        ps_flight->s_next = ps_reader->s_pos;
+        ps_flight->ui8_reports++;
+    }
+}
+
+/* timed out report, read again from its position (a batch: all of its reports, into a batch of
+   the same size as before); an unreadable one (dropped segment) counts as acknowledged */
+static bool resend(replay_st *ps_rp, const dlog_st *ps_log, uint8_t ui8_flight, uint32_t ms_now,
+                   int32_t *psi32_ts, const uint8_t **ppui8_report, uint16_t *pui16_len, ep_monitor_batch_st *ps_batch)
+{
+    replay_flight_st   *ps_flight = &ps_rp->as_flight[ui8_flight];
+    dlog_reader_st     *ps_reader = &ps_rp->as_reader[ps_flight->ui8_stream];
+    dlog_pos_st         s_pos     = ps_reader->s_pos;
+    dlog_pos_st         s_end     = ps_flight->s_next;
+    bool                b_status;
+
+    dlogReaderSetPos(ps_reader, &ps_flight->s_prev);
+    *ppui8_report = monCodecReadRef(&ps_rp->as_codec[ps_flight->ui8_stream], ps_log, ps_reader, &s_end,
+                                    psi32_ts, pui16_len);
+    b_status      = (NULL != *ppui8_report);
+    if ((true == b_status) && (NULL != ps_batch))
+    {
+        ps_flight->s_next      = ps_reader->s_pos;
+        ps_flight->ui8_reports = 1;
+        fillBatch(ps_rp, ps_log, ps_flight, &s_end, *ppui8_report, *pui16_len, ps_batch);
+    }
+    dlogReaderSetPos(ps_reader, &s_pos);
+
+    ps_flight->b_resend    = false;
+    ps_flight->ui16_ticket = 0;
+    ps_flight->ms_sent     = ms_now;
+    ps_flight->b_acked     = !b_status;
+    ps_rp->si8_pending      = (int8_t)ui8_flight;
+    ps_rp->b_pending_resend = true;
+
+    return b_status;
+}
+
+/* new flight: its report and what follows of the stream into the batch, if any */
+static void addBatch(replay_st *ps_rp, const dlog_st *ps_log, const dlog_pos_st *ps_end,
+                     const uint8_t *pui8_report, uint16_t ui16_len, ep_monitor_batch_st *ps_batch)
+{
+    replay_flight_st *ps_flight = &ps_rp->as_flight[ps_rp->si8_pending];
+
+    if (NULL != ps_batch)
+    {
+        fillBatch(ps_rp, ps_log, ps_flight, ps_end, pui8_report, ui16_len, ps_batch);
+        ps_rp->aui32_sent[ps_flight->ui8_stream] += ps_flight->ui8_reports - 1;
+    }
+}
+
+static bool nextReport(replay_st *ps_rp, const dlog_st *ps_log, uint8_t ui8_free_slots, uint32_t ms_now,
+                       int32_t *psi32_ts, const uint8_t **ppui8_report, uint16_t *pui16_len, ep_monitor_batch_st *ps_batch)
+{
+    replay_cursor_st   *ps_cur = &ps_rp->s_cursor;
+    dlog_reader_st     *ps_reader;
+    dlog_pos_st         s_prev;
+    bool                b_settle = false;
+
+    ps_rp->si8_pending = -1;
+    if ((false == ps_rp->b_online) || (0 == ui8_free_slots))
+    {
+        return false;
+    }
+
+    for (uint8_t f = 0; f < ps_rp->ui8_flights; f++)
+    {
+        if (false == ps_rp->as_flight[f].b_resend)
+        {
+            continue;
+        }
+        else if (true == resend(ps_rp, ps_log, f, ms_now, psi32_ts, ppui8_report, pui16_len, ps_batch))
+        {
+            return true;
+        }
+        b_settle = true;
+    }
+
+    if (true == b_settle)
+    {
+        settle(ps_rp);
+    }
+
+    if (K_REPLAY_WINDOW == ps_rp->ui8_flights)
+    {
+        return false;
+    }
+
+    ps_reader = &ps_rp->as_reader[REPLAY_LIVE];
+    s_prev    = ps_reader->s_pos;
+    *ppui8_report = monCodecReadRef(&ps_rp->as_codec[REPLAY_LIVE], ps_log, ps_reader, NULL, psi32_ts, pui16_len);
+    if (NULL != *ppui8_report)
+    {
+        addFlight(ps_rp, REPLAY_LIVE, &s_prev, ms_now);
+        addBatch(ps_rp, ps_log, NULL, *ppui8_report, *pui16_len, ps_batch);
+        return true;
+    }
+
+    if ((ms_now - ps_rp->ms_batch) >= K_REPLAY_BATCH_PERIOD_MS)
+    {
+        ps_rp->ms_batch  = ms_now;
+        ps_rp->ui8_batch = 0;
+    }
+
+    if ((ps_rp->ui8_batch >= K_REPLAY_BATCH) || (ui8_free_slots <= K_REPLAY_MIN_FREE_SLOTS) ||
+        ((ps_rp->ui8_flights + 1) >= K_REPLAY_WINDOW))
+    {
+        return false;
+    }
+
+    ps_reader = &ps_rp->as_reader[REPLAY_BACKLOG];
+    while (0 != ps_cur->ui8_ranges)
+    {
+        s_prev = ps_reader->s_pos;
+        *ppui8_report = monCodecReadRef(&ps_rp->as_codec[REPLAY_BACKLOG], ps_log, ps_reader, &ps_cur->as_range[0].s_to,
+                                        psi32_ts, pui16_len);
+        if (NULL != *ppui8_report)
+        {
+            addFlight(ps_rp, REPLAY_BACKLOG, &s_prev, ms_now);
+            addBatch(ps_rp, ps_log, &ps_cur->as_range[0].s_to, *ppui8_report, *pui16_len, ps_batch);
+            ps_rp->ui8_batch++;
+            return true;
+        }
+        else if (0 != inFlight(ps_rp, REPLAY_BACKLOG))
+        {
+            break;  // the range is done once these are acknowledged
+        }
+        popRange(ps_rp);
+    }
+
+    return false;
+}
+
+/*
+ * Public Functions
+ */
+/* restores the cursor; without one (first start) only reports appended from now on are sent */
+void replayInit(replay_st *ps_rp, const char *pc_path, const dlog_st *ps_log)
+{
+    memset(ps_rp, 0, sizeof(replay_st));
+    ps_rp->pc_path = pc_path;
+
+    if (false == restoreCursor(ps_rp))
+    {
+        dlogEnd(ps_log, &ps_rp->s_cursor.s_live);
+    }
+
+    dlogReaderInit(&ps_rp->as_reader[REPLAY_LIVE]);
+    dlogReaderInit(&ps_rp->as_reader[REPLAY_BACKLOG]);
+    dlogReaderCopy(&ps_rp->as_reader[REPLAY_LIVE], (0 == K_REPLAY_MAPPED));
+    dlogReaderCopy(&ps_rp->as_reader[REPLAY_BACKLOG], (0 == K_REPLAY_MAPPED));
+    monCodecInit(&ps_rp->as_codec[REPLAY_LIVE]);
+    monCodecInit(&ps_rp->as_codec[REPLAY_BACKLOG]);
+    rewindStreams(ps_rp);
+}
+
+/* link (re)established: what the live stream couldn't send becomes a backlog range */
+void replayOnline(replay_st *ps_rp, const dlog_st *ps_log)
+{
+    replay_cursor_st   *ps_cur = &ps_rp->s_cursor;
+    dlog_pos_st         s_end;
+
+    if (true == ps_rp->b_online)
+    {
+        return;
+    }
+
+    dlogEnd(ps_log, &s_end);
+    if (true == dlogPosBefore(&ps_cur->s_live, &s_end))
+    {
+        if (K_REPLAY_MAX_RANGES == ps_cur->ui8_ranges)
+        {
+            // the live reports since the last range are sent again
+            ps_cur->as_range[K_REPLAY_MAX_RANGES - 1].s_to = s_end;
+        }
+        else
+        {
+            ps_cur->as_range[ps_cur->ui8_ranges].s_from = ps_cur->s_live;
+            ps_cur->as_range[ps_cur->ui8_ranges].s_to   = s_end;
+            ps_cur->ui8_ranges++;
+        }
+        ps_cur->s_live = s_end;
+        ps_rp->ui16_unsaved++;
+    }
+
+    rewindStreams(ps_rp);
+    ps_rp->b_online = true;
+}
+
+void replayOffline(replay_st *ps_rp)
+{
+    ps_rp->b_online    = false;
+    ps_rp->ui8_flights = 0;
+}
+
+/* next report to send: live first, then the backlog as long as the batch allows and the send
+   queue has more than K_REPLAY_MIN_FREE_SLOTS free; the payload is decoded in place in the
+   stream's codec and valid until the next replayNext() */
+bool replayNext(replay_st *ps_rp, const dlog_st *ps_log, uint8_t ui8_free_slots, uint32_t ms_now,
+                int32_t *psi32_ts, const uint8_t **ppui8_report, uint16_t *pui16_len)
+{
+    return nextReport(ps_rp, ps_log, ui8_free_slots, ms_now, psi32_ts, ppui8_report, pui16_len, NULL);
+}
+
+/* replayNext() with the stream's following reports packed into ps_batch (initialized by the
+   caller, the same size every time) as far as they fit: one request, one acknowledge for all;
+   the backlog batch limit counts requests */
+bool replayNextBatch(replay_st *ps_rp, const dlog_st *ps_log, uint8_t ui8_free_slots, uint32_t ms_now,
+                     ep_monitor_batch_st *ps_batch)
+{
+    const uint8_t  *pui8_report;
+    int32_t         si32_ts;
+    uint16_t        ui16_len;
+
+    return nextReport(ps_rp, ps_log, ui8_free_slots, ms_now, &si32_ts, &pui8_report, &ui16_len, ps_batch);
+}
+
+/* message id of the report from replayNext(), or it couldn't be sent */
+void replaySent(replay_st *ps_rp, uint16_t ui16_ticket, bool b_ok)
+{
+    replay_flight_st *ps_flight;
+
+    if ((ps_rp->si8_pending < 0) || (ps_rp->si8_pending >= ps_rp->ui8_flights))
+    {
+        return;
+    }
+
+    ps_flight = &ps_rp->as_flight[ps_rp->si8_pending];
+    ps_rp->si8_pending = -1;
+    if (true == b_ok)
+    {
+        ps_flight->ui16_ticket = ui16_ticket;
+        return;
+    }
+    else if (true == ps_rp->b_pending_resend)
+    {
+        ps_flight->b_resend = true;
+        return;
+    }
+
+    dlogReaderSetPos(&ps_rp->as_reader[ps_flight->ui8_stream], &ps_flight->s_prev);
+    ps_rp->aui32_sent[ps_flight->ui8_stream] -= ps_flight->ui8_reports;
+    if ((REPLAY_BACKLOG == ps_flight->ui8_stream) && (0 != ps_rp->ui8_batch))
+    {
+        ps_rp->ui8_batch--;
+    }
+    ps_rp->ui8_flights--;
+}
+
+/* acknowledge of a report; false for unknown / duplicate message ids */
+bool replayAck(replay_st *ps_rp, uint16_t ui16_ticket)
+{
+    bool b_found = false;
+
+    for (uint8_t f = 0; f < ps_rp->ui8_flights; f++)
+    {
+        if ((0 != ui16_ticket) && (ui16_ticket == ps_rp->as_flight[f].ui16_ticket) && (false == ps_rp->as_flight[f].b_acked))
+        {
+            ps_rp->as_flight[f].b_acked = true;
+            b_found = true;
+        }
+    }
+
+    if (true == b_found)
+    {
+        settle(ps_rp);
+    }
+
+    return b_found;
+}
+
+/* true: reports waited K_REPLAY_ACK_TIMEOUT_MS for their acknowledge, they go again */
+bool replayPoll(replay_st *ps_rp, uint32_t ms_now)
+{
+    bool b_timeout = false;
+
+    for (uint8_t f = 0; f < ps_rp->ui8_flights; f++)
+    {
+        replay_flight_st *ps_flight = &ps_rp->as_flight[f];
+
+        if ((false == ps_flight->b_acked) && (false == ps_flight->b_resend) &&
+            ((ms_now - ps_flight->ms_sent) >= K_REPLAY_ACK_TIMEOUT_MS))
+        {
+            ps_flight->b_resend = true;
+            ps_rp->ui32_timeouts++;
+            b_timeout = true;
+        }
+    }
+
+    return b_timeout;
+}
+
+/* every K_REPLAY_CHECKPOINT_ACKS acknowledges, K_REPLAY_CHECKPOINT_MIN after a change, or forced */
+bool replayCheckpoint(replay_st *ps_rp, uint32_t ms_now, bool b_force)
+{
+    replay_record_st    s_rec;
+    FILE               *ps_file;
+
+    if (0 == ps_rp->ui16_unsaved)
+    {
+        ps_rp->ms_checkpoint = ms_now;
+        return false;
+    }
+    else if ((false == b_force) && (ps_rp->ui16_unsaved < K_REPLAY_CHECKPOINT_ACKS) &&
+             ((ms_now - ps_rp->ms_checkpoint) < MS_REPLAY_CHECKPOINT))
+    {
+        return false;
+    }
+
+    memset(&s_rec, 0, sizeof(s_rec));
+    s_rec.ui32_magic = K_REPLAY_MAGIC;
+    s_rec.ui32_seq   = ps_rp->ui32_seq + 1;
+    s_rec.s_cursor   = ps_rp->s_cursor;
+    s_rec.ui16_crc   = recordCrc(&s_rec);
+
+    ps_file = fopen(ps_rp->pc_path, "r+b");
+    if (NULL == ps_file)
+    {
+        ps_file = fopen(ps_rp->pc_path, "w+b");
+    }
+
+    if (NULL == ps_file)
+    {
+        LOGW("replay cursor: open %s failed", ps_rp->pc_path);
+        return false;
+    }
+    else if ((0 != fseek(ps_file, (long)((s_rec.ui32_seq & 1) * sizeof(s_rec)), SEEK_SET)) ||
+             (1 != fwrite(&s_rec, sizeof(s_rec), 1, ps_file)))
+    {
+        LOGW("replay cursor: write failed");
+        fclose(ps_file);
+        return false;
+    }
+    fclose(ps_file);
+
+    ps_rp->ui32_seq      = s_rec.ui32_seq;
+    ps_rp->ms_checkpoint = ms_now;
+    ps_rp->ui16_unsaved  = 0;
+    ps_rp->ui32_checkpoints++;
+
+    return true;
+}
+
+/* outage reports still to be sent */
+bool replayBacklog(const replay_st *ps_rp)
+{
+    return (0 != ps_rp->s_cursor.ui8_ranges);
+}
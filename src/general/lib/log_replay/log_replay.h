@@ -0,0 +1,120 @@
+/*****************************************************************************************//**
+* \file         log_replay.h
+*
+* \brief        Data log replay library header file.
+* \details      Forwards the records of the data log to the cloud: live reports as they are
+*               appended, reports of the outages (backlog ranges) in rate limited batches, with a
+*               window of requests waiting for their acknowledge, each a report or a batch of
+*               consecutive ones. The acknowledged positions are
+*               the durable cursor, checkpointed to a file with two alternating records.
+*
+* \version      v00.01.00
+* \date         20261017
+*********************************************************************************************/
+// *INDENT-OFF*
+#ifndef __LOG_REPLAY_H__
+#define __LOG_REPLAY_H__
+// *INDENT-ON*
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Include .h Library Files
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "log_replay_cfg.h"
+#include "data_log/data_log.h"
+#include "mon_codec/mon_codec.h"
+#include "edge_payload/edge_payload.h"
+
+/*
+ * Global Constants
+ */
+typedef enum
+{
+    REPLAY_LIVE,
+    REPLAY_BACKLOG,
+    REPLAY_NUM_STREAMS
+} replay_stream_et;
+
+/*
+ * Global Structs
+ */
+typedef struct
+{
+    dlog_pos_st     s_from;                             // first report not acknowledged
+    dlog_pos_st     s_to;                               // live reports started here
+} replay_range_st;
+
+typedef struct
+{
+    replay_range_st as_range[K_REPLAY_MAX_RANGES];      // oldest outage first
+    uint8_t         ui8_ranges;
+    uint8_t         aui8_reserved[3];
+    dlog_pos_st     s_live;                             // first live report not acknowledged
+} replay_cursor_st;
+
+typedef struct
+{
+    uint16_t        ui16_ticket;                        // message id of the request
+    uint8_t         ui8_stream;
+    bool            b_acked;
+    bool            b_resend;                           // acknowledge timed out
+    uint8_t         ui8_reports;                        // in the request, more than one batched
+    dlog_pos_st     s_prev;                             // stream position of the report ...
+    dlog_pos_st     s_next;                             // ... and after it
+    uint32_t        ms_sent;
+} replay_flight_st;
+
+typedef struct
+{
+    const char         *pc_path;
+    replay_cursor_st    s_cursor;
+    uint32_t            ui32_seq;
+    bool                b_online;
+    dlog_reader_st      as_reader[REPLAY_NUM_STREAMS];
+    mon_codec_st        as_codec[REPLAY_NUM_STREAMS];   // the delta coded payloads of each reader
+    replay_flight_st    as_flight[K_REPLAY_WINDOW];     // in send order
+    uint8_t             ui8_flights;
+    int8_t              si8_pending;                    // flight returned by replayNext(), -1 none
+    bool                b_pending_resend;
+    uint8_t             ui8_batch;
+    uint32_t            ms_batch;
+    uint16_t            ui16_unsaved;
+    uint32_t            ms_checkpoint;
+
+    // statistics
+    uint32_t            aui32_sent[REPLAY_NUM_STREAMS];
+    uint32_t            aui32_acked[REPLAY_NUM_STREAMS];
+    uint32_t            ui32_timeouts;
+    uint32_t            ui32_checkpoints;
+} replay_st;
+
+/*
+ * Public Function Prototypes
+ */
+void replayInit(replay_st *ps_rp, const char *pc_path, const dlog_st *ps_log);
+void replayOnline(replay_st *ps_rp, const dlog_st *ps_log);
+void replayOffline(replay_st *ps_rp);
+
+bool replayNext(replay_st *ps_rp, const dlog_st *ps_log, uint8_t ui8_free_slots, uint32_t ms_now,
+                int32_t *psi32_ts, const uint8_t **ppui8_report, uint16_t *pui16_len);
+bool replayNextBatch(replay_st *ps_rp, const dlog_st *ps_log, uint8_t ui8_free_slots, uint32_t ms_now,
+                     ep_monitor_batch_st *ps_batch);
+void replaySent(replay_st *ps_rp, uint16_t ui16_ticket, bool b_ok);
+bool replayAck(replay_st *ps_rp, uint16_t ui16_ticket);
+bool replayPoll(replay_st *ps_rp, uint32_t ms_now);
+bool replayCheckpoint(replay_st *ps_rp, uint32_t ms_now, bool b_force);
+
+bool replayBacklog(const replay_st *ps_rp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif/* end of log_replay.h */
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -130,7 +130,7 @@ int ATModem::scanf(bool b_debug, const char *pc_end_pattern,
 {
     va_list args;
     char *pc_data;
-    char *pc_search;
+    const char *pc_search;
     int result;
     uint16_t ui16_bytes_read;
 
@@ -0,0 +1,457 @@
+/*****************************************************************************************//**
+* \file         mon_codec.c
+*
+* \brief        Monitor payload codec library source file.
+* \details      Key record:   K_MON_CODEC_KEY, the payload.
+*               Delta record: K_MON_CODEC_DELTA, a varint per column in payload order, only if
+*                             the payload has the layout (header, phases, ids) of the previous one.
+*               Anything else is a payload logged before the codec and read as a key record.
+*               A reader positioned inside a page decodes the page from its first record.
+*
+* \version      v00.01.00
+* \date         20261017
+*********************************************************************************************/
+/*
+ * Included Modules
+ */
+#include "global_defs.h"
+#include "mon_codec.h"
+
+/*
+ * Private Functions
+ */
+static uint16_t get16(const uint8_t *pui8_buf)
+{
+    return (uint16_t)(pui8_buf[0] | (pui8_buf[1] << 8));
+}
+
+static uint32_t get32(const uint8_t *pui8_buf)
+{
+    return (uint32_t)pui8_buf[0] | ((uint32_t)pui8_buf[1] << 8) | ((uint32_t)pui8_buf[2] << 16) | ((uint32_t)pui8_buf[3] << 24);
+}
+
+static void put16(uint8_t *pui8_buf, uint16_t ui16_val)
+{
+    pui8_buf[0] = (uint8_t)(ui16_val & 0xFF);
+    pui8_buf[1] = (uint8_t)(ui16_val >> 8);
+}
+
+static void put32(uint8_t *pui8_buf, uint32_t ui32_val)
+{
+    pui8_buf[0] = (uint8_t)(ui32_val & 0xFF);
+    pui8_buf[1] = (uint8_t)((ui32_val >> 8) & 0xFF);
+    pui8_buf[2] = (uint8_t)((ui32_val >> 16) & 0xFF);
+    pui8_buf[3] = (uint8_t)(ui32_val >> 24);
+}
+
+static uint32_t zigZag(int32_t si32_val)
+{
+    return ((uint32_t)si32_val << 1) ^ (uint32_t)(si32_val >> 31);
+}
+
+static int32_t unZigZag(uint32_t ui32_val)
+{
+    return (int32_t)((ui32_val >> 1) ^ (0U - (ui32_val & 1U)));
+}
+
+static bool putVarint(uint8_t *pui8_out, uint16_t ui16_out_len, uint16_t *pui16_pos, uint32_t ui32_val)
+{
+    do
+    {
+        if (*pui16_pos >= ui16_out_len)
+        {
+            return false;
+        }
+        pui8_out[(*pui16_pos)++] = (uint8_t)((ui32_val & 0x7F) | ((ui32_val > 0x7F) ? 0x80 : 0x00));
+        ui32_val >>= 7;
+    } while (0 != ui32_val);
+
+    return true;
+}
+
+static bool getVarint(const uint8_t *pui8_in, uint16_t ui16_len, uint16_t *pui16_pos, uint32_t *pui32_val)
+{
+    *pui32_val = 0;
+    for (uint8_t ui8_shift = 0; ui8_shift < 35; ui8_shift += 7)
+    {
+        if (*pui16_pos >= ui16_len)
+        {
+            return false;
+        }
+
+        uint8_t ui8_byte = pui8_in[(*pui16_pos)++];
+
+        *pui32_val |= (uint32_t)(ui8_byte & 0x7F) << ui8_shift;
+        if (0 == (ui8_byte & 0x80))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/* header, then phase groups of (id, value); true if the groups end with the payload */
+static bool validLayout(const uint8_t *pui8_pl, uint16_t ui16_len)
+{
+    uint16_t ui16_off;
+
+    if ((ui16_len < 3) || (ui16_len > K_MON_CODEC_MAX_LEN) || ((3 + pui8_pl[2] + 4) > ui16_len))
+    {
+        return false;
+    }
+
+    ui16_off = (uint16_t)(3 + pui8_pl[2] + 4);
+    while (ui16_off < ui16_len)
+    {
+        uint8_t ui8_count = pui8_pl[ui16_off++] & 0x1F;
+
+        for (uint8_t p = 0; (p < ui8_count) && (ui16_off < ui16_len); p++)
+        {
+            ui16_off += edgePayloadMonitorParamLen(pui8_pl[ui16_off]);
+        }
+    }
+
+    return (ui16_off == ui16_len);
+}
+
+/* everything but the values equal */
+static bool sameLayout(const mon_codec_st *ps_codec, const uint8_t *pui8_pl, uint16_t ui16_len)
+{
+    const uint8_t  *pui8_prev = ps_codec->aui8_prev;
+    uint16_t        ui16_off  = (uint16_t)(3 + pui8_pl[2]);
+
+    if ((ui16_len != ps_codec->ui16_prev_len) || (0 != memcmp(pui8_prev, pui8_pl, ui16_off)))
+    {
+        return false;
+    }
+
+    ui16_off += 4;
+    while (ui16_off < ui16_len)
+    {
+        uint8_t ui8_count = pui8_pl[ui16_off] & 0x1F;
+
+        if (pui8_prev[ui16_off] != pui8_pl[ui16_off])
+        {
+            return false;
+        }
+
+        ui16_off++;
+        for (uint8_t p = 0; p < ui8_count; p++)
+        {
+            if (pui8_prev[ui16_off] != pui8_pl[ui16_off])
+            {
+                return false;
+            }
+            ui16_off += edgePayloadMonitorParamLen(pui8_pl[ui16_off]);
+        }
+    }
+
+    return true;
+}
+
+static bool putCounter(const mon_codec_st *ps_codec, int32_t *psi32_delta, uint8_t ui8_counter, uint32_t ui32_prev, uint32_t ui32_val,
+                       uint8_t *pui8_out, uint16_t ui16_out_len, uint16_t *pui16_pos)
+{
+    int32_t si32_delta = (int32_t)(ui32_val - ui32_prev);
+
+    if (ui8_counter >= K_MON_CODEC_MAX_COUNTERS)
+    {
+        return false;
+    }
+
+    psi32_delta[ui8_counter] = si32_delta;
+
+    return putVarint(pui8_out, ui16_out_len, pui16_pos, zigZag((int32_t)((uint32_t)si32_delta - (uint32_t)ps_codec->asi32_delta[ui8_counter])));
+}
+
+/* columns of a payload with the previous layout; 0 if pui8_out is too small */
+static uint16_t encodeDelta(mon_codec_st *ps_codec, const uint8_t *pui8_pl, uint16_t ui16_len, uint8_t *pui8_out, uint16_t ui16_out_len)
+{
+    const uint8_t  *pui8_prev = ps_codec->aui8_prev;
+    int32_t         asi32_delta[K_MON_CODEC_MAX_COUNTERS];
+    uint8_t         ui8_counters = 0;
+    uint16_t        ui16_pos = 1;
+    uint16_t        ui16_off = (uint16_t)(3 + pui8_pl[2]);
+    bool            b_status;
+
+    if (0 == ui16_out_len)
+    {
+        return 0;
+    }
+    pui8_out[0] = K_MON_CODEC_DELTA;
+
+    // timestamp
+    b_status  = putCounter(ps_codec, asi32_delta, ui8_counters++, get32(&pui8_prev[ui16_off]), get32(&pui8_pl[ui16_off]),
+                           pui8_out, ui16_out_len, &ui16_pos);
+    ui16_off += 4;
+
+    while ((true == b_status) && (ui16_off < ui16_len))
+    {
+        uint8_t ui8_count = pui8_pl[ui16_off++] & 0x1F;
+
+        for (uint8_t p = 0; (true == b_status) && (p < ui8_count); p++)
+        {
+            uint8_t ui8_width = edgePayloadMonitorParamLen(pui8_pl[ui16_off++]) - 1;
+
+            if (2 == ui8_width)
+            {
+                b_status = putVarint(pui8_out, ui16_out_len, &ui16_pos,
+                                     zigZag((int16_t)(get16(&pui8_pl[ui16_off]) - get16(&pui8_prev[ui16_off]))));
+            }
+            else
+            {
+                b_status = putCounter(ps_codec, asi32_delta, ui8_counters++, get32(&pui8_prev[ui16_off]), get32(&pui8_pl[ui16_off]),
+                                      pui8_out, ui16_out_len, &ui16_pos);
+            }
+            ui16_off += ui8_width;
+        }
+    }
+
+    if (false == b_status)
+    {
+        return 0;
+    }
+
+    memcpy(ps_codec->asi32_delta, asi32_delta, ui8_counters * sizeof(int32_t));
+
+    return ui16_pos;
+}
+
+static bool getCounter(mon_codec_st *ps_codec, uint8_t ui8_counter, uint8_t *pui8_val, const uint8_t *pui8_rec, uint16_t ui16_len, uint16_t *pui16_pos)
+{
+    uint32_t ui32_zz;
+
+    if ((ui8_counter >= K_MON_CODEC_MAX_COUNTERS) || (false == getVarint(pui8_rec, ui16_len, pui16_pos, &ui32_zz)))
+    {
+        return false;
+    }
+
+    ps_codec->asi32_delta[ui8_counter] = (int32_t)((uint32_t)ps_codec->asi32_delta[ui8_counter] + (uint32_t)unZigZag(ui32_zz));
+    put32(pui8_val, get32(pui8_val) + (uint32_t)ps_codec->asi32_delta[ui8_counter]);
+
+    return true;
+}
+
+/* applied to the previous payload in place */
+static bool decodeDelta(mon_codec_st *ps_codec, const uint8_t *pui8_rec, uint16_t ui16_len)
+{
+    uint8_t    *pui8_pl  = ps_codec->aui8_prev;
+    uint16_t    ui16_pl_len = ps_codec->ui16_prev_len;
+    uint8_t     ui8_counters = 0;
+    uint16_t    ui16_pos = 1;
+    uint16_t    ui16_off;
+    bool        b_status;
+
+    if (0 == ui16_pl_len)
+    {
+        return false;
+    }
+
+    ui16_off  = (uint16_t)(3 + pui8_pl[2]);
+    b_status  = getCounter(ps_codec, ui8_counters++, &pui8_pl[ui16_off], pui8_rec, ui16_len, &ui16_pos);
+    ui16_off += 4;
+
+    while ((true == b_status) && (ui16_off < ui16_pl_len))
+    {
+        uint8_t ui8_count = pui8_pl[ui16_off++] & 0x1F;
+
+        for (uint8_t p = 0; (true == b_status) && (p < ui8_count); p++)
+        {
+            uint8_t     ui8_width = edgePayloadMonitorParamLen(pui8_pl[ui16_off++]) - 1;
+            uint32_t    ui32_zz;
+
+            if (2 == ui8_width)
+            {
+                b_status = getVarint(pui8_rec, ui16_len, &ui16_pos, &ui32_zz);
+                put16(&pui8_pl[ui16_off], (uint16_t)(get16(&pui8_pl[ui16_off]) + (uint16_t)unZigZag(ui32_zz)));
+            }
+            else
+            {
+                b_status = getCounter(ps_codec, ui8_counters++, &pui8_pl[ui16_off], pui8_rec, ui16_len, &ui16_pos);
+            }
+            ui16_off += ui8_width;
+        }
+    }
+
+    return (true == b_status) && (ui16_pos == ui16_len);
+}
+
+static bool samePos(const dlog_pos_st *ps_a, const dlog_pos_st *ps_b)
+{
+    return (ps_a->ui32_seg == ps_b->ui32_seg) && (ps_a->ui16_page == ps_b->ui16_page) && (ps_a->ui16_rec == ps_b->ui16_rec);
+}
+
+/* the records of the page before the reader position decoded again */
+static void resync(mon_codec_st *ps_codec, const dlog_st *ps_log, dlog_reader_st *ps_reader)
+{
+    dlog_pos_st     s_target = ps_reader->s_pos;
+    dlog_pos_st     s_start  = ps_reader->s_pos;
+    const uint8_t  *pui8_rec;
+    int32_t         si32_ts;
+    uint16_t        ui16_len;
+
+    ps_codec->ui16_prev_len = 0;
+    ps_codec->b_sync        = true;
+    if (0 != s_target.ui16_rec)
+    {
+        s_start.ui16_rec = 0;
+        dlogReaderSetPos(ps_reader, &s_start);
+        while (NULL != (pui8_rec = dlogReadRef(ps_log, ps_reader, &s_target, &si32_ts, &ui16_len)))
+        {
+            (void)monCodecDecode(ps_codec, pui8_rec, ui16_len);
+        }
+        ps_codec->ui32_resyncs++;
+    }
+    ps_codec->s_next = ps_reader->s_pos;
+}
+
+/*
+ * Public Functions
+ */
+void monCodecInit(mon_codec_st *ps_codec)
+{
+    memset(ps_codec, 0, sizeof(mon_codec_st));
+}
+
+/* a key record if b_key, for the first payload or another layout; 0 if the payload isn't a
+   monitor payload or doesn't fit */
+uint16_t monCodecEncode(mon_codec_st *ps_codec, const uint8_t *pui8_payload, uint16_t ui16_len, bool b_key, uint8_t *pui8_out, uint16_t ui16_out_len)
+{
+    uint16_t ui16_rec_len = 0;
+
+    if (false == validLayout(pui8_payload, ui16_len))
+    {
+        return 0;
+    }
+
+    if ((false == b_key) && (true == sameLayout(ps_codec, pui8_payload, ui16_len)))
+    {
+        ui16_rec_len = encodeDelta(ps_codec, pui8_payload, ui16_len, pui8_out, ui16_out_len);
+    }
+
+    if ((0 == ui16_rec_len) && (ui16_out_len > ui16_len))
+    {
+        pui8_out[0] = K_MON_CODEC_KEY;
+        memcpy(&pui8_out[1], pui8_payload, ui16_len);
+        memset(ps_codec->asi32_delta, 0, sizeof(ps_codec->asi32_delta));
+        ui16_rec_len = ui16_len + 1;
+    }
+
+    if (0 != ui16_rec_len)
+    {
+        memcpy(ps_codec->aui8_prev, pui8_payload, ui16_len);
+        ps_codec->ui16_prev_len = ui16_len;
+    }
+
+    return ui16_rec_len;
+}
+
+/* next record of the page into aui8_prev / ui16_prev_len */
+bool monCodecDecode(mon_codec_st *ps_codec, const uint8_t *pui8_rec, uint16_t ui16_len)
+{
+    const uint8_t  *pui8_pl  = pui8_rec;
+    uint16_t        ui16_pl_len = ui16_len;
+
+    if ((0 != ui16_len) && (K_MON_CODEC_DELTA == pui8_rec[0]))
+    {
+        if (false == decodeDelta(ps_codec, pui8_rec, ui16_len))
+        {
+            ps_codec->ui16_prev_len = 0;
+            return false;
+        }
+        return true;
+    }
+    else if ((0 != ui16_len) && (K_MON_CODEC_KEY == pui8_rec[0]))
+    {
+        pui8_pl++;
+        ui16_pl_len--;
+    }
+
+    if (false == validLayout(pui8_pl, ui16_pl_len))
+    {
+        ps_codec->ui16_prev_len = 0;
+        return false;
+    }
+
+    memcpy(ps_codec->aui8_prev, pui8_pl, ui16_pl_len);
+    ps_codec->ui16_prev_len = ui16_pl_len;
+    memset(ps_codec->asi32_delta, 0, sizeof(ps_codec->asi32_delta));
+
+    return true;
+}
+
+/* the only appending task: the first record of a page is a key record, so is the one after a
+   failed append */
+bool monCodecAppend(mon_codec_st *ps_codec, dlog_st *ps_log, int32_t si32_ts, const uint8_t *pui8_payload, uint16_t ui16_len)
+{
+    static uint8_t  aui8_rec[K_MON_CODEC_MAX_LEN + 1];
+    uint16_t        ui16_rec_len = monCodecEncode(ps_codec, pui8_payload, ui16_len, false, aui8_rec, sizeof(aui8_rec));
+
+    if ((0 != ui16_rec_len) && (K_MON_CODEC_DELTA == aui8_rec[0]) && (false == dlogFits(ps_log, ui16_rec_len)))
+    {
+        ui16_rec_len = monCodecEncode(ps_codec, pui8_payload, ui16_len, true, aui8_rec, sizeof(aui8_rec));
+    }
+
+    if ((0 == ui16_rec_len) || (false == dlogAppend(ps_log, si32_ts, aui8_rec, ui16_rec_len)))
+    {
+        ps_codec->ui16_prev_len = 0;
+        return false;
+    }
+
+    ps_codec->ui32_keys   += (K_MON_CODEC_KEY == aui8_rec[0]) ? 1 : 0;
+    ps_codec->ui32_deltas += (K_MON_CODEC_DELTA == aui8_rec[0]) ? 1 : 0;
+    ps_codec->ui64_payload_bytes += ui16_len;
+    ps_codec->ui64_coded_bytes   += ui16_rec_len;
+
+    return true;
+}
+
+/* next payload, decoded from the record in place into aui8_prev and valid until the codec is
+   used again; NULL at the end, undecodable records are skipped */
+const uint8_t *monCodecReadRef(mon_codec_st *ps_codec, const dlog_st *ps_log, dlog_reader_st *ps_reader, const dlog_pos_st *ps_end,
+                               int32_t *psi32_ts, uint16_t *pui16_len)
+{
+    const uint8_t  *pui8_rec;
+    uint16_t        ui16_rec_len;
+
+    if ((false == ps_codec->b_sync) || (false == samePos(&ps_codec->s_next, &ps_reader->s_pos)))
+    {
+        resync(ps_codec, ps_log, ps_reader);
+    }
+
+    do
+    {
+        pui8_rec = dlogReadRef(ps_log, ps_reader, ps_end, psi32_ts, &ui16_rec_len);
+        if (NULL == pui8_rec)
+        {
+            return NULL;
+        }
+        ps_codec->s_next = ps_reader->s_pos;
+        ps_codec->ui32_errors += (false == monCodecDecode(ps_codec, pui8_rec, ui16_rec_len)) ? 1 : 0;
+    } while (0 == ps_codec->ui16_prev_len);
+
+    *pui16_len = ps_codec->ui16_prev_len;
+
+    return ps_codec->aui8_prev;
+}
+
+/* monCodecReadRef() copied into pui8_buf, payloads longer than ui16_buf_len are skipped */
+bool monCodecRead(mon_codec_st *ps_codec, const dlog_st *ps_log, dlog_reader_st *ps_reader, const dlog_pos_st *ps_end,
+                  int32_t *psi32_ts, uint8_t *pui8_buf, uint16_t ui16_buf_len, uint16_t *pui16_len)
+{
+    const uint8_t *pui8_payload;
+
+    do
+    {
+        pui8_payload = monCodecReadRef(ps_codec, ps_log, ps_reader, ps_end, psi32_ts, pui16_len);
+        if (NULL == pui8_payload)
+        {
+            return false;
+        }
+    } while (*pui16_len > ui16_buf_len);
+
+    memcpy(pui8_buf, pui8_payload, *pui16_len);
+
+    return true;
+}
@@ -0,0 +1,78 @@
+/*****************************************************************************************//**
+* \file         mon_codec.h
+*
+* \brief        Monitor payload codec library header file.
+* \details      Compresses the monitor payloads of the data log: every parameter of the payload
+*               is a column, coded against the same column of the previous record of the page
+*               (16-bit values delta, the timestamp & 32-bit counters delta-of-delta) as zig-zag
+*               varints. The first record of a page is stored whole, pages stay independent.
+*
+* \version      v00.01.00
+* \date         20261017
+*********************************************************************************************/
+// *INDENT-OFF*
+#ifndef __MON_CODEC_H__
+#define __MON_CODEC_H__
+// *INDENT-ON*
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Include .h Library Files
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "mon_codec_cfg.h"
+#include "data_log/data_log.h"
+#include "edge_payload/edge_payload.h"
+
+/*
+ * Global Constants
+ */
+#define K_MON_CODEC_KEY                 (0xF0)      // record tags, a payload starts with its protocol version
+#define K_MON_CODEC_DELTA               (0xF1)
+#define K_MON_CODEC_MAX_COUNTERS        (1 + (K_PAYLOAD_MAX_MON_PARAM32_COUNT * K_PAYLOAD_MAX_MON_PHASE_COUNT))
+
+/*
+ * Global Structs
+ */
+typedef struct
+{
+    uint8_t         aui8_prev[K_MON_CODEC_MAX_LEN];                 // previous payload of the page
+    uint16_t        ui16_prev_len;                                  // 0: none, a key record comes next
+    int32_t         asi32_delta[K_MON_CODEC_MAX_COUNTERS];          // previous delta of the timestamp & 32-bit columns
+    bool            b_sync;                                         // reading: decoded up to s_next
+    dlog_pos_st     s_next;
+
+    // statistics
+    uint32_t        ui32_keys;
+    uint32_t        ui32_deltas;
+    uint64_t        ui64_payload_bytes;
+    uint64_t        ui64_coded_bytes;
+    uint32_t        ui32_resyncs;
+    uint32_t        ui32_errors;
+} mon_codec_st;
+
+/*
+ * Public Function Prototypes
+ */
+void monCodecInit(mon_codec_st *ps_codec);
+
+uint16_t monCodecEncode(mon_codec_st *ps_codec, const uint8_t *pui8_payload, uint16_t ui16_len, bool b_key, uint8_t *pui8_out, uint16_t ui16_out_len);
+bool monCodecDecode(mon_codec_st *ps_codec, const uint8_t *pui8_rec, uint16_t ui16_len);
+
+bool monCodecAppend(mon_codec_st *ps_codec, dlog_st *ps_log, int32_t si32_ts, const uint8_t *pui8_payload, uint16_t ui16_len);
+const uint8_t *monCodecReadRef(mon_codec_st *ps_codec, const dlog_st *ps_log, dlog_reader_st *ps_reader, const dlog_pos_st *ps_end,
+                               int32_t *psi32_ts, uint16_t *pui16_len);
+bool monCodecRead(mon_codec_st *ps_codec, const dlog_st *ps_log, dlog_reader_st *ps_reader, const dlog_pos_st *ps_end,
+                  int32_t *psi32_ts, uint8_t *pui8_buf, uint16_t ui16_buf_len, uint16_t *pui16_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif/* end of mon_codec.h */
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,254 @@
+/*****************************************************************************************//**
+* \file         monitor_agg.c
+*
+* \brief        Windowed monitor aggregation library source file.
+* \details      Samples go into the 1 s window; each closed window is merged into the next
+*               tier, so a finished report interval costs one merge per channel & phase.
+*
+* \version      v00.01.00
+* \date         20261017
+*********************************************************************************************/
+/*
+ * Included Modules
+ */
+#include "global_defs.h"
+#include "monitor_agg.h"
+
+/*
+ * Private Functions
+ */
+static void statReset(mon_agg_stat_st *ps_stat)
+{
+    ps_stat->si32_min   = INT32_MAX;
+    ps_stat->si32_max   = INT32_MIN;
+    ps_stat->si64_sum   = 0;
+    ps_stat->ui32_count = 0;
+}
+
+static void statMerge(mon_agg_stat_st *ps_dst, const mon_agg_stat_st *ps_src)
+{
+    if (0 != ps_src->ui32_count)
+    {
+        ps_dst->si32_min    = (ps_src->si32_min < ps_dst->si32_min) ? ps_src->si32_min : ps_dst->si32_min;
+        ps_dst->si32_max    = (ps_src->si32_max > ps_dst->si32_max) ? ps_src->si32_max : ps_dst->si32_max;
+        ps_dst->si64_sum   += ps_src->si64_sum;
+        ps_dst->ui32_count += ps_src->ui32_count;
+    }
+}
+
+/* close the "e_tier" window of every channel & phase into "pas_dst" */
+static void tierRoll(mon_agg_st *ps_agg, mon_agg_tier_et e_tier, mon_agg_stat_st (*pas_dst)[K_MON_AGG_MAX_CHANNELS])
+{
+    for (uint8_t p = 0; p < ps_agg->ui8_phases; p++)
+    {
+        for (uint8_t c = 0; c < ps_agg->ui8_channels; c++)
+        {
+            statMerge(&pas_dst[p][c], &ps_agg->as_stat[e_tier][p][c]);
+            statReset(&ps_agg->as_stat[e_tier][p][c]);
+        }
+    }
+}
+
+/* windows of wall clock second "ui32_wall_s" */
+static void openWindows(mon_agg_st *ps_agg, uint32_t ui32_wall_s)
+{
+    ps_agg->aui32_window[MON_AGG_TIER_SECOND]   = ui32_wall_s;
+    ps_agg->aui32_window[MON_AGG_TIER_MINUTE]   = ui32_wall_s / 60;
+    ps_agg->aui32_window[MON_AGG_TIER_INTERVAL] = (ui32_wall_s / 60) / ps_agg->ui16_interval_min;
+}
+
+static void closeInterval(mon_agg_st *ps_agg, bool b_cut)
+{
+    for (uint8_t p = 0; p < ps_agg->ui8_phases; p++)
+    {
+        for (uint8_t c = 0; c < ps_agg->ui8_channels; c++)
+        {
+            statReset(&ps_agg->as_done[p][c]);
+        }
+    }
+    tierRoll(ps_agg, MON_AGG_TIER_INTERVAL, ps_agg->as_done);
+    ps_agg->ui32_done_window = ps_agg->aui32_window[MON_AGG_TIER_INTERVAL];
+    ps_agg->ui16_done_min    = ps_agg->ui16_interval_min;
+    ps_agg->b_done_cut       = b_cut;
+    ps_agg->ui32_cut        += (true == b_cut) ? 1 : 0;
+}
+
+/* the pending interval & offset from tick second "ui32_now_s" on: the open minute goes into the open
+   interval, which carries over if it started within the new grid's first window, otherwise it's closed
+   (early, unless it just ended anyway). The first new window may be short, its end is on the clock. */
+static bool switchInterval(mon_agg_st *ps_agg, uint32_t ui32_now_s)
+{
+    uint32_t ui32_old_len_s = (uint32_t)ps_agg->ui16_interval_min * 60;
+    uint32_t ui32_new_len_s = (uint32_t)ps_agg->ui16_next_min * 60;
+    uint32_t ui32_old_start = ps_agg->aui32_window[MON_AGG_TIER_INTERVAL] * ui32_old_len_s - ps_agg->ui32_offset_s;
+    uint32_t ui32_new_wall  = ui32_now_s + ps_agg->ui32_next_offset_s;
+    uint32_t ui32_new_start = (ui32_new_wall / ui32_new_len_s) * ui32_new_len_s - ps_agg->ui32_next_offset_s;
+    bool     b_ended        = ((ui32_now_s + ps_agg->ui32_offset_s) / ui32_old_len_s) != ps_agg->aui32_window[MON_AGG_TIER_INTERVAL];
+    bool     b_close        = (true == b_ended) || ((int32_t)(ui32_old_start - ui32_new_start) < 0);
+
+    tierRoll(ps_agg, MON_AGG_TIER_MINUTE, ps_agg->as_stat[MON_AGG_TIER_INTERVAL]);
+    if (true == b_close)
+    {
+        closeInterval(ps_agg, (false == b_ended));
+    }
+
+    ps_agg->ui16_interval_min = ps_agg->ui16_next_min;
+    ps_agg->ui32_offset_s     = ps_agg->ui32_next_offset_s;
+    ps_agg->ui16_next_min     = 0;
+    ps_agg->ui32_switches++;
+    openWindows(ps_agg, ui32_new_wall);
+
+    return b_close;
+}
+
+static uint16_t toPayload(const mon_agg_channel_st *ps_channel, int64_t si64_value)
+{
+    int64_t si64_min = (true == ps_channel->b_signed) ? INT16_MIN : 0;
+    int64_t si64_max = (true == ps_channel->b_signed) ? INT16_MAX : UINT16_MAX;
+
+    si64_value /= ps_channel->si32_div;
+    si64_value  = (si64_value < si64_min) ? si64_min : ((si64_value > si64_max) ? si64_max : si64_value);
+
+    return (uint16_t)si64_value;
+}
+
+static bool addParam(ep_writer_st *ps_writer, ep_monitor_id_et e_id, const mon_agg_channel_st *ps_channel, int64_t si64_value)
+{
+    if (K_MON_AGG_NO_ID == e_id)
+    {
+        return true;
+    }
+
+    return edgePayloadWriteMonitorParam(ps_writer, e_id, toPayload(ps_channel, si64_value));
+}
+
+/*
+ * Public Functions
+ */
+bool monAggInit(mon_agg_st *ps_agg, const mon_agg_channel_st *pas_channel, uint8_t ui8_channels, uint8_t ui8_phases, uint16_t ui16_interval_min)
+{
+    if ((ui8_channels > K_MON_AGG_MAX_CHANNELS) || (ui8_phases > K_MON_AGG_MAX_PHASES) || (0 == ui16_interval_min))
+    {
+        return false;
+    }
+
+    memset(ps_agg, 0, sizeof(mon_agg_st));
+    ps_agg->pas_channel         = pas_channel;
+    ps_agg->ui8_channels        = ui8_channels;
+    ps_agg->ui8_phases          = ui8_phases;
+    ps_agg->ui16_interval_min   = ui16_interval_min;
+    ps_agg->ui16_done_min       = ui16_interval_min;
+
+    for (uint8_t t = 0; t < MON_AGG_NUM_TIERS; t++)
+    {
+        for (uint8_t p = 0; p < K_MON_AGG_MAX_PHASES; p++)
+        {
+            for (uint8_t c = 0; c < K_MON_AGG_MAX_CHANNELS; c++)
+            {
+                statReset(&ps_agg->as_stat[t][p][c]);
+                statReset(&ps_agg->as_done[p][c]);
+            }
+        }
+    }
+
+    return true;
+}
+
+void monAggAdd(mon_agg_st *ps_agg, uint8_t ui8_phase, uint8_t ui8_channel, int32_t si32_value)
+{
+    mon_agg_stat_st *ps_stat;
+
+    if ((ui8_phase >= ps_agg->ui8_phases) || (ui8_channel >= ps_agg->ui8_channels))
+    {
+        return;
+    }
+
+    ps_stat = &ps_agg->as_stat[MON_AGG_TIER_SECOND][ui8_phase][ui8_channel];
+    ps_stat->si32_min   = (si32_value < ps_stat->si32_min) ? si32_value : ps_stat->si32_min;
+    ps_stat->si32_max   = (si32_value > ps_stat->si32_max) ? si32_value : ps_stat->si32_max;
+    ps_stat->si64_sum  += si32_value;
+    ps_stat->ui32_count++;
+}
+
+/* interval of "ui16_interval_min" on the wall clock, "ui32_offset_s" ahead of the tick seconds, from the
+   next new second on (or the first tick); the last request before it wins */
+bool monAggSetInterval(mon_agg_st *ps_agg, uint16_t ui16_interval_min, uint32_t ui32_offset_s)
+{
+    if (0 == ui16_interval_min)
+    {
+        return false;
+    }
+
+    ps_agg->ui16_next_min       = ui16_interval_min;
+    ps_agg->ui32_next_offset_s  = ui32_offset_s;
+
+    return true;
+}
+
+/* call before adding the samples of "ui32_now_s"; true = a report interval just finished */
+bool monAggTick(mon_agg_st *ps_agg, uint32_t ui32_now_s)
+{
+    uint32_t ui32_wall_s    = ui32_now_s + ps_agg->ui32_offset_s;
+    uint32_t ui32_minute    = ui32_wall_s / 60;
+    uint32_t ui32_interval  = ui32_minute / ps_agg->ui16_interval_min;
+    bool     b_done         = false;
+
+    if (false == ps_agg->b_started)
+    {
+        if (0 != ps_agg->ui16_next_min)
+        {
+            ps_agg->ui16_interval_min   = ps_agg->ui16_next_min;
+            ps_agg->ui32_offset_s       = ps_agg->ui32_next_offset_s;
+            ps_agg->ui16_next_min       = 0;
+        }
+        openWindows(ps_agg, ui32_now_s + ps_agg->ui32_offset_s);
+        ps_agg->b_started = true;
+    }
+    else if (ui32_wall_s > ps_agg->aui32_window[MON_AGG_TIER_SECOND])  // late samples stay in the open second
+    {
+        tierRoll(ps_agg, MON_AGG_TIER_SECOND, ps_agg->as_stat[MON_AGG_TIER_MINUTE]);
+        ps_agg->aui32_window[MON_AGG_TIER_SECOND] = ui32_wall_s;
+
+        if (0 != ps_agg->ui16_next_min)
+        {
+            b_done = switchInterval(ps_agg, ui32_now_s);
+        }
+        else if (ui32_minute != ps_agg->aui32_window[MON_AGG_TIER_MINUTE])
+        {
+            tierRoll(ps_agg, MON_AGG_TIER_MINUTE, ps_agg->as_stat[MON_AGG_TIER_INTERVAL]);
+            ps_agg->aui32_window[MON_AGG_TIER_MINUTE] = ui32_minute;
+
+            if (ui32_interval != ps_agg->aui32_window[MON_AGG_TIER_INTERVAL])
+            {
+                closeInterval(ps_agg, false);
+                ps_agg->aui32_window[MON_AGG_TIER_INTERVAL] = ui32_interval;
+                b_done = true;
+            }
+        }
+    }
+
+    return b_done;
+}
+
+/* mean/min/max of the finished interval of "ui8_phase", into the open monitor phase of ps_writer */
+bool monAggAddMonitorParams(ep_writer_st *ps_writer, const mon_agg_st *ps_agg, uint8_t ui8_phase)
+{
+    bool b_status = (ui8_phase < ps_agg->ui8_phases);
+
+    for (uint8_t c = 0; (true == b_status) && (c < ps_agg->ui8_channels); c++)
+    {
+        const mon_agg_channel_st    *ps_channel = &ps_agg->pas_channel[c];
+        const mon_agg_stat_st       *ps_stat    = &ps_agg->as_done[ui8_phase][c];
+
+        if (0 == ps_stat->ui32_count)
+        {
+            continue;
+        }
+
+        b_status = addParam(ps_writer, ps_channel->e_mean_id, ps_channel, ps_stat->si64_sum / (int64_t)ps_stat->ui32_count) &&
+                   addParam(ps_writer, ps_channel->e_min_id,  ps_channel, ps_stat->si32_min) &&
+                   addParam(ps_writer, ps_channel->e_max_id,  ps_channel, ps_stat->si32_max);
+    }
+
+    return b_status;
+}
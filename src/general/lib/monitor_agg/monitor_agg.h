@@ -0,0 +1,99 @@
+/*****************************************************************************************//**
+* \file         monitor_agg.h
+*
+* \brief        Windowed monitor aggregation library header file.
+* \details      Running sum/min/max/count per channel & phase, rolled 1 s -> 1 min -> report
+*               interval. Constant memory, no raw samples are kept. The windows lie on the
+*               wall clock, the interval can be switched while samples come in.
+*
+* \version      v00.01.00
+* \date         20261017
+*********************************************************************************************/
+// *INDENT-OFF*
+#ifndef __MONITOR_AGG_H__
+#define __MONITOR_AGG_H__
+// *INDENT-ON*
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Include .h Library Files
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "monitor_agg_cfg.h"
+#include "edge_payload/edge_payload.h"
+
+/*
+ * Global Constants
+ */
+#define K_MON_AGG_NO_ID                 ((ep_monitor_id_et)0)   // statistic not reported
+
+typedef enum
+{
+    MON_AGG_TIER_SECOND,
+    MON_AGG_TIER_MINUTE,
+    MON_AGG_TIER_INTERVAL,
+    MON_AGG_NUM_TIERS
+} mon_agg_tier_et;
+
+/*
+ * Global Structs
+ */
+typedef struct
+{
+    ep_monitor_id_et    e_mean_id;
+    ep_monitor_id_et    e_min_id;
+    ep_monitor_id_et    e_max_id;
+    int32_t             si32_div;       // sample units per payload unit
+    bool                b_signed;       // payload value is int16
+} mon_agg_channel_st;
+
+typedef struct
+{
+    int32_t             si32_min;
+    int32_t             si32_max;
+    int64_t             si64_sum;
+    uint32_t            ui32_count;
+} mon_agg_stat_st;
+
+typedef struct
+{
+    const mon_agg_channel_st   *pas_channel;
+    uint8_t                     ui8_channels;
+    uint8_t                     ui8_phases;
+    uint16_t                    ui16_interval_min;
+    uint32_t                    ui32_offset_s;                      // tick seconds + offset = wall clock seconds
+    uint16_t                    ui16_next_min;                      // switch at the next new second, 0 = none
+    uint32_t                    ui32_next_offset_s;
+    bool                        b_started;
+    uint32_t                    aui32_window[MON_AGG_NUM_TIERS];    // open second / minute / interval, wall clock
+    uint32_t                    ui32_done_window;                   // interval number of "as_done"
+    uint16_t                    ui16_done_min;                      // ... in intervals of this length
+    bool                        b_done_cut;                         // "as_done" closed early by a switch
+    mon_agg_stat_st             as_stat[MON_AGG_NUM_TIERS][K_MON_AGG_MAX_PHASES][K_MON_AGG_MAX_CHANNELS];
+    mon_agg_stat_st             as_done[K_MON_AGG_MAX_PHASES][K_MON_AGG_MAX_CHANNELS];
+
+    // statistics
+    uint32_t                    ui32_switches;
+    uint32_t                    ui32_cut;                           // intervals closed early by a switch
+} mon_agg_st;
+
+/*
+ * Public Function Prototypes
+ */
+bool monAggInit(mon_agg_st *ps_agg, const mon_agg_channel_st *pas_channel, uint8_t ui8_channels, uint8_t ui8_phases, uint16_t ui16_interval_min);
+void monAggAdd(mon_agg_st *ps_agg, uint8_t ui8_phase, uint8_t ui8_channel, int32_t si32_value);
+bool monAggSetInterval(mon_agg_st *ps_agg, uint16_t ui16_interval_min, uint32_t ui32_offset_s);
+bool monAggTick(mon_agg_st *ps_agg, uint32_t ui32_now_s);
+bool monAggAddMonitorParams(ep_writer_st *ps_writer, const mon_agg_st *ps_agg, uint8_t ui8_phase);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif/* end of monitor_agg.h */
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,205 @@
+/*****************************************************************************************//**
+* \file         pq_event.c
+*
+* \brief        Power quality event detection library source file.
+* \details      An event starts at the first sample outside the limits and ends at the first
+*               sample back inside by the hysteresis. A sag that drops below the interruption
+*               limit becomes an interruption; a sag or swell lasting K_PQ_SUSTAINED_MS is an
+*               under / over voltage.
+*
+* \version      v00.01.00
+* \date         20261017
+*********************************************************************************************/
+/*
+ * Included Modules
+ */
+#include "global_defs.h"
+#include "pq_event.h"
+
+/*
+ * Private Functions
+ */
+static uint16_t pctOf(uint16_t ui16_nominal_cv, uint16_t ui16_pct)
+{
+    return (uint16_t)(((uint32_t)ui16_nominal_cv * ui16_pct) / 100);
+}
+
+static uint16_t clampCv(int32_t si32_cv)
+{
+    return (uint16_t)((si32_cv < 0) ? 0 : ((si32_cv > UINT16_MAX) ? UINT16_MAX : si32_cv));
+}
+
+static pq_state_et classify(const pq_detector_st *ps_det, uint16_t ui16_cv)
+{
+    if (ui16_cv < ps_det->ui16_interruption_cv)
+    {
+        return PQ_STATE_INTERRUPTION;
+    }
+    else if (ui16_cv < ps_det->ui16_sag_cv)
+    {
+        return PQ_STATE_SAG;
+    }
+    else if (ui16_cv > ps_det->ui16_swell_cv)
+    {
+        return PQ_STATE_SWELL;
+    }
+
+    return PQ_STATE_NORMAL;
+}
+
+static void start(pq_phase_st *ps_phase, pq_state_et e_state, uint32_t ms_timestamp, uint16_t ui16_cv)
+{
+    ps_phase->e_state           = e_state;
+    ps_phase->ms_start          = ms_timestamp;
+    ps_phase->ui16_extreme_cv   = ui16_cv;
+}
+
+static void finish(pq_detector_st *ps_det, uint8_t ui8_phase, uint32_t ms_timestamp)
+{
+    pq_phase_st *ps_phase = &ps_det->as_phase[ui8_phase];
+    pq_event_st *ps_event;
+    uint32_t     ms_duration = ms_timestamp - ps_phase->ms_start;
+
+    if (ms_duration < K_PQ_MIN_DURATION_MS)
+    {
+        //
+    }
+    else if (ps_det->ui8_count >= K_PQ_EVENT_QUEUE_LEN)
+    {
+        ps_det->ui32_dropped++;
+    }
+    else
+    {
+        ps_event = &ps_det->as_queue[(ps_det->ui8_head + ps_det->ui8_count) % K_PQ_EVENT_QUEUE_LEN];
+        ps_det->ui8_count++;
+
+        switch (ps_phase->e_state)
+        {
+        case PQ_STATE_INTERRUPTION:
+            ps_event->e_type = EP_EVT_TYP_GDL_NO_VOLTAGE_FAULT;
+            break;
+
+        case PQ_STATE_SAG:
+            ps_event->e_type = (ms_duration >= K_PQ_SUSTAINED_MS) ? EP_EVT_TYP_GDL_UV_WARN : EP_EVT_TYP_GDL_VSAG_FAULT;
+            break;
+
+        default:
+            ps_event->e_type = (ms_duration >= K_PQ_SUSTAINED_MS) ? EP_EVT_TYP_GDL_OV_WARN : EP_EVT_TYP_GDL_VSWELL_FAULT;
+            break;
+        }
+        ps_event->ui8_phase         = ui8_phase;
+        ps_event->ms_start          = ps_phase->ms_start;
+        ps_event->ms_duration       = ms_duration;
+        ps_event->ui16_extreme_cv   = ps_phase->ui16_extreme_cv;
+    }
+
+    ps_phase->e_state = PQ_STATE_NORMAL;
+}
+
+/*
+ * Public Functions
+ */
+void pqDetInit(pq_detector_st *ps_det, uint8_t ui8_phases, uint16_t ui16_nominal_cv)
+{
+    memset(ps_det, 0, sizeof(pq_detector_st));
+    ps_det->ui8_phases           = (ui8_phases < K_PQ_MAX_PHASES) ? ui8_phases : K_PQ_MAX_PHASES;
+    ps_det->ui16_sag_cv          = pctOf(ui16_nominal_cv, K_PQ_SAG_PCT);
+    ps_det->ui16_swell_cv        = pctOf(ui16_nominal_cv, K_PQ_SWELL_PCT);
+    ps_det->ui16_interruption_cv = pctOf(ui16_nominal_cv, K_PQ_INTERRUPTION_PCT);
+    ps_det->ui16_hyst_cv         = pctOf(ui16_nominal_cv, K_PQ_HYSTERESIS_PCT);
+}
+
+/* one rms voltage sample of a phase, O(1) */
+void pqDetAdd(pq_detector_st *ps_det, uint8_t ui8_phase, uint32_t ms_timestamp, int32_t si32_vrms_cv)
+{
+    pq_phase_st *ps_phase;
+    uint16_t     ui16_cv = clampCv(si32_vrms_cv);
+    pq_state_et  e_class;
+
+    if (ui8_phase >= ps_det->ui8_phases)
+    {
+        return;
+    }
+
+    ps_phase = &ps_det->as_phase[ui8_phase];
+    e_class  = classify(ps_det, ui16_cv);
+
+    switch (ps_phase->e_state)
+    {
+    case PQ_STATE_NORMAL:
+        if (PQ_STATE_NORMAL != e_class)
+        {
+            start(ps_phase, e_class, ms_timestamp, ui16_cv);
+        }
+        break;
+
+    case PQ_STATE_SAG:
+    case PQ_STATE_INTERRUPTION:
+        if (PQ_STATE_SWELL == e_class)
+        {
+            finish(ps_det, ui8_phase, ms_timestamp);
+            start(ps_phase, e_class, ms_timestamp, ui16_cv);
+        }
+        else if (ui16_cv >= (ps_det->ui16_sag_cv + ps_det->ui16_hyst_cv))
+        {
+            finish(ps_det, ui8_phase, ms_timestamp);
+        }
+        else
+        {
+            ps_phase->e_state         = (PQ_STATE_INTERRUPTION == e_class) ? PQ_STATE_INTERRUPTION : ps_phase->e_state;
+            ps_phase->ui16_extreme_cv = (ui16_cv < ps_phase->ui16_extreme_cv) ? ui16_cv : ps_phase->ui16_extreme_cv;
+        }
+        break;
+
+    default:
+        if ((PQ_STATE_SAG == e_class) || (PQ_STATE_INTERRUPTION == e_class))
+        {
+            finish(ps_det, ui8_phase, ms_timestamp);
+            start(ps_phase, e_class, ms_timestamp, ui16_cv);
+        }
+        else if (ui16_cv <= (ps_det->ui16_swell_cv - ps_det->ui16_hyst_cv))
+        {
+            finish(ps_det, ui8_phase, ms_timestamp);
+        }
+        else
+        {
+            ps_phase->ui16_extreme_cv = (ui16_cv > ps_phase->ui16_extreme_cv) ? ui16_cv : ps_phase->ui16_extreme_cv;
+        }
+        break;
+    }
+}
+
+/* oldest finished event */
+bool pqDetPop(pq_detector_st *ps_det, pq_event_st *ps_event)
+{
+    if (0 == ps_det->ui8_count)
+    {
+        return false;
+    }
+
+    *ps_event        = ps_det->as_queue[ps_det->ui8_head];
+    ps_det->ui8_head = (ps_det->ui8_head + 1) % K_PQ_EVENT_QUEUE_LEN;
+    ps_det->ui8_count--;
+
+    return true;
+}
+
+/* event content: phase (1), start time (4), duration ms (4), extreme voltage cV (2), little endian */
+uint8_t pqEventContent(const pq_event_st *ps_event, int32_t si32_start_time, uint8_t *pui8_buf)
+{
+    uint8_t *pui8_end = pui8_buf;
+
+    *pui8_end++ = (uint8_t)(EP_PHASE_INDEX_L1 + ps_event->ui8_phase);
+    *pui8_end++ = (uint8_t)((si32_start_time >> 0)  & 0xFF);
+    *pui8_end++ = (uint8_t)((si32_start_time >> 8)  & 0xFF);
+    *pui8_end++ = (uint8_t)((si32_start_time >> 16) & 0xFF);
+    *pui8_end++ = (uint8_t)((si32_start_time >> 24) & 0xFF);
+    *pui8_end++ = (uint8_t)((ps_event->ms_duration >> 0)  & 0xFF);
+    *pui8_end++ = (uint8_t)((ps_event->ms_duration >> 8)  & 0xFF);
+    *pui8_end++ = (uint8_t)((ps_event->ms_duration >> 16) & 0xFF);
+    *pui8_end++ = (uint8_t)((ps_event->ms_duration >> 24) & 0xFF);
+    *pui8_end++ = (uint8_t)((ps_event->ui16_extreme_cv >> 0) & 0xFF);
+    *pui8_end++ = (uint8_t)((ps_event->ui16_extreme_cv >> 8) & 0xFF);
+
+    return (uint8_t)(pui8_end - pui8_buf);
+}
@@ -0,0 +1,92 @@
+/*****************************************************************************************//**
+* \file         pq_event.h
+*
+* \brief        Power quality event detection library header file.
+* \details      Sag / swell / interruption detection on the rms voltage stream of each phase,
+*               with hysteresis and a minimum duration. One state per phase and a fixed queue
+*               of finished events, no history is kept.
+*
+* \version      v00.01.00
+* \date         20261017
+*********************************************************************************************/
+// *INDENT-OFF*
+#ifndef __PQ_EVENT_H__
+#define __PQ_EVENT_H__
+// *INDENT-ON*
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Include .h Library Files
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "pq_event_cfg.h"
+#include "edge_payload/edge_payload.h"
+
+/*
+ * Global Constants
+ */
+#define K_PQ_EVENT_CONTENT_LEN          (11)        // phase, start time, duration, extreme voltage
+
+typedef enum
+{
+    PQ_STATE_NORMAL,
+    PQ_STATE_SAG,
+    PQ_STATE_SWELL,
+    PQ_STATE_INTERRUPTION
+} pq_state_et;
+
+/*
+ * Global Structs
+ */
+typedef struct
+{
+    ep_event_type_et    e_type;
+    uint8_t             ui8_phase;
+    uint32_t            ms_start;           // first sample outside the limits
+    uint32_t            ms_duration;        // until the first sample back inside
+    uint16_t            ui16_extreme_cv;    // lowest (sag, interruption) or highest (swell) rms voltage
+} pq_event_st;
+
+typedef struct
+{
+    pq_state_et         e_state;
+    uint32_t            ms_start;
+    uint16_t            ui16_extreme_cv;
+} pq_phase_st;
+
+typedef struct
+{
+    uint8_t             ui8_phases;
+    uint16_t            ui16_sag_cv;
+    uint16_t            ui16_swell_cv;
+    uint16_t            ui16_interruption_cv;
+    uint16_t            ui16_hyst_cv;
+
+    pq_phase_st         as_phase[K_PQ_MAX_PHASES];
+
+    pq_event_st         as_queue[K_PQ_EVENT_QUEUE_LEN];
+    uint8_t             ui8_head;
+    uint8_t             ui8_count;
+    uint32_t            ui32_dropped;       // queue full
+} pq_detector_st;
+
+/*
+ * Public Function Prototypes
+ */
+void pqDetInit(pq_detector_st *ps_det, uint8_t ui8_phases, uint16_t ui16_nominal_cv);
+void pqDetAdd(pq_detector_st *ps_det, uint8_t ui8_phase, uint32_t ms_timestamp, int32_t si32_vrms_cv);
+bool pqDetPop(pq_detector_st *ps_det, pq_event_st *ps_event);
+
+uint8_t pqEventContent(const pq_event_st *ps_event, int32_t si32_start_time, uint8_t *pui8_buf);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif/* end of pq_event.h */
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+#include <string.h>
+
+
+#ifndef K_SNAPSHOT_RING_ALIGN
+#define K_SNAPSHOT_RING_ALIGN       (64)    // slot alignment, avoids false sharing on cached cores
+#endif
+
+#ifndef K_SNAPSHOT_RING_READ_RETRIES
+#define K_SNAPSHOT_RING_READ_RETRIES (4)    // a reader only retries if the writer lapped the whole ring
+#endif
+
+
+/*
+Single-producer / multi-consumer ring of the N most recent records.
+
+The producer never blocks: each slot is a seqlock (odd version = being written). Readers copy
+a slot and validate its version afterwards, so they never block the producer either and only
+retry when the slot was recycled during the copy.
+*/
+template <typename T, uint8_t N>
+class SnapshotRing
+{
+    static_assert(N >= 2, "ring needs at least 2 slots");
+
+public:
+    SnapshotRing() : ui32_head(0) { }
+
+    /* producer only; returns the record sequence number (1, 2, ...) */
+    uint32_t publish(const T &s_record)
+    {
+        uint32_t ui32_seq = ui32_head.load(std::memory_order_relaxed) + 1;
+        slot_st &s_slot = as_slot[ui32_seq % N];
+
+        s_slot.ui32_version.store((2 * ui32_seq) - 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        memcpy(&s_slot.s_record, &s_record, sizeof(T));
+        s_slot.ui32_version.store(2 * ui32_seq, std::memory_order_release);
+
+        ui32_head.store(ui32_seq, std::memory_order_release);
+
+        return ui32_seq;
+    }
+
+    /* sequence number of the latest record, 0 = none yet */
+    uint32_t latest() const
+    {
+        return ui32_head.load(std::memory_order_acquire);
+    }
+
+    /* copy of record "ui32_seq"; false if never published or already recycled */
+    bool read(uint32_t ui32_seq, T *ps_record) const
+    {
+        const slot_st &s_slot = as_slot[ui32_seq % N];
+        uint32_t ui32_version;
+
+        if (0 == ui32_seq)
+        {
+            return false;
+        }
+
+        ui32_version = s_slot.ui32_version.load(std::memory_order_acquire);
+        if (ui32_version != (2 * ui32_seq))
+        {
+            return false;
+        }
+
+        memcpy(ps_record, (const void *)&s_slot.s_record, sizeof(T));
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        return (ui32_version == s_slot.ui32_version.load(std::memory_order_relaxed));
+    }
+
+    /* copy of the latest record; returns its sequence number, 0 = none */
+    uint32_t read_latest(T *ps_record) const
+    {
+        uint32_t ui32_seq;
+
+        for (uint8_t ui8_try = 0; ui8_try < K_SNAPSHOT_RING_READ_RETRIES; ui8_try++)
+        {
+            ui32_seq = latest();
+            if (0 == ui32_seq)
+            {
+                break;
+            }
+            else if (read(ui32_seq, ps_record))
+            {
+                return ui32_seq;
+            }
+        }
+
+        return 0;
+    }
+
+private:
+    typedef struct alignas(K_SNAPSHOT_RING_ALIGN)
+    {
+        std::atomic<uint32_t>   ui32_version;   // 2*seq when valid, odd while written
+        T                       s_record;
+    } slot_st;
+
+    slot_st                 as_slot[N];
+    alignas(K_SNAPSHOT_RING_ALIGN) std::atomic<uint32_t> ui32_head;
+};
@@ -19,4 +19,7 @@ int8_t _4g_state;
 bool g_b_dtls_ok;
 bool g_b_mcu_to_modem_ok;
 bool g_b_sim_ok;
-bool g_b_udp_ok;
\ No newline at end of file
+bool g_b_udp_ok;
+int8_t measure_interval1 = 1;       // minutes
+int16_t measure_interval2 = 15;     // minutes
+int8_t measure_interval_option = 2; //1 interv 1, 2 - interv 2
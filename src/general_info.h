@@ -23,5 +23,8 @@ extern bool g_b_dtls_ok;
 extern bool g_b_mcu_to_modem_ok;
 extern bool g_b_sim_ok;
 extern bool g_b_udp_ok;
+extern int8_t measure_interval1;
+extern int16_t measure_interval2;
+extern int8_t measure_interval_option;
 
 #endif // GENERAL_INFO_H
@@ -25,7 +25,7 @@ static void hw_init(void)
     wl_handle_t s_wl_handle = WL_INVALID_HANDLE;
 
     // check "src/general/partitions/<size>.csv"
-    err = esp_vfs_fat_spiflash_mount_rw_wl("/mnt", "storage", &mount_config, &s_wl_handle);
+    err = esp_vfs_fat_spiflash_mount_rw_wl(K_STORAGE_BASE_PATH, "storage", &mount_config, &s_wl_handle);
     ESP_ERROR_CHECK( err );
 }
 
@@ -59,7 +59,7 @@ static void sw_init(void)
     // calib
 
     uint64_t storage_total = 0, storage_free = 0;
-    if (ESP_OK == esp_vfs_fat_info("/mnt", &storage_total, &storage_free))
+    if (ESP_OK == esp_vfs_fat_info(K_STORAGE_BASE_PATH, &storage_total, &storage_free))
     {
         printf("--- storage: %lld / %lld ---\r\n", storage_total - storage_free, storage_total);
     }
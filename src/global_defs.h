@@ -18,6 +18,10 @@
 
 #define K_APP_VER           "00.02.0002"    // <major>.<minor>.<test>
 
+#ifndef K_STORAGE_BASE_PATH
+#define K_STORAGE_BASE_PATH "/mnt"          // internal storage mount point
+#endif
+
 
 // at 1ms tick
 #define delayms(ms)         vTaskDelay((ms))
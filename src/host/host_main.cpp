@@ -0,0 +1,371 @@
+/*
+ * host_main.cpp
+ *
+ * Process entry of the host build: select the clock, attach the simulated devices, start
+ * "app_main()" and let the tasks run.
+ *
+ *  pdl_host [--clock=real|fast|manual] [--run-ms=<firmware milliseconds, 0 = forever>]
+ *           [--sim-crc-errors=<corrupt every n-th MSP430 reply>]
+ *           [--snapshot-readers=<threads hammering the enmtr snapshot ring>]
+ *           [--fw-update=<KiB image flashed to the simulated MSP430s through the bootloader>]
+ *
+ * Exits with EXIT_FAILURE if a snapshot reader saw a torn snapshot or the firmware update failed.
+ * The checks of the libraries without the tasks are the host test executables of "test/".
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <pthread.h>
+#include <time.h>
+#include <atomic>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "host_shim.h"
+#include "sim/msp430_sim.h"
+#include "enmtr_manager.h"
+#include "harmonics/harmonics.h"
+#include "crc/crc16.h"
+#include "enmtr_msp430_cfg.h"
+
+extern "C" void app_main(void);
+
+
+#define K_MAX_SNAPSHOT_READERS      8
+#define K_LATENCY_BUCKETS           16      // power of 2 ns buckets, last one open ended
+
+typedef struct
+{
+    pthread_t   s_thread;
+    uint64_t    ui64_reads;
+    uint64_t    ui64_misses;                // recycled while copying / not published yet
+    uint64_t    ui64_torn;                  // sequence number in the copy doesn't match
+    uint64_t    aui64_latency[K_LATENCY_BUCKETS];
+} snapshot_reader_st;
+
+static std::atomic<bool>    b_readers_run;
+static snapshot_reader_st   as_reader[K_MAX_SNAPSHOT_READERS];
+
+
+static uint64_t nowNs(void)
+{
+    struct timespec s_ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &s_ts);
+    return (uint64_t)s_ts.tv_sec * 1000000000ULL + (uint64_t)s_ts.tv_nsec;
+}
+
+/* plain thread, not a task: the snapshot readers must not need the scheduler */
+static void *snapshotReader(void *pv_arg)
+{
+    snapshot_reader_st *ps_reader = (snapshot_reader_st *)pv_arg;
+    ENMTR_CLASS::meas_block_st s_snapshot;
+
+    while (b_readers_run.load(std::memory_order_relaxed))
+    {
+        uint64_t ns_start = nowNs();
+        uint32_t ui32_seq = enmtr::manager::getSnapshotSeq();
+        bool b_ok = enmtr::manager::getSnapshot(ui32_seq, &s_snapshot);
+        uint64_t ns_read = nowNs() - ns_start;
+        uint8_t ui8_bucket = 0;
+
+        while ((ui8_bucket < (K_LATENCY_BUCKETS - 1)) && (ns_read >= (2ULL << ui8_bucket)))
+        {
+            ui8_bucket++;
+        }
+        ps_reader->aui64_latency[ui8_bucket]++;
+        ps_reader->ui64_reads++;
+
+        if (false == b_ok)
+        {
+            ps_reader->ui64_misses++;
+        }
+        else if (s_snapshot.ui32_seq != ui32_seq)
+        {
+            ps_reader->ui64_torn++;
+        }
+    }
+
+    return NULL;
+}
+
+static void printSnapshotReaders(uint8_t ui8_readers)
+{
+    snapshot_reader_st s_sum = {};
+
+    for (uint8_t i = 0; i < ui8_readers; i++)
+    {
+        s_sum.ui64_reads  += as_reader[i].ui64_reads;
+        s_sum.ui64_misses += as_reader[i].ui64_misses;
+        s_sum.ui64_torn   += as_reader[i].ui64_torn;
+        for (uint8_t b = 0; b < K_LATENCY_BUCKETS; b++)
+        {
+            s_sum.aui64_latency[b] += as_reader[i].aui64_latency[b];
+        }
+    }
+
+    printf("--- snapshot readers: %u threads, %llu reads, %llu misses, %llu torn ---\r\n", ui8_readers,
+           (unsigned long long)s_sum.ui64_reads, (unsigned long long)s_sum.ui64_misses,
+           (unsigned long long)s_sum.ui64_torn);
+    for (uint8_t b = 0; b < K_LATENCY_BUCKETS; b++)
+    {
+        if (0 != s_sum.aui64_latency[b])
+        {
+            printf("    %s%6llu ns: %llu\r\n", (b == (K_LATENCY_BUCKETS - 1)) ? ">=" : " <",
+                   (unsigned long long)((b == (K_LATENCY_BUCKETS - 1)) ? (1ULL << b) : (2ULL << b)),
+                   (unsigned long long)s_sum.aui64_latency[b]);
+        }
+    }
+}
+
+/* "mean% (min..max)" of an interval statistic, "n/a" without samples */
+static const char *harmStatText(const harm_stat_st *ps_stat, char *pc_buf, size_t sz_buf_len)
+{
+    if (0 == ps_stat->ui16_count)
+    {
+        snprintf(pc_buf, sz_buf_len, "n/a");
+    }
+    else
+    {
+        snprintf(pc_buf, sz_buf_len, "%.2f%% (%.2f..%.2f)", harmQ15ToCentiPercent(harmStatMean(ps_stat)) / 100.0,
+                 harmQ15ToCentiPercent(ps_stat->ui16_min) / 100.0, harmQ15ToCentiPercent(ps_stat->ui16_max) / 100.0);
+    }
+
+    return pc_buf;
+}
+
+static void printHarmonics(void)
+{
+    harm_phase_st           as_harm[ENMTR_CLASS::NUM_DEVICES];
+    ep_com_header_st        s_header = {};
+    static ep_writer_st     s_writer;
+    static uint8_t          aui8_buf[512];
+    size_t                  sz_len = 0;
+
+    if (false == enmtr::manager::takeHarmonics(as_harm))
+    {
+        return;
+    }
+
+    edgePayloadWriterInit(&s_writer, aui8_buf, sizeof(aui8_buf));
+    (void)edgePayloadWriteComHeader(&s_writer, &s_header);
+    for (uint8_t d = 0; d < ENMTR_CLASS::NUM_DEVICES; d++)
+    {
+        char ac_vthd[40], ac_ithd[40], ac_v3[40], ac_i3[40];
+
+        printf("--- harmonics L%u: %u sweeps, vthd %s, ithd %s, v3 %s, i3 %s ---\r\n", d + 1, as_harm[d].s_vthd.ui16_count,
+               harmStatText(&as_harm[d].s_vthd, ac_vthd, sizeof(ac_vthd)), harmStatText(&as_harm[d].s_ithd, ac_ithd, sizeof(ac_ithd)),
+               harmStatText(&as_harm[d].as_v[0], ac_v3, sizeof(ac_v3)), harmStatText(&as_harm[d].as_i[0], ac_i3, sizeof(ac_i3)));
+
+        if ((false == edgePayloadWriteMonitorPhase(&s_writer, (ep_phase_index_et)(EP_PHASE_INDEX_L1 + d))) ||
+            (false == harmAddMonitorParams(&s_writer, &as_harm[d])))
+        {
+            printf("--- harmonics L%u: monitor payload full ---\r\n", d + 1);
+        }
+    }
+
+    (void)edgePayloadWriterEnd(&s_writer, &sz_len);
+    printf("--- harmonics monitor payload: %u bytes ---\r\n", (unsigned)sz_len);
+}
+
+/* random image file on the storage, flashed by the enmtr task while the firmware runs; the
+   simulated flash of every phase is compared with the image afterwards; false if it failed */
+static bool fwUpdateRun(uint32_t ui32_kib)
+{
+    static const char              *PC_FILE = K_STORAGE_BASE_PATH "/msp430_fw.bin";
+    ENMTR_CLASS::fw_image_hdr_st    s_hdr = {};
+    ENMTR_CLASS::fw_update_stats_st s_stats;
+    host_spi_stats_st               s_spi0, s_spi1;
+    msp430_sim_stats_st             s_sim0, s_sim1;
+    uint32_t                        ui32_len = ui32_kib * 1024;
+    uint8_t                        *pui8_image;
+    uint8_t                        *pui8_flash;
+    uint32_t                        ui32_lcg = 99;
+    uint32_t                        ui32_mismatch = 0;
+    uint64_t                        ns_bus0;
+    FILE                           *ps_file;
+
+    if ((ui32_len + K_MSP430_SIM_APP_START) > K_MSP430_SIM_FLASH_SIZE)
+    {
+        printf("--- fw update: image larger than the application flash ---\r\n");
+        return false;
+    }
+
+    pui8_image = (uint8_t *)malloc(ui32_len);
+    pui8_flash = (uint8_t *)malloc(ui32_len);
+    s_hdr.ui32_magic     = K_ENMTR_FW_MAGIC;
+    s_hdr.ui16_load_addr = K_MSP430_SIM_APP_START;
+    s_hdr.ui32_length    = ui32_len;
+    s_hdr.ui16_crc       = crc16GetSeed();
+    for (uint32_t i = 0; i < ui32_len; i++)
+    {
+        ui32_lcg      = ui32_lcg * 1664525UL + 1013904223UL;
+        pui8_image[i] = (uint8_t)(ui32_lcg >> 24);
+        s_hdr.ui16_crc = crc16CalcByte(s_hdr.ui16_crc, pui8_image[i]);
+    }
+    ps_file = fopen(PC_FILE, "wb");
+    if (NULL != ps_file)
+    {
+        fwrite(&s_hdr, sizeof(s_hdr), 1, ps_file);
+        fwrite(pui8_image, 1, ui32_len, ps_file);
+        fclose(ps_file);
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(1000));    // polling up
+    hostSpiGetStats(SPI2_HOST, &s_spi0);
+    msp430SimGetStats(&s_sim0);
+    ns_bus0 = msp430SimBusNs();
+
+    (void)enmtr::manager::requestFwUpdate(PC_FILE);
+    for (uint32_t ms = 0; (false == enmtr::manager::getFwUpdateStats(&s_stats)) && (ms < 600000); ms += 10)
+    {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    hostSpiGetStats(SPI2_HOST, &s_spi1);
+    msp430SimGetStats(&s_sim1);
+
+    for (uint8_t d = 0; d < K_MSP430_SIM_NUM_DEVICES; d++)
+    {
+        msp430SimGetFlash(d, K_MSP430_SIM_APP_START, pui8_flash, ui32_len);
+        ui32_mismatch += (0 != memcmp(pui8_flash, pui8_image, ui32_len)) ? 1 : 0;
+    }
+
+    double ms_bus = (double)(msp430SimBusNs() - ns_bus0) / 1e6;
+
+    printf("--- fw update: %s, %u KiB x %u phases, flash %s, %u blocks, %u frames, %u retries (%u busy naks) ---\r\n",
+           s_stats.b_ok ? "ok" : "FAILED", (unsigned)ui32_kib, (unsigned)K_MSP430_SIM_NUM_DEVICES,
+           (0 == ui32_mismatch) ? "matches" : "MISMATCH", (unsigned)s_stats.ui32_blocks, (unsigned)s_stats.ui32_frames,
+           (unsigned)s_stats.ui32_retries, (unsigned)(s_sim1.ui32_busy_naks - s_sim0.ui32_busy_naks));
+    printf("--- fw update: %u spi transactions, %.1f ms on the bus (incl. chip select delays), %.1f KiB/s per phase ---\r\n",
+           (unsigned)(s_spi1.ui32_transactions - s_spi0.ui32_transactions), ms_bus,
+           (ms_bus > 0) ? ui32_kib / (ms_bus / 1000.0) : 0.0);
+
+    remove(PC_FILE);
+    free(pui8_image);
+    free(pui8_flash);
+
+    return (true == s_stats.b_ok) && (0 == ui32_mismatch);
+}
+
+static void usage(const char *pc_prog)
+{
+    printf("usage: %s [--clock=real|fast|manual] [--run-ms=N] [--sim-crc-errors=N] [--snapshot-readers=N] [--fw-update=KIB]\r\n",
+           pc_prog);
+}
+
+int main(int argc, char *argv[])
+{
+    host_clock_mode_et e_mode = HOST_CLOCK_REALTIME;
+    uint32_t ms_run = 0;
+    uint32_t ui32_crc_errors = 0;
+    uint8_t ui8_readers = 0;
+    uint32_t ui32_fw_kib = 0;
+    bool b_ok = true;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (0 == strcmp(argv[i], "--clock=real"))
+        {
+            e_mode = HOST_CLOCK_REALTIME;
+        }
+        else if (0 == strcmp(argv[i], "--clock=fast"))
+        {
+            e_mode = HOST_CLOCK_FAST;
+        }
+        else if (0 == strcmp(argv[i], "--clock=manual"))
+        {
+            e_mode = HOST_CLOCK_MANUAL;
+        }
+        else if (0 == strncmp(argv[i], "--run-ms=", 9))
+        {
+            ms_run = (uint32_t)strtoul(&argv[i][9], NULL, 0);
+        }
+        else if (0 == strncmp(argv[i], "--sim-crc-errors=", 17))
+        {
+            ui32_crc_errors = (uint32_t)strtoul(&argv[i][17], NULL, 0);
+        }
+        else if ((0 == strncmp(argv[i], "--snapshot-readers=", 19)) &&
+                 (strtoul(&argv[i][19], NULL, 0) <= K_MAX_SNAPSHOT_READERS))
+        {
+            ui8_readers = (uint8_t)strtoul(&argv[i][19], NULL, 0);
+        }
+        else if (0 == strncmp(argv[i], "--fw-update=", 12))
+        {
+            ui32_fw_kib = (uint32_t)strtoul(&argv[i][12], NULL, 0);
+        }
+        else
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    hostShimInit(e_mode);
+    msp430SimInit(100);
+    msp430SimInjectCrcErrors(ui32_crc_errors);
+
+    app_main();
+
+    b_readers_run = true;
+    for (uint8_t i = 0; i < ui8_readers; i++)
+    {
+        pthread_create(&as_reader[i].s_thread, NULL, snapshotReader, &as_reader[i]);
+    }
+
+    if ((0 != ui32_fw_kib) && (HOST_CLOCK_MANUAL != e_mode))
+    {
+        b_ok = fwUpdateRun(ui32_fw_kib);
+    }
+
+    if (HOST_CLOCK_MANUAL == e_mode)
+    {
+        // nobody else drives the clock
+        for (uint32_t ms = 0; (0 == ms_run) || (ms < ms_run); ms++)
+        {
+            hostClockAdvance(1);
+        }
+    }
+    else
+    {
+        vTaskDelay((0 != ms_run) ? pdMS_TO_TICKS(ms_run) : portMAX_DELAY);
+    }
+
+    b_readers_run = false;
+    for (uint8_t i = 0; i < ui8_readers; i++)
+    {
+        pthread_join(as_reader[i].s_thread, NULL);
+        b_ok = (0 == as_reader[i].ui64_torn) && b_ok;
+    }
+
+    host_spi_stats_st               s_spi;
+    msp430_sim_stats_st             s_sim;
+    uint32_t                        ui32_snapshots;
+    struct rusage                   s_usage;
+
+    hostSpiGetStats(SPI2_HOST, &s_spi);
+    msp430SimGetStats(&s_sim);
+    ui32_snapshots = enmtr::manager::getSnapshotSeq();
+    getrusage(RUSAGE_SELF, &s_usage);
+
+    uint64_t us_cpu = (uint64_t)(s_usage.ru_utime.tv_sec + s_usage.ru_stime.tv_sec) * 1000000 +
+                      (uint64_t)(s_usage.ru_utime.tv_usec + s_usage.ru_stime.tv_usec);
+
+    printf("--- host: %u ms, spi2 %u transactions / %u bytes / %llu us bus ---\r\n",
+           (unsigned)xTaskGetTickCount(), (unsigned)s_spi.ui32_transactions, (unsigned)s_spi.ui32_bytes,
+           (unsigned long long)s_spi.ui64_bus_us);
+    printf("--- enmtr: %u snapshots, %u command frames, %.1f transactions & %.1f us cpu (whole process) per snapshot ---\r\n",
+           (unsigned)ui32_snapshots, (unsigned)s_sim.ui32_frames,
+           ui32_snapshots ? (double)s_spi.ui32_transactions / ui32_snapshots : 0.0,
+           ui32_snapshots ? (double)us_cpu / ui32_snapshots : 0.0);
+    if (0 != ui8_readers)
+    {
+        printSnapshotReaders(ui8_readers);
+    }
+    printHarmonics();
+
+    return (true == b_ok) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,10 @@
+/*
+ * esp_attr.h (host build)
+ */
+
+#pragma once
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define DMA_ATTR                __attribute__((aligned(4)))
+#define WORD_ALIGNED_ATTR       __attribute__((aligned(4)))
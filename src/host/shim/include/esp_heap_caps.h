@@ -0,0 +1,27 @@
+/*
+ * esp_heap_caps.h (host build)
+ *
+ * Every capability is the process heap.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MALLOC_CAP_INTERNAL     (1 << 11)
+#define MALLOC_CAP_SPIRAM       (1 << 10)
+
+static inline void *heap_caps_malloc(size_t size, uint32_t caps)
+{
+    (void)caps;
+    return malloc(size);
+}
+
+#ifdef __cplusplus
+}
+#endif
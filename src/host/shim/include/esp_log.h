@@ -0,0 +1,34 @@
+/*
+ * esp_log.h (host build)
+ */
+
+#pragma once
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <sys/lock.h>    // newlib pulls this in through <stdio.h>
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum
+{
+    ESP_LOG_NONE,
+    ESP_LOG_ERROR,
+    ESP_LOG_WARN,
+    ESP_LOG_INFO,
+    ESP_LOG_DEBUG,
+    ESP_LOG_VERBOSE
+} esp_log_level_t;
+
+#define ESP_LOGE(tag, fmt, ...)     printf("E (%s) " fmt "\r\n", tag, ## __VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...)     printf("W (%s) " fmt "\r\n", tag, ## __VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...)     printf("I (%s) " fmt "\r\n", tag, ## __VA_ARGS__)
+#define ESP_LOGD(tag, fmt, ...)     printf("D (%s) " fmt "\r\n", tag, ## __VA_ARGS__)
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,21 @@
+/*
+ * esp_mac.h (host build)
+ */
+
+#pragma once
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MAC2STR(a)      (a)[0], (a)[1], (a)[2], (a)[3], (a)[4], (a)[5]
+#define MACSTR          "%02x:%02x:%02x:%02x:%02x:%02x"
+
+/* fixed base MAC, override with hostSetBaseMac() */
+esp_err_t esp_efuse_mac_get_default(uint8_t *mac);
+
+#ifdef __cplusplus
+}
+#endif
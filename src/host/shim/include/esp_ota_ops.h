@@ -0,0 +1,33 @@
+/*
+ * esp_ota_ops.h (host build)
+ */
+
+#pragma once
+
+#include "esp_err.h"
+#include "esp_partition.h"
+#include "esp_system.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct
+{
+    uint32_t    magic_word;
+    uint32_t    secure_version;
+    uint32_t    reserv1[2];
+    char        version[32];
+    char        project_name[32];
+    char        time[16];
+    char        date[16];
+    char        idf_ver[32];
+    uint8_t     app_elf_sha256[32];
+} esp_app_desc_t;
+
+const esp_app_desc_t *esp_app_get_description(void);
+const esp_partition_t *esp_ota_get_running_partition(void);
+
+#ifdef __cplusplus
+}
+#endif
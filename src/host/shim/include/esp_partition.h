@@ -0,0 +1,64 @@
+/*
+ * esp_partition.h (host build)
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum
+{
+    ESP_PARTITION_TYPE_APP              = 0x00,
+    ESP_PARTITION_TYPE_DATA             = 0x01,
+    ESP_PARTITION_TYPE_ANY              = 0xff
+} esp_partition_type_t;
+
+typedef enum
+{
+    ESP_PARTITION_SUBTYPE_APP_FACTORY   = 0x00,
+    ESP_PARTITION_SUBTYPE_DATA_NVS      = 0x02,
+    ESP_PARTITION_SUBTYPE_DATA_FAT      = 0x81,
+    ESP_PARTITION_SUBTYPE_ANY           = 0xff
+} esp_partition_subtype_t;
+
+typedef struct
+{
+    void                   *flash_chip;
+    esp_partition_type_t    type;
+    esp_partition_subtype_t subtype;
+    uint32_t                address;
+    uint32_t                size;
+    uint32_t                erase_size;
+    char                    label[17];
+    bool                    encrypted;
+    bool                    readonly;
+} esp_partition_t;
+
+typedef enum
+{
+    ESP_PARTITION_MMAP_DATA,
+    ESP_PARTITION_MMAP_INST
+} esp_partition_mmap_memory_t;
+
+typedef uint32_t esp_partition_mmap_handle_t;
+
+/* raw partitions of the flash emulator, see "flash.c" */
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype, const char *label);
+esp_err_t esp_partition_read(const esp_partition_t *partition, size_t src_offset, void *dst, size_t size);
+esp_err_t esp_partition_write(const esp_partition_t *partition, size_t dst_offset, const void *src, size_t size);
+esp_err_t esp_partition_erase_range(const esp_partition_t *partition, size_t offset, size_t size);
+esp_err_t esp_partition_mmap(const esp_partition_t *partition, size_t offset, size_t size, esp_partition_mmap_memory_t memory,
+                             const void **out_ptr, esp_partition_mmap_handle_t *out_handle);
+void esp_partition_munmap(esp_partition_mmap_handle_t handle);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,23 @@
+/*
+ * esp_task_wdt.h (host build)
+ *
+ * Users are not reset on timeout, a starved user is reported on its next reset instead.
+ */
+
+#pragma once
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct esp_task_wdt_user_handle_s *esp_task_wdt_user_handle_t;
+
+esp_err_t esp_task_wdt_add_user(const char *user_name, esp_task_wdt_user_handle_t *user_handle_ret);
+esp_err_t esp_task_wdt_reset_user(esp_task_wdt_user_handle_t user_handle);
+esp_err_t esp_task_wdt_delete_user(esp_task_wdt_user_handle_t user_handle);
+
+#ifdef __cplusplus
+}
+#endif
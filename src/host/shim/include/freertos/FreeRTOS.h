@@ -0,0 +1,44 @@
+/*
+ * freertos/FreeRTOS.h (host build)
+ *
+ * Tasks are pthreads and ticks come from the host clock (see "host_shim.h").
+ */
+
+#pragma once
+
+#include <assert.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "sdkconfig.h"
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef uint32_t        TickType_t;
+typedef int             BaseType_t;
+typedef unsigned int    UBaseType_t;
+
+#define pdFALSE                 ((BaseType_t)0)
+#define pdTRUE                  ((BaseType_t)1)
+#define pdPASS                  (pdTRUE)
+#define pdFAIL                  (pdFALSE)
+#define errQUEUE_EMPTY          ((BaseType_t)0)
+#define errQUEUE_FULL           ((BaseType_t)0)
+
+#define portMAX_DELAY           ((TickType_t)0xFFFFFFFFUL)
+#define portTICK_PERIOD_MS      ((TickType_t)1000 / CONFIG_FREERTOS_HZ)
+#define pdMS_TO_TICKS(ms)       ((TickType_t)(((uint64_t)(ms) * (uint64_t)CONFIG_FREERTOS_HZ) / (uint64_t)1000U))
+
+#define configASSERT(x)         assert(x)
+
+#define tskNO_AFFINITY          (0x7FFFFFFF)
+
+BaseType_t xPortGetCoreID(void);
+
+#ifdef __cplusplus
+}
+#endif
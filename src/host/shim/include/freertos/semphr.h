@@ -0,0 +1,29 @@
+/*
+ * freertos/semphr.h (host build)
+ *
+ * Semaphores are zero item-size queues (as in FreeRTOS), mutexes have no priority inheritance.
+ */
+
+#pragma once
+
+#include "queue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef QueueHandle_t SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t uxMaxCount, UBaseType_t uxInitialCount);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xBlockTime);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore);
+
+#define xSemaphoreCreateBinary()            xSemaphoreCreateCounting(1, 0)
+#define xSemaphoreCreateMutex()             xSemaphoreCreateCounting(1, 1)
+#define xSemaphoreGiveFromISR(s, p)         xSemaphoreGive((s))
+#define vSemaphoreDelete(s)                 vQueueDelete((s))
+#define uxSemaphoreGetCount(s)              uxQueueMessagesWaiting((s))
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,30 @@
+/*
+ * freertos/task.h (host build)
+ */
+
+#pragma once
+
+#include "FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void (*TaskFunction_t)(void *);
+typedef struct tskTaskControlBlock *TaskHandle_t;
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t pxTaskCode, const char *pcName, const uint32_t usStackDepth,
+                                   void *pvParameters, UBaseType_t uxPriority, TaskHandle_t *pxCreatedTask,
+                                   const BaseType_t xCoreID);
+#define xTaskCreate(code, name, stack, param, prio, handle) \
+            xTaskCreatePinnedToCore((code), (name), (stack), (param), (prio), (handle), tskNO_AFFINITY)
+
+void vTaskDelete(TaskHandle_t xTaskToDelete);
+void vTaskDelay(const TickType_t xTicksToDelay);
+TickType_t xTaskGetTickCount(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+char *pcTaskGetName(TaskHandle_t xTaskToQuery);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,32 @@
+/*
+ * hal/gpio_ll.h (host build)
+ *
+ * Register level output of the target (callable from isr), routed to "gpio_set_level()".
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "driver/gpio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct
+{
+    uint32_t    out;                // unused, the levels live in the gpio driver
+} gpio_dev_t;
+
+extern gpio_dev_t GPIO;
+
+static inline void gpio_ll_set_level(gpio_dev_t *hw, uint32_t gpio_num, uint32_t level)
+{
+    (void)hw;
+    (void)gpio_set_level((gpio_num_t)gpio_num, level);
+}
+
+#ifdef __cplusplus
+}
+#endif
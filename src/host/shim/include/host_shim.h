@@ -0,0 +1,105 @@
+/*
+ * host_shim.h
+ *
+ * Control interface of the host (Linux) build: virtual clock and simulated peripherals.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "esp_partition.h"
+#include "driver/spi_master.h"
+#include "driver/uart.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Global Constants
+ */
+typedef enum
+{
+    HOST_CLOCK_REALTIME,    // ticks follow the monotonic clock
+    HOST_CLOCK_FAST,        // jump to the earliest deadline when every task is blocked
+    HOST_CLOCK_MANUAL       // ticks advance only with "hostClockAdvance()"
+} host_clock_mode_et;
+
+/* timing model of the flash emulator, typical datasheet figures of the module's quad SPI NOR */
+#define K_HOST_FLASH_SECTOR_ERASE_US    (45000)     // 4 KiB
+#define K_HOST_FLASH_BLOCK_ERASE_US     (150000)    // 64 KiB, aligned ranges
+#define K_HOST_FLASH_PROGRAM_US         (700)       // 256 byte program page
+#define K_HOST_FLASH_READ_NS_PER_BYTE   (50)        // 80 MHz QIO
+
+/*
+ * Global Definitions
+ */
+typedef struct
+{
+    uint32_t    ui32_transactions;  // completed transactions
+    uint32_t    ui32_bytes;         // total bytes clocked
+    uint64_t    ui64_bus_us;        // bus time, at the configured clock speed
+} host_spi_stats_st;
+
+/* simulated SPI slave, return false to fail the transaction */
+typedef bool (*host_spi_cb_pt)(void *pv_ctx, const spi_device_interface_config_t *ps_devcfg, spi_transaction_t *ps_trans);
+
+/* host -> device UART traffic */
+typedef void (*host_uart_tx_cb_pt)(void *pv_ctx, const uint8_t *pui8_data, size_t sz_len);
+
+/* sector model of the FAT volume, see "storage.c" */
+typedef struct
+{
+    uint32_t    ui32_writes;        // file writes
+    uint64_t    ui64_bytes;
+    uint64_t    ui64_sectors;       // data sectors, directory entries & FAT sectors written
+} host_storage_stats_st;
+
+/* flash emulator, per partition */
+typedef struct
+{
+    uint32_t    ui32_erases;        // 4 KiB sectors
+    uint32_t    ui32_max_sector_erases;
+    uint64_t    ui64_programmed;    // bytes
+    uint64_t    ui64_read;
+    uint64_t    ui64_busy_us;       // modelled flash time
+    uint32_t    ui32_unerased;      // bytes programmed over cleared bits, corrupted on real flash
+    uint32_t    ui32_maps;          // esp_partition_mmap() windows, read through the cache
+} host_flash_stats_st;
+
+/* GPIO output changes, e.g. chip selects */
+typedef void (*host_gpio_cb_pt)(void *pv_ctx, int i_num, uint32_t ui32_level);
+
+/*
+ * Public Function Prototypes
+ */
+void hostShimInit(host_clock_mode_et e_mode);
+host_clock_mode_et hostClockMode(void);
+void hostClockAdvance(uint32_t ui32_ms);
+
+void hostSetBaseMac(const uint8_t au8_mac[6]);
+
+void hostSpiAttach(spi_host_device_t e_host, host_spi_cb_pt fp_cb, void *pv_ctx);
+void hostSpiGetStats(spi_host_device_t e_host, host_spi_stats_st *ps_stats);
+
+void hostUartAttach(uart_port_t e_port, host_uart_tx_cb_pt fp_cb, void *pv_ctx);
+size_t hostUartInject(uart_port_t e_port, const uint8_t *pui8_data, size_t sz_len);
+
+void hostGpioAttach(host_gpio_cb_pt fp_cb, void *pv_ctx);
+
+/* FAT volume, for the calling thread: power cut (writes stop after ui64_bytes), sector model */
+void hostStorageCut(uint64_t ui64_bytes);
+void hostStorageRestore(void);
+bool hostStorageIsCut(void);
+void hostStorageResetStats(void);
+void hostStorageGetStats(host_storage_stats_st *ps_stats);
+
+void hostFlashResetStats(const esp_partition_t *ps_part);
+void hostFlashGetStats(const esp_partition_t *ps_part, host_flash_stats_st *ps_stats);
+
+#ifdef __cplusplus
+}
+#endif
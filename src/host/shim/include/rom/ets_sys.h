@@ -0,0 +1,18 @@
+/*
+ * rom/ets_sys.h (host build)
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* sleeps on the real-time clock only, sub-tick delays are free on the virtual clock */
+void ets_delay_us(uint32_t us);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,12 @@
+/*
+ * sdkconfig.h (host build)
+ *
+ * Subset of the ESP-IDF generated configuration that is referenced by the firmware.
+ */
+
+#pragma once
+
+#define CONFIG_FREERTOS_HZ                  (1000)  // 1ms tick, see "delayms()"
+#define CONFIG_WL_SECTOR_SIZE               (4096)
+#define CONFIG_ESP_TASK_WDT_TIMEOUT_S       (5)
+#define CONFIG_SPIRAM                       (1)     // WROVER module, PSRAM through "heap_caps_malloc()"
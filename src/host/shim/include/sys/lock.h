@@ -0,0 +1,22 @@
+/*
+ * sys/lock.h (host build)
+ *
+ * newlib retargetable locks, backed by a lazily created pthread mutex.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void *_lock_t;
+
+void _lock_init(_lock_t *plock);
+void _lock_close(_lock_t *plock);
+void _lock_acquire(_lock_t *plock);
+void _lock_release(_lock_t *plock);
+
+#ifdef __cplusplus
+}
+#endif
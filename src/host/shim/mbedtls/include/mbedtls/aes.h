@@ -0,0 +1,32 @@
+/*
+ * mbedtls/aes.h (host build fallback)
+ *
+ * Only the block encryption used by "dtls_crypto" (AES-CCM), used when the workstation has no mbedtls.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MBEDTLS_AES_ENCRYPT                 1
+#define MBEDTLS_ERR_AES_INVALID_KEY_LENGTH  -0x0020
+
+typedef struct
+{
+    int         nr;             // number of rounds
+    uint32_t    rk[60];         // round keys
+} mbedtls_aes_context;
+
+void mbedtls_aes_init(mbedtls_aes_context *ctx);
+void mbedtls_aes_free(mbedtls_aes_context *ctx);
+int mbedtls_aes_setkey_enc(mbedtls_aes_context *ctx, const unsigned char *key, unsigned int keybits);
+int mbedtls_internal_aes_encrypt(mbedtls_aes_context *ctx, const unsigned char input[16], unsigned char output[16]);
+
+#ifdef __cplusplus
+}
+#endif
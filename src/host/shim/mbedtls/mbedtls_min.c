@@ -0,0 +1,268 @@
+/*
+ * mbedtls_min.c
+ *
+ * Straightforward (table based, not constant time) AES encryption and SHA-256, enough to
+ * run the DTLS client on a workstation without mbedtls installed. Never ship this.
+ */
+
+#include <string.h>
+
+#include "mbedtls/aes.h"
+#include "mbedtls/sha256.h"
+
+
+/*
+ * AES
+ */
+static const uint8_t au8_sbox[256] = {
+    0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+    0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+    0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+    0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+    0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+    0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+    0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+    0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+    0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+    0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+    0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+    0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+    0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+    0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+    0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+    0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16
+};
+
+static uint8_t xtime(uint8_t x)
+{
+    return (uint8_t)((x << 1) ^ ((x & 0x80) ? 0x1b : 0x00));
+}
+
+static uint32_t sub_word(uint32_t w)
+{
+    return ((uint32_t)au8_sbox[(w >> 24) & 0xFF] << 24) | ((uint32_t)au8_sbox[(w >> 16) & 0xFF] << 16) |
+           ((uint32_t)au8_sbox[(w >>  8) & 0xFF] <<  8) |  (uint32_t)au8_sbox[w & 0xFF];
+}
+
+void mbedtls_aes_init(mbedtls_aes_context *ctx)
+{
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+void mbedtls_aes_free(mbedtls_aes_context *ctx)
+{
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+int mbedtls_aes_setkey_enc(mbedtls_aes_context *ctx, const unsigned char *key, unsigned int keybits)
+{
+    int nk = (int)keybits / 32;
+    uint8_t rcon = 0x01;
+
+    if ((128 != keybits) && (192 != keybits) && (256 != keybits))
+    {
+        return MBEDTLS_ERR_AES_INVALID_KEY_LENGTH;
+    }
+
+    ctx->nr = nk + 6;
+    for (int i = 0; i < nk; i++)
+    {
+        ctx->rk[i] = ((uint32_t)key[4*i] << 24) | ((uint32_t)key[4*i+1] << 16) | ((uint32_t)key[4*i+2] << 8) | key[4*i+3];
+    }
+    for (int i = nk; i < 4 * (ctx->nr + 1); i++)
+    {
+        uint32_t t = ctx->rk[i - 1];
+        if (0 == (i % nk))
+        {
+            t = sub_word((t << 8) | (t >> 24)) ^ ((uint32_t)rcon << 24);
+            rcon = xtime(rcon);
+        }
+        else if ((nk > 6) && (4 == (i % nk)))
+        {
+            t = sub_word(t);
+        }
+        ctx->rk[i] = ctx->rk[i - nk] ^ t;
+    }
+
+    return 0;
+}
+
+int mbedtls_internal_aes_encrypt(mbedtls_aes_context *ctx, const unsigned char input[16], unsigned char output[16])
+{
+    uint8_t s[16], t[16];
+
+    for (int i = 0; i < 16; i++)
+    {
+        s[i] = input[i] ^ (uint8_t)(ctx->rk[i / 4] >> (24 - 8 * (i % 4)));
+    }
+
+    for (int round = 1; round <= ctx->nr; round++)
+    {
+        // sub bytes + shift rows
+        for (int c = 0; c < 4; c++)
+        {
+            for (int r = 0; r < 4; r++)
+            {
+                t[4*c + r] = au8_sbox[s[4*((c + r) % 4) + r]];
+            }
+        }
+
+        // mix columns, except in the last round
+        if (round != ctx->nr)
+        {
+            for (int c = 0; c < 4; c++)
+            {
+                uint8_t *col = &t[4*c];
+                uint8_t a0 = col[0], a1 = col[1], a2 = col[2], a3 = col[3];
+                uint8_t all = a0 ^ a1 ^ a2 ^ a3;
+                col[0] ^= all ^ xtime(a0 ^ a1);
+                col[1] ^= all ^ xtime(a1 ^ a2);
+                col[2] ^= all ^ xtime(a2 ^ a3);
+                col[3] ^= all ^ xtime(a3 ^ a0);
+            }
+        }
+
+        for (int i = 0; i < 16; i++)
+        {
+            s[i] = t[i] ^ (uint8_t)(ctx->rk[4*round + i / 4] >> (24 - 8 * (i % 4)));
+        }
+    }
+
+    memcpy(output, s, 16);
+    return 0;
+}
+
+
+/*
+ * SHA-256
+ */
+static const uint32_t aui32_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+#define ROTR(x, n)      (((x) >> (n)) | ((x) << (32 - (n))))
+
+static void sha256_block(mbedtls_sha256_context *ctx, const unsigned char blk[64])
+{
+    uint32_t w[64], a, b, c, d, e, f, g, h;
+
+    for (int i = 0; i < 16; i++)
+    {
+        w[i] = ((uint32_t)blk[4*i] << 24) | ((uint32_t)blk[4*i+1] << 16) | ((uint32_t)blk[4*i+2] << 8) | blk[4*i+3];
+    }
+    for (int i = 16; i < 64; i++)
+    {
+        uint32_t s0 = ROTR(w[i-15], 7) ^ ROTR(w[i-15], 18) ^ (w[i-15] >> 3);
+        uint32_t s1 = ROTR(w[i-2], 17) ^ ROTR(w[i-2], 19) ^ (w[i-2] >> 10);
+        w[i] = w[i-16] + s0 + w[i-7] + s1;
+    }
+
+    a = ctx->state[0]; b = ctx->state[1]; c = ctx->state[2]; d = ctx->state[3];
+    e = ctx->state[4]; f = ctx->state[5]; g = ctx->state[6]; h = ctx->state[7];
+
+    for (int i = 0; i < 64; i++)
+    {
+        uint32_t t1 = h + (ROTR(e, 6) ^ ROTR(e, 11) ^ ROTR(e, 25)) + ((e & f) ^ (~e & g)) + aui32_k[i] + w[i];
+        uint32_t t2 = (ROTR(a, 2) ^ ROTR(a, 13) ^ ROTR(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+
+    ctx->state[0] += a; ctx->state[1] += b; ctx->state[2] += c; ctx->state[3] += d;
+    ctx->state[4] += e; ctx->state[5] += f; ctx->state[6] += g; ctx->state[7] += h;
+}
+
+void mbedtls_sha256_init(mbedtls_sha256_context *ctx)
+{
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+void mbedtls_sha256_free(mbedtls_sha256_context *ctx)
+{
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+int mbedtls_sha256_starts(mbedtls_sha256_context *ctx, int is224)
+{
+    static const uint32_t aui32_iv[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+
+    if (is224)
+    {
+        return -0x0074; // MBEDTLS_ERR_SHA256_BAD_INPUT_DATA, not needed here
+    }
+
+    memcpy(ctx->state, aui32_iv, sizeof(ctx->state));
+    ctx->total[0] = ctx->total[1] = 0;
+    ctx->is224 = 0;
+
+    return 0;
+}
+
+int mbedtls_sha256_update(mbedtls_sha256_context *ctx, const unsigned char *input, size_t ilen)
+{
+    size_t fill = ctx->total[0] & 0x3F;
+
+    ctx->total[0] += (uint32_t)ilen;
+    if (ctx->total[0] < (uint32_t)ilen)
+    {
+        ctx->total[1]++;
+    }
+
+    while (ilen > 0)
+    {
+        size_t n = 64 - fill;
+        if (n > ilen)
+        {
+            n = ilen;
+        }
+        memcpy(&ctx->buffer[fill], input, n);
+        fill  += n;
+        input += n;
+        ilen  -= n;
+        if (64 == fill)
+        {
+            sha256_block(ctx, ctx->buffer);
+            fill = 0;
+        }
+    }
+
+    return 0;
+}
+
+int mbedtls_sha256_finish(mbedtls_sha256_context *ctx, unsigned char *output)
+{
+    uint32_t ui32_hi = (ctx->total[0] >> 29) | (ctx->total[1] << 3);
+    uint32_t ui32_lo = ctx->total[0] << 3;
+    size_t fill = ctx->total[0] & 0x3F;
+
+    ctx->buffer[fill++] = 0x80;
+    if (fill > 56)
+    {
+        memset(&ctx->buffer[fill], 0, 64 - fill);
+        sha256_block(ctx, ctx->buffer);
+        fill = 0;
+    }
+    memset(&ctx->buffer[fill], 0, 56 - fill);
+    for (int i = 0; i < 4; i++)
+    {
+        ctx->buffer[56 + i] = (unsigned char)(ui32_hi >> (24 - 8 * i));
+        ctx->buffer[60 + i] = (unsigned char)(ui32_lo >> (24 - 8 * i));
+    }
+    sha256_block(ctx, ctx->buffer);
+
+    for (int i = 0; i < 32; i++)
+    {
+        output[i] = (unsigned char)(ctx->state[i / 4] >> (24 - 8 * (i % 4)));
+    }
+
+    return 0;
+}
@@ -0,0 +1,543 @@
+/*
+ * driver.c
+ *
+ * GPIO, SPI master and UART drivers of the host build, routed to simulated peripherals.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "driver/gpio.h"
+#include "driver/spi_master.h"
+#include "driver/uart.h"
+#include "hal/gpio_ll.h"
+
+#include "host_shim.h"
+#include "host_internal.h"
+
+
+/*
+ * Local Constants
+ */
+#define K_HOST_SPI_MAX_DEVICES      3
+
+
+/*
+ * Local Definitions
+ */
+typedef struct
+{
+    bool                b_initialized;
+    spi_bus_config_t    s_buscfg;
+    host_spi_cb_pt      fp_cb;
+    void               *pv_ctx;
+    host_spi_stats_st   s_stats;
+} host_spi_bus_st;
+
+struct spi_device_t
+{
+    spi_host_device_t               e_host;
+    spi_device_interface_config_t   s_devcfg;
+    spi_transaction_t             **pps_done;       // completed, not yet fetched transactions
+    int                             i_done_head;
+    int                             i_done_count;
+};
+
+typedef struct
+{
+    bool                b_installed;
+    uint8_t            *pui8_rx;
+    size_t              sz_rx_size;
+    size_t              sz_rx_head;
+    size_t              sz_rx_count;
+    host_uart_tx_cb_pt  fp_tx_cb;
+    void               *pv_tx_ctx;
+} host_uart_st;
+
+typedef struct
+{
+    host_uart_st       *ps_uart;
+    size_t              sz_wanted;
+} uart_wait_st;
+
+
+/*
+ * Local Variables
+ */
+static uint32_t         aui32_gpio_level[GPIO_NUM_MAX];
+static host_gpio_cb_pt  fp_gpio_cb      = NULL;
+static void            *pv_gpio_ctx     = NULL;
+
+static host_spi_bus_st  as_spi_bus[SPI_HOST_MAX];
+
+static host_uart_st     as_uart[UART_NUM_MAX];
+
+
+/*
+ * GPIO
+ */
+gpio_dev_t GPIO;
+
+void hostGpioAttach(host_gpio_cb_pt fp_cb, void *pv_ctx)
+{
+    host_lock();
+    fp_gpio_cb  = fp_cb;
+    pv_gpio_ctx = pv_ctx;
+    host_unlock();
+}
+
+esp_err_t gpio_set_direction(gpio_num_t gpio_num, gpio_mode_t mode)
+{
+    (void)mode;
+    return ((gpio_num >= 0) && (gpio_num < GPIO_NUM_MAX)) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level)
+{
+    host_gpio_cb_pt fp_cb;
+    void *pv_ctx;
+
+    if ((gpio_num < 0) || (gpio_num >= GPIO_NUM_MAX))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    host_lock();
+    aui32_gpio_level[gpio_num] = level ? 1 : 0;
+    fp_cb  = fp_gpio_cb;
+    pv_ctx = pv_gpio_ctx;
+    host_unlock();
+
+    if (NULL != fp_cb)
+    {
+        fp_cb(pv_ctx, gpio_num, level ? 1 : 0);
+    }
+
+    return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t gpio_num)
+{
+    int level = 0;
+
+    if ((gpio_num >= 0) && (gpio_num < GPIO_NUM_MAX))
+    {
+        host_lock();
+        level = (int)aui32_gpio_level[gpio_num];
+        host_unlock();
+    }
+
+    return level;
+}
+
+
+/*
+ * SPI Master
+ */
+void hostSpiAttach(spi_host_device_t e_host, host_spi_cb_pt fp_cb, void *pv_ctx)
+{
+    host_lock();
+    as_spi_bus[e_host].fp_cb  = fp_cb;
+    as_spi_bus[e_host].pv_ctx = pv_ctx;
+    host_unlock();
+}
+
+void hostSpiGetStats(spi_host_device_t e_host, host_spi_stats_st *ps_stats)
+{
+    host_lock();
+    *ps_stats = as_spi_bus[e_host].s_stats;
+    host_unlock();
+}
+
+esp_err_t spi_bus_initialize(spi_host_device_t host_id, const spi_bus_config_t *bus_config, spi_dma_chan_t dma_chan)
+{
+    (void)dma_chan;
+
+    if ((host_id >= SPI_HOST_MAX) || (NULL == bus_config))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    else if (as_spi_bus[host_id].b_initialized)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    as_spi_bus[host_id].s_buscfg      = *bus_config;
+    as_spi_bus[host_id].b_initialized = true;
+
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_free(spi_host_device_t host_id)
+{
+    if (host_id >= SPI_HOST_MAX)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    as_spi_bus[host_id].b_initialized = false;
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_add_device(spi_host_device_t host_id, const spi_device_interface_config_t *dev_config, spi_device_handle_t *handle)
+{
+    spi_device_handle_t dev;
+
+    if ((host_id >= SPI_HOST_MAX) || (NULL == dev_config) || (NULL == handle) || (dev_config->queue_size < 1))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    else if (!as_spi_bus[host_id].b_initialized)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    else if (NULL == (dev = calloc(1, sizeof(*dev))))
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    else if (NULL == (dev->pps_done = calloc((size_t)dev_config->queue_size, sizeof(spi_transaction_t *))))
+    {
+        free(dev);
+        return ESP_ERR_NO_MEM;
+    }
+
+    dev->e_host   = host_id;
+    dev->s_devcfg = *dev_config;
+    *handle       = dev;
+
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_remove_device(spi_device_handle_t handle)
+{
+    if (NULL != handle)
+    {
+        free(handle->pps_done);
+        free(handle);
+    }
+    return ESP_OK;
+}
+
+static esp_err_t spi_execute(spi_device_handle_t dev, spi_transaction_t *t)
+{
+    host_spi_bus_st *ps_bus = &as_spi_bus[dev->e_host];
+    size_t sz_bytes = (t->length + 7) / 8;
+    host_spi_cb_pt fp_cb;
+    void *pv_ctx;
+    bool b_ok = true;
+
+    if (0 == t->rxlength)
+    {
+        t->rxlength = t->length;
+    }
+
+    if (NULL != dev->s_devcfg.pre_cb)
+    {
+        dev->s_devcfg.pre_cb(t);
+    }
+
+    host_lock();
+    fp_cb  = ps_bus->fp_cb;
+    pv_ctx = ps_bus->pv_ctx;
+    host_unlock();
+
+    if (NULL != fp_cb)
+    {
+        b_ok = fp_cb(pv_ctx, &dev->s_devcfg, t);
+    }
+    else
+    {
+        // nothing attached: MISO floats high
+        uint8_t *pui8_rx = (t->flags & SPI_TRANS_USE_RXDATA) ? t->rx_data : (uint8_t *)t->rx_buffer;
+        if (NULL != pui8_rx)
+        {
+            memset(pui8_rx, 0xFF, sz_bytes);
+        }
+    }
+
+    if (NULL != dev->s_devcfg.post_cb)
+    {
+        dev->s_devcfg.post_cb(t);
+    }
+
+    host_lock();
+    ps_bus->s_stats.ui32_transactions++;
+    ps_bus->s_stats.ui32_bytes  += (uint32_t)sz_bytes;
+    if (dev->s_devcfg.clock_speed_hz > 0)
+    {
+        ps_bus->s_stats.ui64_bus_us += ((uint64_t)t->length * 1000000) / (uint64_t)dev->s_devcfg.clock_speed_hz;
+    }
+    host_unlock();
+
+    return b_ok ? ESP_OK : ESP_FAIL;
+}
+
+static bool spi_done_has_space(void *pv_dev)
+{
+    spi_device_handle_t dev = (spi_device_handle_t)pv_dev;
+    return dev->i_done_count < dev->s_devcfg.queue_size;
+}
+
+static bool spi_done_has_items(void *pv_dev)
+{
+    spi_device_handle_t dev = (spi_device_handle_t)pv_dev;
+    return dev->i_done_count > 0;
+}
+
+esp_err_t spi_device_queue_trans(spi_device_handle_t handle, spi_transaction_t *trans_desc, TickType_t ticks_to_wait)
+{
+    esp_err_t err;
+
+    if ((NULL == handle) || (NULL == trans_desc))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    host_lock();
+    bool b_space = host_block_until_locked(spi_done_has_space, handle, ticks_to_wait);
+    host_unlock();
+
+    if (!b_space)
+    {
+        return ESP_ERR_TIMEOUT;
+    }
+    else if (ESP_OK != (err = spi_execute(handle, trans_desc)))
+    {
+        return err;
+    }
+
+    host_lock();
+    int i_tail = (handle->i_done_head + handle->i_done_count) % handle->s_devcfg.queue_size;
+    handle->pps_done[i_tail] = trans_desc;
+    handle->i_done_count++;
+    host_notify_locked();
+    host_unlock();
+
+    return ESP_OK;
+}
+
+esp_err_t spi_device_get_trans_result(spi_device_handle_t handle, spi_transaction_t **trans_desc, TickType_t ticks_to_wait)
+{
+    esp_err_t err = ESP_ERR_TIMEOUT;
+
+    if ((NULL == handle) || (NULL == trans_desc))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    host_lock();
+    if (host_block_until_locked(spi_done_has_items, handle, ticks_to_wait))
+    {
+        *trans_desc = handle->pps_done[handle->i_done_head];
+        handle->i_done_head = (handle->i_done_head + 1) % handle->s_devcfg.queue_size;
+        handle->i_done_count--;
+        host_notify_locked();
+        err = ESP_OK;
+    }
+    host_unlock();
+
+    return err;
+}
+
+esp_err_t spi_device_transmit(spi_device_handle_t handle, spi_transaction_t *trans_desc)
+{
+    spi_transaction_t *ps_done;
+    esp_err_t err = spi_device_queue_trans(handle, trans_desc, portMAX_DELAY);
+
+    if (ESP_OK == err)
+    {
+        err = spi_device_get_trans_result(handle, &ps_done, portMAX_DELAY);
+    }
+
+    return err;
+}
+
+esp_err_t spi_device_polling_transmit(spi_device_handle_t handle, spi_transaction_t *trans_desc)
+{
+    return ((NULL == handle) || (NULL == trans_desc)) ? ESP_ERR_INVALID_ARG : spi_execute(handle, trans_desc);
+}
+
+esp_err_t spi_device_acquire_bus(spi_device_handle_t device, TickType_t wait)
+{
+    (void)device;
+    (void)wait;
+    return ESP_OK;
+}
+
+void spi_device_release_bus(spi_device_handle_t dev)
+{
+    (void)dev;
+}
+
+
+/*
+ * UART
+ */
+void hostUartAttach(uart_port_t e_port, host_uart_tx_cb_pt fp_cb, void *pv_ctx)
+{
+    host_lock();
+    as_uart[e_port].fp_tx_cb  = fp_cb;
+    as_uart[e_port].pv_tx_ctx = pv_ctx;
+    host_unlock();
+}
+
+size_t hostUartInject(uart_port_t e_port, const uint8_t *pui8_data, size_t sz_len)
+{
+    host_uart_st *ps_uart = &as_uart[e_port];
+    size_t sz_copied = 0;
+
+    host_lock();
+    if (ps_uart->b_installed)
+    {
+        // overflow drops the newest bytes, like the hardware FIFO
+        while ((sz_copied < sz_len) && (ps_uart->sz_rx_count < ps_uart->sz_rx_size))
+        {
+            ps_uart->pui8_rx[(ps_uart->sz_rx_head + ps_uart->sz_rx_count) % ps_uart->sz_rx_size] = pui8_data[sz_copied++];
+            ps_uart->sz_rx_count++;
+        }
+        host_notify_locked();
+    }
+    host_unlock();
+
+    return sz_copied;
+}
+
+esp_err_t uart_driver_install(uart_port_t uart_num, int rx_buffer_size, int tx_buffer_size,
+                              int queue_size, QueueHandle_t *uart_queue, int intr_alloc_flags)
+{
+    host_uart_st *ps_uart;
+
+    (void)tx_buffer_size;
+    (void)queue_size;
+    (void)intr_alloc_flags;
+
+    if ((uart_num >= UART_NUM_MAX) || (rx_buffer_size <= 0))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ps_uart = &as_uart[uart_num];
+    if (ps_uart->b_installed)
+    {
+        return ESP_FAIL;
+    }
+    else if (NULL == (ps_uart->pui8_rx = malloc((size_t)rx_buffer_size)))
+    {
+        return ESP_ERR_NO_MEM;
+    }
+
+    host_lock();
+    ps_uart->sz_rx_size  = (size_t)rx_buffer_size;
+    ps_uart->sz_rx_head  = 0;
+    ps_uart->sz_rx_count = 0;
+    ps_uart->b_installed = true;
+    host_unlock();
+
+    if (NULL != uart_queue)
+    {
+        *uart_queue = NULL; // no event queue
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t uart_driver_delete(uart_port_t uart_num)
+{
+    host_uart_st *ps_uart = &as_uart[uart_num];
+
+    host_lock();
+    ps_uart->b_installed = false;
+    free(ps_uart->pui8_rx);
+    ps_uart->pui8_rx = NULL;
+    host_unlock();
+
+    return ESP_OK;
+}
+
+esp_err_t uart_param_config(uart_port_t uart_num, const uart_config_t *uart_config)
+{
+    return ((uart_num < UART_NUM_MAX) && (NULL != uart_config)) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t uart_set_pin(uart_port_t uart_num, int tx_io_num, int rx_io_num, int rts_io_num, int cts_io_num)
+{
+    (void)tx_io_num;
+    (void)rx_io_num;
+    (void)rts_io_num;
+    (void)cts_io_num;
+    return (uart_num < UART_NUM_MAX) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+int uart_write_bytes(uart_port_t uart_num, const void *src, size_t size)
+{
+    host_uart_tx_cb_pt fp_cb;
+    void *pv_ctx;
+
+    if ((uart_num >= UART_NUM_MAX) || !as_uart[uart_num].b_installed)
+    {
+        return -1;
+    }
+
+    host_lock();
+    fp_cb  = as_uart[uart_num].fp_tx_cb;
+    pv_ctx = as_uart[uart_num].pv_tx_ctx;
+    host_unlock();
+
+    if (NULL != fp_cb)
+    {
+        fp_cb(pv_ctx, (const uint8_t *)src, size);
+    }
+
+    return (int)size;
+}
+
+static bool uart_rx_ready(void *pv_wait)
+{
+    uart_wait_st *ps_wait = (uart_wait_st *)pv_wait;
+    return ps_wait->ps_uart->sz_rx_count >= ps_wait->sz_wanted;
+}
+
+int uart_read_bytes(uart_port_t uart_num, void *buf, uint32_t length, TickType_t ticks_to_wait)
+{
+    uart_wait_st s_wait;
+    uint8_t *pui8_buf = (uint8_t *)buf;
+    size_t sz_read = 0;
+
+    if ((uart_num >= UART_NUM_MAX) || !as_uart[uart_num].b_installed)
+    {
+        return -1;
+    }
+
+    s_wait.ps_uart   = &as_uart[uart_num];
+    s_wait.sz_wanted = length;
+
+    // like IDF: wait for the full length, return whatever arrived on timeout
+    host_lock();
+    (void)host_block_until_locked(uart_rx_ready, &s_wait, ticks_to_wait);
+    while ((sz_read < length) && (s_wait.ps_uart->sz_rx_count > 0))
+    {
+        pui8_buf[sz_read++] = s_wait.ps_uart->pui8_rx[s_wait.ps_uart->sz_rx_head];
+        s_wait.ps_uart->sz_rx_head = (s_wait.ps_uart->sz_rx_head + 1) % s_wait.ps_uart->sz_rx_size;
+        s_wait.ps_uart->sz_rx_count--;
+    }
+    host_unlock();
+
+    return (int)sz_read;
+}
+
+esp_err_t uart_flush_input(uart_port_t uart_num)
+{
+    host_lock();
+    as_uart[uart_num].sz_rx_head  = 0;
+    as_uart[uart_num].sz_rx_count = 0;
+    host_unlock();
+    return ESP_OK;
+}
+
+esp_err_t uart_get_buffered_data_len(uart_port_t uart_num, size_t *size)
+{
+    host_lock();
+    *size = as_uart[uart_num].sz_rx_count;
+    host_unlock();
+    return ESP_OK;
+}
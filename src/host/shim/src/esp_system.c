@@ -0,0 +1,352 @@
+/*
+ * esp_system.c
+ *
+ * System services of the host build: app descriptor, MAC, NVS, FAT volume, task watchdog.
+ */
+
+#define _GNU_SOURCE
+
+#include <dirent.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "sdkconfig.h"
+#include "esp_err.h"
+#include "esp_mac.h"
+#include "esp_ota_ops.h"
+#include "esp_system.h"
+#include "esp_task_wdt.h"
+#include "esp_vfs_fat.h"
+#include "nvs_flash.h"
+#include "rom/ets_sys.h"
+#include "sys/lock.h"
+
+#include "host_shim.h"
+#include "host_internal.h"
+
+
+/*
+ * Local Constants
+ */
+#ifndef K_APP_VER
+#define K_APP_VER           "host"
+#endif
+
+#define K_HOST_WDT_NAME_LEN     16
+
+
+/*
+ * Local Definitions
+ */
+struct esp_task_wdt_user_handle_s
+{
+    char        ac_name[K_HOST_WDT_NAME_LEN];
+    uint64_t    ms_last_reset;
+};
+
+
+/*
+ * Local Variables
+ */
+static const esp_app_desc_t s_app_desc = {
+    .magic_word     = 0xABCD5432,
+    .version        = K_APP_VER,
+    .project_name   = "pdl_host",
+    .time           = __TIME__,
+    .date           = __DATE__,
+    .idf_ver        = "host",
+};
+
+static const esp_partition_t s_running_partition = {
+    .type           = ESP_PARTITION_TYPE_APP,
+    .subtype        = ESP_PARTITION_SUBTYPE_APP_FACTORY,
+    .address        = 0x10000,
+    .size           = 0x300000,
+    .erase_size     = 4096,
+    .label          = "factory",
+};
+
+static uint8_t au8_base_mac[6] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x01 }; // locally administered
+
+#define K_SHUTDOWN_HANDLERS_NO  (5)     // as CONFIG_ESP_SYSTEM_SHUTDOWN_HANDLERS_NO
+static shutdown_handler_t as_shutdown_handlers[K_SHUTDOWN_HANDLERS_NO];
+
+
+/*
+ * System
+ */
+esp_reset_reason_t esp_reset_reason(void)
+{
+    return ESP_RST_POWERON;
+}
+
+esp_err_t esp_register_shutdown_handler(shutdown_handler_t handle)
+{
+    for (int i = 0; i < K_SHUTDOWN_HANDLERS_NO; i++)
+    {
+        if (as_shutdown_handlers[i] == handle)
+        {
+            return ESP_ERR_INVALID_STATE;
+        }
+        else if (NULL == as_shutdown_handlers[i])
+        {
+            as_shutdown_handlers[i] = handle;
+            return ESP_OK;
+        }
+    }
+
+    return ESP_ERR_NO_MEM;
+}
+
+void esp_restart(void)
+{
+    // same order as esp-idf: last registered first
+    for (int i = K_SHUTDOWN_HANDLERS_NO - 1; i >= 0; i--)
+    {
+        if (NULL != as_shutdown_handlers[i])
+        {
+            as_shutdown_handlers[i]();
+        }
+    }
+
+    printf("esp_restart(): host build exits\r\n");
+    fflush(stdout);
+    exit(EXIT_SUCCESS);
+}
+
+const esp_app_desc_t *esp_app_get_description(void)
+{
+    return &s_app_desc;
+}
+
+const esp_partition_t *esp_ota_get_running_partition(void)
+{
+    return &s_running_partition;
+}
+
+void hostSetBaseMac(const uint8_t au8_mac[6])
+{
+    memcpy(au8_base_mac, au8_mac, sizeof(au8_base_mac));
+}
+
+esp_err_t esp_efuse_mac_get_default(uint8_t *mac)
+{
+    memcpy(mac, au8_base_mac, sizeof(au8_base_mac));
+    return ESP_OK;
+}
+
+void ets_delay_us(uint32_t us)
+{
+    if (HOST_CLOCK_REALTIME == hostClockMode())
+    {
+        struct timespec ts = { .tv_sec = us / 1000000, .tv_nsec = (long)(us % 1000000) * 1000 };
+        (void)nanosleep(&ts, NULL);
+    }
+}
+
+
+/*
+ * Task Watchdog
+ */
+esp_err_t esp_task_wdt_add_user(const char *user_name, esp_task_wdt_user_handle_t *user_handle_ret)
+{
+    esp_task_wdt_user_handle_t handle;
+
+    if ((NULL == user_name) || (NULL == user_handle_ret))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    else if (NULL == (handle = calloc(1, sizeof(*handle))))
+    {
+        return ESP_ERR_NO_MEM;
+    }
+
+    strncpy(handle->ac_name, user_name, sizeof(handle->ac_name) - 1);
+    handle->ms_last_reset = host_now_ms();
+    *user_handle_ret = handle;
+
+    return ESP_OK;
+}
+
+esp_err_t esp_task_wdt_reset_user(esp_task_wdt_user_handle_t user_handle)
+{
+    uint64_t ms_now;
+
+    if (NULL == user_handle)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ms_now = host_now_ms();
+    if ((ms_now - user_handle->ms_last_reset) > (CONFIG_ESP_TASK_WDT_TIMEOUT_S * 1000ULL))
+    {
+        printf("task_wdt: %s starved for %llu ms\r\n", user_handle->ac_name,
+               (unsigned long long)(ms_now - user_handle->ms_last_reset));
+    }
+    user_handle->ms_last_reset = ms_now;
+
+    return ESP_OK;
+}
+
+esp_err_t esp_task_wdt_delete_user(esp_task_wdt_user_handle_t user_handle)
+{
+    free(user_handle);
+    return ESP_OK;
+}
+
+
+/*
+ * NVS
+ */
+esp_err_t nvs_flash_init(void)
+{
+    return ESP_OK;
+}
+
+esp_err_t nvs_flash_erase(void)
+{
+    return ESP_OK;
+}
+
+
+/*
+ * FAT Volume
+ */
+static esp_err_t clear_dir(const char *pc_path)
+{
+    esp_err_t       err = ESP_OK;
+    DIR            *dir = opendir(pc_path);
+    struct dirent  *ent;
+    char            ac_child[512];
+    struct stat     st;
+
+    if (NULL == dir)
+    {
+        return ESP_FAIL;
+    }
+
+    while (NULL != (ent = readdir(dir)))
+    {
+        if ((0 == strcmp(ent->d_name, ".")) || (0 == strcmp(ent->d_name, "..")))
+        {
+            continue;
+        }
+
+        snprintf(ac_child, sizeof(ac_child), "%s/%s", pc_path, ent->d_name);
+        if ((0 == lstat(ac_child, &st)) && S_ISDIR(st.st_mode))
+        {
+            if ((ESP_OK != clear_dir(ac_child)) || (0 != rmdir(ac_child)))
+            {
+                err = ESP_FAIL;
+            }
+        }
+        else if (0 != unlink(ac_child))
+        {
+            err = ESP_FAIL;
+        }
+    }
+    closedir(dir);
+
+    return err;
+}
+
+esp_err_t esp_vfs_fat_spiflash_mount_rw_wl(const char *base_path, const char *partition_label,
+                                           const esp_vfs_fat_mount_config_t *mount_config, wl_handle_t *wl_handle)
+{
+    (void)partition_label;
+    (void)mount_config;
+
+    if ((0 != mkdir(base_path, 0755)) && (EEXIST != errno))
+    {
+        printf("vfs_fat: cannot create \"%s\" (%s)\r\n", base_path, strerror(errno));
+        return ESP_FAIL;
+    }
+
+    if (NULL != wl_handle)
+    {
+        *wl_handle = 0;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t esp_vfs_fat_spiflash_unmount_rw_wl(const char *base_path, wl_handle_t wl_handle)
+{
+    (void)base_path;
+    (void)wl_handle;
+    return ESP_OK;
+}
+
+esp_err_t esp_vfs_fat_spiflash_format_rw_wl(const char *base_path, const char *partition_label)
+{
+    (void)partition_label;
+    return clear_dir(base_path);
+}
+
+esp_err_t esp_vfs_fat_info(const char *base_path, uint64_t *out_total_bytes, uint64_t *out_free_bytes)
+{
+    struct statvfs st;
+
+    if (0 != statvfs(base_path, &st))
+    {
+        return ESP_FAIL;
+    }
+
+    *out_total_bytes = (uint64_t)st.f_blocks * st.f_frsize;
+    *out_free_bytes  = (uint64_t)st.f_bavail * st.f_frsize;
+
+    return ESP_OK;
+}
+
+
+/*
+ * newlib Locks
+ */
+static pthread_mutex_t s_lock_init = PTHREAD_MUTEX_INITIALIZER;
+
+void _lock_init(_lock_t *plock)
+{
+    pthread_mutexattr_t attr;
+    pthread_mutex_t *pm = malloc(sizeof(pthread_mutex_t));
+
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(pm, &attr);
+    pthread_mutexattr_destroy(&attr);
+    *plock = pm;
+}
+
+void _lock_close(_lock_t *plock)
+{
+    if (NULL != *plock)
+    {
+        pthread_mutex_destroy((pthread_mutex_t *)*plock);
+        free(*plock);
+        *plock = NULL;
+    }
+}
+
+void _lock_acquire(_lock_t *plock)
+{
+    // statically zeroed locks are created on first use, as newlib does
+    pthread_mutex_lock(&s_lock_init);
+    if (NULL == *plock)
+    {
+        _lock_init(plock);
+    }
+    pthread_mutex_unlock(&s_lock_init);
+
+    pthread_mutex_lock((pthread_mutex_t *)*plock);
+}
+
+void _lock_release(_lock_t *plock)
+{
+    pthread_mutex_unlock((pthread_mutex_t *)*plock);
+}
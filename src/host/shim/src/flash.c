@@ -0,0 +1,357 @@
+/*
+ * flash.c
+ *
+ * Raw partitions of the host build, a NOR flash emulator on image files in the build tree:
+ *  - erase sets whole 4 KiB sectors to 0xFF, a write can only clear bits (bytes that needed a
+ *    set bit back are counted, on real flash they'd be corrupted)
+ *  - erase count of every sector and the flash time of each operation after the typical
+ *    datasheet figures ("K_HOST_FLASH_..." in "host_shim.h"), block erases for aligned 64 KiB
+ *    as "spi_flash_erase_range()" does
+ *  - esp_partition_mmap() maps the image read-only and shared, so a mapped window sees later
+ *    writes the way the flash cache does once the driver invalidated it; reads through it
+ *    aren't timed
+ * The images keep their content from run to run like the flash does.
+ */
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "esp_partition.h"
+#include "host_shim.h"
+
+
+/*
+ * Local Constants
+ */
+#define K_FLASH_SECTOR_SIZE     (4096)
+#define K_FLASH_BLOCK_SIZE      (65536)
+#define K_FLASH_PROGRAM_PAGE    (256)
+#define K_FLASH_DATALOG_SUBTYPE ((esp_partition_subtype_t)0x40)
+#define K_FLASH_MAX_MAPS        (16)
+
+typedef struct
+{
+    esp_partition_t     s_part;
+    int                 i_fd;               // image, -1 until first found
+    uint32_t           *pui32_erases;       // per sector
+    host_flash_stats_st s_stats;
+} host_flash_part_st;
+
+typedef struct
+{
+    void               *pv_base;            // NULL: free
+    size_t              sz_len;
+} host_flash_map_st;
+
+
+/*
+ * Local Variables
+ */
+static pthread_mutex_t      s_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// as "partitions/16MB_raw_log.csv", plus one for the benches
+static host_flash_part_st   as_parts[] = {
+    { .s_part = { .type = ESP_PARTITION_TYPE_DATA, .subtype = K_FLASH_DATALOG_SUBTYPE, .address = 0x600000,
+                  .size = 0xA00000, .erase_size = K_FLASH_SECTOR_SIZE, .label = "datalog" }, .i_fd = -1 },
+    { .s_part = { .type = ESP_PARTITION_TYPE_DATA, .subtype = K_FLASH_DATALOG_SUBTYPE, .address = 0x1000000,
+                  .size = 0xA00000, .erase_size = K_FLASH_SECTOR_SIZE, .label = "bench" }, .i_fd = -1 },
+};
+
+// handle n is as_maps[n - 1]
+static host_flash_map_st    as_maps[K_FLASH_MAX_MAPS];
+
+
+/*
+ * Private Functions
+ */
+static host_flash_part_st *getPart(const esp_partition_t *ps_part)
+{
+    for (size_t i = 0; i < (sizeof(as_parts) / sizeof(as_parts[0])); i++)
+    {
+        if (ps_part == &as_parts[i].s_part)
+        {
+            return &as_parts[i];
+        }
+    }
+
+    return NULL;
+}
+
+/* image "<build>/flash_<label>.bin", grown to the partition size with erased sectors */
+static bool openImage(host_flash_part_st *ps_fp)
+{
+    char    ac_path[256];
+    uint8_t aui8_erased[K_FLASH_SECTOR_SIZE];
+    off_t   o_size;
+
+    snprintf(ac_path, sizeof(ac_path), "%s/flash_%s.bin", K_HOST_FLASH_DIR, ps_fp->s_part.label);
+    ps_fp->i_fd = open(ac_path, O_RDWR | O_CREAT, 0644);
+    if (ps_fp->i_fd < 0)
+    {
+        printf("flash: cannot open \"%s\"\r\n", ac_path);
+        return false;
+    }
+
+    memset(aui8_erased, 0xFF, sizeof(aui8_erased));
+    o_size = lseek(ps_fp->i_fd, 0, SEEK_END);
+    for (o_size -= o_size % K_FLASH_SECTOR_SIZE; o_size < (off_t)ps_fp->s_part.size; o_size += K_FLASH_SECTOR_SIZE)
+    {
+        if (K_FLASH_SECTOR_SIZE != pwrite(ps_fp->i_fd, aui8_erased, K_FLASH_SECTOR_SIZE, o_size))
+        {
+            return false;
+        }
+    }
+
+    ps_fp->pui32_erases = calloc(ps_fp->s_part.size / K_FLASH_SECTOR_SIZE, sizeof(uint32_t));
+
+    return (NULL != ps_fp->pui32_erases);
+}
+
+static bool inRange(const host_flash_part_st *ps_fp, size_t sz_off, size_t sz_len)
+{
+    return (NULL != ps_fp) && (ps_fp->i_fd >= 0) && (sz_off <= ps_fp->s_part.size) && (sz_len <= (ps_fp->s_part.size - sz_off));
+}
+
+
+/*
+ * Public Functions
+ */
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype, const char *label)
+{
+    const esp_partition_t *ps_found = NULL;
+
+    pthread_mutex_lock(&s_mutex);
+    for (size_t i = 0; i < (sizeof(as_parts) / sizeof(as_parts[0])); i++)
+    {
+        host_flash_part_st *ps_fp = &as_parts[i];
+
+        if (((ESP_PARTITION_TYPE_ANY != type) && (type != ps_fp->s_part.type)) ||
+            ((ESP_PARTITION_SUBTYPE_ANY != subtype) && (subtype != ps_fp->s_part.subtype)) ||
+            ((NULL != label) && (0 != strcmp(label, ps_fp->s_part.label))))
+        {
+            continue;
+        }
+
+        if ((ps_fp->i_fd >= 0) || (true == openImage(ps_fp)))
+        {
+            ps_found = &ps_fp->s_part;
+        }
+        break;
+    }
+    pthread_mutex_unlock(&s_mutex);
+
+    return ps_found;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t *partition, size_t src_offset, void *dst, size_t size)
+{
+    host_flash_part_st *ps_fp = getPart(partition);
+    esp_err_t           err   = ESP_OK;
+
+    pthread_mutex_lock(&s_mutex);
+    if (false == inRange(ps_fp, src_offset, size))
+    {
+        err = ESP_ERR_INVALID_SIZE;
+    }
+    else if ((ssize_t)size != pread(ps_fp->i_fd, dst, size, (off_t)src_offset))
+    {
+        err = ESP_FAIL;
+    }
+    else
+    {
+        ps_fp->s_stats.ui64_read    += size;
+        ps_fp->s_stats.ui64_busy_us += ((uint64_t)size * K_HOST_FLASH_READ_NS_PER_BYTE) / 1000;
+    }
+    pthread_mutex_unlock(&s_mutex);
+
+    return err;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t *partition, size_t dst_offset, const void *src, size_t size)
+{
+    host_flash_part_st *ps_fp  = getPart(partition);
+    const uint8_t      *pui8_src = (const uint8_t *)src;
+    uint8_t             aui8_old[K_FLASH_SECTOR_SIZE];
+    esp_err_t           err    = ESP_OK;
+
+    pthread_mutex_lock(&s_mutex);
+    if (false == inRange(ps_fp, dst_offset, size))
+    {
+        err = ESP_ERR_INVALID_SIZE;
+    }
+
+    // NOR: the new content is the old one AND the data
+    for (size_t sz_done = 0; (ESP_OK == err) && (sz_done < size); )
+    {
+        size_t sz_chunk = size - sz_done;
+
+        sz_chunk = (sz_chunk > sizeof(aui8_old)) ? sizeof(aui8_old) : sz_chunk;
+        if ((ssize_t)sz_chunk != pread(ps_fp->i_fd, aui8_old, sz_chunk, (off_t)(dst_offset + sz_done)))
+        {
+            err = ESP_FAIL;
+            break;
+        }
+
+        for (size_t i = 0; i < sz_chunk; i++)
+        {
+            ps_fp->s_stats.ui32_unerased += (pui8_src[sz_done + i] != (aui8_old[i] & pui8_src[sz_done + i])) ? 1 : 0;
+            aui8_old[i] &= pui8_src[sz_done + i];
+        }
+
+        if ((ssize_t)sz_chunk != pwrite(ps_fp->i_fd, aui8_old, sz_chunk, (off_t)(dst_offset + sz_done)))
+        {
+            err = ESP_FAIL;
+        }
+        sz_done += sz_chunk;
+    }
+
+    if ((ESP_OK == err) && (0 != size))
+    {
+        uint32_t ui32_first = (partition->address + dst_offset) / K_FLASH_PROGRAM_PAGE;
+        uint32_t ui32_last  = (partition->address + dst_offset + size - 1) / K_FLASH_PROGRAM_PAGE;
+
+        ps_fp->s_stats.ui64_programmed += size;
+        ps_fp->s_stats.ui64_busy_us    += (uint64_t)(ui32_last - ui32_first + 1) * K_HOST_FLASH_PROGRAM_US;
+    }
+    pthread_mutex_unlock(&s_mutex);
+
+    return err;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t *partition, size_t offset, size_t size)
+{
+    host_flash_part_st *ps_fp = getPart(partition);
+    uint8_t             aui8_erased[K_FLASH_SECTOR_SIZE];
+    uint8_t             ui8_block_left = 0;     // sectors of the block erase under way
+    esp_err_t           err   = ESP_OK;
+
+    pthread_mutex_lock(&s_mutex);
+    if (false == inRange(ps_fp, offset, size))
+    {
+        err = ESP_ERR_INVALID_SIZE;
+    }
+    else if ((0 != (offset % K_FLASH_SECTOR_SIZE)) || (0 != (size % K_FLASH_SECTOR_SIZE)))
+    {
+        err = ESP_ERR_INVALID_ARG;
+    }
+
+    memset(aui8_erased, 0xFF, sizeof(aui8_erased));
+    for (size_t sz_off = offset; (ESP_OK == err) && (sz_off < (offset + size)); sz_off += K_FLASH_SECTOR_SIZE)
+    {
+        uint32_t *pui32_count = &ps_fp->pui32_erases[sz_off / K_FLASH_SECTOR_SIZE];
+
+        if (K_FLASH_SECTOR_SIZE != pwrite(ps_fp->i_fd, aui8_erased, K_FLASH_SECTOR_SIZE, (off_t)sz_off))
+        {
+            err = ESP_FAIL;
+            break;
+        }
+
+        // a 64 KiB block in one go, sector by sector otherwise
+        if ((0 == ui8_block_left) && (0 == ((partition->address + sz_off) % K_FLASH_BLOCK_SIZE)) &&
+            ((offset + size - sz_off) >= K_FLASH_BLOCK_SIZE))
+        {
+            ps_fp->s_stats.ui64_busy_us += K_HOST_FLASH_BLOCK_ERASE_US;
+            ui8_block_left = K_FLASH_BLOCK_SIZE / K_FLASH_SECTOR_SIZE;
+        }
+        else if (0 == ui8_block_left)
+        {
+            ps_fp->s_stats.ui64_busy_us += K_HOST_FLASH_SECTOR_ERASE_US;
+        }
+        ui8_block_left -= (0 != ui8_block_left) ? 1 : 0;
+
+        (*pui32_count)++;
+        ps_fp->s_stats.ui32_erases++;
+        if (*pui32_count > ps_fp->s_stats.ui32_max_sector_erases)
+        {
+            ps_fp->s_stats.ui32_max_sector_erases = *pui32_count;
+        }
+    }
+    pthread_mutex_unlock(&s_mutex);
+
+    return err;
+}
+
+/* read-only view of the image; offset and size need no alignment, the pointer is to offset */
+esp_err_t esp_partition_mmap(const esp_partition_t *partition, size_t offset, size_t size, esp_partition_mmap_memory_t memory,
+                             const void **out_ptr, esp_partition_mmap_handle_t *out_handle)
+{
+    host_flash_part_st *ps_fp   = getPart(partition);
+    size_t              sz_skip = offset % (size_t)sysconf(_SC_PAGESIZE);
+    esp_err_t           err     = ESP_ERR_NO_MEM;
+
+    pthread_mutex_lock(&s_mutex);
+    if ((false == inRange(ps_fp, offset, size)) || (0 == size) || (ESP_PARTITION_MMAP_DATA != memory))
+    {
+        err = ESP_ERR_INVALID_ARG;
+    }
+
+    for (size_t i = 0; (ESP_ERR_NO_MEM == err) && (i < K_FLASH_MAX_MAPS); i++)
+    {
+        void *pv_base;
+
+        if (NULL != as_maps[i].pv_base)
+        {
+            continue;
+        }
+
+        pv_base = mmap(NULL, size + sz_skip, PROT_READ, MAP_SHARED, ps_fp->i_fd, (off_t)(offset - sz_skip));
+        if (MAP_FAILED == pv_base)
+        {
+            err = ESP_FAIL;
+            break;
+        }
+
+        as_maps[i].pv_base = pv_base;
+        as_maps[i].sz_len  = size + sz_skip;
+        *out_ptr    = (const uint8_t *)pv_base + sz_skip;
+        *out_handle = (esp_partition_mmap_handle_t)(i + 1);
+        ps_fp->s_stats.ui32_maps++;
+        err = ESP_OK;
+    }
+    pthread_mutex_unlock(&s_mutex);
+
+    return err;
+}
+
+void esp_partition_munmap(esp_partition_mmap_handle_t handle)
+{
+    pthread_mutex_lock(&s_mutex);
+    if ((0 != handle) && (handle <= K_FLASH_MAX_MAPS) && (NULL != as_maps[handle - 1].pv_base))
+    {
+        (void)munmap(as_maps[handle - 1].pv_base, as_maps[handle - 1].sz_len);
+        as_maps[handle - 1].pv_base = NULL;
+    }
+    pthread_mutex_unlock(&s_mutex);
+}
+
+/* statistics and per sector erase counts from now on */
+void hostFlashResetStats(const esp_partition_t *ps_part)
+{
+    host_flash_part_st *ps_fp = getPart(ps_part);
+
+    pthread_mutex_lock(&s_mutex);
+    if ((NULL != ps_fp) && (NULL != ps_fp->pui32_erases))
+    {
+        memset(ps_fp->pui32_erases, 0, (ps_fp->s_part.size / K_FLASH_SECTOR_SIZE) * sizeof(uint32_t));
+        memset(&ps_fp->s_stats, 0, sizeof(ps_fp->s_stats));
+    }
+    pthread_mutex_unlock(&s_mutex);
+}
+
+void hostFlashGetStats(const esp_partition_t *ps_part, host_flash_stats_st *ps_stats)
+{
+    host_flash_part_st *ps_fp = getPart(ps_part);
+
+    pthread_mutex_lock(&s_mutex);
+    memset(ps_stats, 0, sizeof(host_flash_stats_st));
+    if (NULL != ps_fp)
+    {
+        *ps_stats = ps_fp->s_stats;
+    }
+    pthread_mutex_unlock(&s_mutex);
+}
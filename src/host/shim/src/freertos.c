@@ -0,0 +1,580 @@
+/*
+ * freertos.c
+ *
+ * FreeRTOS API on top of pthreads. One global lock and condition variable serialize all
+ * kernel objects, which is plenty for the handful of application tasks.
+ *
+ * In "HOST_CLOCK_FAST" mode the tick counter is virtual: whenever every task is blocked the
+ * clock jumps to the earliest pending deadline, so hours of firmware time run in seconds.
+ * "time()" is wrapped at link time to follow the same clock from the wall time at init.
+ */
+
+#define _GNU_SOURCE
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+
+#include "host_shim.h"
+#include "host_internal.h"
+
+
+/*
+ * Local Constants
+ */
+#define K_HOST_NO_DEADLINE          UINT64_MAX
+#define K_HOST_TASK_NAME_LEN        16
+
+
+/*
+ * Local Definitions
+ */
+struct tskTaskControlBlock
+{
+    struct tskTaskControlBlock *ps_next;
+    pthread_t                   thread;
+    char                        ac_name[K_HOST_TASK_NAME_LEN];
+    TaskFunction_t              fp_code;
+    void                       *pv_param;
+    bool                        b_blocked;      // waiting inside the shim
+    bool                        b_deleted;      // exit at next blocking call
+    uint64_t                    ms_deadline;    // wake-up time while blocked
+};
+
+struct QueueDefinition
+{
+    uint8_t                    *pui8_storage;   // NULL for semaphores
+    UBaseType_t                 ux_length;
+    UBaseType_t                 ux_item_size;
+    UBaseType_t                 ux_head;        // oldest item
+    UBaseType_t                 ux_count;
+};
+
+
+/*
+ * Local Variables
+ */
+static pthread_mutex_t              s_lock          = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t               s_cond;
+static bool                         b_initialized   = false;
+static host_clock_mode_et           e_clock_mode    = HOST_CLOCK_REALTIME;
+static struct timespec              s_start;        // monotonic time at init
+static time_t                       t_epoch;        // wall time at init
+static uint64_t                     ms_virtual      = 0;
+static struct tskTaskControlBlock  *ps_tasks        = NULL;
+static unsigned                     u_tasks         = 0;
+static unsigned                     u_blocked       = 0;
+static __thread struct tskTaskControlBlock *ps_self = NULL;
+
+
+/*
+ * Private Functions
+ */
+static uint64_t monotonic_ms(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)(now.tv_sec - s_start.tv_sec) * 1000 + (now.tv_nsec - s_start.tv_nsec) / 1000000;
+}
+
+static void task_register_locked(struct tskTaskControlBlock *ps_task)
+{
+    ps_task->ps_next = ps_tasks;
+    ps_tasks = ps_task;
+    u_tasks++;
+}
+
+static void task_unregister_locked(struct tskTaskControlBlock *ps_task)
+{
+    for (struct tskTaskControlBlock **pps = &ps_tasks; NULL != *pps; pps = &(*pps)->ps_next)
+    {
+        if (*pps == ps_task)
+        {
+            *pps = ps_task->ps_next;
+            u_tasks--;
+            if (ps_task->b_blocked)
+            {
+                u_blocked--;
+            }
+            break;
+        }
+    }
+}
+
+static struct tskTaskControlBlock *self_locked(void)
+{
+    if (NULL == ps_self)
+    {
+        // foreign thread, e.g. a simulated peripheral calling into the kernel
+        ps_self = calloc(1, sizeof(*ps_self));
+        ps_self->thread = pthread_self();
+        strncpy(ps_self->ac_name, "ext", sizeof(ps_self->ac_name) - 1);
+        task_register_locked(ps_self);
+    }
+    return ps_self;
+}
+
+static void unblock_all_locked(void)
+{
+    for (struct tskTaskControlBlock *ps = ps_tasks; NULL != ps; ps = ps->ps_next)
+    {
+        ps->b_blocked = false;
+    }
+    u_blocked = 0;
+    pthread_cond_broadcast(&s_cond);
+}
+
+// fast clock: nobody can run until the next deadline, so skip the idle time
+static void clock_skip_locked(void)
+{
+    if ((HOST_CLOCK_FAST == e_clock_mode) && (u_tasks > 0) && (u_blocked == u_tasks))
+    {
+        uint64_t ms_next = K_HOST_NO_DEADLINE;
+
+        for (struct tskTaskControlBlock *ps = ps_tasks; NULL != ps; ps = ps->ps_next)
+        {
+            if (ps->ms_deadline < ms_next)
+            {
+                ms_next = ps->ms_deadline;
+            }
+        }
+
+        if ((K_HOST_NO_DEADLINE != ms_next) && (ms_next > ms_virtual))
+        {
+            ms_virtual = ms_next;
+            unblock_all_locked();
+        }
+    }
+}
+
+static void task_exit_locked(struct tskTaskControlBlock *ps_task)
+{
+    task_unregister_locked(ps_task);
+    clock_skip_locked();
+    host_unlock();
+    free(ps_task);
+    ps_self = NULL;
+    pthread_exit(NULL);
+}
+
+static void *task_entry(void *pv_arg)
+{
+    struct tskTaskControlBlock *ps_task = (struct tskTaskControlBlock *)pv_arg;
+
+    ps_self = ps_task;
+    ps_task->fp_code(ps_task->pv_param);
+
+    // returning from a task function is an error on target, be forgiving here
+    host_lock();
+    task_exit_locked(ps_task);
+    return NULL;
+}
+
+
+/*
+ * Shim Internals
+ */
+void host_lock(void)
+{
+    pthread_mutex_lock(&s_lock);
+}
+
+void host_unlock(void)
+{
+    pthread_mutex_unlock(&s_lock);
+}
+
+uint64_t host_now_ms_locked(void)
+{
+    return (HOST_CLOCK_REALTIME == e_clock_mode) ? monotonic_ms() : ms_virtual;
+}
+
+uint64_t host_now_ms(void)
+{
+    host_lock();
+    uint64_t ms_now = host_now_ms_locked();
+    host_unlock();
+    return ms_now;
+}
+
+time_t __real_time(time_t *pt_time);
+
+// wall time of the firmware, in step with its tick count whichever the clock mode
+time_t __wrap_time(time_t *pt_time)
+{
+    time_t t_now;
+
+    if (!b_initialized)
+    {
+        return __real_time(pt_time);
+    }
+
+    t_now = t_epoch + (time_t)(host_now_ms() / 1000);
+    if (NULL != pt_time)
+    {
+        *pt_time = t_now;
+    }
+    return t_now;
+}
+
+bool host_block_until_locked(host_pred_pt fp_pred, void *pv_ctx, TickType_t ticks)
+{
+    struct tskTaskControlBlock *ps_task = self_locked();
+    uint64_t ms_deadline = K_HOST_NO_DEADLINE;
+
+    if (portMAX_DELAY != ticks)
+    {
+        ms_deadline = host_now_ms_locked() + (uint64_t)ticks * portTICK_PERIOD_MS;
+    }
+
+    for (;;)
+    {
+        if (ps_task->b_deleted)
+        {
+            task_exit_locked(ps_task);
+        }
+        else if ((NULL != fp_pred) && fp_pred(pv_ctx))
+        {
+            return true;
+        }
+        else if (host_now_ms_locked() >= ms_deadline)
+        {
+            return false;
+        }
+
+        ps_task->b_blocked   = true;
+        ps_task->ms_deadline = ms_deadline;
+        u_blocked++;
+
+        clock_skip_locked();
+
+        if (ps_task->b_blocked)
+        {
+            if ((HOST_CLOCK_REALTIME == e_clock_mode) && (K_HOST_NO_DEADLINE != ms_deadline))
+            {
+                struct timespec abs = s_start;
+                abs.tv_sec  += ms_deadline / 1000;
+                abs.tv_nsec += (ms_deadline % 1000) * 1000000;
+                if (abs.tv_nsec >= 1000000000)
+                {
+                    abs.tv_sec++;
+                    abs.tv_nsec -= 1000000000;
+                }
+                (void)pthread_cond_timedwait(&s_cond, &s_lock, &abs);
+            }
+            else
+            {
+                (void)pthread_cond_wait(&s_cond, &s_lock);
+            }
+
+            if (ps_task->b_blocked)
+            {
+                ps_task->b_blocked = false;
+                u_blocked--;
+            }
+        }
+    }
+}
+
+void host_notify_locked(void)
+{
+    unblock_all_locked();
+}
+
+
+/*
+ * Host Control
+ */
+void hostShimInit(host_clock_mode_et e_mode)
+{
+    pthread_condattr_t attr;
+
+    host_lock();
+    if (!b_initialized)
+    {
+        pthread_condattr_init(&attr);
+        pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+        pthread_cond_init(&s_cond, &attr);
+        pthread_condattr_destroy(&attr);
+        clock_gettime(CLOCK_MONOTONIC, &s_start);
+        t_epoch = __real_time(NULL);
+        b_initialized = true;
+    }
+    e_clock_mode = e_mode;
+    ms_virtual   = 0;
+
+    struct tskTaskControlBlock *ps_main = self_locked();
+    strncpy(ps_main->ac_name, "main", sizeof(ps_main->ac_name) - 1);
+    host_unlock();
+}
+
+host_clock_mode_et hostClockMode(void)
+{
+    return e_clock_mode;
+}
+
+void hostClockAdvance(uint32_t ui32_ms)
+{
+    host_lock();
+    if (HOST_CLOCK_REALTIME != e_clock_mode)
+    {
+        ms_virtual += ui32_ms;
+        unblock_all_locked();
+    }
+    host_unlock();
+}
+
+
+/*
+ * Tasks
+ */
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t pxTaskCode, const char *pcName, const uint32_t usStackDepth,
+                                   void *pvParameters, UBaseType_t uxPriority, TaskHandle_t *pxCreatedTask,
+                                   const BaseType_t xCoreID)
+{
+    struct tskTaskControlBlock *ps_task = calloc(1, sizeof(*ps_task));
+    pthread_attr_t attr;
+    BaseType_t result = pdFAIL;
+
+    (void)uxPriority;
+    (void)xCoreID;
+
+    if (NULL != ps_task)
+    {
+        strncpy(ps_task->ac_name, (NULL != pcName) ? pcName : "", sizeof(ps_task->ac_name) - 1);
+        ps_task->fp_code  = pxTaskCode;
+        ps_task->pv_param = pvParameters;
+
+        // register before start, so the fast clock never sees a half created task as idle
+        host_lock();
+        task_register_locked(ps_task);
+
+        pthread_attr_init(&attr);
+        pthread_attr_setstacksize(&attr, (usStackDepth < 16*1024) ? 64*1024 : 4 * usStackDepth);
+        if (0 == pthread_create(&ps_task->thread, &attr, task_entry, ps_task))
+        {
+            pthread_detach(ps_task->thread);
+            if (NULL != pxCreatedTask)
+            {
+                *pxCreatedTask = ps_task;
+            }
+            result = pdPASS;
+        }
+        else
+        {
+            task_unregister_locked(ps_task);
+            free(ps_task);
+        }
+        pthread_attr_destroy(&attr);
+        host_unlock();
+    }
+
+    return result;
+}
+
+void vTaskDelete(TaskHandle_t xTaskToDelete)
+{
+    host_lock();
+    if ((NULL == xTaskToDelete) || (ps_self == xTaskToDelete))
+    {
+        task_exit_locked(self_locked());
+    }
+    else
+    {
+        // cooperative: the task leaves at its next kernel call
+        xTaskToDelete->b_deleted = true;
+        unblock_all_locked();
+    }
+    host_unlock();
+}
+
+void vTaskDelay(const TickType_t xTicksToDelay)
+{
+    if (0 == xTicksToDelay)
+    {
+        sched_yield();
+    }
+    else
+    {
+        host_lock();
+        (void)host_block_until_locked(NULL, NULL, xTicksToDelay);
+        host_unlock();
+    }
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)(host_now_ms() / portTICK_PERIOD_MS);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    host_lock();
+    TaskHandle_t handle = self_locked();
+    host_unlock();
+    return handle;
+}
+
+char *pcTaskGetName(TaskHandle_t xTaskToQuery)
+{
+    return (NULL != xTaskToQuery) ? xTaskToQuery->ac_name : xTaskGetCurrentTaskHandle()->ac_name;
+}
+
+BaseType_t xPortGetCoreID(void)
+{
+    return 0;
+}
+
+
+/*
+ * Queues & Semaphores
+ */
+static bool queue_has_space(void *pv_queue)
+{
+    QueueHandle_t q = (QueueHandle_t)pv_queue;
+    return q->ux_count < q->ux_length;
+}
+
+static bool queue_has_items(void *pv_queue)
+{
+    QueueHandle_t q = (QueueHandle_t)pv_queue;
+    return q->ux_count > 0;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t uxQueueLength, UBaseType_t uxItemSize)
+{
+    QueueHandle_t q = NULL;
+
+    if ((uxQueueLength > 0) && (NULL != (q = calloc(1, sizeof(*q)))))
+    {
+        q->ux_length    = uxQueueLength;
+        q->ux_item_size = uxItemSize;
+        if ((uxItemSize > 0) && (NULL == (q->pui8_storage = malloc((size_t)uxQueueLength * uxItemSize))))
+        {
+            free(q);
+            q = NULL;
+        }
+    }
+
+    return q;
+}
+
+void vQueueDelete(QueueHandle_t xQueue)
+{
+    if (NULL != xQueue)
+    {
+        free(xQueue->pui8_storage);
+        free(xQueue);
+    }
+}
+
+BaseType_t xQueueSend(QueueHandle_t xQueue, const void *pvItemToQueue, TickType_t xTicksToWait)
+{
+    BaseType_t result = errQUEUE_FULL;
+
+    host_lock();
+    if (host_block_until_locked(queue_has_space, xQueue, xTicksToWait))
+    {
+        if (xQueue->ux_item_size > 0)
+        {
+            UBaseType_t ux_tail = (xQueue->ux_head + xQueue->ux_count) % xQueue->ux_length;
+            memcpy(&xQueue->pui8_storage[ux_tail * xQueue->ux_item_size], pvItemToQueue, xQueue->ux_item_size);
+        }
+        xQueue->ux_count++;
+        host_notify_locked();
+        result = pdPASS;
+    }
+    host_unlock();
+
+    return result;
+}
+
+static BaseType_t queue_fetch(QueueHandle_t xQueue, void *pvBuffer, TickType_t xTicksToWait, bool b_remove)
+{
+    BaseType_t result = errQUEUE_EMPTY;
+
+    host_lock();
+    if (host_block_until_locked(queue_has_items, xQueue, xTicksToWait))
+    {
+        if ((xQueue->ux_item_size > 0) && (NULL != pvBuffer))
+        {
+            memcpy(pvBuffer, &xQueue->pui8_storage[xQueue->ux_head * xQueue->ux_item_size], xQueue->ux_item_size);
+        }
+        if (b_remove)
+        {
+            xQueue->ux_head = (xQueue->ux_head + 1) % xQueue->ux_length;
+            xQueue->ux_count--;
+            host_notify_locked();
+        }
+        result = pdPASS;
+    }
+    host_unlock();
+
+    return result;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t xQueue, void *pvBuffer, TickType_t xTicksToWait)
+{
+    return queue_fetch(xQueue, pvBuffer, xTicksToWait, true);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t xQueue, void *pvBuffer, TickType_t xTicksToWait)
+{
+    return queue_fetch(xQueue, pvBuffer, xTicksToWait, false);
+}
+
+BaseType_t xQueueReset(QueueHandle_t xQueue)
+{
+    host_lock();
+    xQueue->ux_head  = 0;
+    xQueue->ux_count = 0;
+    host_notify_locked();
+    host_unlock();
+    return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t xQueue)
+{
+    host_lock();
+    UBaseType_t ux_count = xQueue->ux_count;
+    host_unlock();
+    return ux_count;
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t xQueue)
+{
+    host_lock();
+    UBaseType_t ux_spaces = xQueue->ux_length - xQueue->ux_count;
+    host_unlock();
+    return ux_spaces;
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t uxMaxCount, UBaseType_t uxInitialCount)
+{
+    SemaphoreHandle_t s = xQueueCreate(uxMaxCount, 0);
+
+    if (NULL != s)
+    {
+        s->ux_count = (uxInitialCount < uxMaxCount) ? uxInitialCount : uxMaxCount;
+    }
+
+    return s;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xBlockTime)
+{
+    return xQueueReceive(xSemaphore, NULL, xBlockTime);
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore)
+{
+    return xQueueSend(xSemaphore, NULL, 0);
+}
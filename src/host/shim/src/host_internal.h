@@ -0,0 +1,38 @@
+/*
+ * host_internal.h
+ *
+ * Scheduler primitives shared by the shim modules. Every "_locked" function expects the
+ * global shim lock to be held by the caller.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* wake-up condition, evaluated with the shim lock held */
+typedef bool (*host_pred_pt)(void *pv_ctx);
+
+void host_lock(void);
+void host_unlock(void);
+
+/* current time in milliseconds, following the selected clock mode */
+uint64_t host_now_ms_locked(void);
+uint64_t host_now_ms(void);
+
+/* block the calling task until "fp_pred" is true (NULL = never) or "ticks" elapsed;
+ * returns the last predicate result */
+bool host_block_until_locked(host_pred_pt fp_pred, void *pv_ctx, TickType_t ticks);
+
+/* state changed: re-evaluate the predicates of all blocked tasks */
+void host_notify_locked(void);
+
+#ifdef __cplusplus
+}
+#endif
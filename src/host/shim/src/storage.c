@@ -0,0 +1,132 @@
+/*
+ * storage.c
+ *
+ * FAT volume of the host build, "fwrite()" is wrapped at link time:
+ *  - power cut: once a thread arms a cut its file writes go through until the byte budget is
+ *    used up, the write it runs out in stores the bytes left and fails, and so does every
+ *    write after it
+ *  - sector model of the wear levelling layer (one erase per 4 KiB sector written): the data
+ *    sectors a write touches, the directory entry updated on close and a FAT sector when the
+ *    file grows into new clusters
+ * Only the thread that armed the cut / reset the statistics counts, the standard streams never.
+ */
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <sys/stat.h>
+
+#include "sdkconfig.h"
+#include "host_shim.h"
+
+
+/*
+ * Local Variables
+ */
+static bool                 b_armed;
+static pthread_t            s_thread;
+static uint64_t             ui64_budget;
+static bool                 b_cut;
+
+static bool                 b_counting;
+static pthread_t            s_count_thread;
+static host_storage_stats_st s_stats;
+
+
+/*
+ * Private Functions
+ */
+size_t __real_fwrite(const void *pv_ptr, size_t sz_size, size_t sz_n, FILE *ps_file);
+
+static void countWrite(FILE *ps_file, size_t sz_len)
+{
+    struct stat s_stat;
+    long        l_pos = ftell(ps_file);
+    uint64_t    ui64_end;
+
+    if ((l_pos < 0) || (0 != fstat(fileno(ps_file), &s_stat)))
+    {
+        return;
+    }
+
+    ui64_end = (uint64_t)l_pos + sz_len;
+    s_stats.ui32_writes++;
+    s_stats.ui64_bytes   += sz_len;
+    s_stats.ui64_sectors += ((ui64_end + CONFIG_WL_SECTOR_SIZE - 1) / CONFIG_WL_SECTOR_SIZE) - ((uint64_t)l_pos / CONFIG_WL_SECTOR_SIZE);
+    s_stats.ui64_sectors += 1;
+    if (((ui64_end + CONFIG_WL_SECTOR_SIZE - 1) / CONFIG_WL_SECTOR_SIZE) >
+        (((uint64_t)s_stat.st_size + CONFIG_WL_SECTOR_SIZE - 1) / CONFIG_WL_SECTOR_SIZE))
+    {
+        s_stats.ui64_sectors += 1;
+    }
+}
+
+
+/*
+ * Public Functions
+ */
+void hostStorageCut(uint64_t ui64_bytes)
+{
+    s_thread    = pthread_self();
+    ui64_budget = ui64_bytes;
+    b_cut       = false;
+    b_armed     = true;
+}
+
+void hostStorageRestore(void)
+{
+    b_armed = false;
+    b_cut   = false;
+}
+
+bool hostStorageIsCut(void)
+{
+    return b_cut;
+}
+
+void hostStorageResetStats(void)
+{
+    s_count_thread = pthread_self();
+    s_stats        = (host_storage_stats_st){ 0 };
+    b_counting     = true;
+}
+
+void hostStorageGetStats(host_storage_stats_st *ps_stats)
+{
+    *ps_stats = s_stats;
+}
+
+size_t __wrap_fwrite(const void *pv_ptr, size_t sz_size, size_t sz_n, FILE *ps_file)
+{
+    size_t sz_len = sz_size * sz_n;
+
+    if (fileno(ps_file) <= 2)
+    {
+        return __real_fwrite(pv_ptr, sz_size, sz_n, ps_file);
+    }
+
+    if ((true == b_counting) && (0 != pthread_equal(s_count_thread, pthread_self())))
+    {
+        countWrite(ps_file, sz_len);
+    }
+
+    if ((false == b_armed) || (0 == pthread_equal(s_thread, pthread_self())))
+    {
+        return __real_fwrite(pv_ptr, sz_size, sz_n, ps_file);
+    }
+    else if ((false == b_cut) && (sz_len <= ui64_budget))
+    {
+        ui64_budget -= sz_len;
+        return __real_fwrite(pv_ptr, sz_size, sz_n, ps_file);
+    }
+
+    // the power goes in the middle of this one
+    if ((false == b_cut) && (0 != ui64_budget))
+    {
+        (void)__real_fwrite(pv_ptr, 1, (size_t)ui64_budget, ps_file);
+    }
+    ui64_budget = 0;
+    b_cut       = true;
+
+    return 0;
+}
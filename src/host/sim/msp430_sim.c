@@ -0,0 +1,590 @@
+/*
+ * msp430_sim.c
+ *
+ * Byte level model of the MSP430 SPI slave protocol (see "EnMtrMSP430::send_cmd()"):
+ *
+ *  read  : cmd[2], dummy, data[2*n] (big endian), crc[2] (lsb first), ack A5 5A
+ *  write : cmd[2], data[2*n], crc[2], dummy, ack A5 5A
+ *
+ * The measurement registers (0x20..0x4F) are refreshed periodically from synthetic waveforms.
+ * VHARM/IHARM report the harmonic order written to REG_HARM (0x0C), with no settling delay.
+ *
+ * Bootloader (CMD_ENTR_BOOTLDR written to the command register, or no valid application after
+ * reset): 0x18/0x19 read the boot signature, 0x01 bit 0 is busy while erasing / programming,
+ * 0x04 is the flash address and 0x05..0x14 the 16 data words, little endian in flash. Reading
+ * the data words returns the flash at the address. Writes while busy are not acknowledged.
+ * Busy times run on the simulated bus time (bytes at the SPI clock plus the chip select
+ * delays) on top of the tick counter, so back-to-back polling sees the device finish.
+ */
+
+#include <pthread.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/gpio.h"
+
+#include "host_shim.h"
+#include "crc/crc16.h"
+#include "enmtr/enmtr_cfg.h"
+#include "enmtr_msp430_cfg.h"
+
+#include "msp430_sim.h"
+
+
+/*
+ * Local Constants
+ */
+#define K_SIM_MAX_NREG              16
+#define K_SIM_ACK_0                 0xA5
+#define K_SIM_ACK_1                 0x5A
+#define K_SIM_IDLE_BYTE             0xFF
+
+#define K_SIM_RESET_PIN             GPIO_NUM_14
+
+#define K_SIM_REG_HARM              0x0C
+
+#define K_SIM_CMD_ENTR_BOOTLDR      0x41AB
+#define K_SIM_CMD_WRITE_FLASH       0x421A
+#define K_SIM_CMD_ERASE_APPCODE     0x42FB
+#define K_SIM_BTL_STATUS            0x01
+#define K_SIM_BTL_FLASH_ADDR        0x04
+#define K_SIM_BTL_FLASH_DATA        0x05
+#define K_SIM_BTL_NREGS             0x20
+#define K_SIM_BTL_BUSY              0x0001
+#define K_SIM_BTL_ERROR             0x0002
+#define K_SIM_FLASH_BLOCK           32
+#define K_SIM_ERASE_NS              (30ULL * 1000000)   // app code (mass) erase
+#define K_SIM_PROGRAM_NS            (16ULL * 75000)     // 16 words
+
+typedef enum
+{
+    SIM_STATE_CMD_0,
+    SIM_STATE_CMD_1,
+    SIM_STATE_RD_DUMMY,
+    SIM_STATE_RD_DATA,
+    SIM_STATE_RD_CRC,
+    SIM_STATE_RD_ACK,
+    SIM_STATE_WR_DATA,
+    SIM_STATE_WR_CRC,
+    SIM_STATE_WR_DUMMY,
+    SIM_STATE_WR_ACK,
+    SIM_STATE_DONE
+} sim_state_et;
+
+
+/*
+ * Local Definitions
+ */
+typedef struct
+{
+    int             i_cs_pin;
+    bool            b_selected;
+    sim_state_et    e_state;
+    uint8_t         aui8_cmd[2];
+    uint8_t         ui8_addr;
+    uint8_t         ui8_nreg;
+    uint8_t         aui8_data[2 * K_SIM_MAX_NREG];
+    uint8_t         aui8_crc[2];
+    uint8_t         aui8_ack[2];
+    uint8_t         ui8_idx;
+    uint16_t        aui16_reg[K_MSP430_SIM_NUM_REGS];
+
+    bool            b_bootloader;
+    uint64_t        ns_busy_until;
+    uint16_t        aui16_btl[K_SIM_BTL_NREGS];
+    uint8_t         aui8_flash[K_MSP430_SIM_FLASH_SIZE];
+} sim_device_st;
+
+
+/*
+ * Local Variables
+ */
+static pthread_mutex_t      s_lock = PTHREAD_MUTEX_INITIALIZER;
+static sim_device_st        as_dev[K_MSP430_SIM_NUM_DEVICES];
+static bool                 b_in_reset      = true;
+static uint32_t             ms_update_period;
+static uint32_t             ui32_update_ctr = 0;
+static TickType_t           ms_last_update;
+static uint32_t             ui32_crc_err_nth = 0;
+static uint32_t             ui32_crc_err_ctr = 0;
+static msp430_sim_stats_st  s_stats;
+static uint64_t             ns_bus;         // simulated bus time
+
+
+/*
+ * Private Functions
+ */
+static void put32(uint16_t *pui16_reg, uint32_t ui32_val)
+{
+    pui16_reg[0] = (uint16_t)(ui32_val >> 16);
+    pui16_reg[1] = (uint16_t)(ui32_val >> 0);
+}
+
+static void put48(uint16_t *pui16_reg, uint64_t ui64_val)
+{
+    pui16_reg[0] = (uint16_t)(ui64_val >> 32);
+    pui16_reg[1] = (uint16_t)(ui64_val >> 16);
+    pui16_reg[2] = (uint16_t)(ui64_val >> 0);
+}
+
+// synthetic spectrum: amplitude ~ 1/order, voltage ~3 % & current ~30 % at the 3rd
+static void update_harmonics(int d)
+{
+    uint16_t *r = as_dev[d].aui16_reg;
+    uint32_t wobble = (ui32_update_ctr + 7 * d) % 64;
+    uint32_t order = ((r[K_SIM_REG_HARM] >= 3) && (r[K_SIM_REG_HARM] <= 63)) ? r[K_SIM_REG_HARM] : 3;
+
+    for (int ch = 0; ch < 2; ch++)
+    {
+        uint32_t v_fund = ((uint32_t)r[0x40 + 4*ch] << 16) | r[0x41 + 4*ch];
+        uint32_t i_fund = ((uint32_t)r[0x48 + 4*ch] << 16) | r[0x49 + 4*ch];
+        uint32_t v_pm   = (90 + d * 6 + (wobble % 8)) / order;         // 0.1 %
+        uint32_t i_pm   = (900 + d * 60 + 4 * wobble) / order;
+
+        put32(&r[0x42 + 4*ch], v_fund / 1000 * v_pm);
+        put32(&r[0x4A + 4*ch], i_fund / 1000 * i_pm);
+    }
+}
+
+// deterministic, slowly varying values, distinct per phase & channel
+static void update_measurements(void)
+{
+    ui32_update_ctr++;
+
+    for (int d = 0; d < K_MSP430_SIM_NUM_DEVICES; d++)
+    {
+        uint16_t *r = as_dev[d].aui16_reg;
+        uint32_t wobble = (ui32_update_ctr + 7 * d) % 64;
+
+        r[0x20] = (uint16_t)(4995 + (wobble % 11));                     // line freq, 0.01 Hz
+        for (int ch = 0; ch < 2; ch++)
+        {
+            uint32_t v_mv   = 230000 + 500 * d + 100 * ch + 10 * wobble;  // mV
+            uint32_t i_ma   = 5000 + 1000 * d + 250 * ch + 5 * wobble;    // mA
+            uint32_t pf     = 9500 - 10 * wobble;                         // 0.0001
+            uint64_t va     = (uint64_t)v_mv * i_ma / 1000;               // mVA
+            uint64_t watt   = va * pf / 10000;
+
+            put32(&r[0x21 + 2*ch], v_mv);
+            put32(&r[0x25 + 2*ch], i_ma);
+            put32(&r[0x29 + 2*ch], pf);
+            put48(&r[0x2D + 3*ch], watt);
+            put48(&r[0x33 + 3*ch], va - watt);  // not physical, just distinct
+            put48(&r[0x39 + 3*ch], va);
+            put32(&r[0x40 + 4*ch], v_mv - 200);  // fundamental
+            put32(&r[0x48 + 4*ch], i_ma - 100);
+        }
+        update_harmonics(d);
+    }
+}
+
+static void refresh_locked(void)
+{
+    TickType_t ms_now = xTaskGetTickCount();
+
+    if ((ms_update_period > 0) && ((ms_now - ms_last_update) >= ms_update_period))
+    {
+        ms_last_update = ms_now;
+        update_measurements();
+    }
+}
+
+static uint64_t now_ns(void)
+{
+    return ((uint64_t)xTaskGetTickCount() * 1000000ULL) + ns_bus;
+}
+
+static bool app_valid(const sim_device_st *ps_dev)
+{
+    return (0xFF != ps_dev->aui8_flash[K_MSP430_SIM_APP_START]) || (0xFF != ps_dev->aui8_flash[K_MSP430_SIM_APP_START + 1]);
+}
+
+static uint16_t btl_read(const sim_device_st *ps_dev, uint8_t ui8_addr)
+{
+    uint16_t ui16_flash = ps_dev->aui16_btl[K_SIM_BTL_FLASH_ADDR];
+
+    if (K_SIM_BTL_STATUS == ui8_addr)
+    {
+        return (uint16_t)((ps_dev->aui16_btl[K_SIM_BTL_STATUS] & K_SIM_BTL_ERROR) | ((now_ns() < ps_dev->ns_busy_until) ? K_SIM_BTL_BUSY : 0));
+    }
+    else if ((ui8_addr >= K_SIM_BTL_FLASH_DATA) && (ui8_addr < (K_SIM_BTL_FLASH_DATA + 16)))
+    {
+        uint32_t ui32_at = (uint32_t)ui16_flash + 2 * (ui8_addr - K_SIM_BTL_FLASH_DATA);
+        return (ui32_at + 1 < K_MSP430_SIM_FLASH_SIZE) ?
+               (uint16_t)(ps_dev->aui8_flash[ui32_at] | ((uint16_t)ps_dev->aui8_flash[ui32_at + 1] << 8)) : 0xFFFF;
+    }
+
+    switch (ui8_addr)
+    {
+    case 0x18: return 0x4F42;   // boot signature
+    case 0x19: return 0x544F;
+    case 0x1A: return ps_dev->aui16_reg[0x1A];
+    case 0x1B: return ps_dev->aui16_reg[0x1B];
+    default:   return (ui8_addr < K_SIM_BTL_NREGS) ? ps_dev->aui16_btl[ui8_addr] : 0;
+    }
+}
+
+static void btl_command(sim_device_st *ps_dev, uint16_t ui16_cmd)
+{
+    uint32_t ui32_at = ps_dev->aui16_btl[K_SIM_BTL_FLASH_ADDR];
+
+    switch (ui16_cmd)
+    {
+    case K_SIM_CMD_ERASE_APPCODE:
+        memset(&ps_dev->aui8_flash[K_MSP430_SIM_APP_START], 0xFF, K_MSP430_SIM_FLASH_SIZE - K_MSP430_SIM_APP_START);
+        ps_dev->aui16_btl[K_SIM_BTL_STATUS] = 0;
+        ps_dev->ns_busy_until = now_ns() + K_SIM_ERASE_NS;
+        break;
+
+    case K_SIM_CMD_WRITE_FLASH:
+        if ((ui32_at < K_MSP430_SIM_APP_START) || ((ui32_at + K_SIM_FLASH_BLOCK) > K_MSP430_SIM_FLASH_SIZE))
+        {
+            ps_dev->aui16_btl[K_SIM_BTL_STATUS] |= K_SIM_BTL_ERROR;
+            break;
+        }
+        for (uint8_t i = 0; i < K_SIM_FLASH_BLOCK; i++)
+        {
+            // nor flash: programming only clears bits
+            ps_dev->aui8_flash[ui32_at + i] &= (uint8_t)(ps_dev->aui16_btl[K_SIM_BTL_FLASH_DATA + i / 2] >> ((i & 1) * 8));
+        }
+        ps_dev->ns_busy_until = now_ns() + K_SIM_PROGRAM_NS;
+        s_stats.ui32_flash_blocks++;
+        break;
+
+    default:
+        break;
+    }
+}
+
+static void begin_read(sim_device_st *ps_dev)
+{
+    uint16_t ui16_crc;
+
+    for (uint8_t i = 0; i < ps_dev->ui8_nreg; i++)
+    {
+        uint8_t  ui8_addr = (uint8_t)((ps_dev->ui8_addr + i) % K_MSP430_SIM_NUM_REGS);
+        uint16_t ui16_val = ps_dev->b_bootloader ? btl_read(ps_dev, ui8_addr) : ps_dev->aui16_reg[ui8_addr];
+        ps_dev->aui8_data[2*i + 0] = (uint8_t)(ui16_val >> 8);
+        ps_dev->aui8_data[2*i + 1] = (uint8_t)(ui16_val >> 0);
+    }
+
+    ui16_crc = crc16CalcBlock(ps_dev->aui8_data, (uint16_t)(2 * ps_dev->ui8_nreg));
+    if ((0 != ui32_crc_err_nth) && (0 == (++ui32_crc_err_ctr % ui32_crc_err_nth)))
+    {
+        ui16_crc ^= 0x0001;
+    }
+    ps_dev->aui8_crc[0] = (uint8_t)(ui16_crc >> 0);
+    ps_dev->aui8_crc[1] = (uint8_t)(ui16_crc >> 8);
+    s_stats.ui32_reads++;
+}
+
+static void end_write(sim_device_st *ps_dev)
+{
+    uint16_t ui16_crc_calc = crc16CalcBlock(ps_dev->aui8_data, (uint16_t)(2 * ps_dev->ui8_nreg));
+    uint16_t ui16_crc_recv = (uint16_t)(((uint16_t)ps_dev->aui8_crc[1] << 8) | ps_dev->aui8_crc[0]);
+
+    if (ui16_crc_calc != ui16_crc_recv)
+    {
+        ps_dev->aui8_ack[0] = 0;
+        ps_dev->aui8_ack[1] = 0;
+        s_stats.ui32_crc_errors++;
+        return;
+    }
+
+    if (ps_dev->b_bootloader)
+    {
+        if (now_ns() < ps_dev->ns_busy_until)
+        {
+            ps_dev->aui8_ack[0] = 0;
+            ps_dev->aui8_ack[1] = 0;
+            s_stats.ui32_busy_naks++;
+            return;
+        }
+        for (uint8_t i = 0; i < ps_dev->ui8_nreg; i++)
+        {
+            uint8_t ui8_addr = (uint8_t)(ps_dev->ui8_addr + i);
+            if (ui8_addr < K_SIM_BTL_NREGS)
+            {
+                ps_dev->aui16_btl[ui8_addr] = (uint16_t)(((uint16_t)ps_dev->aui8_data[2*i] << 8) | ps_dev->aui8_data[2*i + 1]);
+            }
+        }
+        if (0 == ps_dev->ui8_addr)
+        {
+            btl_command(ps_dev, ps_dev->aui16_btl[0]);
+        }
+        ps_dev->aui8_ack[0] = K_SIM_ACK_0;
+        ps_dev->aui8_ack[1] = K_SIM_ACK_1;
+        s_stats.ui32_writes++;
+        return;
+    }
+
+    for (uint8_t i = 0; i < ps_dev->ui8_nreg; i++)
+    {
+        ps_dev->aui16_reg[(ps_dev->ui8_addr + i) % K_MSP430_SIM_NUM_REGS] =
+            (uint16_t)(((uint16_t)ps_dev->aui8_data[2*i] << 8) | ps_dev->aui8_data[2*i + 1]);
+    }
+    if ((0 == ps_dev->ui8_addr) && (K_SIM_CMD_ENTR_BOOTLDR == ps_dev->aui16_reg[0]))
+    {
+        memset(ps_dev->aui16_btl, 0, sizeof(ps_dev->aui16_btl));
+        ps_dev->b_bootloader = true;
+    }
+    if ((ps_dev->ui8_addr <= K_SIM_REG_HARM) && ((ps_dev->ui8_addr + ps_dev->ui8_nreg) > K_SIM_REG_HARM))
+    {
+        update_harmonics((int)(ps_dev - as_dev));
+    }
+    ps_dev->aui8_ack[0] = K_SIM_ACK_0;
+    ps_dev->aui8_ack[1] = K_SIM_ACK_1;
+    s_stats.ui32_writes++;
+}
+
+// one full-duplex byte: "ui8_mosi" in, returns miso
+static uint8_t clock_byte(sim_device_st *ps_dev, uint8_t ui8_mosi)
+{
+    uint8_t ui8_miso = K_SIM_IDLE_BYTE;
+
+    switch (ps_dev->e_state)
+    {
+    case SIM_STATE_CMD_0:
+        ps_dev->aui8_cmd[0] = ui8_mosi;
+        ps_dev->e_state = SIM_STATE_CMD_1;
+        break;
+
+    case SIM_STATE_CMD_1:
+        ps_dev->aui8_cmd[1] = ui8_mosi;
+        ps_dev->ui8_nreg = (uint8_t)(((ps_dev->aui8_cmd[0] >> 4) & 0x0F) + 1);
+        ps_dev->ui8_addr = (uint8_t)(((ps_dev->aui8_cmd[0] & 0x0C) << 4) | (ps_dev->aui8_cmd[1] >> 2));
+        ps_dev->ui8_idx  = 0;
+        s_stats.ui32_frames++;
+        if (ps_dev->aui8_cmd[1] & 0x02)
+        {
+            ps_dev->e_state = SIM_STATE_WR_DATA;
+        }
+        else
+        {
+            refresh_locked();
+            begin_read(ps_dev);
+            ps_dev->e_state = SIM_STATE_RD_DUMMY;
+        }
+        break;
+
+    case SIM_STATE_RD_DUMMY:
+        ps_dev->e_state = SIM_STATE_RD_DATA;
+        break;
+
+    case SIM_STATE_RD_DATA:
+        ui8_miso = ps_dev->aui8_data[ps_dev->ui8_idx++];
+        if (ps_dev->ui8_idx >= 2 * ps_dev->ui8_nreg)
+        {
+            ps_dev->ui8_idx = 0;
+            ps_dev->e_state = SIM_STATE_RD_CRC;
+        }
+        break;
+
+    case SIM_STATE_RD_CRC:
+        ui8_miso = ps_dev->aui8_crc[ps_dev->ui8_idx++];
+        if (ps_dev->ui8_idx >= 2)
+        {
+            ps_dev->ui8_idx = 0;
+            ps_dev->e_state = SIM_STATE_RD_ACK;
+        }
+        break;
+
+    case SIM_STATE_RD_ACK:
+        ui8_miso = (0 == ps_dev->ui8_idx++) ? K_SIM_ACK_0 : K_SIM_ACK_1;
+        if (ps_dev->ui8_idx >= 2)
+        {
+            ps_dev->e_state = SIM_STATE_DONE;
+        }
+        break;
+
+    case SIM_STATE_WR_DATA:
+        ps_dev->aui8_data[ps_dev->ui8_idx++] = ui8_mosi;
+        if (ps_dev->ui8_idx >= 2 * ps_dev->ui8_nreg)
+        {
+            ps_dev->ui8_idx = 0;
+            ps_dev->e_state = SIM_STATE_WR_CRC;
+        }
+        break;
+
+    case SIM_STATE_WR_CRC:
+        ps_dev->aui8_crc[ps_dev->ui8_idx++] = ui8_mosi;
+        if (ps_dev->ui8_idx >= 2)
+        {
+            ps_dev->ui8_idx = 0;
+            ps_dev->e_state = SIM_STATE_WR_DUMMY;
+        }
+        break;
+
+    case SIM_STATE_WR_DUMMY:
+        end_write(ps_dev);
+        ps_dev->e_state = SIM_STATE_WR_ACK;
+        break;
+
+    case SIM_STATE_WR_ACK:
+        ui8_miso = ps_dev->aui8_ack[ps_dev->ui8_idx++];
+        if (ps_dev->ui8_idx >= 2)
+        {
+            ps_dev->e_state = SIM_STATE_DONE;
+        }
+        break;
+
+    case SIM_STATE_DONE:
+    default:
+        break;
+    }
+
+    return ui8_miso;
+}
+
+static bool spi_cb(void *pv_ctx, const spi_device_interface_config_t *ps_devcfg, spi_transaction_t *ps_trans)
+{
+    const uint8_t *pui8_tx = (ps_trans->flags & SPI_TRANS_USE_TXDATA) ? ps_trans->tx_data : (const uint8_t *)ps_trans->tx_buffer;
+    uint8_t *pui8_rx = (ps_trans->flags & SPI_TRANS_USE_RXDATA) ? ps_trans->rx_data : (uint8_t *)ps_trans->rx_buffer;
+    size_t sz_len = (ps_trans->length + 7) / 8;
+    sim_device_st *ps_dev = NULL;
+
+    (void)pv_ctx;
+
+    pthread_mutex_lock(&s_lock);
+    if (ps_devcfg->clock_speed_hz > 0)
+    {
+        ns_bus += ((uint64_t)sz_len * 8 * 1000000000ULL) / (uint64_t)ps_devcfg->clock_speed_hz;
+    }
+    for (int d = 0; d < K_MSP430_SIM_NUM_DEVICES; d++)
+    {
+        if (as_dev[d].b_selected)
+        {
+            ps_dev = (NULL == ps_dev) ? &as_dev[d] : NULL; // bus contention reads as idle
+            if (NULL == ps_dev)
+            {
+                break;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < sz_len; i++)
+    {
+        uint8_t ui8_mosi = (NULL != pui8_tx) ? pui8_tx[i] : 0x00;
+        uint8_t ui8_miso = ((NULL != ps_dev) && !b_in_reset) ? clock_byte(ps_dev, ui8_mosi) : K_SIM_IDLE_BYTE;
+        if (NULL != pui8_rx)
+        {
+            pui8_rx[i] = ui8_miso;
+        }
+    }
+    pthread_mutex_unlock(&s_lock);
+
+    return true;
+}
+
+static void gpio_cb(void *pv_ctx, int i_num, uint32_t ui32_level)
+{
+    (void)pv_ctx;
+
+    pthread_mutex_lock(&s_lock);
+    if (K_SIM_RESET_PIN == i_num)
+    {
+        b_in_reset = (0 == ui32_level);
+        for (int d = 0; (false == b_in_reset) && (d < K_MSP430_SIM_NUM_DEVICES); d++)
+        {
+            as_dev[d].b_bootloader = !app_valid(&as_dev[d]);
+        }
+    }
+    for (int d = 0; d < K_MSP430_SIM_NUM_DEVICES; d++)
+    {
+        if (as_dev[d].i_cs_pin == i_num)
+        {
+            // falling edge starts a new command frame
+            bool b_select = (0 == ui32_level);
+            if (b_select && !as_dev[d].b_selected)
+            {
+                as_dev[d].e_state = SIM_STATE_CMD_0;
+                ns_bus += (K_ENMTR_SPI_CS_CLK_DELAY_US + K_ENMTR_SPI_CS_DELAY_US) * 1000ULL;
+            }
+            as_dev[d].b_selected = b_select;
+        }
+    }
+    pthread_mutex_unlock(&s_lock);
+}
+
+
+/*
+ * Public Functions
+ */
+void msp430SimInit(uint32_t ms_update)
+{
+    static const int ai_cs_pins[K_MSP430_SIM_NUM_DEVICES] = { ENMTR_SPI_SSA_PIN, ENMTR_SPI_SSB_PIN, ENMTR_SPI_SSC_PIN };
+
+    pthread_mutex_lock(&s_lock);
+    memset(as_dev, 0, sizeof(as_dev));
+    memset(&s_stats, 0, sizeof(s_stats));
+    for (int d = 0; d < K_MSP430_SIM_NUM_DEVICES; d++)
+    {
+        as_dev[d].i_cs_pin = ai_cs_pins[d];
+        as_dev[d].e_state  = SIM_STATE_DONE;
+        as_dev[d].aui16_reg[0x18] = 0x0102;     // fw v01.02
+        as_dev[d].aui16_reg[0x19] = 0x0003;     // test 3
+        as_dev[d].aui16_reg[0x1A] = 0x0100;     // bootloader v01.00
+        memset(as_dev[d].aui8_flash, 0xFF, sizeof(as_dev[d].aui8_flash));
+        for (uint32_t i = K_MSP430_SIM_APP_START; i < K_MSP430_SIM_FLASH_SIZE; i++)
+        {
+            as_dev[d].aui8_flash[i] = (uint8_t)(i * 7);  // factory application
+        }
+    }
+    ns_bus = 0;
+    ms_update_period = ms_update;
+    ms_last_update   = xTaskGetTickCount();
+    update_measurements();
+    pthread_mutex_unlock(&s_lock);
+
+    hostGpioAttach(gpio_cb, NULL);
+    hostSpiAttach(ENMTR_SPI_HOST, spi_cb, NULL);
+}
+
+void msp430SimInjectCrcErrors(uint32_t ui32_every_nth)
+{
+    pthread_mutex_lock(&s_lock);
+    ui32_crc_err_nth = ui32_every_nth;
+    ui32_crc_err_ctr = 0;
+    pthread_mutex_unlock(&s_lock);
+}
+
+uint16_t msp430SimGetReg(uint8_t ui8_device, uint8_t ui8_addr)
+{
+    pthread_mutex_lock(&s_lock);
+    uint16_t ui16_val = as_dev[ui8_device % K_MSP430_SIM_NUM_DEVICES].aui16_reg[ui8_addr % K_MSP430_SIM_NUM_REGS];
+    pthread_mutex_unlock(&s_lock);
+    return ui16_val;
+}
+
+void msp430SimSetReg(uint8_t ui8_device, uint8_t ui8_addr, uint16_t ui16_val)
+{
+    pthread_mutex_lock(&s_lock);
+    as_dev[ui8_device % K_MSP430_SIM_NUM_DEVICES].aui16_reg[ui8_addr % K_MSP430_SIM_NUM_REGS] = ui16_val;
+    pthread_mutex_unlock(&s_lock);
+}
+
+void msp430SimGetFlash(uint8_t ui8_device, uint32_t ui32_addr, uint8_t *pui8_buf, uint32_t ui32_len)
+{
+    pthread_mutex_lock(&s_lock);
+    for (uint32_t i = 0; i < ui32_len; i++)
+    {
+        pui8_buf[i] = as_dev[ui8_device % K_MSP430_SIM_NUM_DEVICES].aui8_flash[(ui32_addr + i) % K_MSP430_SIM_FLASH_SIZE];
+    }
+    pthread_mutex_unlock(&s_lock);
+}
+
+uint64_t msp430SimBusNs(void)
+{
+    pthread_mutex_lock(&s_lock);
+    uint64_t ui64_ns = ns_bus;
+    pthread_mutex_unlock(&s_lock);
+    return ui64_ns;
+}
+
+void msp430SimGetStats(msp430_sim_stats_st *ps_stats)
+{
+    pthread_mutex_lock(&s_lock);
+    *ps_stats = s_stats;
+    pthread_mutex_unlock(&s_lock);
+}
@@ -0,0 +1,59 @@
+/*
+ * msp430_sim.h
+ *
+ * Simulated MSP430 metering front-ends (phases A/B/C) on the energy meter SPI bus.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Global Constants
+ */
+#define K_MSP430_SIM_NUM_DEVICES        3
+#define K_MSP430_SIM_NUM_REGS           0x80
+#define K_MSP430_SIM_FLASH_SIZE         0x10000
+#define K_MSP430_SIM_APP_START          0x4400
+
+/*
+ * Global Definitions
+ */
+typedef struct
+{
+    uint32_t    ui32_frames;        // chip-select framed commands
+    uint32_t    ui32_reads;         // read commands
+    uint32_t    ui32_writes;        // write commands
+    uint32_t    ui32_crc_errors;    // rejected writes
+    uint32_t    ui32_busy_naks;     // bootloader writes refused while busy
+    uint32_t    ui32_flash_blocks;  // programmed flash blocks
+} msp430_sim_stats_st;
+
+/*
+ * Public Function Prototypes
+ */
+
+/* attach to the SPI & GPIO shims, "ms_update" = measurement refresh period */
+void msp430SimInit(uint32_t ms_update);
+
+/* corrupt the crc of every n-th read response, 0 = off */
+void msp430SimInjectCrcErrors(uint32_t ui32_every_nth);
+
+uint16_t msp430SimGetReg(uint8_t ui8_device, uint8_t ui8_addr);
+void msp430SimSetReg(uint8_t ui8_device, uint8_t ui8_addr, uint16_t ui16_val);
+void msp430SimGetStats(msp430_sim_stats_st *ps_stats);
+
+/* flash content of a device, "ui32_len" bytes from "ui32_addr" */
+void msp430SimGetFlash(uint8_t ui8_device, uint32_t ui32_addr, uint8_t *pui8_buf, uint32_t ui32_len);
+
+/* simulated bus time: bytes at the SPI clock plus the chip select delays */
+uint64_t msp430SimBusNs(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,233 @@
+/*
+ * host_test.cpp
+ *
+ * Common part of the host test executables, see host_test.h.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "host_shim.h"
+#include "data_log/data_log.h"
+#include "harmonics/harmonics.h"
+#include "test/host_test.h"
+
+
+static void usage(const char *pc_prog, const host_test_st *ps_tests, uint8_t ui8_tests)
+{
+    printf("usage: %s", pc_prog);
+    for (uint8_t t = 0; t < ui8_tests; t++)
+    {
+        printf(" [%s%s]", ps_tests[t].pc_opt, (NULL != ps_tests[t].pf_run) ? "N" : "FILE");
+    }
+    printf("\r\n       without options: all of them,");
+    for (uint8_t t = 0; t < ui8_tests; t++)
+    {
+        printf(" %s%s", ps_tests[t].pc_opt, ps_tests[t].pc_default);
+    }
+    printf("\r\n");
+}
+
+static uint32_t runTest(const host_test_st *ps_test, const char *pc_arg)
+{
+    uint32_t ui32_errors = (NULL != ps_test->pf_run) ? ps_test->pf_run((uint32_t)strtoul(pc_arg, NULL, 0)) :
+                                                       ps_test->pf_run_file(pc_arg);
+
+    if (0 != ui32_errors)
+    {
+        printf("--- %s%s: FAILED, %u errors ---\r\n", ps_test->pc_opt, pc_arg, (unsigned)ui32_errors);
+    }
+
+    return ui32_errors;
+}
+
+int hostTestMain(int argc, char *argv[], const host_test_st *ps_tests, uint8_t ui8_tests)
+{
+    uint32_t ui32_errors = 0;
+
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    hostShimInit(HOST_CLOCK_MANUAL);
+    mkdir(K_STORAGE_BASE_PATH, 0755);
+
+    // all options known before the first test runs
+    for (int i = 1; i < argc; i++)
+    {
+        uint8_t t = 0;
+
+        while ((t < ui8_tests) && (0 != strncmp(argv[i], ps_tests[t].pc_opt, strlen(ps_tests[t].pc_opt))))
+        {
+            t++;
+        }
+        if (t == ui8_tests)
+        {
+            usage(argv[0], ps_tests, ui8_tests);
+            return EXIT_FAILURE;
+        }
+    }
+
+    for (int i = 1; i < argc; i++)
+    {
+        for (uint8_t t = 0; t < ui8_tests; t++)
+        {
+            if (0 == strncmp(argv[i], ps_tests[t].pc_opt, strlen(ps_tests[t].pc_opt)))
+            {
+                ui32_errors += runTest(&ps_tests[t], &argv[i][strlen(ps_tests[t].pc_opt)]);
+                break;
+            }
+        }
+    }
+    for (uint8_t t = 0; (1 == argc) && (t < ui8_tests); t++)
+    {
+        ui32_errors += runTest(&ps_tests[t], ps_tests[t].pc_default);
+    }
+
+    printf("--- %s: %s ---\r\n", argv[0], (0 == ui32_errors) ? "passed" : "FAILED");
+
+    return (0 == ui32_errors) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+uint64_t nowNs(void)
+{
+    struct timespec s_ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &s_ts);
+    return (uint64_t)s_ts.tv_sec * 1000000000ULL + (uint64_t)s_ts.tv_nsec;
+}
+
+void clearDir(const char *pc_dir)
+{
+    DIR            *ps_dir = opendir(pc_dir);
+    struct dirent  *ps_ent;
+    char            ac_path[K_DLOG_PATH_LEN + sizeof(ps_ent->d_name)];
+
+    while ((NULL != ps_dir) && (NULL != (ps_ent = readdir(ps_dir))))
+    {
+        // a cut path would remove another file
+        if (('.' != ps_ent->d_name[0]) &&
+            (snprintf(ac_path, sizeof(ac_path), "%s/%s", pc_dir, ps_ent->d_name) < (int)sizeof(ac_path)))
+        {
+            remove(ac_path);
+        }
+    }
+    if (NULL != ps_dir)
+    {
+        closedir(ps_dir);
+    }
+}
+
+uint16_t queryBenchValue(uint32_t i, uint8_t ui8_phase, uint8_t ui8_param)
+{
+    return (uint16_t)(i * 7 + ui8_phase * 1000 + ui8_param * 13);
+}
+
+uint16_t queryBenchRecord(uint32_t i, int32_t si32_ts, uint8_t *pui8_buf, size_t sz_buf_len)
+{
+    static ep_monitor_payload_st    s_monitor;
+    ep_com_header_st                s_header;
+    size_t                          sz_len = 0;
+
+    (void)edgePayloadInitComHeader(&s_header, si32_ts);
+    (void)edgePayloadInitMonitor(&s_monitor, &s_header);
+    for (uint8_t p = 0; p < 3; p++)
+    {
+        uint8_t k = 0;
+        uint8_t ui8_orders;
+
+        (void)edgePayloadNewMonitorPhase(&s_monitor, (ep_phase_index_et)(EP_PHASE_INDEX_L1 + p));
+        for ( ; k < sizeof(AUI8_QUERY_BENCH_IDS); k++)
+        {
+            (void)edgePayloadAddMonitorParam(&s_monitor, (ep_monitor_id_et)AUI8_QUERY_BENCH_IDS[k], queryBenchValue(i, p, k));
+        }
+        // the orders only if they fit the phase with THD & the energy counters, as harmAddMonitorParams()
+        ui8_orders = (edgePayloadMonitorPhaseRoom(&s_monitor) >= (2 * K_HARM_NUM_ORDERS + 2 + 5)) ? K_HARM_NUM_ORDERS : 0;
+        for (uint8_t h = 0; h < ui8_orders; h++, k += 2)
+        {
+            (void)edgePayloadAddMonitorParam(&s_monitor, (ep_monitor_id_et)(EP_MON_ID_GDL_V_3RD_HARM + h), queryBenchValue(i, p, k));
+            (void)edgePayloadAddMonitorParam(&s_monitor, (ep_monitor_id_et)(EP_MON_ID_GDL_I_3RD_HARM + h), queryBenchValue(i, p, k + 1));
+        }
+        (void)edgePayloadAddMonitorParam(&s_monitor, EP_MON_ID_GDL_VTHD, queryBenchValue(i, p, k++));
+        (void)edgePayloadAddMonitorParam(&s_monitor, EP_MON_ID_GDL_ITHD, queryBenchValue(i, p, k++));
+        for (uint8_t e = 0; e < 5; e++)
+        {
+            (void)edgePayloadAddMonitorParam32(&s_monitor, (ep_monitor_id_et)(EP_MON_ID_GDL_EXPORT_KWH_32 + e), i * 100000UL + p * 10 + e);
+        }
+    }
+    (void)edgePayloadMonitor2Buf(pui8_buf, sz_buf_len, &sz_len, &s_monitor);
+
+    return (uint16_t)sz_len;
+}
+
+int32_t codecBenchNoise(uint32_t i, uint8_t ui8_phase, uint8_t k, int32_t si32_n)
+{
+    uint32_t ui32_hash = (i * 2654435761UL) ^ (ui8_phase * 40503UL) ^ (k * 2246822519UL);
+
+    ui32_hash ^= ui32_hash >> 15;
+    ui32_hash *= 2246822519UL;
+    ui32_hash ^= ui32_hash >> 13;
+
+    return (int32_t)(ui32_hash % (uint32_t)(2 * si32_n + 1)) - si32_n;
+}
+
+uint16_t codecBenchRecord(uint32_t i, int32_t si32_ts, uint32_t *pui32_energy, uint8_t *pui8_buf, size_t sz_buf_len)
+{
+    static ep_monitor_payload_st    s_monitor;
+    ep_com_header_st                s_header;
+    size_t                          sz_len = 0;
+    double                          d_day = 2.0 * M_PI * (i % 1440) / 1440.0;
+
+    (void)edgePayloadInitComHeader(&s_header, si32_ts);
+    (void)edgePayloadInitMonitor(&s_monitor, &s_header);
+    for (uint8_t p = 0; p < 3; p++)
+    {
+        double      d_load = 0.55 + 0.35 * sin(d_day - M_PI / 2 + p * 0.3) + codecBenchNoise(i, p, 0, 50) / 1000.0;
+        int32_t     si32_v = 23000 + (int32_t)(150 * sin(d_day)) + codecBenchNoise(i, p, 1, 30);
+        int32_t     si32_i = (int32_t)(d_load * 2000) + codecBenchNoise(i, p, 2, 20);
+        int32_t     si32_pf = 9500 + codecBenchNoise(i, p, 3, 80);
+        int32_t     si32_va = si32_v * si32_i / 10000;
+        int32_t     si32_w  = si32_va * si32_pf / 10000;
+        int32_t     si32_var = (int32_t)sqrt((double)si32_va * si32_va - (double)si32_w * si32_w);
+        uint16_t    aui16_val[17] =
+        {
+            (uint16_t)si32_v, (uint16_t)(si32_v - 40 - abs(codecBenchNoise(i, p, 4, 60))), (uint16_t)(si32_v + 40 + abs(codecBenchNoise(i, p, 5, 60))),
+            (uint16_t)si32_i, (uint16_t)(si32_i - 50 - abs(codecBenchNoise(i, p, 6, 300))), (uint16_t)(si32_i + 50 + abs(codecBenchNoise(i, p, 7, 900))),
+            (uint16_t)si32_w, (uint16_t)(si32_w * 8 / 10), (uint16_t)(si32_w * 14 / 10),
+            (uint16_t)si32_va, (uint16_t)(si32_va * 8 / 10), (uint16_t)(si32_va * 14 / 10),
+            (uint16_t)si32_var, (uint16_t)(si32_var * 7 / 10), (uint16_t)(si32_var * 15 / 10),
+            (uint16_t)si32_pf, (uint16_t)(5000 + codecBenchNoise(i, p, 8, 4)),
+        };
+        uint8_t     k = 0;
+        uint8_t     ui8_orders;
+
+        (void)edgePayloadNewMonitorPhase(&s_monitor, (ep_phase_index_et)(EP_PHASE_INDEX_L1 + p));
+        for ( ; k < sizeof(AUI8_QUERY_BENCH_IDS); k++)
+        {
+            (void)edgePayloadAddMonitorParam(&s_monitor, (ep_monitor_id_et)AUI8_QUERY_BENCH_IDS[k], aui16_val[k]);
+        }
+        ui8_orders = (edgePayloadMonitorPhaseRoom(&s_monitor) >= (2 * K_HARM_NUM_ORDERS + 2 + 5)) ? K_HARM_NUM_ORDERS : 0;
+        for (uint8_t h = 0; h < ui8_orders; h++)
+        {
+            (void)edgePayloadAddMonitorParam(&s_monitor, (ep_monitor_id_et)(EP_MON_ID_GDL_V_3RD_HARM + h),
+                                             (uint16_t)(200 / (2 * h + 3) + 5 + codecBenchNoise(i, p, 20 + h, 5)));
+            (void)edgePayloadAddMonitorParam(&s_monitor, (ep_monitor_id_et)(EP_MON_ID_GDL_I_3RD_HARM + h),
+                                             (uint16_t)(d_load * 2400 / (2 * h + 3) + 10 + codecBenchNoise(i, p, 40 + h, 10)));
+        }
+        (void)edgePayloadAddMonitorParam(&s_monitor, EP_MON_ID_GDL_VTHD, (uint16_t)(250 + codecBenchNoise(i, p, 60, 20)));
+        (void)edgePayloadAddMonitorParam(&s_monitor, EP_MON_ID_GDL_ITHD, (uint16_t)(1200 - d_load * 600 + codecBenchNoise(i, p, 61, 50)));
+
+        pui32_energy[p * 5 + 1] += (uint32_t)(si32_w / 60);
+        pui32_energy[p * 5 + 2] += (uint32_t)(si32_var / 60);
+        pui32_energy[p * 5 + 4] += (uint32_t)(si32_va / 60);
+        for (uint8_t e = 0; e < 5; e++)
+        {
+            (void)edgePayloadAddMonitorParam32(&s_monitor, (ep_monitor_id_et)(EP_MON_ID_GDL_EXPORT_KWH_32 + e), pui32_energy[p * 5 + e]);
+        }
+    }
+    (void)edgePayloadMonitor2Buf(pui8_buf, sz_buf_len, &sz_len, &s_monitor);
+
+    return (uint16_t)sz_len;
+}
@@ -0,0 +1,67 @@
+/*
+ * host_test.h
+ *
+ * Common part of the host test executables: option parsing & the result, scratch directories,
+ * the synthetic interval reports several of the tests share.
+ *
+ * An executable runs all its tests with their default sizes when started without options, or
+ * the ones named on the command line ("--<name>=<n>"), and exits with EXIT_FAILURE if any of
+ * them found an error. They are registered with ctest in "src/host/CMakeLists.txt".
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "edge_payload/edge_payload.h"
+
+/*
+ * Global Constants
+ */
+#define K_SIM_SEND_QUEUE            8           // K_CLOUD_COMMS_SEND_QUEUE_SIZE
+
+/* the 16-bit aggregates of a GDL interval report, in report order */
+static const uint8_t AUI8_QUERY_BENCH_IDS[] =
+{
+    EP_MON_ID_GDL_VAVE,     EP_MON_ID_GDL_VMIN,     EP_MON_ID_GDL_VMAX,     EP_MON_ID_GDL_IAVE,     EP_MON_ID_GDL_IMIN,
+    EP_MON_ID_GDL_IMAX,     EP_MON_ID_GDL_WATTAVE,  EP_MON_ID_GDL_WATTMIN,  EP_MON_ID_GDL_WATTMAX,  EP_MON_ID_GDL_VAAVE,
+    EP_MON_ID_GDL_VAMIN,    EP_MON_ID_GDL_VAMAX,    EP_MON_ID_GDL_VARAVE,   EP_MON_ID_GDL_VARMIN,   EP_MON_ID_GDL_VARMAX,
+    EP_MON_ID_GDL_PF,       EP_MON_ID_GDL_LINE_FREQ,
+};
+
+/*
+ * Global Types
+ */
+typedef struct
+{
+    const char *pc_opt;                         // "--name=", the value follows
+    const char *pc_default;                     // value of a run without options
+    uint32_t    (*pf_run)(uint32_t ui32_n);     // errors found; NULL: pf_run_file takes the value
+    uint32_t    (*pf_run_file)(const char *pc_file);
+} host_test_st;
+
+/*
+ * Global Functions
+ */
+
+/* shim on the manual clock, storage mounted; the tests named in argv, or all of them with their
+   default sizes; EXIT_FAILURE if any found an error */
+int hostTestMain(int argc, char *argv[], const host_test_st *ps_tests, uint8_t ui8_tests);
+
+uint64_t nowNs(void);
+void clearDir(const char *pc_dir);
+
+/* value of parameter k of phase p in interval i of queryBenchRecord() */
+uint16_t queryBenchValue(uint32_t i, uint8_t ui8_phase, uint8_t ui8_param);
+
+/* monitor payload of interval i as data::logging reports it: 3 phases of 17 aggregates, 22
+   harmonics & 5 energy counters; THD only without K_PAYLOAD_SPLIT_PHASE_GROUPS */
+uint16_t queryBenchRecord(uint32_t i, int32_t si32_ts, uint8_t *pui8_buf, size_t sz_buf_len);
+
+/* deterministic noise in [-n, n] of column k */
+int32_t codecBenchNoise(uint32_t i, uint8_t ui8_phase, uint8_t k, int32_t si32_n);
+
+/* monitor payload of 1 min interval i of a household: daily load curve, mains voltage & frequency
+   noise, harmonics falling with the order, energy counters integrating the power */
+uint16_t codecBenchRecord(uint32_t i, int32_t si32_ts, uint32_t *pui32_energy, uint8_t *pui8_buf, size_t sz_buf_len);
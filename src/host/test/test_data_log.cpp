@@ -0,0 +1,1694 @@
+/*
+ * test_data_log.cpp
+ *
+ * The data log and what builds on it: replay, range queries, the delta codec, the journal,
+ * flush strategies, the raw partition backend, compaction and the mapped read path.
+ *
+ *  test_data_log [--log-bench=<interval records through the data log>]
+ *                [--replay-sim=<hours of cloud outage replayed from the data log>]
+ *                [--query-bench=<hours per range query over a full data log>]
+ *                [--codec-bench=<days of monitor payloads through the data log codec>]
+ *                [--journal-fault=<power cuts at random byte offsets, recovered through the journal>]
+ *                [--flush-sim=<days of 1 min intervals, flash sector writes of the data log flush strategies>]
+ *                [--flash-bench=<days of 1 min intervals, data log in FAT files vs. a raw partition on the flash emulator>]
+ *                [--compact-sim=<days of 1 min intervals, data log compacted into 15 min & 1 h tiers as it ages or fills>]
+ *                [--mmap-bench=<days of 1 min intervals replayed & queried from buffered pages vs. the mapped partition>]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "host_shim.h"
+#include "esp_partition.h"
+#include "data_log/data_log.h"
+#include "log_replay/log_replay.h"
+#include "log_query/log_query.h"
+#include "mon_codec/mon_codec.h"
+#include "journal/journal.h"
+#include "energy/energy.h"
+#include "log_compact/log_compact.h"
+#include "test/host_test.h"
+
+
+/* 300..500 byte record of interval i, the content follows from i */
+static uint16_t logBenchRecord(uint32_t i, uint8_t *pui8_rec)
+{
+    uint32_t ui32_lcg = i * 2654435761UL + 1;
+    uint16_t ui16_len = (uint16_t)(300 + (i * 37) % 201);
+
+    for (uint16_t b = 0; b < ui16_len; b++)
+    {
+        ui32_lcg = ui32_lcg * 1664525UL + 1013904223UL;
+        pui8_rec[b] = (uint8_t)(ui32_lcg >> 24);
+    }
+
+    return ui16_len;
+}
+
+/* n interval records (one per minute) appended, then remounted, read back & searched. The sector
+   write model is the wear levelling layer's view: a page write is one data sector plus the
+   directory entry, a new cluster one FAT sector; a per record "fopen(ab)" append rewrites every
+   sector it touches the same way. */
+static uint32_t logBench(uint32_t ui32_records)
+{
+    static const char  *PC_DIR  = K_STORAGE_BASE_PATH "/log_bench";
+    static const char  *PC_FILE = K_STORAGE_BASE_PATH "/log_bench.bin";
+    static const int32_t SI32_TS0 = 1780000000;
+    static dlog_st      s_log;
+    static dlog_reader_st s_reader;
+    static uint8_t      aui8_rec[K_DLOG_MAX_REC_LEN];
+    static uint8_t      aui8_ref[K_DLOG_MAX_REC_LEN];
+    uint32_t            ui32_naive = (ui32_records < 2000) ? ui32_records : 2000;
+    uint64_t            ui64_naive_bytes = 0;
+    uint64_t            ui64_naive_sectors = 0;
+    uint64_t            ns_start;
+
+    mkdir(PC_DIR, 0755);
+    clearDir(PC_DIR);
+    (void)dlogInit(&s_log, PC_DIR);
+
+    ns_start = nowNs();
+    for (uint32_t i = 0; i < ui32_records; i++)
+    {
+        uint16_t ui16_len = logBenchRecord(i, aui8_rec);
+
+        if (false == dlogAppend(&s_log, SI32_TS0 + (int32_t)(i * 60), aui8_rec, ui16_len))
+        {
+            printf("--- log bench: append %u failed ---\r\n", (unsigned)i);
+            return 1;
+        }
+    }
+    (void)dlogFlush(&s_log, 0, true);
+    uint64_t ns_append = nowNs() - ns_start;
+
+    uint32_t ui32_pages   = (s_log.ui32_segs_dropped + s_log.ui8_segs - 1) * K_DLOG_SEGMENT_PAGES + s_log.ui16_page + 1;
+    uint64_t ui64_written = (uint64_t)s_log.ui32_page_writes * K_DLOG_PAGE_SIZE;
+    // data per page + directory entry per write, FAT per new page
+    uint64_t ui64_sectors = (uint64_t)s_log.ui32_page_writes + s_log.ui32_writes + ui32_pages;
+    uint32_t ui32_appended = s_log.ui32_records;
+    uint64_t ui64_payload  = s_log.ui64_record_bytes;
+    uint32_t ui32_writes   = s_log.ui32_page_writes;
+    uint32_t ui32_dropped  = s_log.ui32_segs_dropped;
+
+    // naive: one file append per record
+    remove(PC_FILE);
+    ns_start = nowNs();
+    for (uint32_t i = 0; i < ui32_naive; i++)
+    {
+        uint16_t    ui16_len = logBenchRecord(i, aui8_rec);
+        FILE       *ps_file  = fopen(PC_FILE, "ab");
+
+        if (NULL != ps_file)
+        {
+            fwrite(aui8_rec, ui16_len, 1, ps_file);
+            fclose(ps_file);
+        }
+        ui64_naive_sectors += ((ui64_naive_bytes + ui16_len - 1) / K_DLOG_PAGE_SIZE) - (ui64_naive_bytes / K_DLOG_PAGE_SIZE) + 1 + 1;
+        ui64_naive_sectors += (0 == (ui64_naive_bytes % K_DLOG_PAGE_SIZE)) ? 1 : 0;
+        ui64_naive_bytes   += ui16_len;
+    }
+    uint64_t ns_naive = nowNs() - ns_start;
+    remove(PC_FILE);
+
+    // remount, everything still there is read back in order
+    uint32_t ui32_read = 0;
+    uint32_t ui32_bad  = 0;
+    int32_t  si32_ts;
+    uint16_t ui16_len;
+
+    ns_start = nowNs();
+    (void)dlogInit(&s_log, PC_DIR);
+    dlogReaderInit(&s_reader);
+
+    uint32_t ui32_first = ui32_records;
+    while (true == dlogRead(&s_log, &s_reader, NULL, &si32_ts, aui8_rec, sizeof(aui8_rec), &ui16_len))
+    {
+        uint32_t i = (uint32_t)(si32_ts - SI32_TS0) / 60;
+
+        ui32_first = (0 == ui32_read) ? i : ui32_first;
+        if ((i != (ui32_first + ui32_read)) || (ui16_len != logBenchRecord(i, aui8_ref)) || (0 != memcmp(aui8_rec, aui8_ref, ui16_len)))
+        {
+            ui32_bad++;
+        }
+        ui32_read++;
+    }
+    uint64_t ns_read = nowNs() - ns_start;
+
+    if ((ui32_first + ui32_read) != ui32_records)
+    {
+        ui32_bad++;
+    }
+
+    // random seeks: first record at or after the target
+    uint32_t ui32_seeks = 1000;
+    uint32_t ui32_lcg   = 4711;
+
+    ns_start = nowNs();
+    for (uint32_t s = 0; s < ui32_seeks; s++)
+    {
+        ui32_lcg = ui32_lcg * 1664525UL + 1013904223UL;
+        int32_t  si32_target = SI32_TS0 + (int32_t)((ui32_lcg >> 8) % (ui32_records * 60));
+        uint32_t ui32_expect = ((uint32_t)(si32_target - SI32_TS0) + 59) / 60;
+
+        ui32_expect = (ui32_expect < ui32_first) ? ui32_first : ui32_expect;
+        dlogSeek(&s_log, &s_reader, si32_target);
+        if (ui32_expect >= ui32_records)
+        {
+            ui32_bad += (true == dlogRead(&s_log, &s_reader, NULL, &si32_ts, aui8_rec, sizeof(aui8_rec), &ui16_len)) ? 1 : 0;
+        }
+        else if ((false == dlogRead(&s_log, &s_reader, NULL, &si32_ts, aui8_rec, sizeof(aui8_rec), &ui16_len)) ||
+                 (si32_ts != (SI32_TS0 + (int32_t)(ui32_expect * 60))))
+        {
+            ui32_bad++;
+        }
+    }
+    uint64_t ns_seek = nowNs() - ns_start;
+
+    printf("--- log bench: %u records (%.0f B avg) in %.3f s, %.0f records/s, %u page writes, %u segments (%u dropped) ---\r\n",
+           (unsigned)ui32_appended, ui32_appended ? (double)ui64_payload / ui32_appended : 0.0, ns_append / 1e9,
+           ns_append ? ui32_appended / (ns_append / 1e9) : 0.0, (unsigned)ui32_writes,
+           (unsigned)s_log.ui8_segs, (unsigned)ui32_dropped);
+    printf("--- log bench: write amplification %.2f (bytes), %.2f (sector model); per record append %.2f (sector model), %.0f records/s ---\r\n",
+           ui64_payload ? (double)ui64_written / ui64_payload : 0.0,
+           ui64_payload ? (double)ui64_sectors * K_DLOG_PAGE_SIZE / ui64_payload : 0.0,
+           ui64_naive_bytes ? (double)ui64_naive_sectors * K_DLOG_PAGE_SIZE / ui64_naive_bytes : 0.0,
+           ns_naive ? ui32_naive / (ns_naive / 1e9) : 0.0);
+    printf("--- log bench: remount + read %u records in %.3f s (%.0f records/s), %u seeks %.1f us each, %u errors ---\r\n",
+           (unsigned)ui32_read, ns_read / 1e9, ns_read ? ui32_read / (ns_read / 1e9) : 0.0, (unsigned)ui32_seeks,
+           (double)ns_seek / ui32_seeks / 1000.0, (unsigned)ui32_bad);
+
+    clearDir(PC_DIR);
+
+    return ui32_bad;
+}
+
+#define K_SIM_TX_MS                 40          // uplink time of one report datagram
+#define K_SIM_RTT_MS                600         // to the acknowledge
+#define K_SIM_ACK_LOSS              100         // every n-th acknowledge lost
+#define K_SIM_MAX_TRANSIT           64
+
+typedef struct
+{
+    uint16_t    ui16_ticket;
+    uint32_t    ui32_idx;
+    uint64_t    ms_ack;
+} sim_msg_st;
+
+/* one report per minute; online for 10 min, an outage of n hours, then online until the backlog
+   is drained, with a reset (cursor restored from the file) half way through. Link: the 8 slot
+   send queue, one datagram per K_SIM_TX_MS, acknowledges after K_SIM_RTT_MS, some lost. */
+static uint32_t replaySim(uint32_t ui32_hours)
+{
+    static const char      *PC_DIR    = K_STORAGE_BASE_PATH "/replay_sim";
+    static const char      *PC_CURSOR = K_STORAGE_BASE_PATH "/replay_sim.bin";
+    static const int32_t    SI32_TS0  = 1780000000;
+    static dlog_st          s_log;
+    static replay_st        s_rp;
+    static mon_codec_st     s_codec;
+    static uint8_t          aui8_rec[K_DLOG_MAX_REC_LEN];
+    sim_msg_st              as_queue[K_SIM_SEND_QUEUE];
+    sim_msg_st              as_transit[K_SIM_MAX_TRANSIT];
+    uint8_t                 ui8_queued = 0;
+    uint8_t                 ui8_transit = 0;
+    uint32_t                ui32_max = (ui32_hours + 4) * 60;
+    uint16_t               *pui16_delivered = (uint16_t *)calloc(ui32_max, sizeof(uint16_t));
+    uint64_t               *pms_appended = (uint64_t *)calloc(ui32_max, sizeof(uint64_t));
+    uint64_t                ms_outage = 10ULL * 60000;
+    uint64_t                ms_back   = ms_outage + (uint64_t)ui32_hours * 3600000ULL;
+    uint64_t                ms_tx_free = 0;
+    uint64_t                ms_caught_up = 0;
+    uint64_t                ms_live_worst = 0;
+    uint32_t                ui32_records = 0;
+    uint32_t                ui32_backlog = 0;
+    uint32_t                ui32_acks = 0;
+    uint32_t                ui32_timeouts = 0;
+    uint16_t                ui16_ticket = 0;
+    bool                    b_reset = false;
+
+    mkdir(PC_DIR, 0755);
+    clearDir(PC_DIR);
+    remove(PC_CURSOR);
+    (void)dlogInit(&s_log, PC_DIR);
+    monCodecInit(&s_codec);
+    replayInit(&s_rp, PC_CURSOR, &s_log);
+
+    for (uint64_t ms = 0; ms < (ms_back + 24ULL * 3600000ULL); ms += 10)
+    {
+        bool b_online = (ms < ms_outage) || (ms >= ms_back);
+
+        if ((0 == (ms % 60000)) && (ui32_records < ui32_max))
+        {
+            int32_t  si32_ts  = SI32_TS0 + (int32_t)(ui32_records * 60);
+            uint16_t ui16_len = queryBenchRecord(ui32_records, si32_ts, aui8_rec, sizeof(aui8_rec));
+
+            (void)monCodecAppend(&s_codec, &s_log, si32_ts, aui8_rec, ui16_len);
+            pms_appended[ui32_records++] = ms;
+        }
+
+        if ((true == b_online) && (ms >= ms_back) && (0 == ui32_backlog))
+        {
+            ui32_backlog = ui32_records - 10;   // first report after the outage is live
+        }
+
+        // reset half way through the drain: RAM state lost, what was queued too
+        if ((false == b_reset) && (0 != ui32_backlog) && (s_rp.aui32_acked[REPLAY_BACKLOG] >= (ui32_backlog / 2)))
+        {
+            replayInit(&s_rp, PC_CURSOR, &s_log);
+            ui8_queued  = 0;
+            ui8_transit = 0;
+            b_reset     = true;
+        }
+
+        // cloud task cycle
+        if (false == b_online)
+        {
+            replayOffline(&s_rp);
+            ui8_queued  = 0;
+            ui8_transit = 0;
+        }
+        else
+        {
+            const uint8_t  *pui8_report;
+            int32_t         si32_ts;
+            uint16_t        ui16_len;
+
+            replayOnline(&s_rp, &s_log);
+            ui32_timeouts += (true == replayPoll(&s_rp, (uint32_t)ms)) ? 1 : 0;
+            while (true == replayNext(&s_rp, &s_log, K_SIM_SEND_QUEUE - ui8_queued, (uint32_t)ms,
+                                      &si32_ts, &pui8_report, &ui16_len))
+            {
+                ui16_ticket = (uint16_t)((0 == (ui16_ticket + 1)) ? 1 : (ui16_ticket + 1));
+                as_queue[ui8_queued].ui16_ticket = ui16_ticket;
+                as_queue[ui8_queued].ui32_idx    = (uint32_t)(si32_ts - SI32_TS0) / 60;
+                ui8_queued++;
+                replaySent(&s_rp, ui16_ticket, true);
+            }
+        }
+        (void)replayCheckpoint(&s_rp, (uint32_t)ms, false);
+
+        // uplink & acknowledges
+        if ((0 != ui8_queued) && (ms >= ms_tx_free) && (ui8_transit < K_SIM_MAX_TRANSIT))
+        {
+            as_transit[ui8_transit] = as_queue[0];
+            as_transit[ui8_transit].ms_ack = ms + K_SIM_TX_MS + K_SIM_RTT_MS;
+            pui16_delivered[as_queue[0].ui32_idx]++;
+            ui8_transit++;
+            memmove(&as_queue[0], &as_queue[1], --ui8_queued * sizeof(sim_msg_st));
+            ms_tx_free = ms + K_SIM_TX_MS;
+        }
+
+        for (uint8_t t = 0; t < ui8_transit; )
+        {
+            if (ms < as_transit[t].ms_ack)
+            {
+                t++;
+                continue;
+            }
+            if (0 != (++ui32_acks % K_SIM_ACK_LOSS))
+            {
+                uint32_t ui32_idx = as_transit[t].ui32_idx;
+
+                if ((true == replayAck(&s_rp, as_transit[t].ui16_ticket)) && (pms_appended[ui32_idx] > ms_back) &&
+                    ((ms - pms_appended[ui32_idx]) > ms_live_worst))
+                {
+                    ms_live_worst = ms - pms_appended[ui32_idx];
+                }
+            }
+            as_transit[t] = as_transit[--ui8_transit];
+        }
+
+        if ((0 != ui32_backlog) && (0 == ms_caught_up) && (false == replayBacklog(&s_rp)))
+        {
+            ms_caught_up = ms;
+        }
+        if ((0 != ms_caught_up) && (ms > (ms_caught_up + 120000)))
+        {
+            break;
+        }
+    }
+
+    uint32_t ui32_dup = 0;
+    uint32_t ui32_lost = 0;
+
+    for (uint32_t i = 0; (i + 1) < ui32_records; i++)
+    {
+        ui32_dup  += (pui16_delivered[i] > 1) ? (pui16_delivered[i] - 1) : 0;
+        ui32_lost += (0 == pui16_delivered[i]) ? 1 : 0;
+    }
+
+    printf("--- replay sim: %u h outage, %u backlog reports caught up in %.1f s (%.1f reports/s), live report latency <= %.2f s ---\r\n",
+           (unsigned)ui32_hours, (unsigned)ui32_backlog, ms_caught_up ? (ms_caught_up - ms_back) / 1000.0 : -1.0,
+           (ms_caught_up > ms_back) ? ui32_backlog / ((ms_caught_up - ms_back) / 1000.0) : 0.0, ms_live_worst / 1000.0);
+    printf("--- replay sim: %u reports, %u lost, %u sent twice (reset half way, 1/%u acks lost), %u ack timeouts, %u cursor checkpoints ---\r\n",
+           (unsigned)ui32_records, (unsigned)ui32_lost, (unsigned)ui32_dup, K_SIM_ACK_LOSS, (unsigned)ui32_timeouts,
+           (unsigned)s_rp.ui32_checkpoints);
+
+    clearDir(PC_DIR);
+    remove(PC_CURSOR);
+    free(pui16_delivered);
+    free(pms_appended);
+
+    // sent twice is allowed, what was lost in the reset or with an acknowledge is not
+    return ui32_lost + ((0 == ms_caught_up) ? 1 : 0);
+}
+
+/* one query drained in web server sized chunks, the output checked against the intervals */
+static bool queryBenchRun(const dlog_st *ps_log, query_st *ps_query, const char *pc_query, uint32_t ui32_first,
+                          int32_t si32_ts0, uint32_t *pui32_bytes, uint32_t *pui32_chunks)
+{
+    static char ac_chunk[2048];
+    static char ac_out[1 << 20];
+    char        ac_row[K_QUERY_ROW_LEN];
+    uint32_t    ui32_out = 0;
+
+    *pui32_chunks = 0;
+    if (false == queryParse(ps_query, pc_query))
+    {
+        return false;
+    }
+
+    while (false == queryDone(ps_query))
+    {
+        uint16_t ui16_len = queryFill(ps_query, ps_log, ac_chunk, sizeof(ac_chunk));
+
+        if ((ui32_out + ui16_len) < sizeof(ac_out))
+        {
+            memcpy(&ac_out[ui32_out], ac_chunk, ui16_len);
+            ui32_out += ui16_len;
+        }
+        *pui32_chunks += (0 != ui16_len) ? 1 : 0;
+    }
+    ac_out[ui32_out] = '\0';
+    *pui32_bytes = ui32_out;
+
+    // intervals from the first one at or after "from", every n-th, L1..L3, VAVE WATTAVE & IMPORT_KWH_32
+    uint32_t i0 = ((uint32_t)(ps_query->si32_from - si32_ts0) + 59) / 60;
+    uint32_t i1 = (uint32_t)(ps_query->si32_to - si32_ts0) / 60;
+    uint32_t ui32_expect = (i1 >= i0) ? ((i1 - i0) / ps_query->ui16_every + 1) * 3 : 0;
+
+    i0 = (i0 < ui32_first) ? ui32_first : i0;
+    snprintf(ac_row, sizeof(ac_row), "\"rows\":[[%ld,1,%u,%u,%lu]", (long)(si32_ts0 + (int32_t)(i0 * 60)),
+             queryBenchValue(i0, 0, 0), queryBenchValue(i0, 0, 6), (unsigned long)(uint32_t)(i0 * 100000UL + 1));
+
+    return (ps_query->ui32_rows == ui32_expect) && (0 == ps_query->ui32_bad_records) &&
+           (NULL != strstr(ac_out, ac_row)) && (0 != ui32_out) && ('}' == ac_out[ui32_out - 1]);
+}
+
+/* the data log filled to K_DLOG_MAX_SEGMENTS with 1 min monitor payloads, remounted, then n hour
+   range queries at random offsets; a full scan of the log for the same range as reference */
+static uint32_t queryBench(uint32_t ui32_hours)
+{
+    static const char      *PC_DIR   = K_STORAGE_BASE_PATH "/query_bench";
+    static const int32_t    SI32_TS0 = 1780000000;
+    static const uint32_t   UI32_QUERIES = 20;
+    static dlog_st          s_log;
+    static query_st         s_query;
+    static mon_codec_st     s_codec;
+    static uint8_t          aui8_rec[K_DLOG_MAX_REC_LEN];
+    char                    ac_query[128];
+    uint32_t                ui32_records = 0;
+    uint32_t                ui32_rec_len = 0;
+    uint32_t                ui32_bad = 0;
+
+    mkdir(PC_DIR, 0755);
+    clearDir(PC_DIR);
+    (void)dlogInit(&s_log, PC_DIR);
+    monCodecInit(&s_codec);
+    while (0 == s_log.ui32_segs_dropped)
+    {
+        uint16_t ui16_len = queryBenchRecord(ui32_records, SI32_TS0 + (int32_t)(ui32_records * 60), aui8_rec, sizeof(aui8_rec));
+
+        if (false == monCodecAppend(&s_codec, &s_log, SI32_TS0 + (int32_t)(ui32_records * 60), aui8_rec, ui16_len))
+        {
+            printf("--- query bench: append %u failed ---\r\n", (unsigned)ui32_records);
+            return 1;
+        }
+        ui32_rec_len = ui16_len;
+        ui32_records++;
+    }
+    (void)dlogFlush(&s_log, 0, true);
+    (void)dlogInit(&s_log, PC_DIR);
+
+    // oldest interval still stored
+    dlog_reader_st *ps_reader = &s_query.s_reader;
+    int32_t         si32_ts;
+    uint16_t        ui16_len;
+
+    dlogReaderInit(ps_reader);
+    (void)dlogRead(&s_log, ps_reader, NULL, &si32_ts, aui8_rec, sizeof(aui8_rec), &ui16_len);
+    uint32_t ui32_first  = (uint32_t)(si32_ts - SI32_TS0) / 60;
+    uint32_t ui32_stored = ui32_records - ui32_first;
+    uint32_t ui32_span   = ui32_hours * 60;
+
+    if (ui32_span >= ui32_stored)
+    {
+        printf("--- query bench: %u h not stored (%u intervals) ---\r\n", (unsigned)ui32_hours, (unsigned)ui32_stored);
+        return 1;
+    }
+
+    for (uint16_t ui16_every = 1; ui16_every <= 15; ui16_every += 14)
+    {
+        uint32_t ui32_lcg = 4711;
+        uint64_t ns_total = 0;
+        uint64_t ns_worst = 0;
+        uint32_t ui32_bytes = 0;
+        uint32_t ui32_chunks = 0;
+        uint32_t ui32_rows = 0;
+        uint32_t ui32_pages = 0;
+
+        for (uint32_t q = 0; q < UI32_QUERIES; q++)
+        {
+            uint32_t ui32_q_bytes;
+            uint32_t ui32_q_chunks;
+            int32_t  si32_from;
+
+            ui32_lcg  = ui32_lcg * 1664525UL + 1013904223UL;
+            si32_from = SI32_TS0 + (int32_t)((ui32_first + (ui32_lcg >> 8) % (ui32_stored - ui32_span)) * 60) + 30;
+            snprintf(ac_query, sizeof(ac_query), "from=%ld&to=%ld&phase=1,2,3&ids=0x%02X,0x%02X,0x%02X&every=%u",
+                     (long)si32_from, (long)(si32_from + (int32_t)ui32_span * 60), EP_MON_ID_GDL_VAVE, EP_MON_ID_GDL_WATTAVE,
+                     EP_MON_ID_GDL_IMPORT_KWH_32, ui16_every);
+
+            uint64_t ns_start = nowNs();
+            ui32_bad += (false == queryBenchRun(&s_log, &s_query, ac_query, ui32_first, SI32_TS0, &ui32_q_bytes, &ui32_q_chunks)) ? 1 : 0;
+            uint64_t ns_query = nowNs() - ns_start;
+
+            ns_total    += ns_query;
+            ns_worst     = (ns_query > ns_worst) ? ns_query : ns_worst;
+            ui32_bytes  += ui32_q_bytes;
+            ui32_chunks += ui32_q_chunks;
+            ui32_rows   += s_query.ui32_rows;
+            ui32_pages  += s_query.s_reader.ui32_page_reads;
+        }
+
+        printf("--- query bench: %u h, every %u: %.2f ms avg / %.2f ms worst, %u rows, %.1f KiB in %u chunks, %u pages (%.0f KiB) read per query ---\r\n",
+               (unsigned)ui32_hours, ui16_every, ns_total / 1e6 / UI32_QUERIES, ns_worst / 1e6, (unsigned)(ui32_rows / UI32_QUERIES),
+               ui32_bytes / 1024.0 / UI32_QUERIES, (unsigned)(ui32_chunks / UI32_QUERIES), (unsigned)(ui32_pages / UI32_QUERIES),
+               ui32_pages * (K_DLOG_PAGE_SIZE / 1024.0) / UI32_QUERIES);
+    }
+
+    // reference: the same range found by reading the log from its start
+    uint32_t ui32_scan_pages = 0;
+    uint64_t ns_start = nowNs();
+
+    for (uint32_t q = 0; q < 3; q++)
+    {
+        int32_t si32_from = SI32_TS0 + (int32_t)((ui32_first + ui32_stored / 2) * 60);
+
+        dlogReaderInit(ps_reader);
+        while ((true == dlogRead(&s_log, ps_reader, NULL, &si32_ts, aui8_rec, sizeof(aui8_rec), &ui16_len)) &&
+               (si32_ts <= (si32_from + (int32_t)ui32_span * 60)))
+        {
+        }
+        ui32_scan_pages += ps_reader->ui32_page_reads;
+    }
+    uint64_t ns_scan = (nowNs() - ns_start) / 3;
+
+    printf("--- query bench: store %u intervals (%.1f days, %u B each, %.0f B coded) in %u segments, %.1f MiB; full scan to the middle %.2f ms, %u pages; %u errors ---\r\n",
+           (unsigned)ui32_stored, ui32_stored / 1440.0, (unsigned)ui32_rec_len,
+           (double)s_codec.ui64_coded_bytes / (s_codec.ui32_keys + s_codec.ui32_deltas), (unsigned)s_log.ui8_segs,
+           (double)s_log.ui8_segs * K_DLOG_SEGMENT_PAGES * K_DLOG_PAGE_SIZE / (1024.0 * 1024.0), ns_scan / 1e6,
+           (unsigned)(ui32_scan_pages / 3), (unsigned)ui32_bad);
+
+    clearDir(PC_DIR);
+
+    return ui32_bad;
+}
+
+/* n days of 1 min monitor payloads: coded in memory (codec alone), then into a raw and a coded
+   data log, both remounted, read back, compared & searched */
+static uint32_t codecBench(uint32_t ui32_days)
+{
+    static const char      *PC_RAW   = K_STORAGE_BASE_PATH "/codec_raw";
+    static const char      *PC_CODED = K_STORAGE_BASE_PATH "/codec_coded";
+    static const int32_t    SI32_TS0 = 1780000000;
+    static dlog_st          s_log;
+    static dlog_reader_st   s_reader;
+    static mon_codec_st     s_codec;
+    static uint8_t          aui8_rec[K_DLOG_MAX_REC_LEN];
+    uint32_t                ui32_records = ui32_days * 1440;
+    uint32_t                aui32_energy[3 * 5] = { 0 };
+    uint8_t                *pui8_raw   = (uint8_t *)malloc((size_t)ui32_records * K_MON_CODEC_MAX_LEN);
+    uint8_t                *pui8_coded = (uint8_t *)malloc((size_t)ui32_records * (K_MON_CODEC_MAX_LEN + 1));
+    uint16_t               *pui16_raw_len   = (uint16_t *)calloc(ui32_records, sizeof(uint16_t));
+    uint16_t               *pui16_coded_len = (uint16_t *)calloc(ui32_records, sizeof(uint16_t));
+    uint64_t                ui64_raw = 0;
+    uint64_t                ui64_coded = 0;
+    uint32_t                ui32_bad = 0;
+    uint64_t                ns_start;
+
+    if ((NULL == pui8_raw) || (NULL == pui8_coded) || (NULL == pui16_raw_len) || (NULL == pui16_coded_len))
+    {
+        printf("--- codec bench: %u days don't fit in memory ---\r\n", (unsigned)ui32_days);
+        free(pui8_raw);
+        free(pui8_coded);
+        free(pui16_raw_len);
+        free(pui16_coded_len);
+        return 1;
+    }
+
+    for (uint32_t i = 0; i < ui32_records; i++)
+    {
+        pui16_raw_len[i] = codecBenchRecord(i, SI32_TS0 + (int32_t)(i * 60), aui32_energy,
+                                            &pui8_raw[(size_t)i * K_MON_CODEC_MAX_LEN], K_MON_CODEC_MAX_LEN);
+        ui64_raw += pui16_raw_len[i];
+    }
+
+    // the codec alone: one key record, then deltas
+    monCodecInit(&s_codec);
+    ns_start = nowNs();
+    for (uint32_t i = 0; i < ui32_records; i++)
+    {
+        pui16_coded_len[i] = monCodecEncode(&s_codec, &pui8_raw[(size_t)i * K_MON_CODEC_MAX_LEN], pui16_raw_len[i], false,
+                                            &pui8_coded[(size_t)i * (K_MON_CODEC_MAX_LEN + 1)], K_MON_CODEC_MAX_LEN + 1);
+        ui64_coded += pui16_coded_len[i];
+    }
+    uint64_t ns_encode = nowNs() - ns_start;
+
+    monCodecInit(&s_codec);
+    ns_start = nowNs();
+    for (uint32_t i = 0; i < ui32_records; i++)
+    {
+        ui32_bad += (false == monCodecDecode(&s_codec, &pui8_coded[(size_t)i * (K_MON_CODEC_MAX_LEN + 1)], pui16_coded_len[i])) ? 1 : 0;
+    }
+    uint64_t ns_decode = nowNs() - ns_start;
+    ui32_bad += ((s_codec.ui16_prev_len != pui16_raw_len[ui32_records - 1]) ||
+                 (0 != memcmp(s_codec.aui8_prev, &pui8_raw[(size_t)(ui32_records - 1) * K_MON_CODEC_MAX_LEN], s_codec.ui16_prev_len))) ? 1 : 0;
+
+    // both logs: append, remount, read back in order, then random seeks
+    uint64_t    ans_append[2];
+    uint64_t    ans_read[2];
+    uint64_t    ans_seek[2];
+    uint32_t    aui32_pages[2];
+    uint32_t    aui32_first[2];
+    uint32_t    ui32_seeks = 1000;
+
+    for (uint8_t c = 0; c < 2; c++)
+    {
+        const char *pc_dir = (0 == c) ? PC_RAW : PC_CODED;
+        uint32_t    ui32_read = 0;
+        int32_t     si32_ts;
+        uint16_t    ui16_len;
+
+        mkdir(pc_dir, 0755);
+        clearDir(pc_dir);
+        (void)dlogInit(&s_log, pc_dir);
+        monCodecInit(&s_codec);
+
+        ns_start = nowNs();
+        for (uint32_t i = 0; i < ui32_records; i++)
+        {
+            const uint8_t  *pui8_payload = &pui8_raw[(size_t)i * K_MON_CODEC_MAX_LEN];
+            int32_t         si32_rec_ts  = SI32_TS0 + (int32_t)(i * 60);
+
+            ui32_bad += (false == ((0 == c) ? dlogAppend(&s_log, si32_rec_ts, pui8_payload, pui16_raw_len[i]) :
+                                              monCodecAppend(&s_codec, &s_log, si32_rec_ts, pui8_payload, pui16_raw_len[i]))) ? 1 : 0;
+        }
+        (void)dlogFlush(&s_log, 0, true);
+        ans_append[c]  = nowNs() - ns_start;
+        aui32_pages[c] = (s_log.ui32_segs_dropped + s_log.ui8_segs - 1) * K_DLOG_SEGMENT_PAGES + s_log.ui16_page + 1;
+
+        (void)dlogInit(&s_log, pc_dir);
+        dlogReaderInit(&s_reader);
+        monCodecInit(&s_codec);
+        aui32_first[c] = ui32_records;
+        ns_start = nowNs();
+        while (true == ((0 == c) ? dlogRead(&s_log, &s_reader, NULL, &si32_ts, aui8_rec, sizeof(aui8_rec), &ui16_len) :
+                                   monCodecRead(&s_codec, &s_log, &s_reader, NULL, &si32_ts, aui8_rec, sizeof(aui8_rec), &ui16_len)))
+        {
+            uint32_t i = (uint32_t)(si32_ts - SI32_TS0) / 60;
+
+            aui32_first[c] = (0 == ui32_read) ? i : aui32_first[c];
+            ui32_bad += ((i != (aui32_first[c] + ui32_read)) || (ui16_len != pui16_raw_len[i]) ||
+                         (0 != memcmp(aui8_rec, &pui8_raw[(size_t)i * K_MON_CODEC_MAX_LEN], ui16_len))) ? 1 : 0;
+            ui32_read++;
+        }
+        ans_read[c] = (nowNs() - ns_start) / (ui32_read ? ui32_read : 1);
+        ui32_bad   += ((aui32_first[c] + ui32_read) != ui32_records) ? 1 : 0;
+
+        uint32_t ui32_lcg = 4711;
+
+        ns_start = nowNs();
+        for (uint32_t s = 0; s < ui32_seeks; s++)
+        {
+            ui32_lcg = ui32_lcg * 1664525UL + 1013904223UL;
+            uint32_t i = aui32_first[c] + (ui32_lcg >> 8) % (ui32_records - aui32_first[c]);
+
+            dlogSeek(&s_log, &s_reader, SI32_TS0 + (int32_t)(i * 60));
+            if ((false == ((0 == c) ? dlogRead(&s_log, &s_reader, NULL, &si32_ts, aui8_rec, sizeof(aui8_rec), &ui16_len) :
+                                      monCodecRead(&s_codec, &s_log, &s_reader, NULL, &si32_ts, aui8_rec, sizeof(aui8_rec), &ui16_len))) ||
+                (si32_ts != (SI32_TS0 + (int32_t)(i * 60))) || (ui16_len != pui16_raw_len[i]) ||
+                (0 != memcmp(aui8_rec, &pui8_raw[(size_t)i * K_MON_CODEC_MAX_LEN], ui16_len)))
+            {
+                ui32_bad++;
+            }
+        }
+        ans_seek[c] = (nowNs() - ns_start) / ui32_seeks;
+        clearDir(pc_dir);
+    }
+    ui32_bad += s_codec.ui32_errors;
+
+    double d_log_pages = (double)K_DLOG_MAX_SEGMENTS * K_DLOG_SEGMENT_PAGES;
+
+    printf("--- codec bench: %u intervals (%u days), payload %.1f B -> %.1f B coded, %.2fx; record + header %.1f B -> %.1f B ---\r\n",
+           (unsigned)ui32_records, (unsigned)ui32_days, (double)ui64_raw / ui32_records, (double)ui64_coded / ui32_records,
+           ui64_coded ? (double)ui64_raw / ui64_coded : 0.0, (double)ui64_raw / ui32_records + K_DLOG_REC_HDR_LEN,
+           (double)ui64_coded / ui32_records + K_DLOG_REC_HDR_LEN);
+    printf("--- codec bench: encode %.0f ns / decode %.0f ns per record; log append %.0f -> %.0f ns, read %.0f -> %.0f ns, seek %.1f -> %.1f us (%u resyncs) ---\r\n",
+           (double)ns_encode / ui32_records, (double)ns_decode / ui32_records, (double)ans_append[0] / ui32_records,
+           (double)ans_append[1] / ui32_records, (double)ans_read[0], (double)ans_read[1], ans_seek[0] / 1000.0, ans_seek[1] / 1000.0,
+           (unsigned)s_codec.ui32_resyncs);
+    printf("--- codec bench: %u -> %u pages (%.2fx), the %u MiB log holds %.1f -> %.1f days; %u errors ---\r\n",
+           (unsigned)aui32_pages[0], (unsigned)aui32_pages[1], aui32_pages[1] ? (double)aui32_pages[0] / aui32_pages[1] : 0.0,
+           (unsigned)(d_log_pages * K_DLOG_PAGE_SIZE / (1024 * 1024)), d_log_pages * ui32_days / aui32_pages[0],
+           d_log_pages * ui32_days / aui32_pages[1], (unsigned)ui32_bad);
+
+    free(pui8_raw);
+    free(pui8_coded);
+    free(pui16_raw_len);
+    free(pui16_coded_len);
+
+    return ui32_bad;
+}
+
+#define K_JOURNAL_FAULT_MAX_INTERVALS   4000
+#define K_JOURNAL_FAULT_MAX_CUT         (1024 * 1024)   // bytes written before the power goes
+#define K_JOURNAL_FAULT_RESTART         50              // intervals logged after the recovery
+
+typedef struct
+{
+    dlog_st         s_log;
+    energy_acc_st   s_energy;
+    journal_st      s_journal;
+    mon_codec_st    s_codec;
+    uint8_t        *pui8_payload;                       // K_MON_CODEC_MAX_LEN per interval
+    uint16_t        aui16_len[K_JOURNAL_FAULT_MAX_INTERVALS];
+    uint32_t        aui32_energy[3 * 5];                // counters of the payloads
+    uint64_t        ui64_energy;                        // phase 1 import register ...
+    uint64_t        ui64_energy_acked;                  // ... of the last snapshot or checkpoint written
+    uint32_t        ui32_energy_seq;                    // newest snapshot in the journal
+} journal_fault_st;
+
+static const char      *PC_JOURNAL_FAULT_DIR     = K_STORAGE_BASE_PATH "/journal_fault";
+static const char      *PC_JOURNAL_FAULT_FILE    = K_STORAGE_BASE_PATH "/journal_fault.bin";
+static const char      *PC_JOURNAL_FAULT_ENERGY  = K_STORAGE_BASE_PATH "/journal_fault_energy.bin";
+static const int32_t    SI32_JOURNAL_FAULT_TS0   = 1780000000;
+
+static journal_fault_st s_fault;
+
+static bool journalFaultReplay(void *pv_ctx, journal_stream_et e_stream, uint32_t ui32_seq, const uint8_t *pui8_data, uint16_t ui16_len)
+{
+    journal_fault_st *ps_bench = (journal_fault_st *)pv_ctx;
+
+    if (JOURNAL_STREAM_DLOG == e_stream)
+    {
+        return dlogReplay(&ps_bench->s_log, ui32_seq, pui8_data, ui16_len);
+    }
+    (void)energyAccApply(&ps_bench->s_energy, pui8_data, ui16_len);
+    ps_bench->ui32_energy_seq = ui32_seq;
+
+    return true;
+}
+
+/* same order as "data_logging": pages, energy checkpoint, then the journal (& its stage with
+   K_JOURNAL_SYNC_MIN) unless b_journal */
+static void journalFaultBoot(journal_fault_st *ps_bench, bool b_journal)
+{
+    static uint8_t aui8_stage[K_JOURNAL_STAGE_SECTORS * K_JOURNAL_SECTOR_SIZE];
+
+    (void)dlogInit(&ps_bench->s_log, PC_JOURNAL_FAULT_DIR);
+    monCodecInit(&ps_bench->s_codec);
+    energyAccInit(&ps_bench->s_energy, 3, PC_JOURNAL_FAULT_ENERGY);
+    (void)energyAccRestore(&ps_bench->s_energy);
+    ps_bench->ui32_energy_seq = 0;
+    if (true == b_journal)
+    {
+        (void)journalOpen(&ps_bench->s_journal, PC_JOURNAL_FAULT_FILE, journalFaultReplay, ps_bench);
+        if (0 != ps_bench->ui32_energy_seq)
+        {
+            journalRelease(&ps_bench->s_journal, JOURNAL_STREAM_ENERGY, ps_bench->ui32_energy_seq - 1);
+        }
+        dlogJournal(&ps_bench->s_log, &ps_bench->s_journal);
+        if (0 != K_JOURNAL_SYNC_MIN)
+        {
+            (void)journalStage(&ps_bench->s_journal, aui8_stage, K_JOURNAL_STAGE_SECTORS);
+        }
+    }
+    ps_bench->ui64_energy = ps_bench->s_energy.as_phase[0].aui64_mwms[ENERGY_IMPORT];
+}
+
+/* interval i as "data_logging" emits it: monitor payload, flush, energy snapshot & journal write
+   when due, checkpoint; true if the record and the ones before it were acknowledged (written
+   with the journal) */
+static bool journalFaultInterval(journal_fault_st *ps_bench, uint32_t i)
+{
+    uint8_t     aui8_snapshot[K_ENERGY_SNAPSHOT_LEN];
+    uint32_t    ui32_misses = ps_bench->s_log.ui32_journal_misses;
+    uint32_t    ui32_seq;
+    uint8_t    *pui8_payload = &ps_bench->pui8_payload[(size_t)i * K_MON_CODEC_MAX_LEN];
+    int32_t     si32_ts = SI32_JOURNAL_FAULT_TS0 + (int32_t)(i * 60);
+    uint32_t    ms_now  = i * 60000UL;
+    bool        b_acked;
+
+    for (uint8_t p = 0; p < 3; p++)
+    {
+        for (uint8_t r = 0; r < ENERGY_NUM_REGS; r++)
+        {
+            ps_bench->s_energy.as_phase[p].aui64_mwms[r] += ((i % 7) + 1 + p + r) * K_ENERGY_MWMS_PER_WH / 10;
+        }
+    }
+    ps_bench->ui64_energy = ps_bench->s_energy.as_phase[0].aui64_mwms[ENERGY_IMPORT];
+
+    ps_bench->aui16_len[i] = codecBenchRecord(i, si32_ts, ps_bench->aui32_energy, pui8_payload, K_MON_CODEC_MAX_LEN);
+    b_acked = monCodecAppend(&ps_bench->s_codec, &ps_bench->s_log, si32_ts, pui8_payload, ps_bench->aui16_len[i]) &&
+              (ui32_misses == ps_bench->s_log.ui32_journal_misses);
+    (void)dlogFlush(&ps_bench->s_log, ms_now, false);
+
+    if (false == journalDue(&ps_bench->s_journal, ms_now))
+    {
+        b_acked = false;
+    }
+    else
+    {
+        uint16_t ui16_len      = energyAccSnapshot(&ps_bench->s_energy, aui8_snapshot, sizeof(aui8_snapshot));
+        bool     b_energy      = journalAppend(&ps_bench->s_journal, JOURNAL_STREAM_ENERGY, NULL, 0, aui8_snapshot, ui16_len, &ui32_seq);
+
+        if (true == b_energy)
+        {
+            journalRelease(&ps_bench->s_journal, JOURNAL_STREAM_ENERGY, ui32_seq - 1);
+        }
+        b_acked = journalSync(&ps_bench->s_journal, ms_now, true) && (false == hostStorageIsCut()) && b_acked;
+        if ((true == b_energy) && (true == b_acked))
+        {
+            ps_bench->ui64_energy_acked = ps_bench->ui64_energy;
+        }
+    }
+    if (true == energyAccCheckpoint(&ps_bench->s_energy, ms_now, false))
+    {
+        ps_bench->ui64_energy_acked = ps_bench->ui64_energy;
+    }
+
+    return b_acked && (false == hostStorageIsCut());
+}
+
+/* records of the log from interval 0 on, each byte for byte the one logged; the number read */
+static uint32_t journalFaultVerify(journal_fault_st *ps_bench, uint32_t *pui32_errors)
+{
+    static dlog_reader_st   s_reader;
+    static mon_codec_st     s_codec;
+    static uint8_t          aui8_rec[K_DLOG_MAX_REC_LEN];
+    uint32_t                ui32_read = 0;
+    int32_t                 si32_ts;
+    uint16_t                ui16_len;
+
+    dlogReaderInit(&s_reader);
+    monCodecInit(&s_codec);
+    while (true == monCodecRead(&s_codec, &ps_bench->s_log, &s_reader, NULL, &si32_ts, aui8_rec, sizeof(aui8_rec), &ui16_len))
+    {
+        if ((ui32_read >= K_JOURNAL_FAULT_MAX_INTERVALS) ||
+            (si32_ts != (SI32_JOURNAL_FAULT_TS0 + (int32_t)(ui32_read * 60))) || (ui16_len != ps_bench->aui16_len[ui32_read]) ||
+            (0 != memcmp(aui8_rec, &ps_bench->pui8_payload[(size_t)ui32_read * K_MON_CODEC_MAX_LEN], ui16_len)))
+        {
+            (*pui32_errors)++;
+            break;
+        }
+        ui32_read++;
+    }
+    *pui32_errors += s_codec.ui32_errors;
+
+    return ui32_read;
+}
+
+/* n runs of the data logger, each cut at a random byte of its writes: the torn page or entry
+   stays on the volume. The reboot has to bring back every acknowledged record in order and
+   the energy of the last snapshot; then the logger goes on and is rebooted once more. The
+   same cut recovered without the journal (pages & energy checkpoint alone) for comparison. */
+static uint32_t journalFault(uint32_t ui32_trials)
+{
+    journal_fault_st   *ps_bench = &s_fault;
+    uint64_t            ui64_lcg = 4711;
+    uint32_t            ui32_cuts = 0;
+    uint32_t            ui32_intervals = 0;
+    uint64_t            ns_recovery = 0;
+    uint64_t            ns_recovery_max = 0;
+    uint64_t            ui64_replayed = 0;
+    uint32_t            ui32_torn = 0;
+    uint32_t            ui32_lost = 0;
+    uint32_t            ui32_errors = 0;
+    uint32_t            ui32_energy_lost = 0;
+    uint32_t            ui32_restart_errors = 0;
+    uint64_t            ui64_lost_plain = 0;
+    uint32_t            ui32_lost_plain_max = 0;
+    uint64_t            ui64_mwms_lost_plain = 0;
+
+    ps_bench->pui8_payload = (uint8_t *)malloc((size_t)K_JOURNAL_FAULT_MAX_INTERVALS * K_MON_CODEC_MAX_LEN);
+    if (NULL == ps_bench->pui8_payload)
+    {
+        printf("--- journal fault: no memory ---\r\n");
+        return 1;
+    }
+    mkdir(PC_JOURNAL_FAULT_DIR, 0755);
+
+    for (uint32_t t = 0; t < ui32_trials; t++)
+    {
+        uint32_t    ui32_acked = 0;
+        uint32_t    ui32_sent = 0;
+        uint32_t    ui32_read;
+        uint64_t    ns_start;
+
+        clearDir(PC_JOURNAL_FAULT_DIR);
+        remove(PC_JOURNAL_FAULT_FILE);
+        remove(PC_JOURNAL_FAULT_ENERGY);
+        memset(ps_bench->aui32_energy, 0, sizeof(ps_bench->aui32_energy));
+        ps_bench->ui64_energy_acked = 0;
+        journalFaultBoot(ps_bench, true);
+
+        ui64_lcg = ui64_lcg * 6364136223846793005ULL + 1442695040888963407ULL;
+        hostStorageCut((ui64_lcg >> 33) % K_JOURNAL_FAULT_MAX_CUT);
+        while ((false == hostStorageIsCut()) && (ui32_sent < K_JOURNAL_FAULT_MAX_INTERVALS))
+        {
+            ui32_acked = (true == journalFaultInterval(ps_bench, ui32_sent)) ? (ui32_sent + 1) : ui32_acked;
+            ui32_sent++;
+        }
+        hostStorageRestore();
+
+        uint64_t ui64_energy_cut = ps_bench->ui64_energy;
+
+        if (ui32_sent >= K_JOURNAL_FAULT_MAX_INTERVALS)
+        {
+            continue;
+        }
+        ui32_cuts++;
+        ui32_intervals += ui32_sent;
+
+        // without the journal
+        uint32_t ui32_plain_errors = 0;
+        uint32_t ui32_plain_lost;
+
+        journalFaultBoot(ps_bench, false);
+        ui32_read            = journalFaultVerify(ps_bench, &ui32_plain_errors);
+        ui32_plain_lost      = (ui32_acked > ui32_read) ? (ui32_acked - ui32_read) : 0;
+        ui64_lost_plain     += ui32_plain_lost;
+        ui32_lost_plain_max  = (ui32_plain_lost > ui32_lost_plain_max) ? ui32_plain_lost : ui32_lost_plain_max;
+        ui64_mwms_lost_plain += (ps_bench->ui64_energy < ps_bench->ui64_energy_acked) ? (ps_bench->ui64_energy_acked - ps_bench->ui64_energy) : 0;
+
+        // with it
+        ns_start = nowNs();
+        journalFaultBoot(ps_bench, true);
+        uint64_t ns_boot = nowNs() - ns_start;
+
+        ns_recovery     += ns_boot;
+        ns_recovery_max  = (ns_boot > ns_recovery_max) ? ns_boot : ns_recovery_max;
+        ui64_replayed   += ps_bench->s_journal.ui32_replayed;
+        ui32_torn       += ps_bench->s_journal.ui32_torn;
+
+        ui32_read    = journalFaultVerify(ps_bench, &ui32_errors);
+        ui32_lost   += (ui32_acked > ui32_read) ? (ui32_acked - ui32_read) : 0;
+        ui32_errors += (ui32_read > ui32_sent) ? 1 : 0;
+        ui32_energy_lost += (ps_bench->ui64_energy < ps_bench->ui64_energy_acked) ? 1 : 0;
+        ui32_errors += (ps_bench->ui64_energy > ui64_energy_cut) ? 1 : 0;
+
+        // the logger goes on from the restored state, then the power goes between two intervals:
+        // what was acknowledged since comes back, the staged rest may not
+        uint32_t ui32_restart_acked = ui32_read;
+        uint32_t ui32_restart_sent  = ui32_read + K_JOURNAL_FAULT_RESTART;
+
+        ps_bench->ui64_energy_acked = ps_bench->ui64_energy;
+        for (uint32_t i = ui32_read; i < ui32_restart_sent; i++)
+        {
+            ui32_restart_acked = (true == journalFaultInterval(ps_bench, i)) ? (i + 1) : ui32_restart_acked;
+        }
+        uint64_t ui64_energy_restart = ps_bench->ui64_energy;
+        uint64_t ui64_energy_restart_acked = ps_bench->ui64_energy_acked;
+
+        journalFaultBoot(ps_bench, true);
+        ui32_read = journalFaultVerify(ps_bench, &ui32_restart_errors);
+        ui32_restart_errors += ((ui32_read < ui32_restart_acked) || (ui32_read > ui32_restart_sent)) ? 1 : 0;
+        ui32_restart_errors += ((ps_bench->ui64_energy < ui64_energy_restart_acked) || (ps_bench->ui64_energy > ui64_energy_restart)) ? 1 : 0;
+    }
+
+    clearDir(PC_JOURNAL_FAULT_DIR);
+    remove(PC_JOURNAL_FAULT_FILE);
+    remove(PC_JOURNAL_FAULT_ENERGY);
+    free(ps_bench->pui8_payload);
+
+    printf("--- journal fault: %u power cuts after 0..%u KiB written (%.0f intervals avg), recovery %.2f ms avg / %.2f ms max, "
+           "%.1f entries replayed, %u torn ---\r\n",
+           (unsigned)ui32_cuts, (unsigned)(K_JOURNAL_FAULT_MAX_CUT / 1024), ui32_cuts ? (double)ui32_intervals / ui32_cuts : 0.0,
+           ui32_cuts ? ns_recovery / 1e6 / ui32_cuts : 0.0, ns_recovery_max / 1e6, ui32_cuts ? (double)ui64_replayed / ui32_cuts : 0.0,
+           (unsigned)ui32_torn);
+    printf("--- journal fault: acknowledged records lost %u, energy snapshots lost %u, errors %u, restart errors %u; "
+           "without the journal %.1f records (max %u) & %.1f Wh lost per cut ---\r\n",
+           (unsigned)ui32_lost, (unsigned)ui32_energy_lost, (unsigned)ui32_errors, (unsigned)ui32_restart_errors,
+           ui32_cuts ? (double)ui64_lost_plain / ui32_cuts : 0.0, (unsigned)ui32_lost_plain_max,
+           ui32_cuts ? (double)ui64_mwms_lost_plain / K_ENERGY_MWMS_PER_WH / ui32_cuts : 0.0);
+
+    return ui32_lost + ui32_energy_lost + ui32_errors + ui32_restart_errors;
+}
+
+#define K_FLUSH_SIM_VOLUME_SECTORS      (13 * 1024 * 1024 / K_DLOG_PAGE_SIZE)
+
+typedef struct
+{
+    const char *pc_name;
+    bool        b_journal;
+    uint8_t     ui8_sync_min;                       // journal written every n intervals, 0: when journalDue() (K_JOURNAL_SYNC_MIN)
+    uint8_t     ui8_stage;                          // journal stage sectors, 0: written at each sector change
+    uint16_t    ui16_ring;                          // pages, 0: each page written when full
+    bool        b_power_fail;                       // POWER_GOOD signalled: no periodic flush, one forced a day
+} flush_sim_cfg_st;
+
+static const flush_sim_cfg_st AS_FLUSH_SIM_CFG[] =
+{
+    { "page when full, hourly flush",   false,  0,      0,                          0,                          false },
+    { "journal, page when full",        true,   0,      0,                          0,                          false },
+    { "journal, PSRAM ring (default)",  true,   0,      0,                          K_DLOG_PSRAM_RING_PAGES,    false },
+    { "journal, RAM ring (no PSRAM)",   true,   0,      0,                          K_DLOG_RAM_RING_PAGES,      false },
+    { "journal, 15 min sync, no stage", true,   15,     0,                          K_DLOG_RAM_RING_PAGES,      false },
+    { "journal, 15 min sync, staged",   true,   15,     K_JOURNAL_STAGE_SECTORS,    K_DLOG_RAM_RING_PAGES,      false },
+    { "PSRAM ring, power fail signal",  false,  0,      0,                          K_DLOG_PSRAM_RING_PAGES,    true  },
+};
+
+/* the data logger over n days of 1 min intervals with each flush strategy: sector writes of the
+   wear levelling layer (data log, journal, energy checkpoints), flush sizes, and the log read
+   back before & after the final flush */
+static uint32_t flushSim(uint32_t ui32_days)
+{
+    static const char      *PC_DIR     = K_STORAGE_BASE_PATH "/flush_sim";
+    static const char      *PC_JOURNAL = K_STORAGE_BASE_PATH "/flush_sim.bin";
+    static const char      *PC_ENERGY  = K_STORAGE_BASE_PATH "/flush_sim_energy.bin";
+    static const int32_t    SI32_TS0   = 1780000000;
+    static dlog_st          s_log;
+    static dlog_reader_st   s_reader;
+    static mon_codec_st     s_codec;
+    static journal_st       s_journal;
+    static energy_acc_st    s_energy;
+    static uint8_t          aui8_ring[K_DLOG_MAX_RING_PAGES * K_DLOG_PAGE_SIZE];
+    static uint8_t          aui8_stage[K_JOURNAL_STAGE_SECTORS * K_JOURNAL_SECTOR_SIZE];
+    static uint8_t          aui8_payload[K_MON_CODEC_MAX_LEN];
+    static uint8_t          aui8_rec[K_DLOG_MAX_REC_LEN];
+    uint32_t                ui32_intervals = ui32_days * 1440;
+    uint32_t                ui32_errors = 0;
+    double                  d_baseline = 0.0;
+
+    mkdir(PC_DIR, 0755);
+    for (uint8_t c = 0; c < (sizeof(AS_FLUSH_SIM_CFG) / sizeof(AS_FLUSH_SIM_CFG[0])); c++)
+    {
+        const flush_sim_cfg_st *ps_cfg = &AS_FLUSH_SIM_CFG[c];
+        uint32_t                aui32_energy[3 * 5] = { 0 };
+        uint32_t                ui32_bad = 0;
+        uint32_t                ui32_flushes = 0;
+        uint32_t                ui32_writes;
+        uint32_t                ui32_pages;
+        host_storage_stats_st   s_stats;
+
+        clearDir(PC_DIR);
+        remove(PC_JOURNAL);
+        remove(PC_ENERGY);
+        (void)dlogInit(&s_log, PC_DIR);
+        if (0 != ps_cfg->ui16_ring)
+        {
+            (void)dlogRing(&s_log, aui8_ring, ps_cfg->ui16_ring);
+        }
+        monCodecInit(&s_codec);
+        (void)journalOpen(&s_journal, PC_JOURNAL, journalFaultReplay, NULL);
+        if (0 != ps_cfg->ui8_stage)
+        {
+            (void)journalStage(&s_journal, aui8_stage, ps_cfg->ui8_stage);
+        }
+        if (true == ps_cfg->b_journal)
+        {
+            dlogJournal(&s_log, &s_journal);
+        }
+        energyAccInit(&s_energy, 3, PC_ENERGY);
+
+        hostStorageResetStats();
+        for (uint32_t i = 0; i < ui32_intervals; i++)
+        {
+            uint32_t    ms_now  = i * 60000UL;
+            int32_t     si32_ts = SI32_TS0 + (int32_t)(i * 60);
+            uint16_t    ui16_len;
+
+            for (uint8_t p = 0; p < 3; p++)
+            {
+                for (uint8_t r = 0; r < ENERGY_NUM_REGS; r++)
+                {
+                    s_energy.as_phase[p].aui64_mwms[r] += ((i % 7) + 1 + p + r) * K_ENERGY_MWMS_PER_WH / 10;
+                }
+            }
+            ui16_len  = codecBenchRecord(i, si32_ts, aui32_energy, aui8_payload, sizeof(aui8_payload));
+            ui32_bad += (false == monCodecAppend(&s_codec, &s_log, si32_ts, aui8_payload, ui16_len)) ? 1 : 0;
+
+            if (false == ps_cfg->b_power_fail)
+            {
+                (void)dlogFlush(&s_log, ms_now, false);
+            }
+            else if ((i % 1440) == ((i / 1440) * 397 % 1440))
+            {
+                // the day's power fail
+                (void)energyAccCheckpoint(&s_energy, ms_now, true);
+                ui32_flushes += (true == dlogFlush(&s_log, ms_now, true)) ? 1 : 0;
+            }
+            if ((true == ps_cfg->b_journal) &&
+                ((0 == ps_cfg->ui8_sync_min) ? (true == journalDue(&s_journal, ms_now)) : (0 == (i % ps_cfg->ui8_sync_min))))
+            {
+                uint8_t     aui8_snapshot[K_ENERGY_SNAPSHOT_LEN];
+                uint32_t    ui32_seq;
+
+                ui16_len = energyAccSnapshot(&s_energy, aui8_snapshot, sizeof(aui8_snapshot));
+                if (true == journalAppend(&s_journal, JOURNAL_STREAM_ENERGY, NULL, 0, aui8_snapshot, ui16_len, &ui32_seq))
+                {
+                    journalRelease(&s_journal, JOURNAL_STREAM_ENERGY, ui32_seq - 1);
+                }
+                ui32_bad += (false == journalSync(&s_journal, ms_now, true)) ? 1 : 0;
+            }
+            (void)energyAccCheckpoint(&s_energy, ms_now, false);
+        }
+        hostStorageGetStats(&s_stats);
+        ui32_bad      += s_log.ui32_journal_misses;
+        ui32_writes    = s_log.ui32_writes;
+        ui32_pages     = s_log.ui32_page_writes;
+
+        // ring, RAM page & flash, then flash alone
+        for (uint8_t r = 0; r < 2; r++)
+        {
+            uint32_t    ui32_read = 0;
+            int32_t     si32_ts;
+            uint16_t    ui16_len;
+
+            if (1 == r)
+            {
+                (void)dlogFlush(&s_log, 0, true);
+                (void)dlogInit(&s_log, PC_DIR);
+            }
+            dlogReaderInit(&s_reader);
+            monCodecInit(&s_codec);
+            while (true == monCodecRead(&s_codec, &s_log, &s_reader, NULL, &si32_ts, aui8_rec, sizeof(aui8_rec), &ui16_len))
+            {
+                ui32_bad += (si32_ts != (SI32_TS0 + (int32_t)(ui32_read * 60))) ? 1 : 0;
+                ui32_read++;
+            }
+            ui32_bad += (ui32_read != ui32_intervals) ? 1 : 0;
+        }
+
+        double d_per_day = (double)s_stats.ui64_sectors / ui32_days;
+
+        d_baseline = (0 == c) ? d_per_day : d_baseline;
+        printf("--- flush sim: %-30s %7.0f sector writes/day (%5.2fx the first), %5.2f erases/sector/year; "
+               "%u log writes of %.1f KiB avg, %u journal entries in %u writes, %u power fail flushes, %u errors ---\r\n",
+               ps_cfg->pc_name, d_per_day, d_baseline ? d_per_day / d_baseline : 0.0,
+               d_per_day * 365 / K_FLUSH_SIM_VOLUME_SECTORS, (unsigned)ui32_writes,
+               ui32_writes ? (double)ui32_pages * (K_DLOG_PAGE_SIZE / 1024) / ui32_writes : 0.0,
+               (unsigned)s_journal.ui32_appends, (unsigned)s_journal.ui32_syncs, (unsigned)ui32_flushes, (unsigned)ui32_bad);
+        ui32_errors += ui32_bad;
+    }
+
+    clearDir(PC_DIR);
+    remove(PC_JOURNAL);
+    remove(PC_ENERGY);
+
+    return ui32_errors;
+}
+
+// per 4 KiB sector the wear levelling layer writes: erase & program, a sector moved every 16 erases
+#define K_FLASH_BENCH_SECTOR_US         (K_HOST_FLASH_SECTOR_ERASE_US + (K_DLOG_PAGE_SIZE / 256) * K_HOST_FLASH_PROGRAM_US)
+#define K_FLASH_BENCH_WL_UPDATE         (16)
+
+/* the data log in segment files of the FAT volume (flash time after the sector model, spread over
+   the volume by the wear levelling) and in a raw partition of the flash emulator, without and
+   with the PSRAM ring, hourly partial page flushes */
+static uint32_t flashBench(uint32_t ui32_days)
+{
+    static const char      *PC_DIR   = K_STORAGE_BASE_PATH "/flash_bench";
+    static const int32_t    SI32_TS0 = 1780000000;
+    static dlog_st          s_log;
+    static dlog_reader_st   s_reader;
+    static mon_codec_st     s_codec;
+    static uint8_t          aui8_ring[K_DLOG_MAX_RING_PAGES * K_DLOG_PAGE_SIZE];
+    static uint8_t          aui8_payload[K_MON_CODEC_MAX_LEN];
+    static uint8_t          aui8_rec[K_DLOG_MAX_REC_LEN];
+    const esp_partition_t  *ps_part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "bench");
+    uint32_t                ui32_intervals = ui32_days * 1440;
+    uint32_t                ui32_errors = 0;
+
+    if (NULL == ps_part)
+    {
+        printf("--- flash bench: no emulated partition ---\r\n");
+        return 1;
+    }
+
+    mkdir(PC_DIR, 0755);
+    for (uint8_t c = 0; c < 4; c++)
+    {
+        bool                    b_raw  = (c >= 2);
+        uint16_t                ui16_ring = (0 != (c % 2)) ? K_DLOG_PSRAM_RING_PAGES : 0;
+        uint32_t                aui32_energy[3 * 5] = { 0 };
+        uint32_t                ui32_bad = 0;
+        uint32_t                ui32_held = 0;
+        uint64_t                us_busy  = 0;
+        uint64_t                us_worst = 0;
+        uint64_t                ui64_erases;
+        uint64_t                us_mount = 0;
+        double                  d_wear;
+        uint64_t                ns_start;
+        double                  d_s;
+        host_storage_stats_st   s_storage;
+        host_flash_stats_st     s_flash;
+
+        clearDir(PC_DIR);
+        (void)esp_partition_erase_range(ps_part, 0, ps_part->size);
+        (void)((true == b_raw) ? dlogInitPartition(&s_log, ps_part) : dlogInit(&s_log, PC_DIR));
+        if (0 != ui16_ring)
+        {
+            (void)dlogRing(&s_log, aui8_ring, ui16_ring);
+        }
+        monCodecInit(&s_codec);
+        hostStorageResetStats();
+        hostFlashResetStats(ps_part);
+
+        ns_start = nowNs();
+        for (uint32_t i = 0; i < ui32_intervals; i++)
+        {
+            int32_t     si32_ts = SI32_TS0 + (int32_t)(i * 60);
+            uint16_t    ui16_len;
+            uint64_t    us_before;
+            uint64_t    us_after;
+
+            hostStorageGetStats(&s_storage);
+            hostFlashGetStats(ps_part, &s_flash);
+            us_before = (true == b_raw) ? s_flash.ui64_busy_us : s_storage.ui64_sectors * K_FLASH_BENCH_SECTOR_US;
+
+            ui16_len  = codecBenchRecord(i, si32_ts, aui32_energy, aui8_payload, sizeof(aui8_payload));
+            ui32_bad += (false == monCodecAppend(&s_codec, &s_log, si32_ts, aui8_payload, ui16_len)) ? 1 : 0;
+            (void)dlogFlush(&s_log, i * 60000UL, false);
+
+            hostStorageGetStats(&s_storage);
+            hostFlashGetStats(ps_part, &s_flash);
+            us_after = (true == b_raw) ? s_flash.ui64_busy_us : s_storage.ui64_sectors * K_FLASH_BENCH_SECTOR_US;
+            us_worst = ((us_after - us_before) > us_worst) ? (us_after - us_before) : us_worst;
+        }
+        d_s = (double)(nowNs() - ns_start) / 1e9;
+        (void)dlogFlush(&s_log, 0, true);
+
+        hostStorageGetStats(&s_storage);
+        hostFlashGetStats(ps_part, &s_flash);
+        if (true == b_raw)
+        {
+            ui64_erases = s_flash.ui32_erases;
+            us_busy     = s_flash.ui64_busy_us;
+            d_wear      = (double)s_flash.ui32_max_sector_erases * 365 / ui32_days;
+        }
+        else
+        {
+            ui64_erases = s_storage.ui64_sectors + (s_storage.ui64_sectors / K_FLASH_BENCH_WL_UPDATE);
+            us_busy     = ui64_erases * K_FLASH_BENCH_SECTOR_US;
+            d_wear      = (double)ui64_erases * 365 / ui32_days / K_FLUSH_SIM_VOLUME_SECTORS;
+        }
+        ui32_bad += (true == b_raw) ? s_flash.ui32_unerased : 0;
+
+        // remount, everything back
+        hostFlashGetStats(ps_part, &s_flash);
+        us_mount = s_flash.ui64_busy_us;
+        (void)((true == b_raw) ? dlogInitPartition(&s_log, ps_part) : dlogInit(&s_log, PC_DIR));
+        hostFlashGetStats(ps_part, &s_flash);
+        us_mount = s_flash.ui64_busy_us - us_mount;
+
+        // the oldest segments are dropped, the rest is in one piece up to the last interval
+        {
+            int32_t     si32_ts;
+            int32_t     si32_prev = 0;
+            uint16_t    ui16_len;
+
+            dlogReaderInit(&s_reader);
+            monCodecInit(&s_codec);
+            while (true == monCodecRead(&s_codec, &s_log, &s_reader, NULL, &si32_ts, aui8_rec, sizeof(aui8_rec), &ui16_len))
+            {
+                ui32_bad  += ((0 != ui32_held) && (si32_ts != (si32_prev + 60))) ? 1 : 0;
+                si32_prev  = si32_ts;
+                ui32_held++;
+            }
+            ui32_bad += (si32_prev != (SI32_TS0 + (int32_t)((ui32_intervals - 1) * 60))) ? 1 : 0;
+        }
+
+        printf("--- flash bench: %-9s %-15s %7.1f erases/day, %6.1f erases/sector/year%s, flash busy %6.1f s/day, worst interval %4u ms, "
+               "%6.0f records/s host%s; %.1f days held, %u errors ---\r\n",
+               (true == b_raw) ? "partition" : "FAT files", (0 != ui16_ring) ? "PSRAM ring," : "page when full,",
+               (double)ui64_erases / ui32_days, d_wear, (true == b_raw) ? " (most worn)" : " (levelled)",
+               (double)us_busy / 1e6 / ui32_days, (unsigned)(us_worst / 1000), ui32_intervals / d_s,
+               (true == b_raw) ? "" : " + fs", ui32_held / 1440.0, (unsigned)ui32_bad);
+        if (true == b_raw)
+        {
+            printf("--- flash bench: partition mount %.1f ms flash time (%u segments) ---\r\n", (double)us_mount / 1000, s_log.ui8_segs);
+        }
+        ui32_errors += ui32_bad;
+    }
+
+    clearDir(PC_DIR);
+
+    return ui32_errors;
+}
+
+/* value of phase & id in a monitor payload, false if it's not reported */
+static bool compactSimParam(const uint8_t *pui8_rec, uint16_t ui16_len, uint8_t ui8_phase, uint8_t ui8_id, uint32_t *pui32_val)
+{
+    uint16_t ui16_off = (uint16_t)(3 + pui8_rec[2] + 4);
+
+    while (ui16_off < ui16_len)
+    {
+        uint8_t ui8_group = pui8_rec[ui16_off++];
+
+        for (uint8_t p = 0; (p < (ui8_group & 0x1F)) && (ui16_off < ui16_len); p++)
+        {
+            uint8_t ui8_plen = edgePayloadMonitorParamLen(pui8_rec[ui16_off]);
+
+            if ((ui8_phase == (ui8_group >> 5)) && (ui8_id == pui8_rec[ui16_off]))
+            {
+                *pui32_val  = (uint32_t)pui8_rec[ui16_off + 1] | ((uint32_t)pui8_rec[ui16_off + 2] << 8);
+                *pui32_val |= (5 == ui8_plen) ? (((uint32_t)pui8_rec[ui16_off + 3] << 16) | ((uint32_t)pui8_rec[ui16_off + 4] << 24)) : 0;
+                return true;
+            }
+            ui16_off += ui8_plen;
+        }
+    }
+
+    return false;
+}
+
+/* aggregate record of a compacted tier against the 1 min payloads of its bucket, regenerated: the
+   voltage mean, min & max of every phase, exact from 1 min records, the mean within 1 from 15 min
+   means; the energy counters never go back */
+static uint32_t compactSimCheck(const uint8_t *pui8_rec, uint16_t ui16_len, int32_t si32_ts, int32_t si32_ts0, int32_t si32_bucket_s,
+                                uint32_t *pui32_energy)
+{
+    static uint8_t  aui8_src[K_MON_CODEC_MAX_LEN];
+    uint32_t        aui32_dummy[3 * 5] = { 0 };
+    uint32_t        ui32_bad = 0;
+    uint32_t        ui32_first = (uint32_t)(si32_ts - si32_ts0 + 59) / 60;
+    uint32_t        ui32_n = (uint32_t)si32_bucket_s / 60;
+
+    // the log's first bucket, partial
+    if (si32_ts < si32_ts0)
+    {
+        return 0;
+    }
+
+    for (uint8_t p = 0; p < 3; p++)
+    {
+        uint32_t    ui32_mean;
+        uint32_t    ui32_min;
+        uint32_t    ui32_max;
+        int64_t     si64_sum = 0;
+        uint32_t    ui32_lo = UINT32_MAX;
+        uint32_t    ui32_hi = 0;
+        uint8_t     ui8_phase = (uint8_t)(EP_PHASE_INDEX_L1 + p);
+
+        if ((false == compactSimParam(pui8_rec, ui16_len, ui8_phase, EP_MON_ID_GDL_VAVE, &ui32_mean)) ||
+            (false == compactSimParam(pui8_rec, ui16_len, ui8_phase, EP_MON_ID_GDL_VMIN, &ui32_min)) ||
+            (false == compactSimParam(pui8_rec, ui16_len, ui8_phase, EP_MON_ID_GDL_VMAX, &ui32_max)))
+        {
+            ui32_bad++;
+            continue;
+        }
+
+        for (uint32_t i = ui32_first; i < (ui32_first + ui32_n); i++)
+        {
+            uint16_t    ui16_src = codecBenchRecord(i, si32_ts0 + (int32_t)(i * 60), aui32_dummy, aui8_src, sizeof(aui8_src));
+            uint32_t    ui32_val;
+
+            (void)compactSimParam(aui8_src, ui16_src, ui8_phase, EP_MON_ID_GDL_VAVE, &ui32_val);
+            si64_sum += ui32_val;
+            (void)compactSimParam(aui8_src, ui16_src, ui8_phase, EP_MON_ID_GDL_VMIN, &ui32_val);
+            ui32_lo = (ui32_val < ui32_lo) ? ui32_val : ui32_lo;
+            (void)compactSimParam(aui8_src, ui16_src, ui8_phase, EP_MON_ID_GDL_VMAX, &ui32_val);
+            ui32_hi = (ui32_val > ui32_hi) ? ui32_val : ui32_hi;
+        }
+
+        si64_sum  = (si64_sum + ui32_n / 2) / ui32_n;
+        ui32_bad += ((ui32_min != ui32_lo) || (ui32_max != ui32_hi) || (ui32_min > ui32_mean) || (ui32_mean > ui32_max)) ? 1 : 0;
+        ui32_bad += (llabs(si64_sum - (int64_t)ui32_mean) > ((900 == si32_bucket_s) ? 0 : 1)) ? 1 : 0;
+
+        for (uint8_t e = 0; e < 5; e++)
+        {
+            uint32_t ui32_val;
+
+            if ((false == compactSimParam(pui8_rec, ui16_len, ui8_phase, (uint8_t)(EP_MON_ID_GDL_EXPORT_KWH_32 + e), &ui32_val)) ||
+                (ui32_val < pui32_energy[p * 5 + e]))
+            {
+                ui32_bad++;
+            }
+            pui32_energy[p * 5 + e] = ui32_val;
+        }
+    }
+
+    return ui32_bad;
+}
+
+/* n days of 1 min monitor payloads into the data log with its compacted tiers, compaction slices
+   as the DataLogging cycles (100 ms) run them; next to it a log of K_DLOG_MAX_SEGMENTS without
+   compaction. Every tier is read back & checked in the end. */
+static uint32_t compactSim(uint32_t ui32_days)
+{
+    static const char      *APC_DIR[K_COMPACT_TIERS]      = { K_STORAGE_BASE_PATH "/compact_sim0", K_STORAGE_BASE_PATH "/compact_sim1",
+                                                              K_STORAGE_BASE_PATH "/compact_sim2" };
+    static const char      *PC_PLAIN                      = K_STORAGE_BASE_PATH "/compact_sim_plain";
+    static const uint8_t    AUI8_SEGMENTS[K_COMPACT_TIERS] = K_COMPACT_TIER_SEGMENTS;
+    static const int32_t    ASI32_BUCKET_S[K_COMPACT_TIERS] = K_COMPACT_BUCKETS_S;
+    static const int32_t    SI32_TS0 = 1780000000;
+    static dlog_st          as_log[K_COMPACT_TIERS];
+    static dlog_st          s_plain;
+    static compact_st       s_compact;
+    static compact_rule_st  as_rule[sizeof(AUI8_QUERY_BENCH_IDS)];
+    static dlog_reader_st   s_reader;
+    static mon_codec_st     s_codec;
+    static mon_codec_st     s_plain_codec;
+    static uint8_t          aui8_payload[K_MON_CODEC_MAX_LEN];
+    static uint8_t          aui8_rec[K_DLOG_MAX_REC_LEN];
+    dlog_st                *aps_log[K_COMPACT_TIERS];
+    uint32_t                ui32_intervals = ui32_days * 1440;
+    uint32_t                aui32_energy[3 * 5] = { 0 };
+    uint32_t                ui32_bad = 0;
+    uint32_t                ui32_cycles = 0;
+    uint64_t                ns_compact = 0;
+    uint64_t                ns_worst = 0;
+    uint64_t                ui64_sectors = 0;
+    uint64_t                ui64_worst_sectors = 0;
+    int32_t                 asi32_first[K_COMPACT_TIERS];
+    int32_t                 si32_oldest = INT32_MAX;            // first interval still held, in whatever tier
+    int32_t                 si32_plain_first = 0;
+    host_storage_stats_st   s_storage;
+
+    // as data::logging builds them: the channels' mean, min & max, power factor & frequency averaged
+    for (uint8_t k = 0; k < sizeof(AUI8_QUERY_BENCH_IDS); k++)
+    {
+        as_rule[k] = { AUI8_QUERY_BENCH_IDS[k], (uint8_t)((k < 15) ? (COMPACT_MEAN + (k % 3)) : COMPACT_MEAN), false };
+    }
+
+    for (uint8_t t = 0; t < K_COMPACT_TIERS; t++)
+    {
+        clearDir(APC_DIR[t]);
+        (void)dlogInit(&as_log[t], APC_DIR[t]);
+        dlogLimit(&as_log[t], AUI8_SEGMENTS[t]);
+        aps_log[t] = &as_log[t];
+    }
+    clearDir(PC_PLAIN);
+    (void)dlogInit(&s_plain, PC_PLAIN);
+    compactInit(&s_compact, aps_log, as_rule, sizeof(as_rule) / sizeof(as_rule[0]));
+    monCodecInit(&s_codec);
+    monCodecInit(&s_plain_codec);
+    hostStorageResetStats();
+
+    for (uint32_t i = 0; i < ui32_intervals; i++)
+    {
+        int32_t     si32_ts  = SI32_TS0 + (int32_t)(i * 60);
+        uint16_t    ui16_len = codecBenchRecord(i, si32_ts, aui32_energy, aui8_payload, sizeof(aui8_payload));
+
+        ui32_bad += (false == monCodecAppend(&s_codec, &as_log[0], si32_ts, aui8_payload, ui16_len)) ? 1 : 0;
+        ui32_bad += (false == monCodecAppend(&s_plain_codec, &s_plain, si32_ts, aui8_payload, ui16_len)) ? 1 : 0;
+
+        // the cycles of the minute
+        for (uint16_t c = 0; c < 600; c++)
+        {
+            uint64_t    ns_start = nowNs();
+            uint64_t    ui64_before;
+            bool        b_step;
+
+            hostStorageGetStats(&s_storage);
+            ui64_before = s_storage.ui64_sectors;
+            b_step      = compactStep(&s_compact);
+            hostStorageGetStats(&s_storage);
+            if (false == b_step)
+            {
+                break;
+            }
+
+            ns_compact         += nowNs() - ns_start;
+            ns_worst            = ((nowNs() - ns_start) > ns_worst) ? (nowNs() - ns_start) : ns_worst;
+            ui64_sectors       += s_storage.ui64_sectors - ui64_before;
+            ui64_worst_sectors  = ((s_storage.ui64_sectors - ui64_before) > ui64_worst_sectors) ? (s_storage.ui64_sectors - ui64_before) : ui64_worst_sectors;
+            ui32_cycles++;
+        }
+    }
+    for (uint8_t t = 0; t < K_COMPACT_TIERS; t++)
+    {
+        (void)dlogFlush(&as_log[t], 0, true);
+    }
+    (void)dlogFlush(&s_plain, 0, true);
+
+    // remounted, every tier in one piece: the aggregates of whole buckets, each tier reaching the next
+    for (uint8_t t = 0; t < K_COMPACT_TIERS; t++)
+    {
+        uint32_t    aui32_last_energy[3 * 5] = { 0 };
+        uint32_t    ui32_held = 0;
+        int32_t     si32_prev = 0;
+        int32_t     si32_from;
+        int32_t     si32_step = (0 == t) ? 60 : ASI32_BUCKET_S[t];
+        int32_t     si32_ts;
+        uint16_t    ui16_len;
+
+        (void)dlogInit(&as_log[t], APC_DIR[t]);
+        dlogReaderInit(&s_reader);
+        monCodecInit(&s_codec);
+        while (true == monCodecRead(&s_codec, &as_log[t], &s_reader, NULL, &si32_ts, aui8_rec, sizeof(aui8_rec), &ui16_len))
+        {
+            ui32_bad += ((0 != ui32_held) && (si32_ts != (si32_prev + si32_step))) ? 1 : 0;
+            ui32_bad += (0 != t) ? compactSimCheck(aui8_rec, ui16_len, si32_ts, SI32_TS0, si32_step, aui32_last_energy) : 0;
+            asi32_first[t] = (0 == ui32_held) ? si32_ts : asi32_first[t];
+            si32_prev      = si32_ts;
+            ui32_held++;
+        }
+        ui32_bad += ((0 != t) && (0 != ui32_held) && ((si32_prev + si32_step) < asi32_first[t - 1])) ? 1 : 0;
+        ui32_bad += ((0 == t) && (si32_prev != (SI32_TS0 + (int32_t)((ui32_intervals - 1) * 60)))) ? 1 : 0;
+
+        // a bucket stamped before the first interval holds from there on
+        si32_from   = (0 == ui32_held) ? 0 : ((asi32_first[t] < SI32_TS0) ? SI32_TS0 : asi32_first[t]);
+        si32_oldest = ((0 != ui32_held) && (si32_from < si32_oldest)) ? si32_from : si32_oldest;
+        printf("--- compact sim: tier %u, %4d s records, %2u of %2u segments: %6u records, %6.1f days (day %6.1f to %6.1f) ---\r\n",
+               t, (int)si32_step, as_log[t].ui8_segs, AUI8_SEGMENTS[t], (unsigned)ui32_held,
+               ui32_held ? (double)(si32_prev + si32_step - si32_from) / 86400 : 0.0,
+               ui32_held ? (double)(si32_from - SI32_TS0) / 86400 : 0.0, ui32_held ? (double)(si32_prev + si32_step - SI32_TS0) / 86400 : 0.0);
+    }
+
+    {
+        int32_t     si32_ts;
+        uint16_t    ui16_len;
+
+        dlogReaderInit(&s_reader);
+        monCodecInit(&s_plain_codec);
+        if (true == monCodecRead(&s_plain_codec, &s_plain, &s_reader, NULL, &si32_ts, aui8_rec, sizeof(aui8_rec), &ui16_len))
+        {
+            si32_plain_first = si32_ts;
+        }
+    }
+
+    double d_s = (double)ns_compact / 1e9;
+
+    printf("--- compact sim: history of %.1f days, %.1f days without compaction (%u segments of 1 min records) ---\r\n",
+           (INT32_MAX != si32_oldest) ? (double)(SI32_TS0 + (int32_t)(ui32_intervals * 60) - si32_oldest) / 86400 : 0.0,
+           (double)(SI32_TS0 + (int32_t)(ui32_intervals * 60) - si32_plain_first) / 86400, s_plain.ui8_segs);
+    printf("--- compact sim: %u segments compacted (%u for their age, %u of a full tier), %u records into %u, %.1f MiB reclaimed (%.1f MiB in, %.1f MiB out); "
+           "%.0f records/s host, %u slices of %u records, worst %.2f ms host / %.0f ms flash (%u sectors), %.1f sector writes/day; "
+           "%u skipped, %u compaction errors, %u errors ---\r\n",
+           (unsigned)s_compact.s_stats.ui32_segments, (unsigned)s_compact.s_stats.ui32_aged,
+           (unsigned)(s_compact.s_stats.ui32_segments - s_compact.s_stats.ui32_aged), (unsigned)s_compact.s_stats.ui32_records_in, (unsigned)s_compact.s_stats.ui32_records_out,
+           (double)(s_compact.s_stats.ui64_bytes_in - s_compact.s_stats.ui64_bytes_out) / 1048576,
+           (double)s_compact.s_stats.ui64_bytes_in / 1048576, (double)s_compact.s_stats.ui64_bytes_out / 1048576,
+           d_s ? s_compact.s_stats.ui32_records_in / d_s : 0.0, (unsigned)ui32_cycles, K_COMPACT_SLICE_RECORDS, (double)ns_worst / 1e6,
+           (double)ui64_worst_sectors * K_FLASH_BENCH_SECTOR_US / 1000, (unsigned)ui64_worst_sectors, (double)ui64_sectors / ui32_days,
+           (unsigned)s_compact.s_stats.ui32_skipped, (unsigned)s_compact.s_stats.ui32_errors, (unsigned)ui32_bad);
+
+    for (uint8_t t = 0; t < K_COMPACT_TIERS; t++)
+    {
+        clearDir(APC_DIR[t]);
+    }
+    clearDir(PC_PLAIN);
+
+    return ui32_bad + s_compact.s_stats.ui32_errors;
+}
+
+/* the backlog of an outage of n days replayed to a send path that acknowledges at once, then the
+   whole range queried (every 15th row kept): from FAT files and from the partition through the reader's page buffer
+   with the payload copied out, as before, and from the partition with mapped windows, the replay
+   copying its pages (K_REPLAY_MAPPED 0) or walking them in place too */
+static uint32_t mmapBench(uint32_t ui32_days)
+{
+    static const char      *PC_DIR    = K_STORAGE_BASE_PATH "/mmap_bench";
+    static const char      *PC_CURSOR = K_STORAGE_BASE_PATH "/mmap_bench.cur";
+    static const char      *APC_NAME[] = { "FAT files, copy", "partition, copy", "partition, mmap", "mmap, replay too" };
+    static const int32_t    SI32_TS0  = 1780000000;
+    static dlog_st          s_log;
+    static dlog_map_st      s_map;
+    static replay_st        s_rp;
+    static query_st         s_query;
+    static mon_codec_st     s_codec;
+    static uint8_t          aui8_rec[K_DLOG_MAX_REC_LEN];
+    static uint8_t          aui8_report[K_DLOG_MAX_REC_LEN];
+    const esp_partition_t  *ps_part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "bench");
+    uint32_t                ui32_intervals = ui32_days * 1440;
+    uint32_t                ui32_first_sum = 0;
+    uint32_t                ui32_errors = 0;
+    double                  d_base = 0.0;
+
+    if (NULL == ps_part)
+    {
+        printf("--- mmap bench: no emulated partition ---\r\n");
+        return 1;
+    }
+
+    // the device id in the payloads, not only once the data logging task got to it
+    edgePayloadInit();
+    mkdir(PC_DIR, 0755);
+    for (uint8_t c = 0; c < (sizeof(APC_NAME) / sizeof(APC_NAME[0])); c++)
+    {
+        bool                b_raw = (c >= 1);
+        bool                b_map = (c >= 2);
+        bool                b_map_replay = (c >= 3);
+        uint32_t            ui32_bad = 0;
+        uint32_t            ui32_sent = 0;
+        uint32_t            ui32_sum = 0;
+        uint32_t            ui32_first;
+        uint64_t            ui64_payload = 0;
+        uint64_t            ui64_copied = 0;
+        uint16_t            ui16_ticket = 0;
+        uint32_t            ms = 0;
+        uint32_t            ui32_q_bytes;
+        uint32_t            ui32_q_chunks;
+        uint32_t            ui32_walked = 0;
+        uint64_t            ns_start;
+        double              d_replay_s;
+        double              d_walk_s;
+        double              d_query_s;
+        host_flash_stats_st s_flash;
+        char                ac_query[128];
+
+        // the link goes down with an empty log and comes back after n days of intervals
+        clearDir(PC_DIR);
+        remove(PC_CURSOR);
+        (void)esp_partition_erase_range(ps_part, 0, ps_part->size);
+        (void)((true == b_raw) ? dlogInitPartition(&s_log, ps_part) : dlogInit(&s_log, PC_DIR));
+        replayInit(&s_rp, PC_CURSOR, &s_log);
+        monCodecInit(&s_codec);
+        for (uint32_t i = 0; i < ui32_intervals; i++)
+        {
+            int32_t     si32_ts  = SI32_TS0 + (int32_t)(i * 60);
+            uint16_t    ui16_len = queryBenchRecord(i, si32_ts, aui8_rec, sizeof(aui8_rec));
+
+            ui32_bad += (false == monCodecAppend(&s_codec, &s_log, si32_ts, aui8_rec, ui16_len)) ? 1 : 0;
+        }
+        (void)dlogFlush(&s_log, 0, true);
+
+        // remounted, the records come from flash
+        (void)((true == b_raw) ? dlogInitPartition(&s_log, ps_part) : dlogInit(&s_log, PC_DIR));
+        if (true == b_map)
+        {
+            ui32_bad += (false == dlogMap(&s_log, &s_map)) ? 1 : 0;
+        }
+        // K_REPLAY_MAPPED: the replay copies its pages unless set
+        dlogReaderCopy(&s_rp.as_reader[REPLAY_BACKLOG], !b_map_replay);
+        hostFlashResetStats(ps_part);
+
+        ns_start = nowNs();
+        replayOnline(&s_rp, &s_log);
+        while (true == replayBacklog(&s_rp))
+        {
+            const uint8_t  *pui8_report;
+            int32_t         si32_ts;
+            uint16_t        ui16_len;
+
+            while (true == replayNext(&s_rp, &s_log, K_SIM_SEND_QUEUE, ms, &si32_ts, &pui8_report, &ui16_len))
+            {
+                if (false == b_map)
+                {
+                    memcpy(aui8_report, pui8_report, ui16_len);
+                    pui8_report  = aui8_report;
+                    ui64_copied += ui16_len;
+                }
+
+                // the send path reads every byte
+                for (uint16_t b = 0; b < ui16_len; b++)
+                {
+                    ui32_sum = ui32_sum * 31 + pui8_report[b];
+                }
+                ui64_payload += ui16_len;
+                ui32_sent++;
+
+                ui16_ticket = (uint16_t)((UINT16_MAX == ui16_ticket) ? 1 : (ui16_ticket + 1));
+                replaySent(&s_rp, ui16_ticket, true);
+                (void)replayAck(&s_rp, ui16_ticket);
+            }
+            ms += K_REPLAY_BATCH_PERIOD_MS;
+        }
+        d_replay_s   = (double)(nowNs() - ns_start) / 1e9;
+        ui64_copied += s_rp.as_reader[REPLAY_BACKLOG].ui64_copied;
+
+        // the dropped segments aside every record, the same ones each time
+        ui32_first      = ui32_intervals - ui32_sent;
+        ui32_first_sum  = (0 == c) ? ui32_sum : ui32_first_sum;
+        ui32_bad       += (ui32_sum != ui32_first_sum) ? 1 : 0;
+
+        snprintf(ac_query, sizeof(ac_query), "from=%ld&to=%ld&phase=1,2,3&ids=0x%02X,0x%02X,0x%02X&every=15",
+                 (long)(SI32_TS0 + (int32_t)(ui32_first * 60)), (long)(SI32_TS0 + (int32_t)((ui32_intervals - 1) * 60)),
+                 EP_MON_ID_GDL_VAVE, EP_MON_ID_GDL_WATTAVE, EP_MON_ID_GDL_IMPORT_KWH_32);
+        ns_start  = nowNs();
+        ui32_bad += (false == queryBenchRun(&s_log, &s_query, ac_query, ui32_first, SI32_TS0, &ui32_q_bytes, &ui32_q_chunks)) ? 1 : 0;
+        d_query_s = (double)(nowNs() - ns_start) / 1e9;
+
+        // the records alone, without the codec
+        {
+            static dlog_reader_st   s_reader;
+            int32_t                 si32_ts;
+            uint16_t                ui16_len;
+
+            dlogReaderInit(&s_reader);
+            ns_start = nowNs();
+            while ((true == b_map) ? (NULL != dlogReadRef(&s_log, &s_reader, NULL, &si32_ts, &ui16_len)) :
+                                     (true == dlogRead(&s_log, &s_reader, NULL, &si32_ts, aui8_rec, sizeof(aui8_rec), &ui16_len)))
+            {
+                ui32_walked++;
+            }
+            d_walk_s  = (double)(nowNs() - ns_start) / 1e9;
+            ui32_bad += (ui32_walked != ui32_sent) ? 1 : 0;
+        }
+
+        hostFlashGetStats(ps_part, &s_flash);
+        d_base = (0 == c) ? (ui32_sent / d_replay_s) : d_base;
+        printf("--- mmap bench: %-16s replay %8.0f reports/s (%5.2fx the first, %6.1f MiB/s), %6.1f B copied per %.0f B report; "
+               "records alone %8.0f/s; query %6.1f ms for %u rows, %4u pages read, %4u mapped; %.1f MiB through esp_partition_read, "
+               "%u windows mapped; %u errors ---\r\n",
+               APC_NAME[c], ui32_sent / d_replay_s, (ui32_sent / d_replay_s) / d_base, (double)ui64_payload / 1048576 / d_replay_s,
+               ui32_sent ? (double)ui64_copied / ui32_sent : 0.0, ui32_sent ? (double)ui64_payload / ui32_sent : 0.0,
+               d_walk_s ? ui32_walked / d_walk_s : 0.0,
+               d_query_s * 1e3, (unsigned)s_query.ui32_rows, (unsigned)s_query.s_reader.ui32_page_reads,
+               (unsigned)s_query.s_reader.ui32_page_maps, (double)s_flash.ui64_read / 1048576,
+               (true == b_map) ? (unsigned)s_map.ui32_maps : 0U, (unsigned)ui32_bad);
+        ui32_errors += ui32_bad;
+    }
+
+    printf("--- mmap bench: %u intervals stored of %u (%.1f days) in %u segments ---\r\n",
+           (unsigned)s_rp.aui32_acked[REPLAY_BACKLOG], (unsigned)ui32_intervals, s_rp.aui32_acked[REPLAY_BACKLOG] / 1440.0,
+           (unsigned)s_log.ui8_segs);
+
+    clearDir(PC_DIR);
+    remove(PC_CURSOR);
+
+    return ui32_errors;
+}
+
+
+static const host_test_st AS_TESTS[] =
+{
+    { "--log-bench=",       "20000",    logBench,       NULL },
+    { "--replay-sim=",      "6",        replaySim,      NULL },
+    { "--query-bench=",     "6",        queryBench,     NULL },
+    { "--codec-bench=",     "3",        codecBench,     NULL },
+    { "--journal-fault=",   "20",       journalFault,   NULL },
+    { "--flush-sim=",       "2",        flushSim,       NULL },
+    { "--flash-bench=",     "3",        flashBench,     NULL },
+    { "--compact-sim=",     "20",       compactSim,     NULL },
+    { "--mmap-bench=",      "3",        mmapBench,      NULL },
+};
+
+int main(int argc, char *argv[])
+{
+    return hostTestMain(argc, argv, AS_TESTS, sizeof(AS_TESTS) / sizeof(AS_TESTS[0]));
+}
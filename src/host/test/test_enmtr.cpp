@@ -0,0 +1,442 @@
+/*
+ * test_enmtr.cpp
+ *
+ * Energy meter side: the harmonic aggregation, the register decoder, the energy counters and
+ * the power quality detector on synthetic or recorded input.
+ *
+ *  test_enmtr [--harm-bench=<synthetic mains cycles through the harmonic aggregation>]
+ *             [--decode-bench=<measurement blocks through the register decoder>]
+ *             [--energy-sim=<days of 10 Hz power samples through the energy counters>]
+ *             [--pq-replay=<csv of "ms,vrms_l1,vrms_l2,vrms_l3" through the power quality detector>]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "enmtr_manager.h"
+#include "harmonics/harmonics.h"
+#include "energy/energy.h"
+#include "pq_event/pq_event.h"
+#include "test/host_test.h"
+
+
+/* spectra of synthetic 3 phase waveforms (fundamental & odd harmonics ~ 1/order, LCG noise),
+   every order of every phase each mains cycle */
+static uint32_t harmonicsBench(uint32_t ui32_cycles)
+{
+    static harm_phase_st    as_phase[ENMTR_CLASS::NUM_DEVICES];
+    uint32_t                ui32_lcg = 12345;
+    uint64_t                ns_start;
+    double                  s_elapsed;
+
+    for (uint8_t d = 0; d < ENMTR_CLASS::NUM_DEVICES; d++)
+    {
+        harmPhaseInit(&as_phase[d]);
+    }
+
+    ns_start = nowNs();
+    for (uint32_t c = 0; c < ui32_cycles; c++)
+    {
+        for (uint8_t d = 0; d < ENMTR_CLASS::NUM_DEVICES; d++)
+        {
+            for (uint8_t o = 0; o < K_HARM_NUM_ORDERS; o++)
+            {
+                ui32_lcg = ui32_lcg * 1664525UL + 1013904223UL;
+
+                uint32_t ui32_vfund = 230000 + (ui32_lcg >> 24);
+                uint32_t ui32_ifund = 5000 + (ui32_lcg >> 26);
+                uint32_t ui32_vharm = (ui32_vfund / 1000) * ((90 + ((ui32_lcg >> 8) & 0x0F)) / harmOrder(o));
+                uint32_t ui32_iharm = (ui32_ifund / 1000) * ((900 + ((ui32_lcg >> 12) & 0x3F)) / harmOrder(o));
+
+                harmPhaseAdd(&as_phase[d], o, ui32_vfund, ui32_vharm, ui32_ifund, ui32_iharm);
+            }
+        }
+        if (0 == (c % 3000))   // one minute interval at 50 Hz
+        {
+            for (uint8_t d = 0; d < ENMTR_CLASS::NUM_DEVICES; d++)
+            {
+                harmPhaseNewInterval(&as_phase[d]);
+            }
+        }
+    }
+    s_elapsed = (double)(nowNs() - ns_start) / 1e9;
+
+    printf("--- harmonics bench: %u cycles x %u phases x %u orders in %.3f s, %.0fx real time at 50 Hz, vthd L1 %.2f%% ---\r\n",
+           (unsigned)ui32_cycles, (unsigned)ENMTR_CLASS::NUM_DEVICES, (unsigned)K_HARM_NUM_ORDERS, s_elapsed,
+           (s_elapsed > 0) ? (ui32_cycles / 50.0) / s_elapsed : 0.0,
+           harmQ15ToCentiPercent(harmStatMean(&as_phase[0].s_vthd)) / 100.0);
+
+    // the last interval holds every cycle since its start
+    return ((0 != ui32_cycles) && (0 == as_phase[0].s_vthd.ui16_count)) ? 1 : 0;
+}
+
+/* per register decoding, as the consumers did before the descriptor table */
+static int32_t decodeOne(const ENMTR_CLASS::meas_block_st *ps_block, ENMTR_CLASS::device_et e_device, ENMTR_CLASS::meas_et e_meas)
+{
+    const ENMTR_CLASS::meas_desc_st &s_desc = ENMTR_CLASS::AS_MEAS_DESC[e_meas];
+    int64_t si64_val;
+
+    switch (s_desc.ui8_words)
+    {
+    case 1:
+        si64_val = ENMTR_CLASS::meas_reg(ps_block, e_device, s_desc.e_addr);
+        si64_val = s_desc.b_signed ? (int16_t)si64_val : si64_val;
+        break;
+
+    case 2:
+        si64_val = ((uint32_t)ENMTR_CLASS::meas_reg(ps_block, e_device, s_desc.e_addr) << 16) |
+                   ENMTR_CLASS::meas_reg(ps_block, e_device, (ENMTR_CLASS::reg_addr_et)(s_desc.e_addr + 1));
+        si64_val = s_desc.b_signed ? (int32_t)si64_val : si64_val;
+        break;
+
+    default:
+        si64_val = ((int64_t)ENMTR_CLASS::meas_reg(ps_block, e_device, s_desc.e_addr) << 32) |
+                   ((int64_t)ENMTR_CLASS::meas_reg(ps_block, e_device, (ENMTR_CLASS::reg_addr_et)(s_desc.e_addr + 1)) << 16) |
+                   ENMTR_CLASS::meas_reg(ps_block, e_device, (ENMTR_CLASS::reg_addr_et)(s_desc.e_addr + 2));
+        si64_val = (s_desc.b_signed && (si64_val & 0x800000000000LL)) ? (si64_val - 0x1000000000000LL) : si64_val;
+        break;
+    }
+
+    return (int32_t)((si64_val > INT32_MAX) ? INT32_MAX : ((si64_val < INT32_MIN) ? INT32_MIN : si64_val));
+}
+
+static void setReg(ENMTR_CLASS::meas_block_st *ps_block, ENMTR_CLASS::reg_addr_et e_addr, uint16_t ui16_val)
+{
+    ps_block->aui16_reg[0][e_addr - ENMTR_CLASS::MEAS_BLOCK_FIRST] = ui16_val;
+}
+
+/* golden vectors, then the table decode against the per register one on random blocks */
+static uint32_t decodeBench(uint32_t ui32_blocks)
+{
+    static ENMTR_CLASS::meas_block_st   as_block[64];
+    static const struct
+    {
+        ENMTR_CLASS::meas_et    e_meas;
+        int32_t                 si32_expect;
+    } AS_GOLDEN[] =
+    {
+        { ENMTR_CLASS::MEAS_LINE_FREQ,  5000        },
+        { ENMTR_CLASS::MEAS_VRMS_A,     230123      },
+        { ENMTR_CLASS::MEAS_PF_A,       -9500       },
+        { ENMTR_CLASS::MEAS_WATT_A,     -1150000    },
+        { ENMTR_CLASS::MEAS_VA_A,       INT32_MAX   },  // 0x00FF'FFFF'FFFF mVA saturates
+        { ENMTR_CLASS::MEAS_IHARM_B,    0x0001FFFF  },  // last registers of the block
+    };
+    int32_t     asi32_val[ENMTR_CLASS::NUM_MEAS];
+    uint32_t    ui32_fail = 0;
+    uint32_t    ui32_lcg  = 1;
+    int64_t     si64_sink = 0;
+    uint64_t    ns_table;
+    uint64_t    ns_single;
+
+    ENMTR_CLASS::meas_block_st &s_golden = as_block[0];
+    memset(&s_golden, 0, sizeof(s_golden));
+    setReg(&s_golden, ENMTR_CLASS::REG_ADDR_LINE_FREQ, 5000);
+    setReg(&s_golden, ENMTR_CLASS::REG_ADDR_VRMS_A_H, 0x0003);
+    setReg(&s_golden, ENMTR_CLASS::REG_ADDR_VRMS_A_L, 0x82EB);
+    setReg(&s_golden, ENMTR_CLASS::REG_ADDR_PF_A_H, 0xFFFF);
+    setReg(&s_golden, ENMTR_CLASS::REG_ADDR_PF_A_L, 0xDAE4);
+    setReg(&s_golden, ENMTR_CLASS::REG_ADDR_WATT_A_W2, 0xFFFF);
+    setReg(&s_golden, ENMTR_CLASS::REG_ADDR_WATT_A_W1, 0xFFEE);
+    setReg(&s_golden, ENMTR_CLASS::REG_ADDR_WATT_A_W0, 0x73D0);
+    setReg(&s_golden, ENMTR_CLASS::REG_ADDR_VA_A_W2, 0x00FF);
+    setReg(&s_golden, ENMTR_CLASS::REG_ADDR_VA_A_W1, 0xFFFF);
+    setReg(&s_golden, ENMTR_CLASS::REG_ADDR_VA_A_W0, 0xFFFF);
+    setReg(&s_golden, ENMTR_CLASS::REG_ADDR_IHARM_B_H, 0x0001);
+    setReg(&s_golden, ENMTR_CLASS::REG_ADDR_IHARM_B_L, 0xFFFF);
+
+    ENMTR_CLASS::decode_meas(&s_golden, ENMTR_CLASS::DEVICE_PHASE_A, asi32_val);
+    for (const auto &s_vec : AS_GOLDEN)
+    {
+        if (asi32_val[s_vec.e_meas] != s_vec.si32_expect)
+        {
+            printf("--- decode: golden meas %u = %d, expected %d ---\r\n", s_vec.e_meas, asi32_val[s_vec.e_meas], s_vec.si32_expect);
+            ui32_fail++;
+        }
+    }
+
+    for (uint32_t b = 1; b < 64; b++)
+    {
+        for (uint32_t d = 0; d < ENMTR_CLASS::NUM_DEVICES; d++)
+        {
+            for (uint32_t r = 0; r < ENMTR_CLASS::MEAS_BLOCK_NREG; r++)
+            {
+                ui32_lcg = ui32_lcg * 1664525UL + 1013904223UL;
+                as_block[b].aui16_reg[d][r] = (uint16_t)(ui32_lcg >> 16);
+            }
+        }
+        for (uint32_t d = 0; d < ENMTR_CLASS::NUM_DEVICES; d++)
+        {
+            ENMTR_CLASS::decode_meas(&as_block[b], (ENMTR_CLASS::device_et)d, asi32_val);
+            for (uint8_t m = 0; m < ENMTR_CLASS::NUM_MEAS; m++)
+            {
+                ui32_fail += (asi32_val[m] != decodeOne(&as_block[b], (ENMTR_CLASS::device_et)d, (ENMTR_CLASS::meas_et)m)) ? 1 : 0;
+            }
+        }
+    }
+
+    ns_table = nowNs();
+    for (uint32_t b = 0; b < ui32_blocks; b++)
+    {
+        for (uint32_t d = 0; d < ENMTR_CLASS::NUM_DEVICES; d++)
+        {
+            ENMTR_CLASS::decode_meas(&as_block[b % 64], (ENMTR_CLASS::device_et)d, asi32_val);
+            si64_sink += asi32_val[b % ENMTR_CLASS::NUM_MEAS];
+        }
+    }
+    ns_table = nowNs() - ns_table;
+
+    ns_single = nowNs();
+    for (uint32_t b = 0; b < ui32_blocks; b++)
+    {
+        for (uint32_t d = 0; d < ENMTR_CLASS::NUM_DEVICES; d++)
+        {
+            for (uint8_t m = 0; m < ENMTR_CLASS::NUM_MEAS; m++)
+            {
+                asi32_val[m] = decodeOne(&as_block[b % 64], (ENMTR_CLASS::device_et)d, (ENMTR_CLASS::meas_et)m);
+            }
+            si64_sink += asi32_val[b % ENMTR_CLASS::NUM_MEAS];
+        }
+    }
+    ns_single = nowNs() - ns_single;
+
+    printf("--- decode: %s (%u mismatches), %u blocks: table %.1f ns/block, per register %.1f ns/block (sink %lld) ---\r\n",
+           (0 == ui32_fail) ? "ok" : "FAILED", (unsigned)ui32_fail, (unsigned)ui32_blocks,
+           ui32_blocks ? (double)ns_table / ui32_blocks : 0.0, ui32_blocks ? (double)ns_single / ui32_blocks : 0.0,
+           (long long)si64_sink);
+
+    return ui32_fail;
+}
+
+/* synthetic load of one phase at "ms": daily profile, L2 feeds in (pv), reactive part follows */
+static void energyLoad(uint8_t ui8_phase, uint64_t ms, int32_t *psi32_mw, int32_t *psi32_mvar, int32_t *psi32_mva)
+{
+    double d_day = 2.0 * M_PI * (double)(ms % 86400000ULL) / 86400000.0;
+    double d_w   = 1500000.0 + 1200000.0 * sin(d_day + ui8_phase);
+    double d_var = 400000.0 * cos(3.0 * d_day + ui8_phase);
+
+    d_w = (1 == ui8_phase) ? -d_w : d_w;
+
+    *psi32_mw   = (int32_t)d_w;
+    *psi32_mvar = (int32_t)d_var;
+    *psi32_mva  = (int32_t)sqrt(d_w * d_w + d_var * d_var);
+}
+
+/* days of 10 Hz samples with +-20 ms jitter; every day ends with a restart, orderly (forced
+   checkpoint) or a power cut (restore loses the tail). The counters are compared with a double
+   precision trapezoid sum of the same samples, less what the power cuts lost. */
+static uint32_t energySim(uint32_t ui32_days)
+{
+    static const char  *PC_FILE = K_STORAGE_BASE_PATH "/energy_sim.bin";
+    static energy_acc_st s_acc;
+    double              ad_ref[K_ENERGY_MAX_PHASES][ENERGY_NUM_REGS] = {};
+    int32_t             asi32_last[K_ENERGY_MAX_PHASES][3];
+    uint32_t            ui32_lcg = 4711;
+    uint32_t            ui32_writes = 0;
+    uint32_t            ui32_restore_fail = 0;
+    uint64_t            ms = 0;
+    uint64_t            ns_restore = 0;
+    double              d_worst = 0.0;
+
+    remove(PC_FILE);
+    energyAccInit(&s_acc, ENMTR_CLASS::NUM_DEVICES, PC_FILE);
+
+    for (uint32_t ui32_day = 0; ui32_day < ui32_days; ui32_day++)
+    {
+        for (uint64_t ms_end = ms + 86400000ULL; ms < ms_end; )
+        {
+            for (uint8_t p = 0; p < ENMTR_CLASS::NUM_DEVICES; p++)
+            {
+                int32_t asi32_val[3];
+
+                energyLoad(p, ms, &asi32_val[0], &asi32_val[1], &asi32_val[2]);
+                energyAccAdd(&s_acc, p, (uint32_t)ms, asi32_val[0], asi32_val[1], asi32_val[2]);
+                asi32_last[p][0] = asi32_val[0];
+                asi32_last[p][1] = asi32_val[1];
+                asi32_last[p][2] = asi32_val[2];
+            }
+            (void)energyAccCheckpoint(&s_acc, (uint32_t)ms, false);
+
+            ui32_lcg = ui32_lcg * 1664525UL + 1013904223UL;
+            uint32_t ms_dt = 80 + (ui32_lcg >> 24) % 41;
+
+            // reference: trapezoid of this sample and the next one
+            for (uint8_t p = 0; p < ENMTR_CLASS::NUM_DEVICES; p++)
+            {
+                int32_t asi32_next[3];
+
+                energyLoad(p, ms + ms_dt, &asi32_next[0], &asi32_next[1], &asi32_next[2]);
+                if ((ms + ms_dt) < ms_end)
+                {
+                    double d_w   = 0.5 * ((double)asi32_last[p][0] + asi32_next[0]) * ms_dt;
+                    double d_var = 0.5 * ((double)asi32_last[p][1] + asi32_next[1]) * ms_dt;
+
+                    ad_ref[p][(d_w >= 0) ? ENERGY_IMPORT : ENERGY_EXPORT]     += fabs(d_w);
+                    ad_ref[p][(d_var >= 0) ? ENERGY_LAGGING : ENERGY_LEADING] += fabs(d_var);
+                    ad_ref[p][ENERGY_APPARENT] += 0.5 * ((double)asi32_last[p][2] + asi32_next[2]) * ms_dt;
+                }
+            }
+            ms += ms_dt;
+        }
+
+        // restart
+        if (0 == (ui32_day & 1))
+        {
+            (void)energyAccCheckpoint(&s_acc, (uint32_t)ms, true);
+        }
+        else
+        {
+            for (uint8_t p = 0; p < ENMTR_CLASS::NUM_DEVICES; p++)
+            {
+                for (uint8_t r = 0; r < ENERGY_NUM_REGS; r++)
+                {
+                    ad_ref[p][r] -= (double)(s_acc.as_phase[p].aui64_mwms[r] - s_acc.as_checkpoint[p].aui64_mwms[r]);
+                }
+            }
+        }
+
+        energy_phase_st as_expect[K_ENERGY_MAX_PHASES];
+        uint64_t        ns_start;
+
+        memcpy(as_expect, s_acc.as_checkpoint, sizeof(as_expect));
+        ui32_writes += s_acc.ui32_writes;
+
+        ns_start = nowNs();
+        energyAccInit(&s_acc, ENMTR_CLASS::NUM_DEVICES, PC_FILE);
+        if ((false == energyAccRestore(&s_acc)) || (0 != memcmp(as_expect, s_acc.as_phase, sizeof(as_expect))))
+        {
+            ui32_restore_fail++;
+        }
+        ns_restore += nowNs() - ns_start;
+        s_acc.ms_checkpoint = (uint32_t)ms;
+    }
+
+    for (uint8_t p = 0; p < ENMTR_CLASS::NUM_DEVICES; p++)
+    {
+        for (uint8_t r = 0; r < ENERGY_NUM_REGS; r++)
+        {
+            if (ad_ref[p][r] > K_ENERGY_MWMS_PER_WH)
+            {
+                double d_rel = fabs((double)s_acc.as_phase[p].aui64_mwms[r] - ad_ref[p][r]) / ad_ref[p][r];
+                d_worst = (d_rel > d_worst) ? d_rel : d_worst;
+            }
+        }
+        printf("--- energy L%u: import %u Wh, export %u Wh, leading %u varh, lagging %u varh, %u VAh ---\r\n", p + 1,
+               (unsigned)energyAccWh(&s_acc, p, ENERGY_IMPORT), (unsigned)energyAccWh(&s_acc, p, ENERGY_EXPORT),
+               (unsigned)energyAccWh(&s_acc, p, ENERGY_LEADING), (unsigned)energyAccWh(&s_acc, p, ENERGY_LAGGING),
+               (unsigned)energyAccWh(&s_acc, p, ENERGY_APPARENT));
+    }
+    printf("--- energy sim: %u days, %u checkpoint writes (%.1f / day), %u restore failures, %.1f us / restore, worst drift %.3g ---\r\n",
+           (unsigned)ui32_days, (unsigned)ui32_writes, ui32_days ? (double)ui32_writes / ui32_days : 0.0,
+           (unsigned)ui32_restore_fail, ui32_days ? (double)ns_restore / ui32_days / 1000.0 : 0.0, d_worst);
+    remove(PC_FILE);
+
+    // the counters are integers of mW*ms, the reference a double sum: rounding only
+    return ui32_restore_fail + ((d_worst > 1e-6) ? 1 : 0);
+}
+
+/* recorded rms voltages (volts, "#" comments and a header line allowed) through the detector:
+   the events, then the cost per sample replaying the recording until 10^6 samples */
+static uint32_t pqReplay(const char *pc_file)
+{
+    static pq_detector_st   s_det;
+    FILE                   *ps_file = fopen(pc_file, "r");
+    char                    ac_line[128];
+    uint32_t               *pms_ts = NULL;
+    int32_t                *psi32_cv = NULL;
+    uint32_t                ui32_rows = 0;
+    uint32_t                ui32_cap = 0;
+    uint32_t                ui32_events = 0;
+    pq_event_st             s_event;
+
+    if (NULL == ps_file)
+    {
+        printf("--- pq replay: cannot open %s ---\r\n", pc_file);
+        return 1;
+    }
+
+    while (NULL != fgets(ac_line, sizeof(ac_line), ps_file))
+    {
+        unsigned long   ul_ms;
+        double          ad_v[3];
+
+        if (4 != sscanf(ac_line, "%lu,%lf,%lf,%lf", &ul_ms, &ad_v[0], &ad_v[1], &ad_v[2]))
+        {
+            continue;
+        }
+        if (ui32_rows == ui32_cap)
+        {
+            ui32_cap  = ui32_cap ? (2 * ui32_cap) : 1024;
+            pms_ts    = (uint32_t *)realloc(pms_ts, ui32_cap * sizeof(uint32_t));
+            psi32_cv  = (int32_t *)realloc(psi32_cv, ui32_cap * 3 * sizeof(int32_t));
+        }
+        pms_ts[ui32_rows] = (uint32_t)ul_ms;
+        for (uint8_t p = 0; p < 3; p++)
+        {
+            psi32_cv[(ui32_rows * 3) + p] = (int32_t)lround(ad_v[p] * 100.0);
+        }
+        ui32_rows++;
+    }
+    fclose(ps_file);
+
+    pqDetInit(&s_det, 3, K_PQ_NOMINAL_CV);
+    for (uint32_t r = 0; r < ui32_rows; r++)
+    {
+        for (uint8_t p = 0; p < 3; p++)
+        {
+            pqDetAdd(&s_det, p, pms_ts[r], psi32_cv[(r * 3) + p]);
+        }
+        while (true == pqDetPop(&s_det, &s_event))
+        {
+            printf("--- pq event %02x L%u: start %u ms, %u ms, %u.%02u V ---\r\n", (unsigned)s_event.e_type,
+                   s_event.ui8_phase + 1, (unsigned)s_event.ms_start, (unsigned)s_event.ms_duration,
+                   s_event.ui16_extreme_cv / 100, s_event.ui16_extreme_cv % 100);
+            ui32_events++;
+        }
+    }
+
+    uint32_t ui32_loops = ui32_rows ? (1000000 / (ui32_rows * 3)) + 1 : 0;
+    uint32_t ms_span    = ui32_rows ? (pms_ts[ui32_rows - 1] - pms_ts[0] + 100) : 0;
+    uint64_t ns_start   = nowNs();
+
+    pqDetInit(&s_det, 3, K_PQ_NOMINAL_CV);
+    for (uint32_t l = 0; l < ui32_loops; l++)
+    {
+        for (uint32_t r = 0; r < ui32_rows; r++)
+        {
+            for (uint8_t p = 0; p < 3; p++)
+            {
+                pqDetAdd(&s_det, p, pms_ts[r] + (l * ms_span), psi32_cv[(r * 3) + p]);
+            }
+            while (true == pqDetPop(&s_det, &s_event))
+            {
+            }
+        }
+    }
+    uint64_t ns_total = nowNs() - ns_start;
+
+    printf("--- pq replay: %u rows, %u events, %.1f ns / sample, detector %u bytes ---\r\n", (unsigned)ui32_rows,
+           (unsigned)ui32_events, ui32_loops ? (double)ns_total / ((double)ui32_loops * ui32_rows * 3) : 0.0,
+           (unsigned)sizeof(pq_detector_st));
+
+    free(pms_ts);
+    free(psi32_cv);
+
+    return 0;
+}
+
+
+static const host_test_st AS_TESTS[] =
+{
+    { "--harm-bench=",      "30000",                                    harmonicsBench, NULL },
+    { "--decode-bench=",    "100000",                                   decodeBench,    NULL },
+    { "--energy-sim=",      "4",                                        energySim,      NULL },
+    { "--pq-replay=",       K_HOST_SIM_DIR "/pq_replay_sample.csv",     NULL,           pqReplay },
+};
+
+int main(int argc, char *argv[])
+{
+    return hostTestMain(argc, argv, AS_TESTS, sizeof(AS_TESTS) / sizeof(AS_TESTS[0]));
+}
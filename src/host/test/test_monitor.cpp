@@ -0,0 +1,103 @@
+/*
+ * test_monitor.cpp
+ *
+ * The monitor aggregation: report interval switches and clock steps against the wall clock grid.
+ *
+ *  test_monitor [--interval-sim=<report interval switches at random seconds through the monitor aggregation>]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "monitor_agg/monitor_agg.h"
+#include "test/host_test.h"
+
+
+/* n report interval switches (1..60 min, now & then with a clock step) at random seconds of a 10 Hz
+   sample stream through the monitor aggregation: every sample in exactly one interval, every interval
+   not cut by a switch ending on a wall clock boundary of its length */
+static uint32_t intervalSim(uint32_t ui32_switches)
+{
+    static const uint16_t           AUI16_MIN[] = { 1, 2, 3, 5, 10, 15, 20, 30, 60 };
+    static const mon_agg_channel_st AS_CHANNEL[1] = { { EP_MON_ID_GDL_VAVE, EP_MON_ID_GDL_VMIN, EP_MON_ID_GDL_VMAX, 1, false } };
+    static mon_agg_st       s_agg;
+    uint32_t                ui32_lcg = 2024;
+    uint32_t                ui32_offset = 1780000000 + 37;     // tick 0 isn't on a minute
+    uint32_t                ui32_next_s = 0;
+    uint32_t                ui32_done = 0;
+    uint32_t                ui32_carried = 0;
+    uint32_t                ui32_misaligned = 0;
+    uint32_t                ui32_steps = 0;
+    uint64_t                ui64_samples = 0;
+    uint64_t                ui64_counted = 0;
+    uint64_t                ns_start;
+    uint32_t                s;
+
+    (void)monAggInit(&s_agg, AS_CHANNEL, 1, 1, 15);
+    (void)monAggSetInterval(&s_agg, 15, ui32_offset);
+
+    ns_start = nowNs();
+    for (s = 0; s_agg.ui32_switches < ui32_switches; s++)
+    {
+        if (s == ui32_next_s)
+        {
+            ui32_lcg = ui32_lcg * 1664525UL + 1013904223UL;
+            if (0 == ((ui32_lcg >> 8) & 0x07))
+            {
+                ui32_offset += ((ui32_lcg >> 12) & 0x3FF) - 0x200 + ((0 == ((ui32_lcg >> 22) & 1)) ? K_MON_AGG_REALIGN_S : -K_MON_AGG_REALIGN_S);
+                ui32_steps++;
+            }
+            (void)monAggSetInterval(&s_agg, AUI16_MIN[(ui32_lcg >> 24) % (sizeof(AUI16_MIN) / sizeof(AUI16_MIN[0]))], ui32_offset);
+            ui32_next_s = s + 1 + ((ui32_lcg >> 4) % 5400);
+        }
+
+        uint32_t ui32_wall_s = s + s_agg.ui32_offset_s;   // the grid the interval closes on
+        uint32_t ui32_switched = s_agg.ui32_switches;
+
+        if (true == monAggTick(&s_agg, s))
+        {
+            ui32_done++;
+            ui64_counted += s_agg.as_done[0][0].ui32_count;
+            if ((false == s_agg.b_done_cut) &&
+                (ui32_wall_s != (s_agg.ui32_done_window + 1) * (uint32_t)s_agg.ui16_done_min * 60))
+            {
+                ui32_misaligned++;
+            }
+        }
+        else if (s_agg.ui32_switches != ui32_switched)
+        {
+            ui32_carried++;
+        }
+
+        for (uint8_t k = 0; k < 10; k++)
+        {
+            monAggAdd(&s_agg, 0, 0, 230);
+            ui64_samples++;
+        }
+    }
+
+    // what's still open
+    for (uint8_t t = 0; t < MON_AGG_NUM_TIERS; t++)
+    {
+        ui64_counted += s_agg.as_stat[t][0][0].ui32_count;
+    }
+
+    printf("--- interval sim: %u switches (%u clock steps) over %.1f days, %u intervals, %u cut short, %u carried over; "
+           "%llu samples, %lld not in one interval, %u intervals off the clock; %.0f ns per second ---\r\n",
+           (unsigned)s_agg.ui32_switches, (unsigned)ui32_steps, s / 86400.0, (unsigned)ui32_done, (unsigned)s_agg.ui32_cut,
+           (unsigned)ui32_carried, (unsigned long long)ui64_samples, (long long)(ui64_samples - ui64_counted),
+           (unsigned)ui32_misaligned, (double)(nowNs() - ns_start) / s);
+
+    return ui32_misaligned + ((ui64_samples != ui64_counted) ? 1 : 0);
+}
+
+
+static const host_test_st AS_TESTS[] =
+{
+    { "--interval-sim=",    "2000",     intervalSim,    NULL },
+};
+
+int main(int argc, char *argv[])
+{
+    return hostTestMain(argc, argv, AS_TESTS, sizeof(AS_TESTS) / sizeof(AS_TESTS[0]));
+}
@@ -0,0 +1,1495 @@
+/*
+ * test_payload.cpp
+ *
+ * The edge payload encoders & decoders, the monitor report batches and the path of a report into
+ * its DTLS record.
+ *
+ *  test_payload [--payload-bench=<monitor reports into DTLS records: struct, CoAP & record copies vs. the writer & built in the send slot>]
+ *               [--payload-pack=<random monitor payloads, packed struct vs. writer vs. the wire format spelled out>]
+ *               [--batch-sim=<1 min intervals replayed one per request vs. batched, three report sizes>]
+ *               [--payload-fuzz=<random payloads of the four kinds encoded, decoded & encoded again, then mutated>]
+ *               [--mesh-relay=<child payloads in segments through the parent's queue, malformed ones dropped at dequeue>]
+ *               [--payload-micro=<calls timed of every edge_payload encoder & decoder>]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+
+#include "data_log/data_log.h"
+#include "log_replay/log_replay.h"
+#include "mon_codec/mon_codec.h"
+#include "harmonics/harmonics.h"
+#include "coap/coap_client.h"
+#include "dtls/dtls_client.h"
+#include "cloud_comms_cfg.h"
+#include "test/host_test.h"
+
+
+#if (1 == K_PAYLOAD_SPLIT_PHASE_GROUPS)
+#define K_PACK_MAX_PHASE_PARAMS     (K_PAYLOAD_MAX_MON_PARAM_COUNT + K_PAYLOAD_MAX_MON_PARAM32_COUNT)
+#else
+#define K_PACK_MAX_PHASE_PARAMS     (31)
+#endif
+
+static dtls_client_context_st   s_bench_dtls;
+static uint8_t                  aui8_bench_slot[DTLS_MAX_BUF];      // udp send queue slot
+static size_t                   sz_bench_slot_len;
+static uint64_t                 ui64_bench_copied;
+
+static int payloadBenchDtlsWrite(uint8_t *pui8_buf, size_t sz_len)
+{
+    memcpy(aui8_bench_slot, pui8_buf, sz_len);
+    sz_bench_slot_len  = sz_len;
+    ui64_bench_copied += sz_len;
+    return (int)sz_len;
+}
+
+static int payloadBenchCoapSend(const uint8_t *pui8_buf, uint16_t ui16_len)
+{
+    ui64_bench_copied += ui16_len;                          // into the record
+    return dtls_write(&s_bench_dtls, pui8_buf, ui16_len);
+}
+
+/* the values of report i as the aggregation hands them over: 3 phases of 16-bit parameters
+   (two groups each) and the 32-bit energy counters */
+static uint16_t payloadBenchValue(uint32_t i, uint8_t ui8_phase, uint8_t k)
+{
+    return (uint16_t)(1000 + k * 37 + codecBenchNoise(i, ui8_phase, k, 500));
+}
+
+static bool payloadBenchOld(coap_client_context_st *ps_coap, uint32_t i, uint16_t ui16_msg_id)
+{
+    static ep_monitor_payload_st    s_monitor;
+    static uint8_t                  aui8_report[K_MON_CODEC_MAX_LEN];
+    ep_com_header_st                s_header;
+    size_t                          sz_len = 0;
+
+    (void)edgePayloadInitComHeader(&s_header, (int32_t)(1780000000 + i * 60));
+    (void)edgePayloadInitMonitor(&s_monitor, &s_header);
+    for (uint8_t p = 0; p < 3; p++)
+    {
+        (void)edgePayloadNewMonitorPhase(&s_monitor, (ep_phase_index_et)(EP_PHASE_INDEX_L1 + p));
+        for (uint8_t k = 0; k < sizeof(AUI8_QUERY_BENCH_IDS); k++)
+        {
+            (void)edgePayloadAddMonitorParam(&s_monitor, (ep_monitor_id_et)AUI8_QUERY_BENCH_IDS[k], payloadBenchValue(i, p, k));
+        }
+        for (uint8_t h = 0; h < K_HARM_NUM_ORDERS; h++)
+        {
+            (void)edgePayloadAddMonitorParam(&s_monitor, (ep_monitor_id_et)(EP_MON_ID_GDL_V_3RD_HARM + h), payloadBenchValue(i, p, 20 + h));
+            (void)edgePayloadAddMonitorParam(&s_monitor, (ep_monitor_id_et)(EP_MON_ID_GDL_I_3RD_HARM + h), payloadBenchValue(i, p, 40 + h));
+        }
+        for (uint8_t e = 0; e < 5; e++)
+        {
+            (void)edgePayloadAddMonitorParam32(&s_monitor, (ep_monitor_id_et)(EP_MON_ID_GDL_EXPORT_KWH_32 + e), 100000 * i + payloadBenchValue(i, p, 60 + e));
+        }
+    }
+
+    // the report as logged, replayed & sent
+    if (false == edgePayloadMonitor2Buf(aui8_report, sizeof(aui8_report), &sz_len, &s_monitor))
+    {
+        return false;
+    }
+    ui64_bench_copied += sz_len;                            // into the CoAP message
+    return coapClientSendPutRequest(ps_coap, ui16_msg_id, K_CLOUD_MONITOR_PATH, aui8_report, (uint16_t)sz_len);
+}
+
+static bool payloadBenchNew(uint32_t i, uint16_t ui16_msg_id)
+{
+    static ep_writer_st s_writer;
+    static uint8_t      aui8_report[K_MON_CODEC_MAX_LEN];
+    ep_com_header_st    s_header;
+    uint8_t            *pui8_plain;
+    size_t              sz_room = 0;
+    size_t              sz_len  = 0;
+    uint16_t            ui16_coap;
+    int                 i_rlen;
+
+    // the report as emitInterval() writes it for the log
+    edgePayloadWriterInit(&s_writer, aui8_report, sizeof(aui8_report));
+    (void)edgePayloadInitComHeader(&s_header, (int32_t)(1780000000 + i * 60));
+    (void)edgePayloadWriteComHeader(&s_writer, &s_header);
+    for (uint8_t p = 0; p < 3; p++)
+    {
+        (void)edgePayloadWriteMonitorPhase(&s_writer, (ep_phase_index_et)(EP_PHASE_INDEX_L1 + p));
+        for (uint8_t k = 0; k < sizeof(AUI8_QUERY_BENCH_IDS); k++)
+        {
+            (void)edgePayloadWriteMonitorParam(&s_writer, (ep_monitor_id_et)AUI8_QUERY_BENCH_IDS[k], payloadBenchValue(i, p, k));
+        }
+        for (uint8_t h = 0; h < K_HARM_NUM_ORDERS; h++)
+        {
+            (void)edgePayloadWriteMonitorParam(&s_writer, (ep_monitor_id_et)(EP_MON_ID_GDL_V_3RD_HARM + h), payloadBenchValue(i, p, 20 + h));
+            (void)edgePayloadWriteMonitorParam(&s_writer, (ep_monitor_id_et)(EP_MON_ID_GDL_I_3RD_HARM + h), payloadBenchValue(i, p, 40 + h));
+        }
+        for (uint8_t e = 0; e < 5; e++)
+        {
+            (void)edgePayloadWriteMonitorParam32(&s_writer, (ep_monitor_id_et)(EP_MON_ID_GDL_EXPORT_KWH_32 + e), 100000 * i + payloadBenchValue(i, p, 60 + e));
+        }
+    }
+    if (false == edgePayloadWriterEnd(&s_writer, &sz_len))
+    {
+        return false;
+    }
+
+    // then as cloud::monitor sends it: CoAP header in the queue slot, the report after it, sealed there
+    pui8_plain = dtls_write_begin(&s_bench_dtls, aui8_bench_slot, sizeof(aui8_bench_slot), &sz_room);
+    sz_room    = (sz_room < (COAP_BUF_MAX_SIZE - 1)) ? sz_room : (COAP_BUF_MAX_SIZE - 1);
+    ui16_coap  = (NULL != pui8_plain) ? coapClientWriteRequestHeader(pui8_plain, (uint16_t)sz_room, COAP_METHOD_PUT, ui16_msg_id, K_CLOUD_MONITOR_PATH) : 0;
+    if ((0 == ui16_coap) || (sz_len > (sz_room - ui16_coap)))
+    {
+        return false;
+    }
+    memcpy(pui8_plain + ui16_coap, aui8_report, sz_len);
+    ui64_bench_copied += sz_len;                            // out of the replay
+
+    i_rlen = dtls_write_seal(&s_bench_dtls, aui8_bench_slot, ui16_coap + sz_len);
+    sz_bench_slot_len = (i_rlen > 0) ? (size_t)i_rlen : 0;
+    return (i_rlen > 0);
+}
+
+/* n monitor reports into DTLS records (PSK AES-128-CCM-8, a fixed key) in the udp send queue slot:
+   built in the payload struct, serialized, copied into the CoAP message, the record and the slot
+   vs. written as logged and copied once behind the CoAP header in the slot, encrypted there (the
+   data log codec in between is the same for both and left out); the records have to match byte by byte */
+static uint32_t payloadBench(uint32_t ui32_reports)
+{
+    static uint8_t          aui8_old[DTLS_MAX_BUF];
+    static coap_client_context_st s_coap;
+    dtls_security_parameters_st *ps_sec;
+    uint64_t                ui64_copied_old = 0;
+    uint64_t                ui64_copied_new = 0;
+    uint64_t                ui64_record = 0;
+    uint64_t                ns_old = 0;
+    uint64_t                ns_new = 0;
+    uint64_t                ui64_rseq;
+    uint32_t                ui32_errors = 0;
+    uint32_t                i;
+
+    edgePayloadInit();
+    memset(&s_bench_dtls, 0, sizeof(s_bench_dtls));
+    (void)dtls_client_init(&s_bench_dtls);
+    ps_sec = s_bench_dtls.ps_active_security_param;
+    ps_sec->e_cipher = TLS_PSK_WITH_AES_128_CCM_8;
+    ps_sec->epoch    = 1;
+    for (uint8_t k = 0; k < sizeof(ps_sec->key_block); k++)
+    {
+        ps_sec->key_block[k] = (uint8_t)(k * 29 + 7);
+    }
+    s_bench_dtls.s_handler.write = payloadBenchDtlsWrite;
+    s_bench_dtls.e_state = DTLS_STATE_CONNECTED;
+    coapClientInit(s_coap, payloadBenchCoapSend, NULL);
+
+    for (i = 0; i < ui32_reports; i++)
+    {
+        uint64_t ns_start;
+        size_t   sz_old;
+        bool     b_old;
+        bool     b_new;
+
+        ui64_rseq = ps_sec->rseq;
+        ui64_bench_copied = 0;
+        ns_start = nowNs();
+        b_old = payloadBenchOld(&s_coap, i, (uint16_t)i);
+        ns_old += nowNs() - ns_start;
+        ui64_copied_old += ui64_bench_copied;
+        sz_old = sz_bench_slot_len;
+        memcpy(aui8_old, aui8_bench_slot, sz_old);
+
+        ps_sec->rseq = ui64_rseq;                           // same record again
+        memset(aui8_bench_slot, 0, sizeof(aui8_bench_slot));
+        ui64_bench_copied = 0;
+        ns_start = nowNs();
+        b_new = payloadBenchNew(i, (uint16_t)i);
+        ns_new += nowNs() - ns_start;
+        ui64_copied_new += ui64_bench_copied;
+        ui64_record += sz_bench_slot_len;
+
+        if ((false == b_old) || (false == b_new) || (sz_old != sz_bench_slot_len) || (0 != memcmp(aui8_old, aui8_bench_slot, sz_old)))
+        {
+            ui32_errors++;
+        }
+    }
+
+    i = (0 != ui32_reports) ? ui32_reports : 1;
+    printf("--- payload bench: %u reports, %.0f byte records, %u mismatches ---\r\n",
+           (unsigned)ui32_reports, (double)ui64_record / i, (unsigned)ui32_errors);
+    printf("    struct & copies:  %6.0f bytes copied, %7.0f ns per report, %u bytes payload struct + %u report + %u CoAP + %u record buffers\r\n",
+           (double)ui64_copied_old / i, (double)ns_old / i, (unsigned)sizeof(ep_monitor_payload_st), (unsigned)K_MON_CODEC_MAX_LEN,
+           (unsigned)COAP_BUF_MAX_SIZE, (unsigned)DTLS_MAX_BUF);
+    printf("    in place:         %6.0f bytes copied, %7.0f ns per report, %u bytes writer + %u report buffers\r\n",
+           (double)ui64_copied_new / i, (double)ns_new / i, (unsigned)sizeof(ep_writer_st), (unsigned)K_MON_CODEC_MAX_LEN);
+
+    return ui32_errors;
+}
+
+/* the monitor payload struct before the parameters were packed into flat arrays, for its size */
+typedef struct
+{
+    ep_phase_index_et   e_phase_index;
+    uint8_t             ui8_param_count;
+    uint8_t             ui8_param32_count;
+    struct { ep_monitor_id_et e_id; uint16_t ui16_value; } as_params[K_PAYLOAD_MAX_MON_PARAM_COUNT];
+    struct { ep_monitor_id_et e_id; uint32_t ui32_value; } as_params32[K_PAYLOAD_MAX_MON_PARAM32_COUNT];
+} payload_pack_phase_v1_st;
+
+typedef struct
+{
+    ep_com_header_st            s_header;
+    uint8_t                     ui8_phase_count;
+    payload_pack_phase_v1_st    as_mon_phase[K_PAYLOAD_MAX_MON_PHASE_COUNT];
+} payload_pack_monitor_v1_st;
+
+/* a GDL interval report built on the stack, as printHarmonics() does */
+static void *payloadPackStackReport(void *pv_arg)
+{
+    ep_monitor_payload_st   s_monitor;
+    ep_com_header_st        s_header;
+    size_t                  sz_len = 0;
+
+    (void)edgePayloadInitComHeader(&s_header, 1780000000);
+    (void)edgePayloadInitMonitor(&s_monitor, &s_header);
+    for (uint8_t p = 0; p < 3; p++)
+    {
+        (void)edgePayloadNewMonitorPhase(&s_monitor, (ep_phase_index_et)(EP_PHASE_INDEX_L1 + p));
+        for (uint8_t k = 0; k < 39; k++)
+        {
+            (void)edgePayloadAddMonitorParam(&s_monitor, (ep_monitor_id_et)AUI8_QUERY_BENCH_IDS[k % sizeof(AUI8_QUERY_BENCH_IDS)], k);
+        }
+        for (uint8_t e = 0; e < 5; e++)
+        {
+            (void)edgePayloadAddMonitorParam32(&s_monitor, (ep_monitor_id_et)(EP_MON_ID_GDL_EXPORT_KWH_32 + e), e);
+        }
+    }
+    (void)edgePayloadMonitor2Buf((uint8_t *)pv_arg, K_MON_CODEC_MAX_LEN, &sz_len, &s_monitor);
+
+    return NULL;
+}
+
+static void *payloadPackStackNone(void *pv_arg)
+{
+    return pv_arg;
+}
+
+/* bytes of a painted thread stack used by pf_thread */
+static size_t payloadPackStack(void *(*pf_thread)(void *), void *pv_arg)
+{
+    static const size_t SZ_STACK = 64 * 1024;
+    uint8_t            *pui8_stack = (uint8_t *)aligned_alloc(4096, SZ_STACK);
+    pthread_attr_t      s_attr;
+    pthread_t           s_thread;
+    size_t              sz_free = 0;
+
+    memset(pui8_stack, 0xA5, SZ_STACK);
+    pthread_attr_init(&s_attr);
+    pthread_attr_setstack(&s_attr, pui8_stack, SZ_STACK);
+    if (0 == pthread_create(&s_thread, &s_attr, pf_thread, pv_arg))
+    {
+        pthread_join(s_thread, NULL);
+        while ((sz_free < SZ_STACK) && (0xA5 == pui8_stack[sz_free]))
+        {
+            sz_free++;
+        }
+    }
+    pthread_attr_destroy(&s_attr);
+    free(pui8_stack);
+
+    return SZ_STACK - sz_free;
+}
+
+/* n random monitor payloads (1..4 phases, empty to overfull ones, group splits) through the packed
+   struct, the streaming writer and the wire format spelled out here: same bytes, same parameters
+   refused; then the struct sizes and the stack of a report built on a thread stack */
+static uint32_t payloadPack(uint32_t ui32_payloads)
+{
+    static ep_monitor_payload_st    s_monitor;
+    static ep_writer_st             s_writer;
+    static uint8_t                  aui8_struct[1024];
+    static uint8_t                  aui8_writer[1024];
+    static uint8_t                  aui8_spelled[1024];
+    uint32_t                        ui32_lcg = 22;
+    uint32_t                        ui32_errors = 0;
+    uint32_t                        ui32_refused = 0;
+    uint64_t                        ui64_params = 0;
+    uint64_t                        ui64_bytes = 0;
+
+    edgePayloadInit();
+    for (uint32_t i = 0; i < ui32_payloads; i++)
+    {
+        ep_com_header_st    s_header;
+        uint8_t            *pui8_spelled = aui8_spelled;
+        uint8_t             ui8_phases;
+        uint8_t             ui8_total = 0;
+        uint8_t             ui8_total32 = 0;
+        size_t              sz_struct = 0;
+        size_t              sz_writer = 0;
+        bool                b_ok = true;
+
+        ui32_lcg = ui32_lcg * 1664525UL + 1013904223UL;
+        ui8_phases = 1 + ((ui32_lcg >> 24) % K_PAYLOAD_MAX_MON_PHASE_COUNT);
+        (void)edgePayloadInitComHeader(&s_header, (int32_t)ui32_lcg);
+        (void)edgePayloadInitMonitor(&s_monitor, &s_header);
+        edgePayloadWriterInit(&s_writer, aui8_writer, sizeof(aui8_writer));
+        (void)edgePayloadWriteComHeader(&s_writer, &s_header);
+        (void)edgePayloadComHeader2Buf(pui8_spelled, sizeof(aui8_spelled), &sz_struct, &s_header);
+        pui8_spelled += sz_struct;
+
+        for (uint8_t p = 0; p < ui8_phases; p++)
+        {
+            ep_phase_index_et   e_phase = (ep_phase_index_et)((ui32_lcg >> (4 + p * 2)) & 0x03);
+            uint8_t             ui8_n   = (uint8_t)(((ui32_lcg >> (8 + p)) & 1) ? ((ui32_lcg >> 12) % 60) : ((ui32_lcg >> 16) % 8));
+            uint8_t             ui8_n32 = (uint8_t)((ui32_lcg >> (20 + p)) % 9);
+            uint8_t             ui8_kept = 0;
+            uint8_t             ui8_kept32 = 0;
+            uint16_t            aui16_val[64];
+            uint32_t            aui32_val[16];
+
+            b_ok = (true == edgePayloadNewMonitorPhase(&s_monitor, e_phase)) && (true == edgePayloadWriteMonitorPhase(&s_writer, e_phase)) && b_ok;
+            for (uint8_t k = 0; k < ui8_n; k++)
+            {
+                bool b_fits   = (ui8_kept < K_PAYLOAD_MAX_MON_PARAM_COUNT) && (ui8_total < K_PAYLOAD_MAX_MON_PARAMS) &&
+                                (ui8_kept < K_PACK_MAX_PHASE_PARAMS);
+                bool b_taken  = edgePayloadAddMonitorParam(&s_monitor, (ep_monitor_id_et)(k + 1), (uint16_t)(ui32_lcg ^ (k * 40503UL)));
+
+                b_ok = (b_fits == b_taken) && b_ok;
+                if (true == b_taken)
+                {
+                    // the writer only knows the per phase limit
+                    b_ok = edgePayloadWriteMonitorParam(&s_writer, (ep_monitor_id_et)(k + 1), (uint16_t)(ui32_lcg ^ (k * 40503UL))) && b_ok;
+                    aui16_val[ui8_kept++] = (uint16_t)(ui32_lcg ^ (k * 40503UL));
+                    ui8_total++;
+                }
+                else
+                {
+                    ui32_refused++;
+                }
+            }
+            for (uint8_t k = 0; k < ui8_n32; k++)
+            {
+                bool b_fits   = (ui8_kept32 < K_PAYLOAD_MAX_MON_PARAM32_COUNT) && (ui8_total32 < K_PAYLOAD_MAX_MON_PARAMS32) &&
+                                ((ui8_kept + ui8_kept32) < K_PACK_MAX_PHASE_PARAMS);
+                bool b_taken  = edgePayloadAddMonitorParam32(&s_monitor, (ep_monitor_id_et)(EP_MON_ID_GDL_EXPORT_KWH_32 + k), ui32_lcg * (k + 3));
+
+                b_ok = (b_fits == b_taken) && b_ok;
+                if (true == b_taken)
+                {
+                    b_ok = edgePayloadWriteMonitorParam32(&s_writer, (ep_monitor_id_et)(EP_MON_ID_GDL_EXPORT_KWH_32 + k), ui32_lcg * (k + 3)) && b_ok;
+                    aui32_val[ui8_kept32++] = ui32_lcg * (k + 3);
+                    ui8_total32++;
+                }
+                else
+                {
+                    ui32_refused++;
+                }
+            }
+
+            // groups of up to 31: the 16-bit parameters, then the 32-bit ones
+            uint8_t ui8_all = ui8_kept + ui8_kept32;
+
+            if (0 == ui8_all)
+            {
+                *pui8_spelled++ = (uint8_t)(e_phase << 5);
+            }
+            for (uint8_t k = 0; k < ui8_all; k++)
+            {
+                if (0 == (k % 31))
+                {
+                    *pui8_spelled++ = (uint8_t)((e_phase << 5) | (((ui8_all - k) > 31) ? 31 : (ui8_all - k)));
+                }
+                if (k < ui8_kept)
+                {
+                    *pui8_spelled++ = (uint8_t)(k + 1);
+                    *pui8_spelled++ = (uint8_t)aui16_val[k];
+                    *pui8_spelled++ = (uint8_t)(aui16_val[k] >> 8);
+                }
+                else
+                {
+                    *pui8_spelled++ = (uint8_t)(EP_MON_ID_GDL_EXPORT_KWH_32 + k - ui8_kept);
+                    for (uint8_t b = 0; b < 4; b++)
+                    {
+                        *pui8_spelled++ = (uint8_t)(aui32_val[k - ui8_kept] >> (8 * b));
+                    }
+                }
+            }
+            ui64_params += ui8_all;
+        }
+
+        b_ok = (true == edgePayloadMonitor2Buf(aui8_struct, sizeof(aui8_struct), &sz_struct, &s_monitor)) &&
+               (true == edgePayloadWriterEnd(&s_writer, &sz_writer)) && b_ok;
+        if ((false == b_ok) || (sz_struct != sz_writer) || (sz_struct != (size_t)(pui8_spelled - aui8_spelled)) ||
+            (0 != memcmp(aui8_struct, aui8_writer, sz_struct)) || (0 != memcmp(aui8_struct, aui8_spelled, sz_struct)))
+        {
+            ui32_errors++;
+        }
+        ui64_bytes += sz_struct;
+    }
+
+    // stack of a report built on a thread, less what the thread start takes
+    static uint8_t  aui8_out[K_MON_CODEC_MAX_LEN];
+    size_t          sz_used = payloadPackStack(payloadPackStackReport, aui8_out) - payloadPackStack(payloadPackStackNone, NULL);
+
+    printf("--- payload pack: %u payloads, %.1f params & %.0f bytes each, %u params refused at the limits, %u mismatches ---\r\n",
+           (unsigned)ui32_payloads, (double)ui64_params / (ui32_payloads ? ui32_payloads : 1),
+           (double)ui64_bytes / (ui32_payloads ? ui32_payloads : 1), (unsigned)ui32_refused, (unsigned)ui32_errors);
+    printf("    ep_monitor_payload_st %u bytes (%u before the packing, %u saved), ep_writer_st %u bytes; "
+           "GDL report built on the stack: %u bytes of stack ---\r\n",
+           (unsigned)sizeof(ep_monitor_payload_st), (unsigned)sizeof(payload_pack_monitor_v1_st),
+           (unsigned)(sizeof(payload_pack_monitor_v1_st) - sizeof(ep_monitor_payload_st)), (unsigned)sizeof(ep_writer_st), (unsigned)sz_used);
+
+    return ui32_errors;
+}
+
+#define K_BATCH_SIM_COAP_HDR        (4 + 1 + 2 + 1)     // header, path option, payload marker
+#define K_BATCH_SIM_DTLS_HDR        (13 + 8 + 8)        // record header, explicit nonce, CCM-8 tag
+#define K_BATCH_SIM_UDP_IP_HDR      (8 + 20)
+
+static const struct
+{
+    const char *pc_name;
+    uint8_t     ui8_phases;
+    bool        b_harm;
+} AS_BATCH_SIM_SHAPE[] =
+{
+    { "3 phases & harmonics", 3, true  },
+    { "3 phases",             3, false },
+    { "1 phase",              1, false },
+};
+
+static uint16_t batchSimRecord(uint8_t ui8_shape, uint32_t i, int32_t si32_ts, uint8_t *pui8_buf, size_t sz_buf_len)
+{
+    static ep_monitor_payload_st    s_monitor;
+    ep_com_header_st                s_header;
+    size_t                          sz_len = 0;
+
+    (void)edgePayloadInitComHeader(&s_header, si32_ts);
+    (void)edgePayloadInitMonitor(&s_monitor, &s_header);
+    for (uint8_t p = 0; p < AS_BATCH_SIM_SHAPE[ui8_shape].ui8_phases; p++)
+    {
+        (void)edgePayloadNewMonitorPhase(&s_monitor, (ep_phase_index_et)(EP_PHASE_INDEX_L1 + p));
+        for (uint8_t k = 0; k < sizeof(AUI8_QUERY_BENCH_IDS); k++)
+        {
+            (void)edgePayloadAddMonitorParam(&s_monitor, (ep_monitor_id_et)AUI8_QUERY_BENCH_IDS[k], payloadBenchValue(i, p, k));
+        }
+        for (uint8_t h = 0; (true == AS_BATCH_SIM_SHAPE[ui8_shape].b_harm) && (h < K_HARM_NUM_ORDERS); h++)
+        {
+            (void)edgePayloadAddMonitorParam(&s_monitor, (ep_monitor_id_et)(EP_MON_ID_GDL_V_3RD_HARM + h), payloadBenchValue(i, p, 20 + h));
+            (void)edgePayloadAddMonitorParam(&s_monitor, (ep_monitor_id_et)(EP_MON_ID_GDL_I_3RD_HARM + h), payloadBenchValue(i, p, 40 + h));
+        }
+        for (uint8_t e = 0; e < 5; e++)
+        {
+            (void)edgePayloadAddMonitorParam32(&s_monitor, (ep_monitor_id_et)(EP_MON_ID_GDL_EXPORT_KWH_32 + e), 100000 * i + payloadBenchValue(i, p, 60 + e));
+        }
+    }
+    (void)edgePayloadMonitor2Buf(pui8_buf, sz_buf_len, &sz_len, &s_monitor);
+
+    return (uint16_t)sz_len;
+}
+
+/* the intervals of a batch unpacked and compared with the records they came from, counted per
+   interval; false: malformed */
+static bool batchSimCheck(uint8_t ui8_shape, const uint8_t *pui8_batch, size_t sz_len, int32_t si32_ts0, uint16_t *pui16_delivered,
+                          uint32_t ui32_intervals)
+{
+    static uint8_t  aui8_rec[K_MON_CODEC_MAX_LEN];
+    static uint8_t  aui8_unpacked[K_MON_CODEC_MAX_LEN];
+    size_t          sz_hdr = 3 + pui8_batch[2];
+    size_t          sz_off = sz_hdr + 4 + 1;
+    int32_t         si32_first;
+    uint8_t         ui8_count;
+
+    if (sz_len < sz_off)
+    {
+        return false;
+    }
+    si32_first = (int32_t)((uint32_t)pui8_batch[sz_hdr] | ((uint32_t)pui8_batch[sz_hdr + 1] << 8) |
+                           ((uint32_t)pui8_batch[sz_hdr + 2] << 16) | ((uint32_t)pui8_batch[sz_hdr + 3] << 24));
+    ui8_count  = pui8_batch[sz_hdr + 4];
+
+    for (uint8_t n = 0; n < ui8_count; n++)
+    {
+        int32_t     si32_ts;
+        uint16_t    ui16_body;
+        uint32_t    i;
+
+        if ((sz_off + 4) > sz_len)
+        {
+            return false;
+        }
+        si32_ts   = si32_first + (int32_t)(pui8_batch[sz_off] | (pui8_batch[sz_off + 1] << 8));
+        ui16_body = (uint16_t)(pui8_batch[sz_off + 2] | (pui8_batch[sz_off + 3] << 8));
+        sz_off   += 4;
+        i         = (uint32_t)(si32_ts - si32_ts0) / 60;
+        if (((sz_off + ui16_body) > sz_len) || (i >= ui32_intervals) || ((sz_hdr + 4 + ui16_body) > sizeof(aui8_unpacked)))
+        {
+            return false;
+        }
+
+        memcpy(aui8_unpacked, pui8_batch, sz_hdr);
+        for (uint8_t b = 0; b < 4; b++)
+        {
+            aui8_unpacked[sz_hdr + b] = (uint8_t)((uint32_t)si32_ts >> (8 * b));
+        }
+        memcpy(&aui8_unpacked[sz_hdr + 4], &pui8_batch[sz_off], ui16_body);
+        sz_off += ui16_body;
+
+        if (((sz_hdr + 4 + ui16_body) != batchSimRecord(ui8_shape, i, si32_ts, aui8_rec, sizeof(aui8_rec))) ||
+            (0 != memcmp(aui8_rec, aui8_unpacked, sz_hdr + 4 + ui16_body)))
+        {
+            return false;
+        }
+        pui16_delivered[i]++;
+    }
+
+    return (sz_off == sz_len);
+}
+
+/* a single interval request ("mn", edgePayloadBatch2Monitor()) compared with its record */
+static bool batchSimCheckSingle(uint8_t ui8_shape, const uint8_t *pui8_payload, size_t sz_len, int32_t si32_ts0, uint16_t *pui16_delivered,
+                                uint32_t ui32_intervals)
+{
+    static uint8_t  aui8_rec[K_MON_CODEC_MAX_LEN];
+    size_t          sz_hdr = 3 + pui8_payload[2];
+    int32_t         si32_ts;
+    uint32_t        i;
+
+    if (sz_len < (sz_hdr + 4))
+    {
+        return false;
+    }
+    si32_ts = (int32_t)((uint32_t)pui8_payload[sz_hdr] | ((uint32_t)pui8_payload[sz_hdr + 1] << 8) |
+                        ((uint32_t)pui8_payload[sz_hdr + 2] << 16) | ((uint32_t)pui8_payload[sz_hdr + 3] << 24));
+    i       = (uint32_t)(si32_ts - si32_ts0) / 60;
+    if ((i >= ui32_intervals) || (sz_len != batchSimRecord(ui8_shape, i, si32_ts, aui8_rec, sizeof(aui8_rec))) ||
+        (0 != memcmp(aui8_rec, pui8_payload, sz_len)))
+    {
+        return false;
+    }
+    pui16_delivered[i]++;
+
+    return true;
+}
+
+/* n 1 min intervals per report size through the data log and the replay, the link up: one report
+   per request vs. consecutive ones batched into K_CLOUD_MONITOR_BATCH_LEN bytes (a batch of one
+   sent as a single, as cloud::monitor does), every 10th acknowledge lost; requests & bytes on the
+   air, every interval unpacked & compared */
+static uint32_t batchSim(uint32_t ui32_intervals)
+{
+    static const char      *PC_DIR    = K_STORAGE_BASE_PATH "/batch_sim";
+    static const char      *PC_CURSOR = K_STORAGE_BASE_PATH "/batch_sim.bin";
+    static const int32_t    SI32_TS0  = 1780000000;
+    static dlog_st          s_log;
+    static replay_st        s_rp;
+    static mon_codec_st     s_codec;
+    static uint8_t          aui8_rec[K_DLOG_MAX_REC_LEN];
+    static uint8_t          aaui8_batch[K_SIM_SEND_QUEUE][K_CLOUD_MONITOR_BATCH_LEN];
+    uint16_t               *pui16_delivered = (uint16_t *)calloc(ui32_intervals, sizeof(uint16_t));
+    uint32_t                ui32_failed = 0;
+
+    edgePayloadInit();
+    for (uint8_t ui8_shape = 0; ui8_shape < (sizeof(AS_BATCH_SIM_SHAPE) / sizeof(AS_BATCH_SIM_SHAPE[0])); ui8_shape++)
+    {
+        uint64_t    ui64_payload = 0;
+
+        for (uint8_t ui8_batched = 0; ui8_batched < 2; ui8_batched++)
+        {
+            uint16_t    aui16_ticket[K_SIM_SEND_QUEUE];
+            uint8_t     ui8_sent = 0;
+            uint16_t    ui16_ticket = 0;
+            uint32_t    ui32_requests = 0;
+            uint32_t    ui32_acks = 0;
+            uint32_t    ui32_errors = 0;
+            uint32_t    ui32_lost = 0;
+            uint32_t    ui32_dup = 0;
+            uint64_t    ui64_bytes = 0;
+            uint64_t    ms = 0;
+
+            mkdir(PC_DIR, 0755);
+            clearDir(PC_DIR);
+            remove(PC_CURSOR);
+            (void)dlogInit(&s_log, PC_DIR);
+            monCodecInit(&s_codec);
+            replayInit(&s_rp, PC_CURSOR, &s_log);
+            replayOnline(&s_rp, &s_log);
+            memset(pui16_delivered, 0, ui32_intervals * sizeof(uint16_t));
+
+            ui64_payload = 0;
+            for (uint32_t i = 0; i < ui32_intervals; i++)
+            {
+                int32_t  si32_ts  = SI32_TS0 + (int32_t)(i * 60);
+                uint16_t ui16_len = batchSimRecord(ui8_shape, i, si32_ts, aui8_rec, sizeof(aui8_rec));
+
+                (void)monCodecAppend(&s_codec, &s_log, si32_ts, aui8_rec, ui16_len);
+                ui64_payload += ui16_len;
+            }
+
+            // one cycle per second: what was sent is acknowledged by the next one
+            for ( ; (s_rp.aui32_acked[REPLAY_LIVE] < ui32_intervals) && (ms < 3600000ULL * 24); ms += 1000)
+            {
+                for (uint8_t q = 0; q < ui8_sent; q++)
+                {
+                    if (0 != (++ui32_acks % 10))
+                    {
+                        (void)replayAck(&s_rp, aui16_ticket[q]);
+                    }
+                }
+                ui8_sent = 0;
+                (void)replayPoll(&s_rp, (uint32_t)ms);
+
+                while (ui8_sent < K_SIM_SEND_QUEUE)
+                {
+                    ep_monitor_batch_st s_batch;
+                    const uint8_t      *pui8_report;
+                    int32_t             si32_ts;
+                    uint16_t            ui16_len;
+                    bool                b_ok;
+                    size_t              sz_len;
+
+                    ui16_ticket = (uint16_t)((0 == (ui16_ticket + 1)) ? 1 : (ui16_ticket + 1));
+                    if (0 != ui8_batched)
+                    {
+                        edgePayloadBatchInit(&s_batch, aaui8_batch[ui8_sent], K_CLOUD_MONITOR_BATCH_LEN);
+                        if (false == replayNextBatch(&s_rp, &s_log, K_SIM_SEND_QUEUE - ui8_sent, (uint32_t)ms, &s_batch))
+                        {
+                            break;
+                        }
+                        if (1 < s_batch.ui8_count)
+                        {
+                            sz_len = edgePayloadBatchLen(&s_batch);
+                            b_ok   = batchSimCheck(ui8_shape, aaui8_batch[ui8_sent], sz_len, SI32_TS0, pui16_delivered, ui32_intervals);
+                        }
+                        else
+                        {
+                            sz_len = edgePayloadBatch2Monitor(&s_batch);
+                            b_ok   = batchSimCheckSingle(ui8_shape, aaui8_batch[ui8_sent], sz_len, SI32_TS0, pui16_delivered, ui32_intervals);
+                        }
+                    }
+                    else
+                    {
+                        if (false == replayNext(&s_rp, &s_log, K_SIM_SEND_QUEUE - ui8_sent, (uint32_t)ms, &si32_ts, &pui8_report, &ui16_len))
+                        {
+                            break;
+                        }
+                        sz_len = ui16_len;
+                        b_ok   = ((uint32_t)(si32_ts - SI32_TS0) / 60) < ui32_intervals;
+                        if (true == b_ok)
+                        {
+                            pui16_delivered[(si32_ts - SI32_TS0) / 60]++;
+                        }
+                    }
+
+                    ui32_errors += (false == b_ok) ? 1 : 0;
+                    ui32_requests++;
+                    ui64_bytes += sz_len + K_BATCH_SIM_COAP_HDR + K_BATCH_SIM_DTLS_HDR + K_BATCH_SIM_UDP_IP_HDR;
+                    aui16_ticket[ui8_sent++] = ui16_ticket;
+                    replaySent(&s_rp, ui16_ticket, true);
+                }
+            }
+
+            for (uint32_t i = 0; i < ui32_intervals; i++)
+            {
+                ui32_lost += (0 == pui16_delivered[i]) ? 1 : 0;
+                ui32_dup  += (pui16_delivered[i] > 1) ? (pui16_delivered[i] - 1) : 0;
+            }
+
+            printf("--- batch sim: %-20s %s %u intervals (%.0f B) in %6u requests, %.2f per request, %6.1f B on the air per interval, "
+                   "%.0f s; %u lost, %u sent again, %u errors ---\r\n",
+                   AS_BATCH_SIM_SHAPE[ui8_shape].pc_name, (0 != ui8_batched) ? "batched:" : "single: ", (unsigned)ui32_intervals,
+                   (double)ui64_payload / ui32_intervals, (unsigned)ui32_requests, (double)s_rp.aui32_sent[REPLAY_LIVE] / ui32_requests,
+                   (double)ui64_bytes / ui32_intervals, ms / 1000.0, (unsigned)ui32_lost, (unsigned)ui32_dup, (unsigned)ui32_errors);
+            ui32_failed += ui32_lost + ui32_errors;
+        }
+    }
+
+    clearDir(PC_DIR);
+    remove(PC_CURSOR);
+    free(pui16_delivered);
+
+    return ui32_failed;
+}
+
+static uint32_t payloadFuzzRand(uint32_t *pui32_lcg)
+{
+    *pui32_lcg = *pui32_lcg * 1664525UL + 1013904223UL;
+
+    return *pui32_lcg >> 8;
+}
+
+/* random payload of kind 0 monitor, 1 status, 2 event, 3 update get; consecutive phases of other
+   indices, as a device reports them */
+static size_t payloadFuzzMake(uint8_t ui8_kind, uint32_t *pui32_lcg, const uint8_t *pui8_pool, uint8_t *pui8_buf, size_t sz_buf_len)
+{
+    static ep_monitor_payload_st    s_monitor;
+    static ep_status_payload_st     s_status;
+    static ep_event_payload_st      s_event;
+    static ep_update_get_payload_st s_update_get;
+    ep_com_header_st                s_header;
+    size_t                          sz_len = 0;
+    uint8_t                         ui8_phase = (uint8_t)(payloadFuzzRand(pui32_lcg) & 0x03);
+
+    // this device's header from the template, or another's field by field
+    (void)edgePayloadInitComHeader(&s_header, (int32_t)payloadFuzzRand(pui32_lcg));
+    if (0 != (payloadFuzzRand(pui32_lcg) & 1))
+    {
+        s_header.b_template         = false;
+        s_header.e_protocol_ver     = (ep_protocol_ver_et)(EP_PROTOCOL_VER_MIN + (payloadFuzzRand(pui32_lcg) % 2));
+        s_header.e_dev_type         = (ep_dev_type_et)(EP_DEVICE_TYPE_MIN + (payloadFuzzRand(pui32_lcg) % (EP_DEVICE_TYPE_MAX - EP_DEVICE_TYPE_MIN + 1)));
+        s_header.s_dev_id.ui8_len   = (uint8_t)(payloadFuzzRand(pui32_lcg) % (K_PAYLOAD_MAX_DEV_ID_LEN + 1));
+        memcpy(s_header.s_dev_id.aui8_id, &pui8_pool[payloadFuzzRand(pui32_lcg) % 192], sizeof(s_header.s_dev_id.aui8_id));
+    }
+
+    switch (ui8_kind)
+    {
+        case 0:
+            (void)edgePayloadInitMonitor(&s_monitor, &s_header);
+            for (uint8_t p = (uint8_t)(payloadFuzzRand(pui32_lcg) % K_PAYLOAD_MAX_MON_PHASE_COUNT); p < K_PAYLOAD_MAX_MON_PHASE_COUNT; p++)
+            {
+                uint8_t ui8_n   = (uint8_t)(payloadFuzzRand(pui32_lcg) % 64);
+                uint8_t ui8_n32 = (uint8_t)(payloadFuzzRand(pui32_lcg) % 8);
+
+                ui8_phase = (uint8_t)((ui8_phase + 1 + (payloadFuzzRand(pui32_lcg) % 3)) & 0x03);
+                (void)edgePayloadNewMonitorPhase(&s_monitor, (ep_phase_index_et)ui8_phase);
+                for (uint8_t k = 0; k < ui8_n; k++)
+                {
+                    (void)edgePayloadAddMonitorParam(&s_monitor, (ep_monitor_id_et)(payloadFuzzRand(pui32_lcg) % EP_MON_ID_GDL_EXPORT_KWH_32),
+                                                     (uint16_t)payloadFuzzRand(pui32_lcg));
+                }
+                for (uint8_t k = 0; k < ui8_n32; k++)
+                {
+                    (void)edgePayloadAddMonitorParam32(&s_monitor, (ep_monitor_id_et)(EP_MON_ID_GDL_EXPORT_KWH_32 + (payloadFuzzRand(pui32_lcg) % 5)),
+                                                       payloadFuzzRand(pui32_lcg) * 257);
+                }
+            }
+            (void)edgePayloadMonitor2Buf(pui8_buf, sz_buf_len, &sz_len, &s_monitor);
+            break;
+
+        case 1:
+            (void)edgePayloadInitStatus(&s_status, &s_header);
+            for (uint8_t t = (uint8_t)(payloadFuzzRand(pui32_lcg) % (K_PAYLOAD_MAX_STATUS_TAG_COUNT + 1)); t > 0; t--)
+            {
+                (void)edgePayloadAddStatusTag(&s_status, (ep_tag_id_et)(EP_STATUS_TAG_MIN + (payloadFuzzRand(pui32_lcg) % (EP_STATUS_TAG_MAX - EP_STATUS_TAG_MIN + 1))),
+                                              &pui8_pool[payloadFuzzRand(pui32_lcg) % 192], (uint8_t)(payloadFuzzRand(pui32_lcg) % 64));
+            }
+            (void)edgePayloadStatus2Buf(pui8_buf, sz_buf_len, &sz_len, &s_status);
+            break;
+
+        case 2:
+            (void)edgePayloadInitEvent(&s_event, &s_header);
+            for (uint8_t e = (uint8_t)(payloadFuzzRand(pui32_lcg) % (K_PAYLOAD_MAX_EVENTS_COUNT + 1)); e > 0; e--)
+            {
+                (void)edgePayloadAddEventContent(&s_event, (ep_event_type_et)(payloadFuzzRand(pui32_lcg) & 0xFF),
+                                                 &pui8_pool[payloadFuzzRand(pui32_lcg) % 192], (uint8_t)(payloadFuzzRand(pui32_lcg) % 64));
+            }
+            (void)edgePayloadEvent2Buf(pui8_buf, sz_buf_len, &sz_len, &s_event);
+            break;
+
+        default:
+            (void)edgePayloadInitUpdateGet(&s_update_get, &s_header);
+            (void)edgePayloadSetUpdateGetContent(&s_update_get, payloadFuzzRand(pui32_lcg) * 512, (uint16_t)payloadFuzzRand(pui32_lcg));
+            (void)edgePayloadUpdateGet2Buf(pui8_buf, sz_buf_len, &sz_len, &s_update_get);
+            break;
+    }
+
+    return sz_len;
+}
+
+/* pui8_in decoded as kind ui8_kind and encoded again into pui8_out: 0 refused by the decoder,
+   the length encoded otherwise */
+static size_t payloadFuzzRoundTrip(uint8_t ui8_kind, const uint8_t *pui8_in, size_t sz_in_len, uint8_t *pui8_out, size_t sz_out_len)
+{
+    static ep_monitor_view_st       s_view;
+    static ep_monitor_payload_st    s_monitor;
+    static ep_status_payload_st     s_status;
+    static ep_event_payload_st      s_event;
+    static ep_update_get_payload_st s_update_get;
+    size_t                          sz_len = 0;
+    bool                            b_ok = false;
+
+    switch (ui8_kind)
+    {
+        case 0:
+            if (true == edgePayloadBuf2Monitor(pui8_in, sz_in_len, &s_view))
+            {
+                (void)edgePayloadInitMonitor(&s_monitor, &s_view.s_header);
+                for (uint8_t p = 0; p < s_view.ui8_phase_count; p++)
+                {
+                    ep_monitor_cursor_st    s_cursor;
+                    uint8_t                 ui8_id;
+                    uint32_t                ui32_value;
+
+                    (void)edgePayloadNewMonitorPhase(&s_monitor, (ep_phase_index_et)s_view.as_phases[p].ui8_phase_index);
+                    edgePayloadMonitorViewCursor(&s_view.as_phases[p], &s_cursor);
+                    while (true == edgePayloadMonitorViewNext(&s_cursor, &ui8_id, &ui32_value))
+                    {
+                        if (5 == edgePayloadMonitorParamLen(ui8_id))
+                        {
+                            (void)edgePayloadAddMonitorParam32(&s_monitor, (ep_monitor_id_et)ui8_id, ui32_value);
+                        }
+                        else
+                        {
+                            (void)edgePayloadAddMonitorParam(&s_monitor, (ep_monitor_id_et)ui8_id, (uint16_t)ui32_value);
+                        }
+                    }
+                }
+                b_ok = edgePayloadMonitor2Buf(pui8_out, sz_out_len, &sz_len, &s_monitor);
+            }
+            break;
+
+        case 1:
+            b_ok = (true == edgePayloadBuf2Status(pui8_in, sz_in_len, &s_status)) &&
+                   (true == edgePayloadStatus2Buf(pui8_out, sz_out_len, &sz_len, &s_status));
+            break;
+
+        case 2:
+            b_ok = (true == edgePayloadBuf2Event(pui8_in, sz_in_len, &s_event)) &&
+                   (true == edgePayloadEvent2Buf(pui8_out, sz_out_len, &sz_len, &s_event));
+            break;
+
+        default:
+            b_ok = (true == edgePayloadBuf2UpdateGet(pui8_in, sz_in_len, &s_update_get)) &&
+                   (true == edgePayloadUpdateGet2Buf(pui8_out, sz_out_len, &sz_len, &s_update_get));
+            break;
+    }
+
+    // nothing valid encodes to 0 bytes: at least the header
+    return (true == b_ok) ? ((0 == sz_len) ? 1 : sz_len) : 0;
+}
+
+/* n random payloads of each kind encoded, decoded & encoded again: same bytes; every one then
+   mutated (bytes flipped, cut, grown) from a buffer of its exact length, through all four
+   decoders: what one accepts must encode back to the same bytes. Then decoding against
+   encoding throughput of GDL reports */
+static uint32_t payloadFuzz(uint32_t ui32_payloads)
+{
+    static const char  *APC_KIND[] = { "monitor", "status", "event", "update get" };
+    static uint8_t      aui8_pool[256];
+    static uint8_t      aui8_enc[1024];
+    static uint8_t      aui8_out[1024];
+    uint32_t            ui32_lcg = 24;
+    uint32_t            aui32_trips[4] = { 0 };
+    uint32_t            aui32_taken[4] = { 0 };
+    uint32_t            ui32_mutants = 0;
+    uint32_t            ui32_errors = 0;
+
+    edgePayloadInit();
+    for (size_t b = 0; b < sizeof(aui8_pool); b++)
+    {
+        aui8_pool[b] = (uint8_t)payloadFuzzRand(&ui32_lcg);
+    }
+
+    for (uint32_t i = 0; i < (4 * ui32_payloads); i++)
+    {
+        uint8_t ui8_kind = (uint8_t)(i & 0x03);
+        size_t  sz_len   = payloadFuzzMake(ui8_kind, &ui32_lcg, aui8_pool, aui8_enc, sizeof(aui8_enc));
+
+        if ((0 == sz_len) || (sz_len != payloadFuzzRoundTrip(ui8_kind, aui8_enc, sz_len, aui8_out, sizeof(aui8_out))) ||
+            (0 != memcmp(aui8_enc, aui8_out, sz_len)))
+        {
+            ui32_errors++;
+            continue;
+        }
+        aui32_trips[ui8_kind]++;
+
+        for (uint8_t m = 0; m < 8; m++)
+        {
+            size_t      sz_mut = sz_len;
+            uint8_t    *pui8_mut;
+            uint32_t    ui32_r = payloadFuzzRand(&ui32_lcg);
+
+            switch (ui32_r & 0x03)
+            {
+                case 0:     sz_mut = (ui32_r >> 2) % sz_len;    break;             // cut
+                case 1:     sz_mut = sz_len + 1 + (ui32_r % 7); break;             // grown
+                default:                                        break;             // bytes flipped
+            }
+
+            pui8_mut = (uint8_t *)malloc((0 == sz_mut) ? 1 : sz_mut);
+            memcpy(pui8_mut, aui8_enc, (sz_mut < sz_len) ? sz_mut : sz_len);
+            for (size_t b = sz_len; b < sz_mut; b++)
+            {
+                pui8_mut[b] = (uint8_t)payloadFuzzRand(&ui32_lcg);
+            }
+            for (uint8_t f = 0; (f < (1 + (ui32_r >> 28))) && (sz_mut > 0) && ((ui32_r & 0x03) > 1); f++)
+            {
+                pui8_mut[payloadFuzzRand(&ui32_lcg) % sz_mut] ^= (uint8_t)(1 << (payloadFuzzRand(&ui32_lcg) & 0x07));
+            }
+
+            for (uint8_t k = 0; k < 4; k++)
+            {
+                size_t sz_out = payloadFuzzRoundTrip(k, pui8_mut, sz_mut, aui8_out, sizeof(aui8_out));
+
+                if (0 != sz_out)
+                {
+                    aui32_taken[k]++;
+                    ui32_errors += ((sz_out != sz_mut) || (0 != memcmp(pui8_mut, aui8_out, sz_mut))) ? 1 : 0;
+                }
+            }
+            free(pui8_mut);
+            ui32_mutants++;
+        }
+    }
+
+    printf("--- payload fuzz: %u x 4 payloads encoded, decoded & encoded again, %u mutants through the 4 decoders; %u errors ---\r\n",
+           (unsigned)ui32_payloads, (unsigned)ui32_mutants, (unsigned)ui32_errors);
+    for (uint8_t k = 0; k < 4; k++)
+    {
+        printf("    %-10s %u round trips, %u mutants accepted (encode back to the same bytes) ---\r\n",
+               APC_KIND[k], (unsigned)aui32_trips[k], (unsigned)aui32_taken[k]);
+    }
+
+    // GDL reports: decoded & every parameter read vs. the struct filled & encoded
+    static uint8_t  aaui8_rep[64][K_MON_CODEC_MAX_LEN];
+    uint16_t        aui16_rep_len[64];
+    uint64_t        ui64_bytes = 0;
+    uint64_t        ui64_sum = 0;
+    uint64_t        ns_check;
+    uint64_t        ns_decode;
+    uint64_t        ns_encode;
+    uint32_t        ui32_rounds = (ui32_payloads < 64) ? 1 : (ui32_payloads / 64);
+
+    for (uint8_t r = 0; r < 64; r++)
+    {
+        aui16_rep_len[r] = batchSimRecord(0, r, 1780000000 + r * 60, aaui8_rep[r], sizeof(aaui8_rep[r]));
+    }
+
+    ns_check = nowNs();
+    for (uint32_t n = 0; n < ui32_rounds; n++)
+    {
+        for (uint8_t r = 0; r < 64; r++)
+        {
+            static ep_monitor_view_st s_view;
+
+            ui32_errors += (true == edgePayloadBuf2Monitor(aaui8_rep[r], aui16_rep_len[r], &s_view)) ? 0 : 1;
+            ui64_sum    += s_view.ui8_phase_count;
+        }
+    }
+    ns_check = nowNs() - ns_check;
+
+    ns_decode = nowNs();
+    for (uint32_t n = 0; n < ui32_rounds; n++)
+    {
+        for (uint8_t r = 0; r < 64; r++)
+        {
+            static ep_monitor_view_st   s_view;
+            ep_monitor_cursor_st        s_cursor;
+            uint8_t                     ui8_id;
+            uint32_t                    ui32_value;
+
+            if (false == edgePayloadBuf2Monitor(aaui8_rep[r], aui16_rep_len[r], &s_view))
+            {
+                ui32_errors++;
+                continue;
+            }
+            for (uint8_t p = 0; p < s_view.ui8_phase_count; p++)
+            {
+                edgePayloadMonitorViewCursor(&s_view.as_phases[p], &s_cursor);
+                while (true == edgePayloadMonitorViewNext(&s_cursor, &ui8_id, &ui32_value))
+                {
+                    ui64_sum += ui32_value;
+                }
+            }
+            ui64_bytes += aui16_rep_len[r];
+        }
+    }
+    ns_decode = nowNs() - ns_decode;
+
+    ns_encode = nowNs();
+    for (uint32_t n = 0; n < ui32_rounds; n++)
+    {
+        for (uint8_t r = 0; r < 64; r++)
+        {
+            ui64_sum += batchSimRecord(0, r, 1780000000 + r * 60, aui8_out, sizeof(aui8_out));
+        }
+    }
+    ns_encode = nowNs() - ns_encode;
+
+    printf("    GDL reports (%u B): checked %.0f ns each, checked & every parameter read %.0f ns each (%.0f MB/s), filled & encoded "
+           "%.0f ns each; %u errors (%llx) ---\r\n",
+           (unsigned)aui16_rep_len[0], (double)ns_check / (ui32_rounds * 64.0), (double)ns_decode / (ui32_rounds * 64.0),
+           (double)ui64_bytes * 1000.0 / (ns_decode ? ns_decode : 1),
+           (double)ns_encode / (ui32_rounds * 64.0), (unsigned)ui32_errors, (unsigned long long)(ui64_sum & 0xF));
+
+    return ui32_errors;
+}
+
+/* the parent's relay of child payloads as app/lora_mesh/cloud_mesh.c does it: an entry queued
+   with the first segment, the others appended, then getQueuedRequest() forwarding it or dropping
+   what edgePayloadCheck() refuses */
+#define K_RELAY_PAYLOAD_MAX         (320)       // K_MESH_CLOUD_REPORT_PAYLOAD_MAXIMUM_SIZE
+#define K_RELAY_QUEUE_SIZE          (4)         // K_MESH_CLOUD_REQUEST_QUEUE_SIZE
+#define K_RELAY_SEGMENT             (96)        // child payload bytes per mesh message
+
+typedef struct
+{
+    ep_payload_kind_et  e_kind;
+    bool                b_mutated;
+    uint8_t             aui8_buf[K_RELAY_PAYLOAD_MAX];
+    uint16_t            ui16_len;
+} relay_entry_st;
+
+static struct
+{
+    relay_entry_st  as_entries[K_RELAY_QUEUE_SIZE];
+    QueueHandle_t   queue;
+    uint32_t        ui32_forwarded;
+    uint32_t        ui32_dropped;
+    uint32_t        ui32_dropped_mutated;
+    uint32_t        ui32_errors;
+} s_relay;
+
+/* the head entry forwarded or dropped as getQueuedRequest() does; false if the queue is empty */
+static bool meshRelayDequeue(void)
+{
+    static const uint8_t    AUI8_FUZZ_KIND[] = { 0, 1, 0xFF, 2, 3 };           // by ep_payload_kind_et
+    static uint8_t          aui8_out[1024];
+    relay_entry_st         *ps_entry = NULL;
+
+    if (pdTRUE != xQueuePeek(s_relay.queue, &ps_entry, 0))
+    {
+        return false;
+    }
+
+    (void)xQueueReceive(s_relay.queue, &ps_entry, 0);
+    if (false == edgePayloadCheck(ps_entry->e_kind, ps_entry->aui8_buf, ps_entry->ui16_len))
+    {
+        s_relay.ui32_dropped++;
+        s_relay.ui32_dropped_mutated += (true == ps_entry->b_mutated) ? 1 : 0;
+        s_relay.ui32_errors          += (true == ps_entry->b_mutated) ? 0 : 1;        // an intact payload lost
+    }
+    else
+    {
+        size_t              sz_out = 0;
+        ep_com_header_st    s_header;
+
+        // what is forwarded, mutated or not, decodes & encodes back to the same bytes
+        if (EP_PAYLOAD_STATUS_GET == ps_entry->e_kind)
+        {
+            sz_out = ((true == edgePayloadBuf2ComHeader(ps_entry->aui8_buf, ps_entry->ui16_len, &sz_out, &s_header)) &&
+                      (true == edgePayloadComHeader2Buf(aui8_out, sizeof(aui8_out), &sz_out, &s_header))) ? sz_out : 0;
+        }
+        else
+        {
+            sz_out = payloadFuzzRoundTrip(AUI8_FUZZ_KIND[ps_entry->e_kind], ps_entry->aui8_buf, ps_entry->ui16_len, aui8_out, sizeof(aui8_out));
+        }
+        s_relay.ui32_errors += ((sz_out != ps_entry->ui16_len) || (0 != memcmp(ps_entry->aui8_buf, aui8_out, sz_out))) ? 1 : 0;
+        s_relay.ui32_forwarded++;
+    }
+    memset(ps_entry, 0, sizeof(relay_entry_st));
+
+    return true;
+}
+
+/* n random payloads of each kind a child sends, one in four mutated (a bit flipped, cut, grown)
+   before it is split into segments: no intact payload dropped, nothing forwarded the decoders
+   would not encode back */
+static uint32_t meshRelay(uint32_t ui32_payloads)
+{
+    static const ep_payload_kind_et AE_KIND[] = { EP_PAYLOAD_MONITOR, EP_PAYLOAD_STATUS, EP_PAYLOAD_STATUS_GET,
+                                                  EP_PAYLOAD_EVENT, EP_PAYLOAD_UPDATE_GET };
+    static const uint8_t            AUI8_FUZZ_KIND[] = { 0, 1, 0xFF, 2, 3 };
+    static uint8_t                  aui8_pool[256];
+    static uint8_t                  aui8_enc[1024];
+    uint32_t                        ui32_lcg = 17;
+    uint32_t                        ui32_relayed = 0;
+    uint32_t                        ui32_mutated = 0;
+    uint32_t                        ui32_segments = 0;
+
+    memset(&s_relay, 0, sizeof(s_relay));
+    s_relay.queue = xQueueCreate(K_RELAY_QUEUE_SIZE, sizeof(relay_entry_st *));
+    edgePayloadInit();
+    for (size_t b = 0; b < sizeof(aui8_pool); b++)
+    {
+        aui8_pool[b] = (uint8_t)payloadFuzzRand(&ui32_lcg);
+    }
+
+    for (uint32_t i = 0; i < (5 * ui32_payloads); i++)
+    {
+        ep_payload_kind_et  e_kind = AE_KIND[i % 5];
+        relay_entry_st     *ps_entry = NULL;
+        size_t              sz_len = 0;
+        uint32_t            ui32_r = payloadFuzzRand(&ui32_lcg);
+        bool                b_mutated = (0 == (ui32_r & 0x03));
+
+        if (EP_PAYLOAD_STATUS_GET == e_kind)
+        {
+            (void)edgePayloadHeaderPrefix2Buf(aui8_enc, sizeof(aui8_enc), &sz_len, (int32_t)(1780000000 + i));
+        }
+        else
+        {
+            sz_len = payloadFuzzMake(AUI8_FUZZ_KIND[e_kind], &ui32_lcg, aui8_pool, aui8_enc, sizeof(aui8_enc));
+        }
+        if ((0 == sz_len) || (sz_len >= K_RELAY_PAYLOAD_MAX))
+        {
+            continue;                                                               // refused by the parent on arrival
+        }
+
+        if (true == b_mutated)
+        {
+            switch ((ui32_r >> 2) % 3)
+            {
+                case 0:     aui8_enc[(ui32_r >> 4) % sz_len] ^= (uint8_t)(1 << ((ui32_r >> 12) & 0x07));    break;
+                case 1:     sz_len -= 1 + ((ui32_r >> 4) % sz_len);                                         break;
+                default:    aui8_enc[sz_len++] = (uint8_t)(ui32_r >> 4);                                    break;
+            }
+            if (0 == sz_len)
+            {
+                continue;
+            }
+        }
+
+        // an empty entry, the queue drained when there is none
+        for (uint8_t e = 0; (NULL == ps_entry) && (e < K_RELAY_QUEUE_SIZE); e++)
+        {
+            ps_entry = (0 == s_relay.as_entries[e].ui16_len) ? &s_relay.as_entries[e] : NULL;
+        }
+        if (NULL == ps_entry)
+        {
+            while (true == meshRelayDequeue())
+            {
+            }
+            ps_entry = &s_relay.as_entries[0];
+        }
+
+        ps_entry->e_kind    = e_kind;
+        ps_entry->b_mutated = b_mutated;
+        for (size_t sz_off = 0; sz_off < sz_len; sz_off += K_RELAY_SEGMENT)
+        {
+            size_t sz_seg = ((sz_len - sz_off) < K_RELAY_SEGMENT) ? (sz_len - sz_off) : K_RELAY_SEGMENT;
+
+            memcpy(&ps_entry->aui8_buf[ps_entry->ui16_len], &aui8_enc[sz_off], sz_seg);
+            ps_entry->ui16_len += (uint16_t)sz_seg;
+            if ((0 == sz_off) && (pdTRUE != xQueueSend(s_relay.queue, &ps_entry, 0)))
+            {
+                s_relay.ui32_errors++;
+            }
+            ui32_segments++;
+        }
+        ui32_relayed++;
+        ui32_mutated += (true == b_mutated) ? 1 : 0;
+    }
+    while (true == meshRelayDequeue())
+    {
+    }
+    vQueueDelete(s_relay.queue);
+
+    printf("--- mesh relay: %u payloads in %u segments through a %u-entry queue, %u mutated: %u forwarded, %u dropped at dequeue "
+           "(%u of them mutated); %u errors ---\r\n",
+           (unsigned)ui32_relayed, (unsigned)ui32_segments, (unsigned)K_RELAY_QUEUE_SIZE, (unsigned)ui32_mutated,
+           (unsigned)s_relay.ui32_forwarded, (unsigned)s_relay.ui32_dropped, (unsigned)s_relay.ui32_dropped_mutated,
+           (unsigned)s_relay.ui32_errors);
+
+    return s_relay.ui32_errors + ((ui32_relayed == (s_relay.ui32_forwarded + s_relay.ui32_dropped)) ? 0 : 1);
+}
+
+/* fixtures of the edge_payload microbenchmarks: this device's header from the template and the
+   same header field by field (as decoded), a GDL report, status, event & update get payloads
+   and their encodings */
+static struct
+{
+    ep_com_header_st            s_template;
+    ep_com_header_st            s_fields;
+    ep_monitor_payload_st       s_monitor;
+    ep_monitor_payload_st       s_monitor_fields;
+    ep_status_payload_st        s_status;
+    ep_event_payload_st         s_event;
+    ep_update_get_payload_st    s_update_get;
+    ep_monitor_view_st          s_view;
+    ep_writer_st                s_writer;
+    ep_monitor_batch_st         s_batch;
+    uint8_t                     aui8_content[3][16];
+    uint8_t                     aui8_out[1024];
+    uint8_t                     aui8_monitor[K_MON_CODEC_MAX_LEN];
+    uint8_t                     aui8_small[K_MON_CODEC_MAX_LEN];
+    uint8_t                     aui8_status[128];
+    uint8_t                     aui8_event[128];
+    uint8_t                     aui8_update_get[32];
+    size_t                      sz_monitor;
+    size_t                      sz_small;
+    size_t                      sz_status;
+    size_t                      sz_event;
+    size_t                      sz_update_get;
+} s_micro;
+
+static size_t payloadMicroComHeader(uint32_t i)
+{
+    size_t sz_len = 0;
+
+    s_micro.s_template.si32_timestamp = (int32_t)i;
+    (void)edgePayloadComHeader2Buf(s_micro.aui8_out, sizeof(s_micro.aui8_out), &sz_len, &s_micro.s_template);
+    return sz_len;
+}
+
+static size_t payloadMicroComHeaderFields(uint32_t i)
+{
+    size_t sz_len = 0;
+
+    s_micro.s_fields.si32_timestamp = (int32_t)i;
+    (void)edgePayloadComHeader2Buf(s_micro.aui8_out, sizeof(s_micro.aui8_out), &sz_len, &s_micro.s_fields);
+    return sz_len;
+}
+
+static size_t payloadMicroHeaderPrefix(uint32_t i)
+{
+    size_t sz_len = 0;
+
+    (void)edgePayloadHeaderPrefix2Buf(s_micro.aui8_out, sizeof(s_micro.aui8_out), &sz_len, (int32_t)i);
+    return sz_len;
+}
+
+static size_t payloadMicroMonitor(uint32_t i)
+{
+    size_t sz_len = 0;
+
+    s_micro.s_monitor.s_header.si32_timestamp = (int32_t)i;
+    (void)edgePayloadMonitor2Buf(s_micro.aui8_out, sizeof(s_micro.aui8_out), &sz_len, &s_micro.s_monitor);
+    return sz_len;
+}
+
+static size_t payloadMicroMonitorFields(uint32_t i)
+{
+    size_t sz_len = 0;
+
+    s_micro.s_monitor_fields.s_header.si32_timestamp = (int32_t)i;
+    (void)edgePayloadMonitor2Buf(s_micro.aui8_out, sizeof(s_micro.aui8_out), &sz_len, &s_micro.s_monitor_fields);
+    return sz_len;
+}
+
+static size_t payloadMicroWriter(uint32_t i)
+{
+    size_t sz_len = 0;
+
+    s_micro.s_template.si32_timestamp = (int32_t)i;
+    edgePayloadWriterInit(&s_micro.s_writer, s_micro.aui8_out, sizeof(s_micro.aui8_out));
+    (void)edgePayloadWriteComHeader(&s_micro.s_writer, &s_micro.s_template);
+    for (uint8_t p = 0; p < s_micro.s_monitor.ui8_phase_count; p++)
+    {
+        const ep_monitor_phase_st *ps_phase = &s_micro.s_monitor.as_mon_phase[p];
+
+        (void)edgePayloadWriteMonitorPhase(&s_micro.s_writer, (ep_phase_index_et)ps_phase->ui8_phase_index);
+        for (uint8_t k = 0; k < ps_phase->ui8_param_count; k++)
+        {
+            (void)edgePayloadWriteMonitorParam(&s_micro.s_writer, (ep_monitor_id_et)s_micro.s_monitor.as_params[ps_phase->ui8_first + k].ui8_id,
+                                               s_micro.s_monitor.as_params[ps_phase->ui8_first + k].ui16_value);
+        }
+        for (uint8_t k = 0; k < ps_phase->ui8_param32_count; k++)
+        {
+            (void)edgePayloadWriteMonitorParam32(&s_micro.s_writer, (ep_monitor_id_et)s_micro.s_monitor.as_params32[ps_phase->ui8_first32 + k].ui8_id,
+                                                 s_micro.s_monitor.as_params32[ps_phase->ui8_first32 + k].ui32_value);
+        }
+    }
+    (void)edgePayloadWriterEnd(&s_micro.s_writer, &sz_len);
+    return sz_len;
+}
+
+static size_t payloadMicroStatus(uint32_t i)
+{
+    size_t sz_len = 0;
+
+    s_micro.s_status.s_header.si32_timestamp = (int32_t)i;
+    (void)edgePayloadStatus2Buf(s_micro.aui8_out, sizeof(s_micro.aui8_out), &sz_len, &s_micro.s_status);
+    return sz_len;
+}
+
+static size_t payloadMicroEvent(uint32_t i)
+{
+    size_t sz_len = 0;
+
+    s_micro.s_event.s_header.si32_timestamp = (int32_t)i;
+    (void)edgePayloadEvent2Buf(s_micro.aui8_out, sizeof(s_micro.aui8_out), &sz_len, &s_micro.s_event);
+    return sz_len;
+}
+
+static size_t payloadMicroUpdateGet(uint32_t i)
+{
+    size_t sz_len = 0;
+
+    s_micro.s_update_get.s_header.si32_timestamp = (int32_t)i;
+    (void)edgePayloadUpdateGet2Buf(s_micro.aui8_out, sizeof(s_micro.aui8_out), &sz_len, &s_micro.s_update_get);
+    return sz_len;
+}
+
+static size_t payloadMicroBatch(uint32_t i)
+{
+    (void)i;
+    edgePayloadBatchInit(&s_micro.s_batch, s_micro.aui8_out, K_CLOUD_MONITOR_BATCH_LEN);
+    while (true == edgePayloadBatchAddMonitor(&s_micro.s_batch, s_micro.aui8_small, s_micro.sz_small))
+    {
+        // the same interval again: 0 s after the first
+    }
+    return edgePayloadBatchLen(&s_micro.s_batch);
+}
+
+static size_t payloadMicroBuf2Monitor(uint32_t i)
+{
+    (void)i;
+    return (true == edgePayloadBuf2Monitor(s_micro.aui8_monitor, s_micro.sz_monitor, &s_micro.s_view)) ? s_micro.sz_monitor : 0;
+}
+
+static size_t payloadMicroBuf2MonitorRead(uint32_t i)
+{
+    size_t sz_sum = 0;
+
+    (void)i;
+    if (true == edgePayloadBuf2Monitor(s_micro.aui8_monitor, s_micro.sz_monitor, &s_micro.s_view))
+    {
+        for (uint8_t p = 0; p < s_micro.s_view.ui8_phase_count; p++)
+        {
+            ep_monitor_cursor_st    s_cursor;
+            uint8_t                 ui8_id;
+            uint32_t                ui32_value;
+
+            edgePayloadMonitorViewCursor(&s_micro.s_view.as_phases[p], &s_cursor);
+            while (true == edgePayloadMonitorViewNext(&s_cursor, &ui8_id, &ui32_value))
+            {
+                sz_sum += ui32_value;
+            }
+        }
+    }
+    return (0 != sz_sum) ? s_micro.sz_monitor : 0;
+}
+
+static size_t payloadMicroBuf2Status(uint32_t i)
+{
+    static ep_status_payload_st s_status;
+
+    (void)i;
+    return (true == edgePayloadBuf2Status(s_micro.aui8_status, s_micro.sz_status, &s_status)) ? s_micro.sz_status : 0;
+}
+
+static size_t payloadMicroBuf2Event(uint32_t i)
+{
+    static ep_event_payload_st s_event;
+
+    (void)i;
+    return (true == edgePayloadBuf2Event(s_micro.aui8_event, s_micro.sz_event, &s_event)) ? s_micro.sz_event : 0;
+}
+
+static size_t payloadMicroBuf2UpdateGet(uint32_t i)
+{
+    static ep_update_get_payload_st s_update_get;
+
+    (void)i;
+    return (true == edgePayloadBuf2UpdateGet(s_micro.aui8_update_get, s_micro.sz_update_get, &s_update_get)) ? s_micro.sz_update_get : 0;
+}
+
+/* n calls of every edge_payload encoder & decoder on fixed payloads, after n / 8 to warm up:
+   time per call & bytes per second */
+static uint32_t payloadMicro(uint32_t ui32_calls)
+{
+    static const struct
+    {
+        const char *pc_name;
+        size_t      (*pf_call)(uint32_t i);
+    } AS_MICRO[] =
+    {
+        { "edgePayloadComHeader2Buf (template)",            payloadMicroComHeader       },
+        { "edgePayloadComHeader2Buf (fields)",              payloadMicroComHeaderFields },
+        { "edgePayloadHeaderPrefix2Buf",                    payloadMicroHeaderPrefix    },
+        { "edgePayloadMonitor2Buf (GDL, template)",         payloadMicroMonitor         },
+        { "edgePayloadMonitor2Buf (GDL, fields)",           payloadMicroMonitorFields   },
+        { "edgePayloadWrite* (GDL, template)",              payloadMicroWriter          },
+        { "edgePayloadStatus2Buf (3 tags)",                 payloadMicroStatus          },
+        { "edgePayloadEvent2Buf (3 events)",                payloadMicroEvent           },
+        { "edgePayloadUpdateGet2Buf",                       payloadMicroUpdateGet       },
+        { "edgePayloadBatchAddMonitor (1 phase, full)",     payloadMicroBatch           },
+        { "edgePayloadBuf2Monitor (GDL)",                   payloadMicroBuf2Monitor     },
+        { "edgePayloadBuf2Monitor (GDL) & read",            payloadMicroBuf2MonitorRead },
+        { "edgePayloadBuf2Status (3 tags)",                 payloadMicroBuf2Status      },
+        { "edgePayloadBuf2Event (3 events)",                payloadMicroBuf2Event       },
+        { "edgePayloadBuf2UpdateGet",                       payloadMicroBuf2UpdateGet   },
+    };
+    size_t  sz_hdr_len = 0;
+    bool    b_ok;
+
+    edgePayloadInit();
+    (void)edgePayloadInitComHeader(&s_micro.s_template, 1780000000);
+    (void)edgePayloadHeaderPrefix2Buf(s_micro.aui8_out, sizeof(s_micro.aui8_out), &sz_hdr_len, 1780000000);
+    b_ok = edgePayloadBuf2ComHeader(s_micro.aui8_out, sz_hdr_len, &sz_hdr_len, &s_micro.s_fields);
+
+    s_micro.sz_monitor = batchSimRecord(0, 1, 1780000000, s_micro.aui8_monitor, sizeof(s_micro.aui8_monitor));
+    s_micro.sz_small   = batchSimRecord(2, 1, 1780000000, s_micro.aui8_small, sizeof(s_micro.aui8_small));
+    b_ok = (true == edgePayloadBuf2Monitor(s_micro.aui8_monitor, s_micro.sz_monitor, &s_micro.s_view)) && b_ok;
+    (void)edgePayloadInitMonitor(&s_micro.s_monitor, &s_micro.s_template);
+    for (uint8_t p = 0; p < s_micro.s_view.ui8_phase_count; p++)
+    {
+        ep_monitor_cursor_st    s_cursor;
+        uint8_t                 ui8_id;
+        uint32_t                ui32_value;
+
+        (void)edgePayloadNewMonitorPhase(&s_micro.s_monitor, (ep_phase_index_et)s_micro.s_view.as_phases[p].ui8_phase_index);
+        edgePayloadMonitorViewCursor(&s_micro.s_view.as_phases[p], &s_cursor);
+        while (true == edgePayloadMonitorViewNext(&s_cursor, &ui8_id, &ui32_value))
+        {
+            b_ok = ((5 == edgePayloadMonitorParamLen(ui8_id)) ? edgePayloadAddMonitorParam32(&s_micro.s_monitor, (ep_monitor_id_et)ui8_id, ui32_value)
+                                                              : edgePayloadAddMonitorParam(&s_micro.s_monitor, (ep_monitor_id_et)ui8_id, (uint16_t)ui32_value)) && b_ok;
+        }
+    }
+    s_micro.s_monitor_fields          = s_micro.s_monitor;
+    s_micro.s_monitor_fields.s_header = s_micro.s_fields;
+
+    (void)edgePayloadInitStatus(&s_micro.s_status, &s_micro.s_template);
+    (void)edgePayloadInitEvent(&s_micro.s_event, &s_micro.s_template);
+    for (uint8_t k = 0; k < 3; k++)
+    {
+        memset(s_micro.aui8_content[k], 0x30 + k, sizeof(s_micro.aui8_content[k]));
+        b_ok = edgePayloadAddStatusTag(&s_micro.s_status, (ep_tag_id_et)(EP_STATUS_TAG_COMMS_SW_VER + k), s_micro.aui8_content[k], sizeof(s_micro.aui8_content[k])) && b_ok;
+        b_ok = edgePayloadAddEventContent(&s_micro.s_event, EP_EVT_TYP_GDL_UV_WARN, s_micro.aui8_content[k], sizeof(s_micro.aui8_content[k])) && b_ok;
+    }
+    (void)edgePayloadInitUpdateGet(&s_micro.s_update_get, &s_micro.s_template);
+    (void)edgePayloadSetUpdateGetContent(&s_micro.s_update_get, 0x12000, 512);
+
+    b_ok = edgePayloadStatus2Buf(s_micro.aui8_status, sizeof(s_micro.aui8_status), &s_micro.sz_status, &s_micro.s_status) && b_ok;
+    b_ok = edgePayloadEvent2Buf(s_micro.aui8_event, sizeof(s_micro.aui8_event), &s_micro.sz_event, &s_micro.s_event) && b_ok;
+    b_ok = edgePayloadUpdateGet2Buf(s_micro.aui8_update_get, sizeof(s_micro.aui8_update_get), &s_micro.sz_update_get, &s_micro.s_update_get) && b_ok;
+
+    // both headers encode to the same bytes, so do the reports built on them
+    b_ok = (payloadMicroComHeader(7) == payloadMicroComHeaderFields(7)) && b_ok;
+    b_ok = (s_micro.sz_monitor == payloadMicroMonitorFields(1780000000)) && (0 == memcmp(s_micro.aui8_out, s_micro.aui8_monitor, s_micro.sz_monitor)) && b_ok;
+    b_ok = (s_micro.sz_monitor == payloadMicroWriter(1780000000)) && (0 == memcmp(s_micro.aui8_out, s_micro.aui8_monitor, s_micro.sz_monitor)) && b_ok;
+    b_ok = (s_micro.sz_monitor == payloadMicroMonitor(1780000000)) && (0 == memcmp(s_micro.aui8_out, s_micro.aui8_monitor, s_micro.sz_monitor)) && b_ok;
+
+    printf("--- payload micro: %u calls each, fixtures %s ---\r\n", (unsigned)ui32_calls, (true == b_ok) ? "ok" : "BROKEN");
+    for (size_t f = 0; f < (sizeof(AS_MICRO) / sizeof(AS_MICRO[0])); f++)
+    {
+        uint64_t    ui64_bytes = 0;
+        uint64_t    ns;
+
+        for (uint32_t i = 0; i < (ui32_calls / 8); i++)
+        {
+            ui64_bytes += AS_MICRO[f].pf_call(i);
+        }
+
+        ui64_bytes = 0;
+        ns = nowNs();
+        for (uint32_t i = 0; i < ui32_calls; i++)
+        {
+            ui64_bytes += AS_MICRO[f].pf_call(i);
+        }
+        ns = nowNs() - ns;
+
+        printf("    %-46s %8.1f ns per call %8.0f MB/s %5u B ---\r\n", AS_MICRO[f].pc_name, (double)ns / (ui32_calls ? ui32_calls : 1),
+               (double)ui64_bytes * 1000.0 / (ns ? ns : 1), (unsigned)(ui64_bytes / (ui32_calls ? ui32_calls : 1)));
+    }
+
+    return (true == b_ok) ? 0 : 1;
+}
+
+
+static const host_test_st AS_TESTS[] =
+{
+    { "--payload-bench=",   "20000",    payloadBench,   NULL },
+    { "--payload-pack=",    "20000",    payloadPack,    NULL },
+    { "--batch-sim=",       "2000",     batchSim,       NULL },
+    { "--payload-fuzz=",    "5000",     payloadFuzz,    NULL },
+    { "--mesh-relay=",      "2000",     meshRelay,      NULL },
+    { "--payload-micro=",   "20000",    payloadMicro,   NULL },
+};
+
+int main(int argc, char *argv[])
+{
+    return hostTestMain(argc, argv, AS_TESTS, sizeof(AS_TESTS) / sizeof(AS_TESTS[0]));
+}
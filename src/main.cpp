@@ -7,7 +7,9 @@
 #include "input_monitoring.h"
 #include "lora_mesh.h"
 #include "modem_manager.h"
+#if !defined(HOST_BUILD)
 #include "wifi_manager.h"
+#endif
 #include <stdio.h>
 
 
@@ -22,10 +24,14 @@
 DECLARE_TASK(Heartbeat,       heartbeat::init,          heartbeat::cycle,          1000);
 DECLARE_TASK(EnmtrManager,    enmtr::manager::init,     enmtr::manager::cycle,      100);
 DECLARE_TASK(InputMonitoring, input::monitoring::init,  input::monitoring::cycle,   100);
+#if !defined(HOST_BUILD)
 DECLARE_TASK(WifiManager,     wifi::manager::init,      wifi::manager::cycle,       100);
+#endif
 DECLARE_TASK(ModemManager,    modem::manager::init,     modem::manager::cycle,       10);
 DECLARE_TASK(LoraMesh,        lora::mesh::init,         lora::mesh::cycle,          100);
+#if !defined(HOST_BUILD)
 DECLARE_TASK(CloudComms,      cloud::comms::init,       cloud::comms::cycle,         10);
+#endif
 DECLARE_TASK(DataLogging,     data::logging::init,      data::logging::cycle,       100);
 
     
@@ -36,6 +42,12 @@ extern "C" void app_main(void)
                     ESP_ERROR_CHECK(esp_task_wdt_add_user(#task, &task##_wdt_hdl)); \
                     assert(pdTRUE == xTaskCreatePinnedToCore(task##Task, #task, (stack), NULL, (priority), NULL, (core)))
 
+#if defined(HOST_BUILD) // see "host/CMakeLists.txt"
+    RUN_TASK(Heartbeat,         2*1024,  2, 1);
+    RUN_TASK(EnmtrManager,      4*1024,  7, 0);
+    RUN_TASK(InputMonitoring,   2*1024,  5, 1);
+    RUN_TASK(DataLogging,       2*1024,  3, 1);
+#else
     // RUN_TASK(Heartbeat,         2*1024,  2, 1);
     // RUN_TASK(EnmtrManager,      4*1024,  7, 0);
     // RUN_TASK(InputMonitoring,   2*1024,  5, 1);
@@ -44,4 +56,5 @@ extern "C" void app_main(void)
     // RUN_TASK(LoraMesh,          2*1024,  4, 0);
     // RUN_TASK(CloudComms,        8*1024,  3, 1);
     // RUN_TASK(DataLogging,       2*1024,  3, 1);
+#endif
 }